@@ -96,6 +96,15 @@ class LIBNXMAP_EXPORTABLE nxmap_ObjList
 protected:
    IntegerArray<UINT32> *m_objectList;
    ObjectArray<ObjLink> *m_linkList;
+   bool m_objectListSorted;
+   int m_removedLinks;
+   HashMap<UINT32, ObjectArray<ObjLink> > *m_objects;   // object ID -> links of that object
+   HashMap<UINT64, ObjLink> *m_links;                    // unordered object ID pair -> link
+
+   void sortObjects();
+   void compactLinks();
+   void registerLink(ObjLink *link);
+   ObjLink *findLink(UINT32 id1, UINT32 id2);
 
 public:
    nxmap_ObjList();
@@ -110,9 +119,9 @@ public:
    void clear();
 
    int getNumObjects() { return m_objectList->size(); }
-   IntegerArray<UINT32> *getObjects() { return m_objectList; }
-   int getNumLinks() { return m_linkList->size(); }
-   ObjectArray<ObjLink> *getLinks() { return m_linkList; }
+   IntegerArray<UINT32> *getObjects() { sortObjects(); return m_objectList; }
+   int getNumLinks() { return m_linkList->size() - m_removedLinks; }
+   ObjectArray<ObjLink> *getLinks() { compactLinks(); return m_linkList; }
 
 	void createMessage(NXCPMessage *pMsg);
 
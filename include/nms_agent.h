@@ -268,6 +268,9 @@
 #define DCIDESC_AGENT_PROXY_ISENABLED             _T("Check if agent proxy is enabled")
 #define DCIDESC_AGENT_REGISTRAR                   _T("Registrar server address set on agent startup")
 #define DCIDESC_AGENT_REJECTEDCONNECTIONS         _T("Number of connections rejected by agent")
+#define DCIDESC_AGENT_REQUESTS_ACTIVE             _T("Number of server requests being processed by agent")
+#define DCIDESC_AGENT_REQUESTS_AVGTIME            _T("Average server request processing time (milliseconds)")
+#define DCIDESC_AGENT_REQUESTS_QUEUESIZE          _T("Number of server requests waiting for processing")
 #define DCIDESC_AGENT_SENT_TRAPS                  _T("Number of traps successfully sent to server")
 #define DCIDESC_AGENT_SNMP_ISPROXYENABLED         _T("Check if SNMP proxy is enabled")
 #define DCIDESC_AGENT_SNMP_REQUESTS               _T("Number of SNMP requests sent")
@@ -205,6 +205,20 @@ void LIBNETXMS_EXPORTABLE bswap_array_32(UINT32 *v, int len);
 #define NXLOG_DEBUG_MODE        ((UINT32)0x00000008)
 #define NXLOG_IS_OPEN           ((UINT32)0x80000000)
 
+/**
+ * Maximum length of debug tag
+ */
+#define MAX_DEBUG_TAG_LENGTH     64
+
+/**
+ * Debug tag with individual debug level
+ */
+struct DebugTagInfo
+{
+   TCHAR tag[MAX_DEBUG_TAG_LENGTH];
+   int level;
+};
+
 /**
  * nxlog rotation policy
  */
@@ -936,6 +950,35 @@ public:
    Iterator<const TCHAR> *iterator() { return new Iterator<const TCHAR>(new StringSetIterator(this)); }
 };
 
+/**
+ * Index of names which may contain * and ? wildcards (like agent parameter names).
+ * Names are matched case-insensitively. Names without wildcards before argument
+ * list (like Net.Interface.BytesIn(*)) are indexed by the part before argument list,
+ * all other names are checked one by one. Lookup returns ID (position in order of
+ * addition) of first matching name, same as sequential check with MatchString.
+ */
+class LIBNETXMS_EXPORTABLE WildcardNameIndex
+{
+private:
+   StringList m_names;     // names converted to upper case
+   StringObjectMap<IntegerArray<INT32> > m_keys;
+   IntegerArray<INT32> m_patterns;
+
+   static bool getKey(const TCHAR *name, TCHAR *key, size_t size);
+
+public:
+   WildcardNameIndex();
+   ~WildcardNameIndex();
+
+   int add(const TCHAR *name);
+   void clear();
+
+   int find(const TCHAR *name) const;
+   int findExact(const TCHAR *name) const;
+
+   int size() const { return m_names.size(); }
+};
+
 /**
  * Opaque hash map entry structure
  */
@@ -2162,6 +2205,11 @@ bool LIBNETXMS_EXPORTABLE nxlog_set_rotation_policy(int rotationMode, UINT64 max
 bool LIBNETXMS_EXPORTABLE nxlog_rotate();
 void LIBNETXMS_EXPORTABLE nxlog_set_debug_level(int level);
 int LIBNETXMS_EXPORTABLE nxlog_get_debug_level();
+UINT64 LIBNETXMS_EXPORTABLE nxlog_get_dropped_count();
+void LIBNETXMS_EXPORTABLE nxlog_set_debug_level_tag(const TCHAR *tag, int level);
+int LIBNETXMS_EXPORTABLE nxlog_get_debug_level_tag(const TCHAR *tag);
+void LIBNETXMS_EXPORTABLE nxlog_debug_tag(const TCHAR *tag, int level, const TCHAR *format, ...);
+void LIBNETXMS_EXPORTABLE nxlog_debug_tag2(const TCHAR *tag, int level, const TCHAR *format, va_list args);
 
 typedef void (*NxLogDebugWriter)(const TCHAR *);
 void LIBNETXMS_EXPORTABLE nxlog_set_debug_writer(NxLogDebugWriter writer);
@@ -2255,6 +2303,8 @@ String LIBNETXMS_EXPORTABLE EscapeStringForAgent(const TCHAR *s);
 
 StringList LIBNETXMS_EXPORTABLE *ParseCommandLine(const TCHAR *cmdline);
 
+StructArray<DebugTagInfo> LIBNETXMS_EXPORTABLE *nxlog_get_debug_tags();
+
 #if !defined(_WIN32) && !defined(_NETWARE) && defined(NMS_THREADS_H_INCLUDED)
 void LIBNETXMS_EXPORTABLE BlockAllSignals(bool processWide, bool allowInterrupt);
 void LIBNETXMS_EXPORTABLE StartMainLoop(ThreadFunction pfSignalHandler, ThreadFunction pfMain);
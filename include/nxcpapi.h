@@ -158,13 +158,23 @@ public:
 typedef struct
 {
    void *msg;         // Pointer to message, either to NXCPMessage object or raw message
-   UINT64 sequence;   // Sequence number
    UINT32 id;         // Message ID
    UINT32 ttl;        // Message time-to-live in milliseconds
    UINT16 code;       // Message code
    UINT16 isBinary;   // 1 for binary (raw) messages
+   int next;          // Next element with same code and ID or next free element
 } WAIT_QUEUE_ELEMENT;
 
+/**
+ * Message waiting queue index entry (internal)
+ */
+struct WaitQueueIndexEntry;
+
+/**
+ * Thread waiting for message in message waiting queue (internal)
+ */
+struct WaitQueueWaiter;
+
 /**
  * Max number of waiting threads in message queue
  */
@@ -182,18 +192,25 @@ private:
    BYTE m_waiters[MAX_MSGQUEUE_WAITERS];
 #elif defined(_USE_GNU_PTH)
    pth_mutex_t m_mutex;
-   pth_cond_t m_wakeupCondition;
 #else
    pthread_mutex_t m_mutex;
-   pthread_cond_t m_wakeupCondition;
 #endif
    UINT32 m_holdTime;
    int m_size;
    int m_allocated;
+   int m_firstFree;
    WAIT_QUEUE_ELEMENT *m_elements;
-   UINT64 m_sequence;
+   WaitQueueIndexEntry *m_index;
+   WaitQueueIndexEntry *m_freeIndexEntries;
+   UINT64 m_wakeups;
+   UINT64 m_spuriousWakeups;
 
    void *waitForMessageInternal(UINT16 isBinary, UINT16 code, UINT32 id, UINT32 timeout);
+   void putInternal(void *msg, UINT16 code, UINT32 id, UINT16 isBinary);
+   WaitQueueIndexEntry *getIndexEntry(UINT16 isBinary, UINT16 code, UINT32 id, bool create);
+   void releaseIndexEntry(WaitQueueIndexEntry *entry);
+   void wakeupWaiter(WaitQueueIndexEntry *entry);
+   void destroyMessage(int index);
 
    void lock()
    {
@@ -116,6 +116,34 @@ struct LIBNXDB_PERF_COUNTERS
    UINT64 totalQueries;
    UINT64 longRunningQueries;
    UINT64 failedQueries;
+   UINT64 statementCacheHits;
+   UINT64 statementCacheMisses;
+   UINT64 statementCacheEvictions;
+};
+
+/**
+ * Maximum length of normalized query text (fingerprint)
+ */
+#define MAX_QUERY_FINGERPRINT_LENGTH   256
+
+/**
+ * Number of buckets in query latency histogram
+ * (<1 ms, <10 ms, <100 ms, <1 s, <10 s, 10 s and more)
+ */
+#define DB_QUERY_HISTOGRAM_SIZE        6
+
+/**
+ * Statistics for queries with same fingerprint
+ */
+struct LIBNXDB_QUERY_STATS
+{
+   TCHAR fingerprint[MAX_QUERY_FINGERPRINT_LENGTH];
+   UINT64 count;
+   UINT64 failed;
+   UINT64 totalTime;    // milliseconds
+   UINT32 maxTime;      // milliseconds
+   UINT64 rows;
+   UINT64 histogram[DB_QUERY_HISTOGRAM_SIZE];
 };
 
 /**
@@ -238,9 +266,13 @@ int LIBNXDB_EXPORTABLE DBConnectionPoolGetSize();
 int LIBNXDB_EXPORTABLE DBConnectionPoolGetAcquiredCount();
 
 void LIBNXDB_EXPORTABLE DBSetLongRunningThreshold(UINT32 threshold);
+void LIBNXDB_EXPORTABLE DBSetStatementCacheSize(int size);
 void LIBNXDB_EXPORTABLE DBAbortReconnect();
 ObjectArray<PoolConnectionInfo> LIBNXDB_EXPORTABLE *DBConnectionPoolGetConnectionList();
 void LIBNXDB_EXPORTABLE DBGetPerfCounters(LIBNXDB_PERF_COUNTERS *counters);
+StructArray<LIBNXDB_QUERY_STATS> LIBNXDB_EXPORTABLE *DBGetQueryStatistics(UINT64 *untrackedQueries = NULL);
+void LIBNXDB_EXPORTABLE DBResetQueryStatistics();
+UINT32 LIBNXDB_EXPORTABLE DBNormalizeQuery(const TCHAR *query, TCHAR *buffer, size_t size);
 
 bool LIBNXDB_EXPORTABLE IsDatabaseRecordExist(DB_HANDLE hdb, const TCHAR *table, const TCHAR *idColumn, UINT32 id);
 bool LIBNXDB_EXPORTABLE IsDatabaseRecordExist(DB_HANDLE hdb, const TCHAR *table, const TCHAR *idColumn, const uuid& id);
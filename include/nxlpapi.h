@@ -84,6 +84,7 @@
 typedef void (* LogParserCallback)(UINT32, const TCHAR *, const TCHAR *, const TCHAR *, UINT32, UINT32, int, TCHAR **, UINT32, int, void *);
 
 class LIBNXLP_EXPORTABLE LogParser;
+class LogParserPrefilter;
 
 /**
  * Per object rule statistics
@@ -111,6 +112,7 @@ private:
 	int m_numParams;
 	regmatch_t *m_pmatch;
 	TCHAR *m_regexp;
+	TCHAR *m_literal;    // literal which must be present in matching line (NULL if cannot be determined)
 	TCHAR *m_source;
 	UINT32 m_level;
 	UINT32 m_idStart;
@@ -218,14 +220,27 @@ private:
 	int m_recordsProcessed;
 	int m_recordsMatched;
 	bool m_processAllRules;
+	bool m_prefilterEnabled;
+	bool m_prefilterValid;
+	LogParserPrefilter *m_prefilter;
+	bool *m_prefilterDefaults;
+	bool *m_prefilterHits;
 	int m_traceLevel;
 	void (*m_traceCallback)(int, const TCHAR *, va_list);
 	TCHAR m_status[MAX_PARSER_STATUS_LEN];
+	int m_fileHandle;
+	size_t m_fileSize;
+	bool m_readFromStart;
+	bool m_fileChanged;
+	int m_watchDescriptor;
+	TCHAR m_currentFile[MAX_PATH];
 #ifdef _WIN32
    TCHAR *m_marker;
 #endif
 
 	const TCHAR *checkContext(LogParserRule *rule);
+	void buildPrefilter();
+	const bool *prefilter(const TCHAR *line);
 	void trace(int level, const TCHAR *format, ...);
 	bool matchLogRecord(bool hasAttributes, const TCHAR *source, UINT32 eventId, UINT32 level, const TCHAR *line, UINT32 objectId);
 
@@ -233,6 +248,12 @@ private:
 
    int getCharSize() const;
 
+   bool openMonitoredFile();
+   bool checkMonitoredFile();
+   void closeMonitoredFile();
+   void updateFileWatch(int notifyHandle, ObjectArray<LogParser> *parsers);
+   static bool waitForFileEvents(int notifyHandle, int wakeupHandle, ObjectArray<LogParser> *parsers, CONDITION stopCondition, UINT32 timeout);
+
    void setStatus(const TCHAR *status) { nx_strncpy(m_status, status, MAX_PARSER_STATUS_LEN); }
 
 #ifdef _WIN32
@@ -267,6 +288,9 @@ public:
 	void setProcessAllFlag(bool flag) { m_processAllRules = flag; }
 	bool getProcessAllFlag() { return m_processAllRules; }
 
+	void setPrefilterFlag(bool flag) { m_prefilterEnabled = flag; }
+	bool getPrefilterFlag() { return m_prefilterEnabled; }
+
 	bool addRule(const TCHAR *regexp, UINT32 eventCode = 0, const TCHAR *eventName = NULL, int numParams = 0, int repeatInterval = 0, int repeatCount = 0, bool resetRepeat = true);
 	bool addRule(LogParserRule *rule);
 	void setCallback(LogParserCallback cb) { m_cb = cb; }
@@ -289,11 +313,14 @@ public:
 	void setTraceCallback(void (*cb)(int, const TCHAR *, va_list)) { m_traceCallback = cb; }
 
 	bool monitorFile(CONDITION stopCondition, bool readFromCurrPos = true);
+	static bool monitorFiles(ObjectArray<LogParser> *parsers, CONDITION stopCondition, bool readFromCurrPos = true);
+	static void stopFileMonitoring(CONDITION stopCondition);
 #ifdef _WIN32
 	bool monitorEventLog(CONDITION stopCondition, const TCHAR *markerPrefix);
    void saveLastProcessedRecordTimestamp(time_t timestamp);
 #endif
 
+   int getRuleCount() const { return m_rules->size(); }
    int getRuleCheckCount(const TCHAR *ruleName, UINT32 objectId = 0) const { const LogParserRule *r = findRuleByName(ruleName); return (r != NULL) ? r->getCheckCount(objectId) : -1; }
    int getRuleMatchCount(const TCHAR *ruleName, UINT32 objectId = 0) const { const LogParserRule *r = findRuleByName(ruleName); return (r != NULL) ? r->getMatchCount(objectId) : -1; }
 
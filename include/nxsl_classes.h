@@ -307,6 +307,53 @@ public:
    }
 };
 
+/**
+ * Pool for NXSL_Value objects. Owned by VM; once detached from VM it is destroyed
+ * after last value allocated from it is deleted. Blocks of values destroyed by
+ * owning thread are put back to free list directly; blocks of values destroyed
+ * by other threads are put to separate list protected by mutex and taken back
+ * by owning thread when free list is exhausted. VM rebinds pool to thread which
+ * executes it.
+ */
+class LIBNXSL_EXPORTABLE NXSL_ValuePool
+{
+private:
+   void *m_chunks;
+   void *m_freeList;
+   void *m_remoteFreeList;
+   MUTEX m_remoteLock;
+   int m_chunkSize;
+   VolatileCounter m_activeBlocks;  // Includes one reference held by owner until detach
+   UINT64 m_owner;
+   bool m_detached;
+   UINT64 m_allocations;
+   UINT32 m_chunkAllocations;
+
+   ~NXSL_ValuePool();
+
+public:
+   NXSL_ValuePool(int chunkSize = 256);
+
+   void *allocate(size_t size);
+   void deallocate(void *block);
+   void detach();
+   void setOwner();
+
+   UINT64 getAllocations() const { return m_allocations; }
+   UINT32 getChunkAllocations() const { return m_chunkAllocations; }
+   int getActiveBlocks() const { return m_detached ? (int)m_activeBlocks : (int)m_activeBlocks - 1; }
+};
+
+/**
+ * Size of internal buffer for short string representation (in bytes)
+ */
+#define NXSL_SHORT_STRING_BUFFER_SIZE  32
+
+/**
+ * Length of internal buffer for short string representation (in characters, including terminating 0)
+ */
+#define NXSL_SHORT_STRING_LENGTH       (NXSL_SHORT_STRING_BUFFER_SIZE / sizeof(TCHAR))
+
 /**
  * Variable or constant value
  */
@@ -315,6 +362,7 @@ class LIBNXSL_EXPORTABLE NXSL_Value
 protected:
    UINT32 m_dwStrLen;
    TCHAR *m_pszValStr;
+   TCHAR m_stringBuffer[NXSL_SHORT_STRING_LENGTH];
 #ifdef UNICODE
 	char *m_valueMBStr;	// value as MB string; NULL until first request
 #endif
@@ -336,10 +384,18 @@ protected:
 
    void updateNumber();
    void updateString();
+   void setString(const TCHAR *value, UINT32 len);
+
+   void freeString()
+   {
+      if (m_pszValStr != m_stringBuffer)
+         free(m_pszValStr);
+      m_pszValStr = NULL;
+   }
 
    void invalidateString()
    {
-      safe_free_and_null(m_pszValStr);
+      freeString();
 #ifdef UNICODE
 		safe_free_and_null(m_valueMBStr);
 #endif
@@ -347,6 +403,11 @@ protected:
    }
 
 public:
+   void *operator new(size_t size);
+   void *operator new(size_t size, NXSL_ValuePool *pool);
+   void operator delete(void *p);
+   void operator delete(void *p, NXSL_ValuePool *pool);
+
    NXSL_Value();
    NXSL_Value(const NXSL_Value *src);
    NXSL_Value(NXSL_Object *object);
@@ -796,6 +857,9 @@ protected:
    int m_errorLine;
    TCHAR *m_errorText;
 
+   NXSL_ValuePool *m_valuePool;
+   UINT64 m_instructionCount;
+
    void execute();
    bool unwind();
    void callFunction(int nArgCount);
@@ -858,6 +922,9 @@ public:
    const TCHAR *getErrorText() { return CHECK_NULL_EX(m_errorText); }
    NXSL_Value *getResult() { return m_pRetValue; }
 
+   UINT64 getInstructionCount() const { return m_instructionCount; }
+   const NXSL_ValuePool *getValuePool() const { return m_valuePool; }
+
 	void *getUserData() { return m_userData; }
 	void setUserData(void *data) { m_userData = data; }
 };
@@ -168,6 +168,7 @@
 #define ASN_UINTEGER32              0x47
 #define ASN_NO_SUCH_OBJECT          0x80
 #define ASN_NO_SUCH_INSTANCE        0x81
+#define ASN_END_OF_MIBVIEW          0x82
 #define ASN_GET_REQUEST_PDU         0xA0
 #define ASN_GET_NEXT_REQUEST_PDU    0xA1
 #define ASN_RESPONSE_PDU            0xA2
@@ -445,6 +446,7 @@ private:
 	size_t m_idLen;
 	int m_engineBoots;
 	int m_engineTime;
+	time_t m_timeUpdated;   // local time when engine time was received
 
 public:
 	SNMP_Engine();
@@ -456,9 +458,10 @@ public:
 	size_t getIdLen() const { return m_idLen; }
 	int getBoots() const { return m_engineBoots; }
 	int getTime() const { return m_engineTime; }
+	int getAdjustedTime() const { return (m_engineTime != 0) ? m_engineTime + (int)(time(NULL) - m_timeUpdated) : 0; }
 
 	void setBoots(int boots) { m_engineBoots = boots; }
-	void setTime(int engineTime) { m_engineTime = engineTime; }
+	void setTime(int engineTime) { m_engineTime = engineTime; m_timeUpdated = time(NULL); }
 };
 
 /**
@@ -478,8 +481,9 @@ private:
 	SNMP_Engine m_authoritativeEngine;
 	int m_authMethod;
 	int m_privMethod;
+	bool m_validKeys;
 
-	void recalculateKeys();
+	void validateKeys();
 
 public:
 	SNMP_SecurityContext();
@@ -501,17 +505,17 @@ public:
 	bool needEncryption() { return (m_privMethod != SNMP_ENCRYPT_NONE) && (m_authoritativeEngine.getIdLen() != 0); }
 	int getAuthMethod() { return m_authMethod; }
 	int getPrivMethod() { return m_privMethod; }
-	BYTE *getAuthKeyMD5() { return m_authKeyMD5; }
-	BYTE *getAuthKeySHA1() { return m_authKeySHA1; }
-	BYTE *getPrivKey() { return m_privKey; }
+	BYTE *getAuthKeyMD5() { validateKeys(); return m_authKeyMD5; }
+	BYTE *getAuthKeySHA1() { validateKeys(); return m_authKeySHA1; }
+	BYTE *getPrivKey() { validateKeys(); return m_privKey; }
 
 	void setAuthName(const char *name);
 	void setCommunity(const char *community) { setAuthName(community); }
 	void setUser(const char *user) { setAuthName(user); }
 	void setAuthPassword(const char *password);
 	void setPrivPassword(const char *password);
-	void setAuthMethod(int method) { m_authMethod = method; }
-	void setPrivMethod(int method) { m_privMethod = method; }
+	void setAuthMethod(int method) { m_authMethod = method; m_validKeys = false; }
+	void setPrivMethod(int method) { m_privMethod = method; m_validKeys = false; }
 	void setSecurityModel(int model) { m_securityModel = model; }
 	void setContextName(const TCHAR *name);
 #ifdef UNICODE
@@ -591,6 +595,12 @@ public:
    UINT32 getVersion() { return m_version; }
    UINT32 getErrorCode() { return m_dwErrorCode; }
 
+   // GETBULK request parameters are encoded in place of error status and error index
+   UINT32 getNonRepeaters() { return m_dwErrorCode; }
+   void setNonRepeaters(UINT32 value) { m_dwErrorCode = value; }
+   UINT32 getMaxRepetitions() { return m_dwErrorIndex; }
+   void setMaxRepetitions(UINT32 value) { m_dwErrorIndex = value; }
+
 	void setMessageId(UINT32 msgId) { m_msgId = msgId; }
 	UINT32 getMessageId() { return m_msgId; }
 
@@ -705,6 +715,94 @@ public:
    UINT16 getPort() { return m_port; }
 };
 
+/**
+ * Completion callback for asynchronous SNMP request. Response is NULL if request
+ * failed; it is destroyed by engine after callback returns.
+ */
+typedef void (*SNMP_AsyncCallback)(UINT32 rc, SNMP_PDU *response, void *context);
+
+/**
+ * Asynchronous SNMP engine statistics
+ */
+struct SNMP_AsyncEngineStats
+{
+   UINT64 requests;
+   UINT64 responses;
+   UINT64 timeouts;
+   UINT64 retransmissions;
+   UINT64 unmatchedResponses;
+   int inFlight;
+   int waiting;
+   int targets;
+};
+
+/**
+ * Target key for asynchronous SNMP engine
+ */
+struct SNMP_AsyncTargetKey
+{
+   BYTE addr[16];
+   UINT16 port;
+   INT16 family;
+};
+
+struct SNMP_AsyncRequest;
+struct SNMP_AsyncTarget;
+struct SNMP_AsyncTimer;
+
+/**
+ * Asynchronous SNMP engine. Requests to all targets are sent through small
+ * number of shared UDP sockets and matched to responses by request ID.
+ * Timeouts and retransmissions are handled by engine's I/O thread, which
+ * also calls completion callbacks, so callbacks should not block.
+ * Only SNMP versions 1 and 2c are supported.
+ */
+class LIBNXSNMP_EXPORTABLE SNMP_AsyncEngine
+{
+private:
+   SOCKET m_socketV4;
+   SOCKET m_socketV6;
+   MUTEX m_mutex;
+   THREAD m_thread;
+   volatile bool m_shutdown;
+   bool m_running;      // protected by engine mutex
+   int m_maxInFlight;
+   HashMap<UINT32, SNMP_AsyncRequest> *m_requests;
+   HashMap<SNMP_AsyncTargetKey, SNMP_AsyncTarget> *m_targets;
+   SNMP_AsyncTimer *m_timers;
+   int m_timerCount;
+   int m_timerAllocated;
+   int m_waiting;
+   UINT64 m_requestCount;
+   UINT64 m_responseCount;
+   UINT64 m_timeoutCount;
+   UINT64 m_retransmissionCount;
+   UINT64 m_unmatchedCount;
+
+   static THREAD_RESULT THREAD_CALL ioThreadStarter(void *arg);
+   void ioThread();
+   void transmit(SNMP_AsyncRequest *rq);
+   void addTimer(SNMP_AsyncRequest *rq);
+   void finish(SNMP_AsyncRequest *rq, UINT32 rc, SNMP_PDU *response, SNMP_AsyncRequest **completed);
+   void receive(SOCKET s, BYTE *buffer, size_t bufferSize, SNMP_AsyncRequest **completed);
+   void checkTimeouts(SNMP_AsyncRequest **completed);
+   UINT32 getPollTimeout();
+
+public:
+   SNMP_AsyncEngine(int maxInFlightPerTarget = 8);
+   ~SNMP_AsyncEngine();
+
+   bool start();
+   void stop();
+
+   UINT32 sendRequest(SNMP_PDU *request, const InetAddress& addr, UINT16 port, SNMP_SecurityContext *securityContext,
+            SNMP_AsyncCallback callback, void *context, UINT32 timeout = 0, int numRetries = 3);
+   UINT32 doRequest(SNMP_PDU *request, const InetAddress& addr, UINT16 port, SNMP_SecurityContext *securityContext,
+            SNMP_PDU **response, UINT32 timeout = 0, int numRetries = 3);
+
+   void getStats(SNMP_AsyncEngineStats *stats);
+};
+
 struct SNMP_SnapshotIndexEntry;
 
 /**
@@ -758,10 +856,26 @@ UINT32 LIBNXSNMP_EXPORTABLE SNMPGetMIBTreeTimestamp(const TCHAR *fileName, UINT3
 UINT32 LIBNXSNMP_EXPORTABLE SNMPResolveDataType(const TCHAR *pszType);
 TCHAR LIBNXSNMP_EXPORTABLE *SNMPDataTypeName(UINT32 type, TCHAR *buffer, size_t bufferSize);
 
+/**
+ * SNMP walk counters
+ */
+struct LIBNXSNMP_WALK_COUNTERS
+{
+   UINT64 walks;           // number of walks
+   UINT64 requests;        // total number of request PDUs sent
+   UINT64 bulkRequests;    // number of GETBULK request PDUs sent
+   UINT64 varbinds;        // number of variables received
+   UINT64 bulkFallbacks;   // number of walks switched from GETBULK to GETNEXT
+};
+
 UINT32 LIBNXSNMP_EXPORTABLE SnmpNewRequestId();
 void LIBNXSNMP_EXPORTABLE SnmpSetMessageIds(DWORD msgParseError, DWORD msgTypeError, DWORD msgGetError);
 void LIBNXSNMP_EXPORTABLE SnmpSetDefaultTimeout(UINT32 timeout);
 UINT32 LIBNXSNMP_EXPORTABLE SnmpGetDefaultTimeout();
+void LIBNXSNMP_EXPORTABLE SnmpSetDefaultMaxRepetitions(UINT32 maxRepetitions);
+UINT32 LIBNXSNMP_EXPORTABLE SnmpGetDefaultMaxRepetitions();
+void LIBNXSNMP_EXPORTABLE SnmpGetWalkCounters(LIBNXSNMP_WALK_COUNTERS *counters);
+void LIBNXSNMP_EXPORTABLE SnmpGetKeyCacheCounters(UINT64 *hits, UINT64 *misses, int *size);
 UINT32 LIBNXSNMP_EXPORTABLE SnmpGet(int version, SNMP_Transport *transport,
                                     const TCHAR *szOidStr, const UINT32 *oidBinary, size_t oidLen, void *pValue,
                                     size_t bufferSize, UINT32 dwFlags);
@@ -183,6 +183,8 @@
 #define _istdigit iswdigit
 #define _istxdigit iswxdigit
 #define _istalpha iswalpha
+#define _istalnum iswalnum
+#define _totlower towlower
 #define _istupper iswupper
 #define _istprint iswprint
 #define _itot     _itow
@@ -268,6 +270,8 @@
 #define _istdigit isdigit
 #define _istxdigit isxdigit
 #define _istalpha isalpha
+#define _istalnum isalnum
+#define _totlower tolower
 #define _istupper isupper
 #define _istprint isprint
 #define _itot     _itoa
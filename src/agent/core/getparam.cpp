@@ -28,6 +28,7 @@
 LONG H_ActionList(const TCHAR *cmd, const TCHAR *arg, StringList *value, AbstractCommSession *session);
 LONG H_ActiveConnections(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session);
 LONG H_AgentProxyStats(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session);
+LONG H_AgentRequestStats(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session);
 LONG H_AgentTraps(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session);
 LONG H_AgentUptime(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session);
 LONG H_CRC32(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session);
@@ -80,6 +81,13 @@ static UINT32 m_dwProcessedRequests = 0;
 static UINT32 m_dwFailedRequests = 0;
 static UINT32 m_dwUnsupportedRequests = 0;
 
+/**
+ * Name indexes for parameters, lists, and tables (ID in index is position in corresponding list)
+ */
+static WildcardNameIndex s_paramIndex;
+static WildcardNameIndex s_listIndex;
+static WildcardNameIndex s_tableIndex;
+
 /**
  * Handler for parameters which always returns string constant
  */
@@ -302,6 +310,9 @@ static NETXMS_SUBAGENT_PARAM m_stdParams[] =
    { _T("Agent.Proxy.IsEnabled"), H_FlagValue, CAST_TO_POINTER(AF_ENABLE_PROXY, TCHAR *), DCI_DT_UINT, DCIDESC_AGENT_PROXY_ISENABLED },
    { _T("Agent.Registrar"), H_StringConstant, g_szRegistrar, DCI_DT_STRING, DCIDESC_AGENT_REGISTRAR },
    { _T("Agent.RejectedConnections"), H_UIntPtr, (TCHAR *)&g_rejectedConnections, DCI_DT_UINT, DCIDESC_AGENT_REJECTEDCONNECTIONS },
+   { _T("Agent.RequestProcessing.ActiveRequests"), H_AgentRequestStats, _T("A"), DCI_DT_UINT, DCIDESC_AGENT_REQUESTS_ACTIVE },
+   { _T("Agent.RequestProcessing.AverageTime"), H_AgentRequestStats, _T("T"), DCI_DT_UINT, DCIDESC_AGENT_REQUESTS_AVGTIME },
+   { _T("Agent.RequestProcessing.QueueSize"), H_AgentRequestStats, _T("Q"), DCI_DT_UINT, DCIDESC_AGENT_REQUESTS_QUEUESIZE },
    { _T("Agent.SentTraps"), H_AgentTraps, _T("S"), DCI_DT_UINT64, DCIDESC_AGENT_SENT_TRAPS },
    { _T("Agent.SNMP.IsProxyEnabled"), H_FlagValue, CAST_TO_POINTER(AF_ENABLE_SNMP_PROXY, TCHAR *), DCI_DT_UINT, DCIDESC_AGENT_SNMP_ISPROXYENABLED },
    { _T("Agent.SNMP.IsTrapProxyEnabled"), H_FlagValue, CAST_TO_POINTER(AF_ENABLE_SNMP_TRAP_PROXY, TCHAR *), DCI_DT_UINT, DCIDESC_AGENT_SNMP_ISPROXYENABLED },
@@ -385,6 +396,8 @@ BOOL InitParameterList()
 		if (m_pParamList == NULL)
 			return FALSE;
 		memcpy(m_pParamList, m_stdParams, sizeof(NETXMS_SUBAGENT_PARAM) * m_iNumParams);
+      for(int i = 0; i < m_iNumParams; i++)
+         s_paramIndex.add(m_pParamList[i].name);
 	}
 
    m_iNumEnums = sizeof(m_stdLists) / sizeof(NETXMS_SUBAGENT_LIST);
@@ -394,6 +407,8 @@ BOOL InitParameterList()
 		if (m_pEnumList == NULL)
 			return FALSE;
 		memcpy(m_pEnumList, m_stdLists, sizeof(NETXMS_SUBAGENT_LIST) * m_iNumEnums);
+      for(int i = 0; i < m_iNumEnums; i++)
+         s_listIndex.add(m_pEnumList[i].name);
 	}
 
    m_iNumTables = sizeof(m_stdTables) / sizeof(NETXMS_SUBAGENT_TABLE);
@@ -403,6 +418,8 @@ BOOL InitParameterList()
 		if (m_pTableList == NULL)
 			return FALSE;
 		memcpy(m_pTableList, m_stdTables, sizeof(NETXMS_SUBAGENT_TABLE) * m_iNumTables);
+      for(int i = 0; i < m_iNumTables; i++)
+         s_tableIndex.add(m_pTableList[i].name);
 	}
 
    return TRUE;
@@ -443,13 +460,9 @@ void AddPushParameter(const TCHAR *name, int dataType, const TCHAR *description)
 void AddParameter(const TCHAR *pszName, LONG (* fpHandler)(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *), const TCHAR *pArg,
                   int iDataType, const TCHAR *pszDescription)
 {
-   int i;
-
    // Search for existing parameter
-   for(i = 0; i < m_iNumParams; i++)
-      if (!_tcsicmp(m_pParamList[i].name, pszName))
-         break;
-   if (i < m_iNumParams)
+   int i = s_paramIndex.findExact(pszName);
+   if (i != -1)
    {
       // Replace existing handler and attributes
       m_pParamList[i].handler = fpHandler;
@@ -476,6 +489,7 @@ void AddParameter(const TCHAR *pszName, LONG (* fpHandler)(const TCHAR *, const
       m_pParamList[m_iNumParams].arg = pArg;
       m_pParamList[m_iNumParams].dataType = iDataType;
       nx_strncpy(m_pParamList[m_iNumParams].description, pszDescription, MAX_DB_STRING);
+      s_paramIndex.add(m_pParamList[m_iNumParams].name);
       m_iNumParams++;
    }
 }
@@ -485,13 +499,9 @@ void AddParameter(const TCHAR *pszName, LONG (* fpHandler)(const TCHAR *, const
  */
 void AddList(const TCHAR *name, LONG (* handler)(const TCHAR *, const TCHAR *, StringList *, AbstractCommSession *), const TCHAR *arg)
 {
-   int i;
-
    // Search for existing enum
-   for(i = 0; i < m_iNumEnums; i++)
-      if (!_tcsicmp(m_pEnumList[i].name, name))
-         break;
-   if (i < m_iNumEnums)
+   int i = s_listIndex.findExact(name);
+   if (i != -1)
    {
       // Replace existing handler and arg
       m_pEnumList[i].handler = handler;
@@ -504,6 +514,7 @@ void AddList(const TCHAR *name, LONG (* handler)(const TCHAR *, const TCHAR *, S
       nx_strncpy(m_pEnumList[m_iNumEnums].name, name, MAX_PARAM_NAME - 1);
       m_pEnumList[m_iNumEnums].handler = handler;
       m_pEnumList[m_iNumEnums].arg = arg;
+      s_listIndex.add(m_pEnumList[m_iNumEnums].name);
       m_iNumEnums++;
    }
 }
@@ -514,13 +525,9 @@ void AddList(const TCHAR *name, LONG (* handler)(const TCHAR *, const TCHAR *, S
 void AddTable(const TCHAR *name, LONG (* handler)(const TCHAR *, const TCHAR *, Table *, AbstractCommSession *), const TCHAR *arg,
 				  const TCHAR *instanceColumns, const TCHAR *description, int numColumns, NETXMS_SUBAGENT_TABLE_COLUMN *columns)
 {
-   int i;
-
    // Search for existing table
-   for(i = 0; i < m_iNumTables; i++)
-      if (!_tcsicmp(m_pTableList[i].name, name))
-         break;
-   if (i < m_iNumTables)
+   int i = s_tableIndex.findExact(name);
+   if (i != -1)
    {
       // Replace existing handler and arg
       m_pTableList[i].handler = handler;
@@ -541,6 +548,7 @@ void AddTable(const TCHAR *name, LONG (* handler)(const TCHAR *, const TCHAR *,
 		nx_strncpy(m_pTableList[m_iNumTables].description, description, MAX_DB_STRING);
       m_pTableList[m_iNumTables].numColumns = numColumns;
       m_pTableList[m_iNumTables].columns = columns;
+      s_tableIndex.add(m_pTableList[m_iNumTables].name);
       m_iNumTables++;
    }
 }
@@ -582,44 +590,41 @@ BOOL AddExternalParameter(TCHAR *pszCfgLine, BOOL bShellExec, BOOL bIsList) //to
  */
 UINT32 GetParameterValue(const TCHAR *param, TCHAR *value, AbstractCommSession *session)
 {
-   int i, rc;
+   int rc;
    UINT32 dwErrorCode;
 
    session->debugPrintf(5, _T("Requesting parameter \"%s\""), param);
-   for(i = 0; i < m_iNumParams; i++)
-	{
-      if (MatchString(m_pParamList[i].name, param, FALSE))
+   int i = s_paramIndex.find(param);
+   if (i != -1)
+   {
+      rc = m_pParamList[i].handler(param, m_pParamList[i].arg, value, session);
+      switch(rc)
       {
-         rc = m_pParamList[i].handler(param, m_pParamList[i].arg, value, session);
-         switch(rc)
-         {
-            case SYSINFO_RC_SUCCESS:
-               dwErrorCode = ERR_SUCCESS;
-               m_dwProcessedRequests++;
-               break;
-            case SYSINFO_RC_ERROR:
-               dwErrorCode = ERR_INTERNAL_ERROR;
-               m_dwFailedRequests++;
-               break;
-            case SYSINFO_RC_NO_SUCH_INSTANCE:
-               dwErrorCode = ERR_NO_SUCH_INSTANCE;
-               m_dwFailedRequests++;
-               break;
-            case SYSINFO_RC_UNSUPPORTED:
-               dwErrorCode = ERR_UNKNOWN_PARAMETER;
-               m_dwUnsupportedRequests++;
-               break;
-            default:
-               nxlog_write(MSG_UNEXPECTED_IRC, EVENTLOG_ERROR_TYPE, "ds", rc, param);
-               dwErrorCode = ERR_INTERNAL_ERROR;
-               m_dwFailedRequests++;
-               break;
-         }
-         break;
+         case SYSINFO_RC_SUCCESS:
+            dwErrorCode = ERR_SUCCESS;
+            m_dwProcessedRequests++;
+            break;
+         case SYSINFO_RC_ERROR:
+            dwErrorCode = ERR_INTERNAL_ERROR;
+            m_dwFailedRequests++;
+            break;
+         case SYSINFO_RC_NO_SUCH_INSTANCE:
+            dwErrorCode = ERR_NO_SUCH_INSTANCE;
+            m_dwFailedRequests++;
+            break;
+         case SYSINFO_RC_UNSUPPORTED:
+            dwErrorCode = ERR_UNKNOWN_PARAMETER;
+            m_dwUnsupportedRequests++;
+            break;
+         default:
+            nxlog_write(MSG_UNEXPECTED_IRC, EVENTLOG_ERROR_TYPE, "ds", rc, param);
+            dwErrorCode = ERR_INTERNAL_ERROR;
+            m_dwFailedRequests++;
+            break;
       }
-	}
+   }
 
-   if (i == m_iNumParams)
+   if (i == -1)
    {
 		rc = GetParameterValueFromExtProvider(param, value);
 		if (rc == SYSINFO_RC_SUCCESS)
@@ -633,7 +638,7 @@ UINT32 GetParameterValue(const TCHAR *param, TCHAR *value, AbstractCommSession *
 		}
    }
 
-   if ((dwErrorCode == ERR_UNKNOWN_PARAMETER) && (i == m_iNumParams))
+   if ((dwErrorCode == ERR_UNKNOWN_PARAMETER) && (i == -1))
    {
 		dwErrorCode = GetParameterValueFromAppAgent(param, value);
 		if (dwErrorCode == ERR_SUCCESS)
@@ -646,7 +651,7 @@ UINT32 GetParameterValue(const TCHAR *param, TCHAR *value, AbstractCommSession *
 		}
    }
 
-   if ((dwErrorCode == ERR_UNKNOWN_PARAMETER) && (i == m_iNumParams))
+   if ((dwErrorCode == ERR_UNKNOWN_PARAMETER) && (i == -1))
    {
 		dwErrorCode = GetParameterValueFromExtSubagent(param, value);
 		if (dwErrorCode == ERR_SUCCESS)
@@ -673,44 +678,41 @@ UINT32 GetParameterValue(const TCHAR *param, TCHAR *value, AbstractCommSession *
  */
 UINT32 GetListValue(const TCHAR *param, StringList *value, AbstractCommSession *session)
 {
-   int i, rc;
+   int rc;
    UINT32 dwErrorCode;
 
    session->debugPrintf(5, _T("Requesting list \"%s\""), param);
-   for(i = 0; i < m_iNumEnums; i++)
-	{
-      if (MatchString(m_pEnumList[i].name, param, FALSE))
+   int i = s_listIndex.find(param);
+   if (i != -1)
+   {
+      rc = m_pEnumList[i].handler(param, m_pEnumList[i].arg, value, session);
+      switch(rc)
       {
-         rc = m_pEnumList[i].handler(param, m_pEnumList[i].arg, value, session);
-         switch(rc)
-         {
-            case SYSINFO_RC_SUCCESS:
-               dwErrorCode = ERR_SUCCESS;
-               m_dwProcessedRequests++;
-               break;
-            case SYSINFO_RC_ERROR:
-               dwErrorCode = ERR_INTERNAL_ERROR;
-               m_dwFailedRequests++;
-               break;
-            case SYSINFO_RC_NO_SUCH_INSTANCE:
-               dwErrorCode = ERR_NO_SUCH_INSTANCE;
-               m_dwFailedRequests++;
-               break;
-            case SYSINFO_RC_UNSUPPORTED:
-               dwErrorCode = ERR_UNKNOWN_PARAMETER;
-               m_dwUnsupportedRequests++;
-               break;
-            default:
-               nxlog_write(MSG_UNEXPECTED_IRC, EVENTLOG_ERROR_TYPE, "ds", rc, param);
-               dwErrorCode = ERR_INTERNAL_ERROR;
-               m_dwFailedRequests++;
-               break;
-         }
-         break;
+         case SYSINFO_RC_SUCCESS:
+            dwErrorCode = ERR_SUCCESS;
+            m_dwProcessedRequests++;
+            break;
+         case SYSINFO_RC_ERROR:
+            dwErrorCode = ERR_INTERNAL_ERROR;
+            m_dwFailedRequests++;
+            break;
+         case SYSINFO_RC_NO_SUCH_INSTANCE:
+            dwErrorCode = ERR_NO_SUCH_INSTANCE;
+            m_dwFailedRequests++;
+            break;
+         case SYSINFO_RC_UNSUPPORTED:
+            dwErrorCode = ERR_UNKNOWN_PARAMETER;
+            m_dwUnsupportedRequests++;
+            break;
+         default:
+            nxlog_write(MSG_UNEXPECTED_IRC, EVENTLOG_ERROR_TYPE, "ds", rc, param);
+            dwErrorCode = ERR_INTERNAL_ERROR;
+            m_dwFailedRequests++;
+            break;
       }
-	}
+   }
 
-	if (i == m_iNumEnums)
+	if (i == -1)
    {
 		dwErrorCode = GetListValueFromExtSubagent(param, value);
 		if (dwErrorCode == ERR_SUCCESS)
@@ -737,54 +739,51 @@ UINT32 GetListValue(const TCHAR *param, StringList *value, AbstractCommSession *
  */
 UINT32 GetTableValue(const TCHAR *param, Table *value, AbstractCommSession *session)
 {
-   int i, rc;
+   int rc;
    UINT32 dwErrorCode;
 
    session->debugPrintf(5, _T("Requesting table \"%s\""), param);
-   for(i = 0; i < m_iNumTables; i++)
-	{
-      if (MatchString(m_pTableList[i].name, param, FALSE))
+   int i = s_tableIndex.find(param);
+   if (i != -1)
+   {
+      // pre-fill table columns if specified in table definition
+      if (m_pTableList[i].numColumns > 0)
       {
-         // pre-fill table columns if specified in table definition
-         if (m_pTableList[i].numColumns > 0)
+         for(int c = 0; c < m_pTableList[i].numColumns; c++)
          {
-            for(int c = 0; c < m_pTableList[i].numColumns; c++)
-            {
-               NETXMS_SUBAGENT_TABLE_COLUMN *col = &m_pTableList[i].columns[c];
-               value->addColumn(col->name, col->dataType, col->displayName, col->isInstance);
-            }
+            NETXMS_SUBAGENT_TABLE_COLUMN *col = &m_pTableList[i].columns[c];
+            value->addColumn(col->name, col->dataType, col->displayName, col->isInstance);
          }
+      }
 
-         rc = m_pTableList[i].handler(param, m_pTableList[i].arg, value, session);
-         switch(rc)
-         {
-            case SYSINFO_RC_SUCCESS:
-               dwErrorCode = ERR_SUCCESS;
-               m_dwProcessedRequests++;
-               break;
-            case SYSINFO_RC_ERROR:
-               dwErrorCode = ERR_INTERNAL_ERROR;
-               m_dwFailedRequests++;
-               break;
-            case SYSINFO_RC_NO_SUCH_INSTANCE:
-               dwErrorCode = ERR_NO_SUCH_INSTANCE;
-               m_dwFailedRequests++;
-               break;
-            case SYSINFO_RC_UNSUPPORTED:
-               dwErrorCode = ERR_UNKNOWN_PARAMETER;
-               m_dwUnsupportedRequests++;
-               break;
-            default:
-               nxlog_write(MSG_UNEXPECTED_IRC, EVENTLOG_ERROR_TYPE, "ds", rc, param);
-               dwErrorCode = ERR_INTERNAL_ERROR;
-               m_dwFailedRequests++;
-               break;
-         }
-         break;
+      rc = m_pTableList[i].handler(param, m_pTableList[i].arg, value, session);
+      switch(rc)
+      {
+         case SYSINFO_RC_SUCCESS:
+            dwErrorCode = ERR_SUCCESS;
+            m_dwProcessedRequests++;
+            break;
+         case SYSINFO_RC_ERROR:
+            dwErrorCode = ERR_INTERNAL_ERROR;
+            m_dwFailedRequests++;
+            break;
+         case SYSINFO_RC_NO_SUCH_INSTANCE:
+            dwErrorCode = ERR_NO_SUCH_INSTANCE;
+            m_dwFailedRequests++;
+            break;
+         case SYSINFO_RC_UNSUPPORTED:
+            dwErrorCode = ERR_UNKNOWN_PARAMETER;
+            m_dwUnsupportedRequests++;
+            break;
+         default:
+            nxlog_write(MSG_UNEXPECTED_IRC, EVENTLOG_ERROR_TYPE, "ds", rc, param);
+            dwErrorCode = ERR_INTERNAL_ERROR;
+            m_dwFailedRequests++;
+            break;
       }
-	}
+   }
 
-	if (i == m_iNumTables)
+	if (i == -1)
    {
 		dwErrorCode = GetTableValueFromExtSubagent(param, value);
 		if (dwErrorCode == ERR_SUCCESS)
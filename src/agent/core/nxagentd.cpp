@@ -172,6 +172,8 @@ UINT16 g_snmpTrapPort = 162;
 time_t g_tmAgentStartTime;
 UINT32 g_dwStartupDelay = 0;
 UINT32 g_dwMaxSessions = 0;
+UINT32 g_maxRequestsPerSession = 4;
+UINT32 g_requestProcessingPoolSize = 64;
 UINT32 g_longRunningQueryThreshold = 250;
 UINT32 g_dcReconciliationBlockSize = 1024;
 UINT32 g_dcReconciliationTimeout = 15000;
@@ -286,8 +288,10 @@ static NX_CFG_TEMPLATE m_cfgTemplate[] =
    { _T("LongRunningQueryThreshold"), CT_LONG, 0, 0, 0, 0, &g_longRunningQueryThreshold, NULL },
    { _T("MasterServers"), CT_STRING_LIST, ',', 0, 0, 0, &m_pszMasterServerList, NULL },
    { _T("MaxLogSize"), CT_SIZE_BYTES, 0, 0, 0, 0, &s_maxLogSize, NULL },
+   { _T("MaxRequestsPerSession"), CT_LONG, 0, 0, 0, 0, &g_maxRequestsPerSession, NULL },
    { _T("MaxSessions"), CT_LONG, 0, 0, 0, 0, &g_dwMaxSessions, NULL },
    { _T("PlatformSuffix"), CT_STRING, 0, 0, MAX_PSUFFIX_LENGTH, 0, g_szPlatformSuffix, NULL },
+   { _T("RequestProcessingThreadPoolSize"), CT_LONG, 0, 0, 0, 0, &g_requestProcessingPoolSize, NULL },
    { _T("RequireAuthentication"), CT_BOOLEAN, 0, 0, AF_REQUIRE_AUTH, 0, &g_dwFlags, NULL },
    { _T("RequireEncryption"), CT_BOOLEAN, 0, 0, AF_REQUIRE_ENCRYPTION, 0, &g_dwFlags, NULL },
    { _T("ServerConnection"), CT_STRING_LIST, '\n', 0, 0, 0, &s_serverConnectionList, NULL },
@@ -816,6 +820,10 @@ BOOL Initialize()
 	if (!(g_dwFlags & AF_SUBAGENT_LOADER))
 	{
 	   g_commThreadPool = ThreadPoolCreate(2, 32, _T("COMM"));
+	   if (g_maxRequestsPerSession > 1)
+	   {
+	      g_requestProcessingThreadPool = ThreadPoolCreate(2, max(g_requestProcessingPoolSize, 2), _T("REQUEST"));
+	   }
 	   if (g_dwFlags & AF_ENABLE_SNMP_PROXY)
 	   {
 	      g_snmpProxyThreadPool = ThreadPoolCreate(2, 128, _T("SNMPPROXY"));
@@ -1146,6 +1154,8 @@ void Shutdown()
       ThreadPoolDestroy(g_snmpProxyThreadPool);
    }
    ThreadPoolDestroy(g_commThreadPool);
+   if (g_requestProcessingThreadPool != NULL)
+      ThreadPoolDestroy(g_requestProcessingThreadPool);
 
    UnloadAllSubAgents();
    CloseLocalDatabase();
@@ -336,6 +336,8 @@ private:
 	MUTEX m_socketWriteMutex;
    VolatileCounter m_requestId;
    MsgWaitQueue *m_responseQueue;
+   VolatileCounter m_activeRequests;   // Requests being processed on request processing thread pool
+   CONDITION m_requestCompleted;
 
 	bool sendRawMessage(NXCP_MESSAGE *msg, NXCPEncryptionContext *ctx);
    void authenticate(NXCPMessage *pRequest, NXCPMessage *pMsg);
@@ -354,6 +356,9 @@ private:
    void readThread();
    void writeThread();
    void processingThread();
+   void processRequest(NXCPMessage *request);
+   void processRequestAsync(NXCPMessage *request);
+   void waitForActiveRequests(int maxActive);
    void proxyReadThread();
    void proxySnmpRequest(NXCPMessage *request);
 
@@ -668,6 +673,7 @@ extern TCHAR g_szPlatformSuffix[];
 extern UINT32 g_dwStartupDelay;
 extern UINT32 g_dwIdleTimeout;
 extern UINT32 g_dwMaxSessions;
+extern UINT32 g_maxRequestsPerSession;
 extern UINT32 g_execTimeout;
 extern UINT32 g_snmpTimeout;
 extern UINT16 g_snmpTrapPort;
@@ -686,6 +692,7 @@ extern CommSession **g_pSessionList;
 extern MUTEX g_hSessionListAccess;
 extern ThreadPool *g_snmpProxyThreadPool;
 extern ThreadPool *g_commThreadPool;
+extern ThreadPool *g_requestProcessingThreadPool;
 
 #ifdef _WIN32
 extern TCHAR g_windowsEventSourceName[];
@@ -41,6 +41,11 @@ ThreadPool *g_snmpProxyThreadPool = NULL;
  */
 ThreadPool *g_commThreadPool = NULL;
 
+/**
+ * Thread pool for parallel processing of session requests
+ */
+ThreadPool *g_requestProcessingThreadPool = NULL;
+
 /**
  * Next free session ID
  */
@@ -52,6 +57,14 @@ static VolatileCounter s_sessionId = 0;
 static UINT64 s_proxyConnectionRequests = 0;
 static VolatileCounter s_activeProxySessions = 0;
 
+/**
+ * Request processing statistics
+ */
+static VolatileCounter s_queuedRequests = 0;
+static VolatileCounter s_activeRequests = 0;
+static double s_averageProcessingTime = 0;
+static Mutex s_processingTimeLock;
+
 /**
  * Handler for agent proxy stats parameters
  */
@@ -71,6 +84,41 @@ LONG H_AgentProxyStats(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, Abstrac
    return SYSINFO_RC_SUCCESS;
 }
 
+/**
+ * Handler for request processing stats parameters
+ */
+LONG H_AgentRequestStats(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
+{
+   switch(*arg)
+   {
+      case 'A':
+         ret_uint(value, (UINT32)s_activeRequests);
+         break;
+      case 'Q':
+         ret_uint(value, (UINT32)s_queuedRequests);
+         break;
+      case 'T':
+         s_processingTimeLock.lock();
+         ret_uint(value, (UINT32)s_averageProcessingTime);
+         s_processingTimeLock.unlock();
+         break;
+      default:
+         return SYSINFO_RC_UNSUPPORTED;
+   }
+   return SYSINFO_RC_SUCCESS;
+}
+
+/**
+ * Check if given command can be processed in parallel with other requests
+ * from same session. Only read-only requests which do not depend on
+ * session state changes made by previous requests are allowed.
+ */
+inline bool IsParallelCommand(UINT32 command)
+{
+   return (command == CMD_GET_PARAMETER) || (command == CMD_GET_LIST) ||
+          (command == CMD_GET_TABLE) || (command == CMD_KEEPALIVE);
+}
+
 /**
  * Client communication read thread
  */
@@ -143,6 +191,8 @@ CommSession::CommSession(AbstractCommChannel *channel, const InetAddress &server
    m_socketWriteMutex = MutexCreate();
    m_responseQueue = new MsgWaitQueue();
    m_requestId = 0;
+   m_activeRequests = 0;
+   m_requestCompleted = ConditionCreate(false);
 }
 
 /**
@@ -166,13 +216,19 @@ CommSession::~CommSession()
    delete m_sendQueue;
 
    while((p = m_processingQueue->get()) != NULL)
+   {
       if (p != INVALID_POINTER_VALUE)
+      {
          delete (NXCPMessage *)p;
+         InterlockedDecrement(&s_queuedRequests);
+      }
+   }
    delete m_processingQueue;
 	if ((m_pCtx != NULL) && (m_pCtx != PROXY_ENCRYPTION_CTX))
 		m_pCtx->decRefCount();
 	MutexDestroy(m_socketWriteMutex);
    delete m_responseQueue;
+   ConditionDestroy(m_requestCompleted);
 }
 
 /**
@@ -380,6 +436,7 @@ void CommSession::readThread()
                   }
                   break;
                default:
+                  InterlockedIncrement(&s_queuedRequests);
                   m_processingQueue->put(msg);
                   break;
             }
@@ -510,94 +567,144 @@ void CommSession::writeThread()
 }
 
 /**
- * Message processing thread
+ * Message processing thread. Requests which can be processed in parallel are
+ * passed to request processing thread pool (up to MaxRequestsPerSession at a time).
+ * All other requests are processed in order after all running requests are completed.
  */
 void CommSession::processingThread()
 {
-   NXCPMessage response;
+   int maxActiveRequests = (int)g_maxRequestsPerSession;
    while(true)
    {
       NXCPMessage *request = (NXCPMessage *)m_processingQueue->getOrBlock();
       if (request == INVALID_POINTER_VALUE)    // Session termination indicator
          break;
-      UINT32 command = request->getCode();
-
-      // Prepare response message
-      response.setCode(CMD_REQUEST_COMPLETED);
-      response.setId(request->getId());
 
-      // Check if authentication required
-      if ((!m_authenticated) && (command != CMD_AUTHENTICATE))
+      if ((maxActiveRequests > 1) && IsParallelCommand(request->getCode()))
       {
-			debugPrintf(6, _T("Authentication required"));
-			response.setField(VID_RCC, ERR_AUTH_REQUIRED);
+         waitForActiveRequests(maxActiveRequests - 1);
+         InterlockedIncrement(&m_activeRequests);
+         incRefCount();
+         ThreadPoolExecute(g_requestProcessingThreadPool, this, &CommSession::processRequestAsync, request);
       }
-      else if ((g_dwFlags & AF_REQUIRE_ENCRYPTION) && (m_pCtx == NULL))
+      else
       {
-			debugPrintf(6, _T("Encryption required"));
-			response.setField(VID_RCC, ERR_ENCRYPTION_REQUIRED);
+         waitForActiveRequests(0);
+         processRequest(request);
       }
-      else
+   }
+   waitForActiveRequests(0);
+}
+
+/**
+ * Wait until number of requests being processed in background drops to given value.
+ * Should be called only from processing thread.
+ */
+void CommSession::waitForActiveRequests(int maxActive)
+{
+   while(m_activeRequests > maxActive)
+      ConditionWait(m_requestCompleted, INFINITE);
+}
+
+/**
+ * Process request in background (called on request processing thread pool)
+ */
+void CommSession::processRequestAsync(NXCPMessage *request)
+{
+   processRequest(request);
+   InterlockedDecrement(&m_activeRequests);
+   ConditionSet(m_requestCompleted);
+   decRefCount();
+}
+
+/**
+ * Process single request and send response. Request object will be destroyed.
+ */
+void CommSession::processRequest(NXCPMessage *request)
+{
+   InterlockedDecrement(&s_queuedRequests);
+   InterlockedIncrement(&s_activeRequests);
+   INT64 startTime = GetCurrentTimeMs();
+
+   UINT32 command = request->getCode();
+
+   // Prepare response message
+   NXCPMessage response;
+   response.setCode(CMD_REQUEST_COMPLETED);
+   response.setId(request->getId());
+
+   // Check if authentication required
+   if ((!m_authenticated) && (command != CMD_AUTHENTICATE))
+   {
+      debugPrintf(6, _T("Authentication required"));
+      response.setField(VID_RCC, ERR_AUTH_REQUIRED);
+   }
+   else if ((g_dwFlags & AF_REQUIRE_ENCRYPTION) && (m_pCtx == NULL))
+   {
+      debugPrintf(6, _T("Encryption required"));
+      response.setField(VID_RCC, ERR_ENCRYPTION_REQUIRED);
+   }
+   else
+   {
+      switch(command)
       {
-         switch(command)
-         {
-            case CMD_AUTHENTICATE:
-               authenticate(request, &response);
-               break;
-            case CMD_GET_PARAMETER:
-               getParameter(request, &response);
-               break;
-            case CMD_GET_LIST:
-               getList(request, &response);
-               break;
-            case CMD_GET_TABLE:
-               getTable(request, &response);
-               break;
-            case CMD_KEEPALIVE:
-               response.setField(VID_RCC, ERR_SUCCESS);
-               break;
-            case CMD_ACTION:
-               action(request, &response);
-               break;
-            case CMD_TRANSFER_FILE:
-               recvFile(request, &response);
-               break;
-            case CMD_UPGRADE_AGENT:
-               response.setField(VID_RCC, upgrade(request));
-               break;
-            case CMD_GET_PARAMETER_LIST:
-               response.setField(VID_RCC, ERR_SUCCESS);
-               GetParameterList(&response);
-               break;
-            case CMD_GET_ENUM_LIST:
-               response.setField(VID_RCC, ERR_SUCCESS);
-               GetEnumList(&response);
-               break;
-            case CMD_GET_TABLE_LIST:
-               response.setField(VID_RCC, ERR_SUCCESS);
-               GetTableList(&response);
-               break;
-            case CMD_GET_AGENT_CONFIG:
-               getConfig(&response);
-               break;
-            case CMD_UPDATE_AGENT_CONFIG:
-               updateConfig(request, &response);
-               break;
-            case CMD_ENABLE_AGENT_TRAPS:
-               m_acceptTraps = true;
+         case CMD_AUTHENTICATE:
+            authenticate(request, &response);
+            break;
+         case CMD_GET_PARAMETER:
+            getParameter(request, &response);
+            break;
+         case CMD_GET_LIST:
+            getList(request, &response);
+            break;
+         case CMD_GET_TABLE:
+            getTable(request, &response);
+            break;
+         case CMD_KEEPALIVE:
+            response.setField(VID_RCC, ERR_SUCCESS);
+            break;
+         case CMD_ACTION:
+            action(request, &response);
+            break;
+         case CMD_TRANSFER_FILE:
+            recvFile(request, &response);
+            break;
+         case CMD_UPGRADE_AGENT:
+            response.setField(VID_RCC, upgrade(request));
+            break;
+         case CMD_GET_PARAMETER_LIST:
+            response.setField(VID_RCC, ERR_SUCCESS);
+            GetParameterList(&response);
+            break;
+         case CMD_GET_ENUM_LIST:
+            response.setField(VID_RCC, ERR_SUCCESS);
+            GetEnumList(&response);
+            break;
+         case CMD_GET_TABLE_LIST:
+            response.setField(VID_RCC, ERR_SUCCESS);
+            GetTableList(&response);
+            break;
+         case CMD_GET_AGENT_CONFIG:
+            getConfig(&response);
+            break;
+         case CMD_UPDATE_AGENT_CONFIG:
+            updateConfig(request, &response);
+            break;
+         case CMD_ENABLE_AGENT_TRAPS:
+            m_acceptTraps = true;
+            response.setField(VID_RCC, ERR_SUCCESS);
+            break;
+         case CMD_ENABLE_FILE_UPDATES:
+            if (m_masterServer)
+            {
+               m_acceptFileUpdates = true;
                response.setField(VID_RCC, ERR_SUCCESS);
-               break;
-            case CMD_ENABLE_FILE_UPDATES:
-               if (m_masterServer)
-               {
-                  m_acceptFileUpdates = true;
-                  response.setField(VID_RCC, ERR_SUCCESS);
-               }
-               else
-               {
-                  response.setField(VID_RCC, ERR_ACCESS_DENIED);
-               }
-               break;
+            }
+            else
+            {
+               response.setField(VID_RCC, ERR_ACCESS_DENIED);
+            }
+            break;
 				case CMD_DEPLOY_AGENT_POLICY:
 					if (m_masterServer)
 					{
@@ -628,82 +735,86 @@ void CommSession::processingThread()
 					   response.setField(VID_RCC, ERR_ACCESS_DENIED);
 					}
 					break;
-            case CMD_TAKE_SCREENSHOT:
+         case CMD_TAKE_SCREENSHOT:
 					if (m_controlServer)
 					{
-                  TCHAR sessionName[256];
-                  request->getFieldAsString(VID_NAME, sessionName, 256);
-                  debugPrintf(6, _T("Take screenshot from session \"%s\""), sessionName);
-                  SessionAgentConnector *conn = AcquireSessionAgentConnector(sessionName);
-                  if (conn != NULL)
-                  {
-                     debugPrintf(6, _T("Session agent connector acquired"));
-                     conn->takeScreenshot(&response);
-                     conn->decRefCount();
-                  }
-                  else
-                  {
-                     response.setField(VID_RCC, ERR_NO_SESSION_AGENT);
-                  }
+               TCHAR sessionName[256];
+               request->getFieldAsString(VID_NAME, sessionName, 256);
+               debugPrintf(6, _T("Take screenshot from session \"%s\""), sessionName);
+               SessionAgentConnector *conn = AcquireSessionAgentConnector(sessionName);
+               if (conn != NULL)
+               {
+                  debugPrintf(6, _T("Session agent connector acquired"));
+                  conn->takeScreenshot(&response);
+                  conn->decRefCount();
+               }
+               else
+               {
+                  response.setField(VID_RCC, ERR_NO_SESSION_AGENT);
+               }
 					}
 					else
 					{
 					   response.setField(VID_RCC, ERR_ACCESS_DENIED);
 					}
 					break;
-            case CMD_SET_SERVER_CAPABILITIES:
-               // Servers before 2.0 use VID_ENABLED
-               m_ipv6Aware = request->isFieldExist(VID_IPV6_SUPPORT) ? request->getFieldAsBoolean(VID_IPV6_SUPPORT) : request->getFieldAsBoolean(VID_ENABLED);
-               m_bulkReconciliationSupported = request->getFieldAsBoolean(VID_BULK_RECONCILIATION);
-               m_allowCompression = request->getFieldAsBoolean(VID_ENABLE_COMPRESSION);
+         case CMD_SET_SERVER_CAPABILITIES:
+            // Servers before 2.0 use VID_ENABLED
+            m_ipv6Aware = request->isFieldExist(VID_IPV6_SUPPORT) ? request->getFieldAsBoolean(VID_IPV6_SUPPORT) : request->getFieldAsBoolean(VID_ENABLED);
+            m_bulkReconciliationSupported = request->getFieldAsBoolean(VID_BULK_RECONCILIATION);
+            m_allowCompression = request->getFieldAsBoolean(VID_ENABLE_COMPRESSION);
+            response.setField(VID_RCC, ERR_SUCCESS);
+            debugPrintf(1, _T("Server capabilities: IPv6: %s; bulk reconciliation: %s; compression: %s"),
+                        m_ipv6Aware ? _T("yes") : _T("no"),
+                        m_bulkReconciliationSupported ? _T("yes") : _T("no"),
+                        m_allowCompression ? _T("yes") : _T("no"));
+            break;
+         case CMD_SET_SERVER_ID:
+            m_serverId = request->getFieldAsUInt64(VID_SERVER_ID);
+            debugPrintf(1, _T("Server ID set to ") UINT64X_FMT(_T("016")), m_serverId);
+            response.setField(VID_RCC, ERR_SUCCESS);
+            break;
+         case CMD_DATA_COLLECTION_CONFIG:
+            if (m_serverId != 0)
+            {
+               ConfigureDataCollection(m_serverId, request);
+               m_acceptData = true;
                response.setField(VID_RCC, ERR_SUCCESS);
-               debugPrintf(1, _T("Server capabilities: IPv6: %s; bulk reconciliation: %s; compression: %s"),
-                           m_ipv6Aware ? _T("yes") : _T("no"),
-                           m_bulkReconciliationSupported ? _T("yes") : _T("no"),
-                           m_allowCompression ? _T("yes") : _T("no"));
-               break;
-            case CMD_SET_SERVER_ID:
-               m_serverId = request->getFieldAsUInt64(VID_SERVER_ID);
-               debugPrintf(1, _T("Server ID set to ") UINT64X_FMT(_T("016")), m_serverId);
+            }
+            else
+            {
+               debugPrintf(1, _T("Data collection configuration command received but server ID is not set"));
+               response.setField(VID_RCC, ERR_SERVER_ID_UNSET);
+            }
+            break;
+         case CMD_CLEAN_AGENT_DCI_CONF:
+            if (m_masterServer)
+            {
+               ClearDataCollectionConfiguration();
                response.setField(VID_RCC, ERR_SUCCESS);
-               break;
-            case CMD_DATA_COLLECTION_CONFIG:
-               if (m_serverId != 0)
-               {
-                  ConfigureDataCollection(m_serverId, request);
-                  m_acceptData = true;
-                  response.setField(VID_RCC, ERR_SUCCESS);
-               }
-               else
-               {
-                  debugPrintf(1, _T("Data collection configuration command received but server ID is not set"));
-                  response.setField(VID_RCC, ERR_SERVER_ID_UNSET);
-               }
-               break;
-            case CMD_CLEAN_AGENT_DCI_CONF:
-               if (m_masterServer)
-               {
-                  ClearDataCollectionConfiguration();
-                  response.setField(VID_RCC, ERR_SUCCESS);
-               }
-               else
-               {
-                  response.setField(VID_RCC, ERR_ACCESS_DENIED);
-               }
-               break;
-            default:
-               // Attempt to process unknown command by subagents
-               if (!ProcessCmdBySubAgent(command, request, &response, this))
-                  response.setField(VID_RCC, ERR_UNKNOWN_COMMAND);
-               break;
-         }
+            }
+            else
+            {
+               response.setField(VID_RCC, ERR_ACCESS_DENIED);
+            }
+            break;
+         default:
+            // Attempt to process unknown command by subagents
+            if (!ProcessCmdBySubAgent(command, request, &response, this))
+               response.setField(VID_RCC, ERR_UNKNOWN_COMMAND);
+            break;
       }
-      delete request;
-
-      // Send response
-      sendMessage(&response);
-      response.deleteAllFields();
    }
+   delete request;
+
+   // Send response
+   sendMessage(&response);
+
+   INT64 elapsed = GetCurrentTimeMs() - startTime;
+   s_processingTimeLock.lock();
+   s_averageProcessingTime = (s_averageProcessingTime * 15 + (double)elapsed) / 16;
+   s_processingTimeLock.unlock();
+   InterlockedDecrement(&s_activeRequests);
 }
 
 /**
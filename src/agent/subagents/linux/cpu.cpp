@@ -21,85 +21,174 @@
 #include "linux_subagent.h"
 
 #define CPU_USAGE_SLOTS			900 // 60 sec * 15 min => 900 sec
-// 64 + 1 for overal
-#define MAX_CPU					(64 + 1)
+#define CPU_USAGE_SOURCES     (CPU_USAGE_GUEST + 1)
+#define CPU_USAGE_COUNTERS    (CPU_USAGE_SOURCES - 1)  // user, nice, system, idle, iowait, irq, softirq, steal, guest
+#define CPU_USAGE_WINDOWS     3
+
+/**
+ * Number of samples in each averaging window (indexed by INTERVAL_xxx)
+ */
+static const int s_windowSize[CPU_USAGE_WINDOWS] = { 60, 5 * 60, 15 * 60 };
+
+/**
+ * Usage history for single CPU. Samples are stored in hundredths of percent,
+ * with all sources of one sample kept together so each collector pass touches
+ * single memory block per CPU. Running sums for all averaging windows are
+ * updated on each sample, so readers never have to scan history.
+ */
+struct CpuUsageHistory
+{
+   UINT64 counters[CPU_USAGE_COUNTERS];
+   UINT32 volatile sums[CPU_USAGE_WINDOWS][CPU_USAGE_SOURCES];
+   UINT16 samples[CPU_USAGE_SLOTS][CPU_USAGE_SOURCES];
+};
 
 static THREAD m_cpuUsageCollector = INVALID_THREAD_HANDLE;
-static MUTEX m_cpuUsageMutex = INVALID_MUTEX_HANDLE;
 static bool volatile m_stopCollectorThread = false;
-static UINT64 m_user[MAX_CPU];
-static UINT64 m_nice[MAX_CPU];
-static UINT64 m_system[MAX_CPU];
-static UINT64 m_idle[MAX_CPU];
-static UINT64 m_iowait[MAX_CPU];
-static UINT64 m_irq[MAX_CPU];
-static UINT64 m_softirq[MAX_CPU];
-static UINT64 m_steal[MAX_CPU];
-static UINT64 m_guest[MAX_CPU];
 static UINT64 m_cpuInterrupts;
 static UINT64 m_cpuContextSwitches;
-static float *m_cpuUsage;
-static float *m_cpuUsageUser;
-static float *m_cpuUsageNice;
-static float *m_cpuUsageSystem;
-static float *m_cpuUsageIdle;
-static float *m_cpuUsageIoWait;
-static float *m_cpuUsageIrq;
-static float *m_cpuUsageSoftIrq;
-static float *m_cpuUsageSteal;
-static float *m_cpuUsageGuest;
-static int m_currentSlot = 0;
-static int m_maxCPU = 0;
+static CpuUsageHistory *s_history = NULL;  // element 0 holds overall usage, element N + 1 holds usage for CPU N
+static int s_historySize = 0;
+static int volatile s_cpuCount = 0;
+static int s_currentSlot = 0;
+
+/**
+ * Collector modes
+ */
+enum CollectorMode
+{
+   COLLECT_INIT,     // read initial counter values
+   COLLECT_FILL,     // fill entire history with first sample
+   COLLECT_NORMAL
+};
+
+/**
+ * Get number of CPUs which may appear in /proc/stat
+ */
+static int GetPossibleCpuCount()
+{
+   int count = (int)sysconf(_SC_NPROCESSORS_CONF);
+
+   // /proc/stat can list CPUs with IDs above configured count on some systems
+   FILE *hStat = fopen("/proc/stat", "r");
+   if (hStat != NULL)
+   {
+      char buffer[1024];
+      while(fgets(buffer, sizeof(buffer), hStat) != NULL)
+      {
+         if (strncmp(buffer, "cpu", 3))
+            break;   // CPU lines are at the beginning of the file
+         if ((buffer[3] >= '0') && (buffer[3] <= '9'))
+         {
+            int id = (int)strtol(&buffer[3], NULL, 10);
+            if (id >= count)
+               count = id + 1;
+         }
+      }
+      fclose(hStat);
+   }
+   return max(count, 1);
+}
+
+/**
+ * Add new sample to CPU usage history
+ */
+static void AddSample(CpuUsageHistory *h, const UINT64 *counters, CollectorMode mode)
+{
+   UINT64 delta[CPU_USAGE_COUNTERS];
+   UINT64 totalDelta = 0;
+   for(int i = 0; i < CPU_USAGE_COUNTERS; i++)
+   {
+      delta[i] = (counters[i] > h->counters[i]) ? counters[i] - h->counters[i] : 0;
+      totalDelta += delta[i];
+      h->counters[i] = counters[i];
+   }
+
+   if (mode == COLLECT_INIT)
+      return;
+
+   UINT16 sample[CPU_USAGE_SOURCES];
+   if (totalDelta > 0)
+   {
+      for(int i = 0; i < CPU_USAGE_COUNTERS; i++)
+         sample[i + 1] = (UINT16)(delta[i] * 10000 / totalDelta);
+      sample[CPU_USAGE_OVERAL] = 10000 - sample[CPU_USAGE_IDLE];
+   }
+   else
+   {
+      memset(sample, 0, sizeof(sample));
+   }
+
+   if (mode == COLLECT_FILL)
+   {
+      for(int i = 0; i < CPU_USAGE_SLOTS; i++)
+         memcpy(h->samples[i], sample, sizeof(sample));
+      for(int w = 0; w < CPU_USAGE_WINDOWS; w++)
+         for(int s = 0; s < CPU_USAGE_SOURCES; s++)
+            h->sums[w][s] = (UINT32)sample[s] * s_windowSize[w];
+      return;
+   }
+
+   // Sample leaving each window should be subtracted before current slot is overwritten
+   for(int w = 0; w < CPU_USAGE_WINDOWS; w++)
+   {
+      const UINT16 *oldest = h->samples[(s_currentSlot + CPU_USAGE_SLOTS - s_windowSize[w]) % CPU_USAGE_SLOTS];
+      for(int s = 0; s < CPU_USAGE_SOURCES; s++)
+         h->sums[w][s] = h->sums[w][s] + sample[s] - oldest[s];
+   }
+   memcpy(h->samples[s_currentSlot], sample, sizeof(sample));
+}
 
 /**
  * CPU usage collector
  */
-static void CpuUsageCollector()
+static void CpuUsageCollector(CollectorMode mode)
 {
 	FILE *hStat = fopen("/proc/stat", "r");
-
 	if (hStat == NULL)
 	{
 		AgentWriteDebugLog(2, _T("Cannot open /proc/stat"));
 		return;
 	}
 
-	UINT64 user, nice, system, idle;
-	UINT64 iowait = 0, irq = 0, softirq = 0; // 2.6
-	UINT64 steal = 0; // 2.6.11
-	UINT64 guest = 0; // 2.6.24
-	unsigned int cpu = 0;
-	unsigned int maxCpu = 0;
+	int maxCpu = 0;
 	char buffer[1024];
-
-	MutexLock(m_cpuUsageMutex);
-	if (m_currentSlot == CPU_USAGE_SLOTS)
+	while(fgets(buffer, sizeof(buffer), hStat) != NULL)
 	{
-		m_currentSlot = 0;
-	}
-
-	// scan for all CPUs
-	while(true)
-	{
-		if (fgets(buffer, sizeof(buffer), hStat) == NULL)
-			break;
-
-		int ret;
 		if (buffer[0] == 'c' && buffer[1] == 'p' && buffer[2] == 'u')
 		{
+         UINT64 counters[CPU_USAGE_COUNTERS];
+         memset(counters, 0, sizeof(counters));  // iowait and later fields are missing on older kernels
+
+         int cpu, ret;
          if (buffer[3] == ' ')
          {
             // "cpu ..." - Overal
             cpu = 0;
             ret = sscanf(buffer, "cpu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
-                  &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal, &guest);
+                  &counters[0], &counters[1], &counters[2], &counters[3], &counters[4],
+                  &counters[5], &counters[6], &counters[7], &counters[8]);
          }
          else
          {
-            ret = sscanf(buffer, "cpu%u %llu %llu %llu %llu %llu %llu %llu %llu %llu",
-                  &cpu, &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal, &guest);
+            ret = sscanf(buffer, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu %llu", &cpu,
+                  &counters[0], &counters[1], &counters[2], &counters[3], &counters[4],
+                  &counters[5], &counters[6], &counters[7], &counters[8]) - 1;
             cpu++;
          }
+
+         if ((ret < 4) || (cpu < 0))
+            continue;
+
+         if (cpu >= s_historySize)
+         {
+            AgentWriteDebugLog(5, _T("CpuUsageCollector: CPU %d is out of range (max %d)"), cpu - 1, s_historySize - 2);
+            continue;
+         }
+
+         AddSample(&s_history[cpu], counters, mode);
+         if (cpu > maxCpu)
+            maxCpu = cpu;
 		}
 		else if (buffer[0] == 'i' && buffer[1] == 'n' && buffer[2] == 't' && buffer[3] == 'r')
 		{
@@ -109,80 +198,16 @@ static void CpuUsageCollector()
       {
          sscanf(buffer, "ctxt %llu", &m_cpuContextSwitches);
       }
-		else
-		   continue;
-
-		if (ret < 4)
-			continue;
-
-		maxCpu = max(cpu, maxCpu);
-
-		UINT64 userDelta, niceDelta, systemDelta, idleDelta;
-		UINT64 iowaitDelta, irqDelta, softirqDelta, stealDelta;
-		UINT64 guestDelta;
-
-#define DELTA(x, y) (((x) > (y)) ? ((x) - (y)) : 0)
-		userDelta = DELTA(user, m_user[cpu]);
-		niceDelta = DELTA(nice, m_nice[cpu]);
-		systemDelta = DELTA(system, m_system[cpu]);
-		idleDelta = DELTA(idle, m_idle[cpu]);
-		iowaitDelta = DELTA(iowait, m_iowait[cpu]);
-		irqDelta = DELTA(irq, m_irq[cpu]);
-		softirqDelta = DELTA(softirq, m_softirq[cpu]);
-		stealDelta = DELTA(steal, m_steal[cpu]); // steal=time spent in virtualization stuff (xen).
-		guestDelta = DELTA(guest, m_guest[cpu]); //
-#undef DELTA
-
-		UINT64 totalDelta = userDelta + niceDelta + systemDelta + idleDelta + iowaitDelta + irqDelta + softirqDelta + stealDelta + guestDelta;
-		float onePercent = (float)totalDelta / 100.0; // 1% of total
-		if (onePercent == 0)
-		{
-			onePercent = 1; // TODO: why 1?
-		}
-			
-		/* update detailed stats */
-#define UPDATE(delta, target) { \
-			if (delta > 0) { *(target + (cpu * CPU_USAGE_SLOTS) + m_currentSlot) = (float)delta / onePercent; } \
-			else { *(target + (cpu * CPU_USAGE_SLOTS) + m_currentSlot) = 0; } \
-		}
-
-		UPDATE(userDelta, m_cpuUsageUser);
-		UPDATE(niceDelta, m_cpuUsageNice);
-		UPDATE(systemDelta, m_cpuUsageSystem);
-		UPDATE(idleDelta, m_cpuUsageIdle);
-		UPDATE(iowaitDelta, m_cpuUsageIoWait);
-		UPDATE(irqDelta, m_cpuUsageIrq);
-		UPDATE(softirqDelta, m_cpuUsageSoftIrq);
-		UPDATE(stealDelta, m_cpuUsageSteal);
-		UPDATE(guestDelta, m_cpuUsageGuest);
-
-		/* update overal cpu usage */
-		if (totalDelta > 0)
-		{
-			*(m_cpuUsage + (cpu * CPU_USAGE_SLOTS) + m_currentSlot) = 100.0 - ((float)idleDelta / onePercent);
-		}
-		else
-		{
-			*(m_cpuUsage + (cpu * CPU_USAGE_SLOTS) + m_currentSlot) = 0;
-		}
-
-		m_user[cpu] = user;
-		m_nice[cpu] = nice;
-		m_system[cpu] = system;
-		m_idle[cpu] = idle;
-		m_iowait[cpu] = iowait;
-		m_irq[cpu] = irq;
-		m_softirq[cpu] = softirq;
-		m_steal[cpu] = steal;
-		m_guest[cpu] = guest;
 	}
-
-	/* go to the next slot */
-	m_currentSlot++;
-	MutexUnlock(m_cpuUsageMutex);
-
 	fclose(hStat);
-	m_maxCPU = maxCpu;
+
+	if (mode == COLLECT_NORMAL)
+	{
+	   s_currentSlot++;
+	   if (s_currentSlot == CPU_USAGE_SLOTS)
+	      s_currentSlot = 0;
+	}
+	s_cpuCount = maxCpu;
 }
 
 /**
@@ -190,10 +215,12 @@ static void CpuUsageCollector()
  */
 static THREAD_RESULT THREAD_CALL CpuUsageCollectorThread(void *pArg)
 {
-	while(m_stopCollectorThread == false)
+	while(true)
 	{
-		CpuUsageCollector();
 		ThreadSleepMs(1000); // sleep 1 second
+		if (m_stopCollectorThread)
+		   break;
+		CpuUsageCollector(COLLECT_NORMAL);
 	}
 	return THREAD_OK;
 }
@@ -203,63 +230,20 @@ static THREAD_RESULT THREAD_CALL CpuUsageCollectorThread(void *pArg)
  */
 void StartCpuUsageCollector()
 {
-	int i, j;
-
-	m_cpuUsageMutex = MutexCreate();
-
-#define SIZE sizeof(float) * CPU_USAGE_SLOTS * MAX_CPU
-#define ALLOCATE_AND_CLEAR(x) x = (float *)malloc(SIZE); memset(x, 0, SIZE);
-	ALLOCATE_AND_CLEAR(m_cpuUsage);
-	ALLOCATE_AND_CLEAR(m_cpuUsageUser);
-	ALLOCATE_AND_CLEAR(m_cpuUsageNice);
-	ALLOCATE_AND_CLEAR(m_cpuUsageSystem);
-	ALLOCATE_AND_CLEAR(m_cpuUsageIdle);
-	ALLOCATE_AND_CLEAR(m_cpuUsageIoWait);
-	ALLOCATE_AND_CLEAR(m_cpuUsageIrq);
-	ALLOCATE_AND_CLEAR(m_cpuUsageSoftIrq);
-	ALLOCATE_AND_CLEAR(m_cpuUsageSteal);
-	ALLOCATE_AND_CLEAR(m_cpuUsageGuest);
-#undef ALLOCATE_AND_CLEAR
-#undef SIZE
-
-#define CLEAR(x) memset(x, 0, sizeof(UINT64) * MAX_CPU);
-	CLEAR(m_user)
-	CLEAR(m_nice)
-	CLEAR(m_system)
-	CLEAR(m_idle)
-	CLEAR(m_iowait)
-	CLEAR(m_irq)
-	CLEAR(m_softirq)
-	CLEAR(m_steal)
-	CLEAR(m_guest)
-#undef CLEAR
+   // History is allocated once for all possible CPUs, so readers
+   // can access it without locking
+   s_historySize = GetPossibleCpuCount() + 1;
+   s_history = (CpuUsageHistory *)calloc(s_historySize, sizeof(CpuUsageHistory));
+   AgentWriteDebugLog(3, _T("CPU usage collector: history allocated for %d CPUs (%d KB)"),
+            s_historySize - 1, (int)(s_historySize * sizeof(CpuUsageHistory) / 1024));
 
 	// get initial count of user/system/idle time
-	m_currentSlot = 0;
-	CpuUsageCollector();
+	CpuUsageCollector(COLLECT_INIT);
 
 	sleep(1);
 
-	// fill first slot with u/s/i delta
-	m_currentSlot = 0;
-	CpuUsageCollector();
-
 	// fill all slots with current cpu usage
-#define FILL(x) memcpy(x + i, x, sizeof(float));
-	for (i = 0; i < (CPU_USAGE_SLOTS * MAX_CPU) - 1; i++)
-	{
-			FILL(m_cpuUsage);
-			FILL(m_cpuUsageUser);
-			FILL(m_cpuUsageNice);
-			FILL(m_cpuUsageSystem);
-			FILL(m_cpuUsageIdle);
-			FILL(m_cpuUsageIoWait);
-			FILL(m_cpuUsageIrq);
-			FILL(m_cpuUsageSoftIrq);
-			FILL(m_cpuUsageSteal);
-			FILL(m_cpuUsageGuest);
-	}
-#undef FILL
+	CpuUsageCollector(COLLECT_FILL);
 
 	// start collector
 	m_cpuUsageCollector = ThreadCreateEx(CpuUsageCollectorThread, 0, NULL);
@@ -272,130 +256,51 @@ void ShutdownCpuUsageCollector()
 {
 	m_stopCollectorThread = true;
 	ThreadJoin(m_cpuUsageCollector);
-	MutexDestroy(m_cpuUsageMutex);
-
-	free(m_cpuUsage);
-	free(m_cpuUsageUser);
-	free(m_cpuUsageNice);
-	free(m_cpuUsageSystem);
-	free(m_cpuUsageIdle);
-	free(m_cpuUsageIoWait);
-	free(m_cpuUsageIrq);
-	free(m_cpuUsageSoftIrq);
-	free(m_cpuUsageSteal);
-	free(m_cpuUsageGuest);
+	free(s_history);
+	s_history = NULL;
+	s_historySize = 0;
+	s_cpuCount = 0;
 }
 
-static void GetUsage(int source, int cpu, int count, TCHAR *value)
+/**
+ * Get average usage for given source, CPU, and interval
+ */
+static void GetUsage(int source, int cpu, int interval, TCHAR *value)
 {
-	float *table;
-	switch (source)
-	{
-		case CPU_USAGE_OVERAL:
-			table = (float *)m_cpuUsage;
-			break;
-		case CPU_USAGE_USER:
-			table = (float *)m_cpuUsageUser;
-			break;
-		case CPU_USAGE_NICE:
-			table = (float *)m_cpuUsageNice;
-			break;
-		case CPU_USAGE_SYSTEM:
-			table = (float *)m_cpuUsageSystem;
-			break;
-		case CPU_USAGE_IDLE:
-			table = (float *)m_cpuUsageIdle;
-			break;
-		case CPU_USAGE_IOWAIT:
-			table = (float *)m_cpuUsageIoWait;
-			break;
-		case CPU_USAGE_IRQ:
-			table = (float *)m_cpuUsageIrq;
-			break;
-		case CPU_USAGE_SOFTIRQ:
-			table = (float *)m_cpuUsageSoftIrq;
-			break;
-		case CPU_USAGE_STEAL:
-			table = (float *)m_cpuUsageSteal;
-			break;
-		case CPU_USAGE_GUEST:
-			table = (float *)m_cpuUsageGuest;
-			break;
-		default:
-			table = (float *)m_cpuUsage;
-	}
-
-   table += cpu * CPU_USAGE_SLOTS;
-   float usage = 0;
-   MutexLock(m_cpuUsageMutex);
-
-   float *p = table + m_currentSlot - 1;
-   for (int i = 0; i < count; i++)
-   {
-      usage += *p;
-      if (p == table)
-      {
-         p += CPU_USAGE_SLOTS;
-      }
-      p--;
-   }
-
-   MutexUnlock(m_cpuUsageMutex);
-
-   usage /= count;
-
-	ret_double(value, usage);
+   if ((source < 0) || (source >= CPU_USAGE_SOURCES))
+      source = CPU_USAGE_OVERAL;
+   if ((interval < 0) || (interval >= CPU_USAGE_WINDOWS))
+      interval = INTERVAL_1MIN;
+   ret_double(value, (double)s_history[cpu].sums[interval][source] / s_windowSize[interval] / 100.0);
 }
 
+/**
+ * Handler for System.CPU.Usage parameters
+ */
 LONG H_CpuUsage(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, AbstractCommSession *session)
 {
-	int count;
-
-	switch(CPU_USAGE_PARAM_INTERVAL(pArg))
-	{
-		case INTERVAL_5MIN:
-			count = 5 * 60;
-			break;
-		case INTERVAL_15MIN:
-			count = 15 * 60;
-			break;
-		default:
-			count = 60;
-			break;
-	}
-
-	GetUsage(CPU_USAGE_PARAM_SOURCE(pArg), 0, count, pValue);
+   if (s_history == NULL)
+      return SYSINFO_RC_ERROR;
+	GetUsage(CPU_USAGE_PARAM_SOURCE(pArg), 0, CPU_USAGE_PARAM_INTERVAL(pArg), pValue);
 	return SYSINFO_RC_SUCCESS;
 }
 
+/**
+ * Handler for System.CPU.Usage parameters for individual CPUs
+ */
 LONG H_CpuUsageEx(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, AbstractCommSession *session)
 {
-	int count, cpu;
+	int cpu;
 	TCHAR buffer[256], *eptr;
-	struct CpuUsageParam *p = (struct CpuUsageParam *)pValue;
 
 	if (!AgentGetParameterArg(pszParam, 1, buffer, 256))
 		return SYSINFO_RC_UNSUPPORTED;
 		
 	cpu = _tcstol(buffer, &eptr, 0);
-	if ((*eptr != 0) || (cpu < 0) || (cpu >= m_maxCPU))
+	if ((*eptr != 0) || (cpu < 0) || (cpu >= s_cpuCount))
 		return SYSINFO_RC_UNSUPPORTED;
 
-	switch(CPU_USAGE_PARAM_INTERVAL(pArg))
-	{
-		case INTERVAL_5MIN:
-			count = 5 * 60;
-			break;
-		case INTERVAL_15MIN:
-			count = 15 * 60;
-			break;
-		default:
-			count = 60;
-			break;
-	}
-
-	GetUsage(CPU_USAGE_PARAM_SOURCE(pArg), cpu + 1, count, pValue);
-
+	GetUsage(CPU_USAGE_PARAM_SOURCE(pArg), cpu + 1, CPU_USAGE_PARAM_INTERVAL(pArg), pValue);
 	return SYSINFO_RC_SUCCESS;
 }
 
@@ -404,7 +309,7 @@ LONG H_CpuUsageEx(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, Abstr
  */
 LONG H_CpuCount(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, AbstractCommSession *session)
 {
-	ret_uint(pValue, m_maxCPU);
+	ret_uint(pValue, s_cpuCount);
 	return SYSINFO_RC_SUCCESS;
 }
 
@@ -454,6 +359,8 @@ static int ReadCpuInfo(CPU_INFO *info, int size)
 
       if (!strcmp(buffer, "processor"))
       {
+         if (count == size - 1)
+            break;
          count++;
          memset(&info[count], 0, sizeof(CPU_INFO));
          info[count].id = (int)strtol(s, NULL, 10);
@@ -500,10 +407,14 @@ static int ReadCpuInfo(CPU_INFO *info, int size)
  */
 LONG H_CpuInfo(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
 {
-   CPU_INFO cpuInfo[256];
-   int count = ReadCpuInfo(cpuInfo, 256);
+   int size = max(s_historySize - 1, 256);
+   CPU_INFO *cpuInfo = (CPU_INFO *)malloc(sizeof(CPU_INFO) * size);
+   int count = ReadCpuInfo(cpuInfo, size);
    if (count <= 0)
+   {
+      free(cpuInfo);
       return SYSINFO_RC_ERROR;
+   }
 
    TCHAR buffer[32];
    AgentGetParameterArg(param, 1, buffer, 32);
@@ -519,8 +430,12 @@ LONG H_CpuInfo(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommS
       }
    }
    if (cpu == NULL)
+   {
+      free(cpuInfo);
       return SYSINFO_RC_NO_SUCH_INSTANCE;
+   }
 
+   LONG rc = SYSINFO_RC_SUCCESS;
    switch(*arg)
    {
       case 'C':   // Core ID
@@ -539,10 +454,12 @@ LONG H_CpuInfo(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommS
          ret_int(value, cpu->cacheSize);
          break;
       default:
-         return SYSINFO_RC_UNSUPPORTED;
+         rc = SYSINFO_RC_UNSUPPORTED;
+         break;
    }
 
-   return SYSINFO_RC_SUCCESS;
+   free(cpuInfo);
+   return rc;
 }
 
 /*
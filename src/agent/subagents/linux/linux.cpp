@@ -101,6 +101,7 @@ static BOOL SubAgentInit(Config *config)
 	StartCpuUsageCollector();
 	StartIoStatCollector();
 	InitDrbdCollector();
+	InitProcessSnapshot(config);
 	return TRUE;
 }
 
@@ -112,6 +113,7 @@ static void SubAgentShutdown()
 	ShutdownCpuUsageCollector();
 	ShutdownIoStatCollector();
 	StopDrbdCollector();
+	ShutdownProcessSnapshot();
 }
 
 /**
@@ -130,6 +132,10 @@ LONG H_PhysicalDiskInfo(const TCHAR *pszParam, const TCHAR *pszArg, TCHAR *pValu
  */
 static NETXMS_SUBAGENT_PARAM m_parameters[] =
 {
+   { _T("Agent.ProcessSnapshot.Age"), H_ProcessSnapshotInfo, _T("A"), DCI_DT_UINT64, _T("Age of process information snapshot (milliseconds)") },
+   { _T("Agent.ProcessSnapshot.ProcessCount"), H_ProcessSnapshotInfo, _T("P"), DCI_DT_UINT, _T("Number of processes in process information snapshot") },
+   { _T("Agent.ProcessSnapshot.RefreshCount"), H_ProcessSnapshotInfo, _T("C"), DCI_DT_UINT64, _T("Number of process information snapshot refreshes") },
+   { _T("Agent.ProcessSnapshot.RefreshTime"), H_ProcessSnapshotInfo, _T("T"), DCI_DT_UINT, _T("Time spent on last process information snapshot refresh (milliseconds)") },
    { _T("Agent.SourcePackageSupport"), H_SourcePkgSupport, NULL, DCI_DT_INT, DCIDESC_AGENT_SOURCEPACKAGESUPPORT },
 
 	{ _T("Disk.Avail(*)"),                H_DiskInfo,        (TCHAR *)DISK_AVAIL,
@@ -235,6 +235,7 @@ LONG H_CpuUsage(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
 LONG H_CpuUsageEx(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
 LONG H_ProcessCount(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
 LONG H_ProcessDetails(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
+LONG H_ProcessSnapshotInfo(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
 LONG H_ThreadCount(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
 LONG H_MemoryInfo(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
 LONG H_SourcePkgSupport(const TCHAR *, const TCHAR *, TCHAR *, AbstractCommSession *);
@@ -251,4 +252,7 @@ void ShutdownIoStatCollector();
 void InitDrbdCollector();
 void StopDrbdCollector();
 
+void InitProcessSnapshot(Config *config);
+void ShutdownProcessSnapshot();
+
 #endif // __LINUX_SUBAGENT_H__
@@ -63,6 +63,8 @@ class Process
 public:
 	UINT32 pid;
 	char *name;
+	char *cmdLine;          // Command line (NULL if not read yet)
+	bool cmdLineValid;      // true if command line was read after last snapshot refresh
 	UINT32 parent;          // PID of parent process
 	UINT32 group;           // Group ID
 	char state;             // Process state
@@ -73,12 +75,16 @@ public:
 	long rss;               // Process's resident set size in pages
 	unsigned long minflt;   // Number of minor page faults
 	unsigned long majflt;   // Number of major page faults
+	unsigned long long startTime;  // Process start time in ticks since boot (used to detect PID reuse)
    ObjectArray<FileDescriptor> *fd;
+   bool fdValid;           // true if file descriptor list is valid for current snapshot
    
    Process(UINT32 _pid, const char *_name)
    {
       pid = _pid;
       name = strdup(_name);
+      cmdLine = NULL;
+      cmdLineValid = false;
       parent = 0;
       group = 0;
       state = '?';
@@ -89,14 +95,20 @@ public:
       rss = 0;
       minflt = 0;
       majflt = 0;
+      startTime = 0;
       fd = NULL;
+      fdValid = false;
    }
    
    ~Process()
    {
       free(name);
+      free(cmdLine);
       delete fd;
    }
+
+   const char *getCmdLine();
+   ObjectArray<FileDescriptor> *getHandles();
 };
 
 /**
@@ -148,165 +160,344 @@ static ObjectArray<FileDescriptor> *ReadProcessHandles(UINT32 pid)
 }
 
 /**
- * Read process information from /proc system
- * Parameters:
- *    plist    - array to fill, can be NULL
+ * Get process handles (read on first access after snapshot refresh)
+ */
+ObjectArray<FileDescriptor> *Process::getHandles()
+{
+   if (!fdValid)
+   {
+      delete fd;
+      fd = ReadProcessHandles(pid);
+      fdValid = true;
+   }
+   return fd;
+}
+
+/**
+ * Get process command line (read on first access after snapshot refresh, as process
+ * can change it at any time). Arguments are separated by spaces.
+ */
+const char *Process::getCmdLine()
+{
+   if (cmdLineValid)
+      return cmdLine;
+
+   char fileName[MAX_PATH];
+   snprintf(fileName, MAX_PATH, "/proc/%u/cmdline", pid);
+   FILE *hFile = fopen(fileName, "r");
+   if (hFile == NULL)
+      return (cmdLine != NULL) ? cmdLine : "";  // process may be gone or not accessible
+
+   size_t len = 0, pos = 0;
+   cmdLine = (char *)realloc(cmdLine, 1024);
+   while(true)
+   {
+      int bytes = fread(&cmdLine[pos], 1, 1024, hFile);
+      if (bytes < 0)
+         bytes = 0;
+      len += bytes;
+      if (bytes < 1024)
+      {
+         cmdLine[len] = 0;
+         break;
+      }
+      pos += bytes;
+      cmdLine = (char *)realloc(cmdLine, pos + 1024);
+   }
+   fclose(hFile);
+   cmdLineValid = true;
+
+   // got a valid record in format: argv[0]\x00argv[1]\x00...
+   // Note: to behave identicaly on different platforms,
+   // full command line including argv[0] should be matched
+   // replace 0x00 with spaces
+   for(size_t j = 0; j + 1 < len; j++)
+   {
+      if (cmdLine[j] == 0)
+         cmdLine[j] = ' ';
+   }
+   return cmdLine;
+}
+
+/**
+ * Read /proc/<pid>/stat into process object. If process object is NULL, new one will be created.
+ * Returns process object or NULL on failure.
+ */
+static Process *ReadProcessStat(UINT32 pid, Process *p)
+{
+   char fileName[MAX_PATH];
+   snprintf(fileName, MAX_PATH, "/proc/%u/stat", pid);
+   FILE *hFile = fopen(fileName, "r");
+   if (hFile == NULL)
+      return NULL;
+
+   char szProcStat[1024] = {0};
+   bool success = (fgets(szProcStat, sizeof(szProcStat), hFile) != NULL);
+   fclose(hFile);
+   if (!success)
+      return NULL;
+
+   // Process name is enclosed in parenthesis and may contain spaces and parenthesis
+   char *pProcStat = strrchr(szProcStat, ')');
+   char *pProcName = strchr(szProcStat, '(');
+   if ((pProcStat == NULL) || (pProcName == NULL) || (pProcName > pProcStat))
+      return NULL;
+   *pProcStat = 0;
+   pProcStat++;
+   pProcName++;
+
+   unsigned long long startTime = 0;
+   Process tmp(pid, "");
+   if (sscanf(pProcStat, " %c %d %d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu %*u %*u %*d %*d %ld %*d %llu %lu %ld ",
+              &tmp.state, &tmp.parent, &tmp.group, &tmp.minflt, &tmp.majflt,
+              &tmp.utime, &tmp.ktime, &tmp.threads, &startTime, &tmp.vmsize, &tmp.rss) != 11)
+   {
+      AgentWriteDebugLog(2, _T("Error parsing /proc/%u/stat"), pid);
+   }
+
+   if ((p != NULL) && (p->startTime == startTime) && !strcmp(p->name, pProcName))
+   {
+      p->cmdLineValid = false;
+      p->fdValid = false;
+   }
+   else
+   {
+      // New process or PID was reused
+      p = new Process(pid, pProcName);
+      p->startTime = startTime;
+   }
+   p->state = tmp.state;
+   p->parent = tmp.parent;
+   p->group = tmp.group;
+   p->minflt = tmp.minflt;
+   p->majflt = tmp.majflt;
+   p->utime = tmp.utime;
+   p->ktime = tmp.ktime;
+   p->threads = tmp.threads;
+   p->vmsize = tmp.vmsize;
+   p->rss = tmp.rss;
+   return p;
+}
+
+/**
+ * Compare process IDs
+ */
+static int ComparePID(const void *e1, const void *e2)
+{
+   UINT32 p1 = *((const UINT32 *)e1);
+   UINT32 p2 = *((const UINT32 *)e2);
+   return (p1 < p2) ? -1 : ((p1 > p2) ? 1 : 0);
+}
+
+/**
+ * Process snapshot (ordered by PID) shared by all process related parameters
+ */
+static ObjectArray<Process> *s_snapshot = NULL;
+static Mutex s_snapshotLock;
+static INT64 s_snapshotTimestamp = 0;
+static UINT32 s_snapshotRefreshTime = 0;
+static UINT64 s_snapshotRefreshCount = 0;
+
+/**
+ * Maximum snapshot age in milliseconds (0 to disable caching)
+ */
+static UINT32 s_snapshotMaxAge = 2000;
+
+/**
+ * Refresh process snapshot. Information for already known processes is updated
+ * in place; command lines and handles are re-read on first access after refresh.
+ * Should be called with snapshot lock held.
+ * Returns false on failure.
+ */
+static bool RefreshProcessSnapshot()
+{
+   INT64 startTime = GetCurrentTimeMs();
+
+   DIR *dir = opendir("/proc");
+   if (dir == NULL)
+      return false;
+
+   IntegerArray<UINT32> pids(1024, 1024);
+   struct dirent *e;
+   while((e = readdir(dir)) != NULL)
+   {
+      if (ProcFilter(e))
+         pids.add(strtoul(e->d_name, NULL, 10));
+   }
+   closedir(dir);
+   if (pids.size() == 0)
+      return false;  // consider 0 as error as there should not be 0 processes
+   qsort(pids.getBuffer(), pids.size(), sizeof(UINT32), ComparePID);
+
+   ObjectArray<Process> *snapshot = new ObjectArray<Process>(pids.size(), 256, true);
+   int oldIndex = 0;
+   int oldCount = 0;
+   if (s_snapshot != NULL)
+   {
+      oldCount = s_snapshot->size();
+      s_snapshot->setOwner(false);  // reused elements will be replaced with NULL
+   }
+   for(int i = 0; i < pids.size(); i++)
+   {
+      UINT32 pid = pids.get(i);
+
+      // Both lists are ordered by PID
+      Process *curr = NULL;
+      while((oldIndex < oldCount) && (s_snapshot->get(oldIndex)->pid < pid))
+         oldIndex++;
+      if ((oldIndex < oldCount) && (s_snapshot->get(oldIndex)->pid == pid))
+         curr = s_snapshot->get(oldIndex);
+
+      Process *p = ReadProcessStat(pid, curr);
+      if (p == NULL)
+         continue;   // process terminated
+      if (p == curr)
+         s_snapshot->set(oldIndex++, NULL);  // moved to new snapshot
+      snapshot->add(p);
+   }
+
+   if (s_snapshot != NULL)
+   {
+      s_snapshot->setOwner(true);   // destroy terminated processes
+      delete s_snapshot;
+   }
+   s_snapshot = snapshot;
+
+   s_snapshotTimestamp = GetCurrentTimeMs();
+   s_snapshotRefreshTime = (UINT32)(s_snapshotTimestamp - startTime);
+   s_snapshotRefreshCount++;
+   AgentWriteDebugLog(7, _T("Process snapshot refreshed (%d processes, %u ms)"), snapshot->size(), s_snapshotRefreshTime);
+   return true;
+}
+
+/**
+ * Lock process snapshot and refresh it if needed. Returns NULL on failure.
+ * Caller must call UnlockProcessSnapshot when processing completes.
+ */
+static ObjectArray<Process> *LockProcessSnapshot()
+{
+   s_snapshotLock.lock();
+   if ((s_snapshot == NULL) || (GetCurrentTimeMs() - s_snapshotTimestamp >= (INT64)s_snapshotMaxAge))
+   {
+      if (!RefreshProcessSnapshot())
+      {
+         s_snapshotLock.unlock();
+         return NULL;
+      }
+   }
+   return s_snapshot;
+}
+
+/**
+ * Unlock process snapshot
+ */
+inline void UnlockProcessSnapshot()
+{
+   s_snapshotLock.unlock();
+}
+
+/**
+ * Initialize process snapshot
+ */
+void InitProcessSnapshot(Config *config)
+{
+   s_snapshotMaxAge = config->getValueAsUInt(_T("/Linux/ProcessSnapshotMaxAge"), s_snapshotMaxAge);
+   AgentWriteDebugLog(3, _T("Process snapshot maximum age set to %u milliseconds"), s_snapshotMaxAge);
+}
+
+/**
+ * Destroy process snapshot
+ */
+void ShutdownProcessSnapshot()
+{
+   s_snapshotLock.lock();
+   delete_and_null(s_snapshot);
+   s_snapshotLock.unlock();
+}
+
+/**
+ * Check if process matches given filters.
  *    procNameFilter - If not NULL, only processes with matched name will
- *               be counted and read. If cmdLineFilter is NULL, then exact
+ *               pass. If cmdLineFilter is NULL, then exact
  *               match required to pass filter; otherwise procNameFilter can
  *               be a regular expression.
  *    cmdLineFilter - If not NULL, only processes with command line matched to
- *              regular expression will be counted and read.
+ *              regular expression will pass.
+ */
+static bool MatchProcess(Process *p, const char *procNameFilter, const char *cmdLineFilter)
+{
+   if ((procNameFilter != NULL) && (*procNameFilter != 0))
+   {
+      if (cmdLineFilter == NULL) // use old style compare
+      {
+         if (strcmp(p->name, procNameFilter))
+            return false;
+      }
+      else if (!RegexpMatchA(p->name, procNameFilter, FALSE))
+      {
+         return false;
+      }
+   }
+
+   if ((cmdLineFilter != NULL) && (*cmdLineFilter != 0))
+      return RegexpMatchA(p->getCmdLine(), cmdLineFilter, TRUE);
+   return true;
+}
+
+/**
+ * Count processes matching given filters (see MatchProcess for details)
  * Return value: number of matched processes or -1 in case of error.
  */
-static int ProcRead(ObjectArray<Process> *plist, const char *procNameFilter, const char *cmdLineFilter)
+static int ProcCount(const char *procNameFilter, const char *cmdLineFilter)
 {
-	AgentWriteDebugLog(5, _T("ProcRead(%p, \"%hs\",\"%hs\")"), plist, CHECK_NULL_A(procNameFilter), CHECK_NULL_A(cmdLineFilter));
+	AgentWriteDebugLog(5, _T("ProcCount(\"%hs\",\"%hs\")"), CHECK_NULL_A(procNameFilter), CHECK_NULL_A(cmdLineFilter));
 
-	struct dirent **nameList;
-	int count = scandir("/proc", &nameList, ProcFilter, alphasort);
-   if (count < 0)
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
       return -1;
-   if (count == 0)
+
+   int found;
+   if ((procNameFilter == NULL) && (cmdLineFilter == NULL))
    {
-      free(nameList);
-      return -1;  // consider 0 as error as there should not be 0 processes
+      found = snapshot->size();
    }
-   
-   // get process count without filtering, we can skip long loop
-	if ((plist == NULL) && (procNameFilter == NULL) && (cmdLineFilter == NULL))
-	{
-      for(int i = 0; i < count; i++)
-         free(nameList[i]);
-      free(nameList);
-		return count;
-	}
-
-   int found = 0;
-   while(count-- > 0)
+   else
    {
-      bool procFound = false;
-      bool cmdFound = false;
-      char *pProcName = NULL;
-      char *pProcStat = NULL;
-      unsigned long nPid = 0;
-
-      char fileName[MAX_PATH];
-      snprintf(fileName, MAX_PATH, "/proc/%s/stat", nameList[count]->d_name);
-      FILE *hFile = fopen(fileName, "r");
-      if (hFile != NULL)
-      {
-         char szProcStat[1024] = {0}; 
-         if (fgets(szProcStat, sizeof(szProcStat), hFile) != NULL)
-         {
-            if (sscanf(szProcStat, "%lu ", &nPid) == 1)
-            {
-               pProcName = strchr(szProcStat, ')');
-               if (pProcName != NULL)
-               {
-                  pProcStat = pProcName + 1;
-                  *pProcName = 0;							
-                  pProcName =  strchr(szProcStat, '(');
-                  if (pProcName != NULL)
-                  {
-                     pProcName++;
-                     if ((procNameFilter != NULL) && (*procNameFilter != 0))
-                     {
-                        if (cmdLineFilter == NULL) // use old style compare
-                           procFound = (strcmp(pProcName, procNameFilter) == 0);
-                        else
-                           procFound = RegexpMatchA(pProcName, procNameFilter, FALSE);
-                     }
-                     else
-                     {
-                        procFound = true;
-                     }
-                  }
-               } // pProcName != NULL
-            }
-         } // fgets   
-         fclose(hFile);
-      } // hFile
-
-      if ((cmdLineFilter != NULL) && (*cmdLineFilter != 0))
+      found = 0;
+      for(int i = 0; i < snapshot->size(); i++)
       {
-         snprintf(fileName, MAX_PATH, "/proc/%s/cmdline", nameList[count]->d_name);
-         hFile = fopen(fileName, "r");
-         if (hFile != NULL)
-         {
-            size_t len = 0, pos = 0;
-            char *processCmdLine = (char *)malloc(1024);
-            while(true)
-            {
-               int bytes = fread(&processCmdLine[pos], 1, 1024, hFile);
-               if (bytes < 0)
-                  bytes = 0;
-               len += bytes;
-               if (bytes < 1024)
-               {
-                  processCmdLine[len] = 0;
-                  break;
-               }
-               pos += bytes;
-               processCmdLine = (char *)realloc(processCmdLine, pos + 1024);
-            }
-            if (len > 0)
-            {
-               // got a valid record in format: argv[0]\x00argv[1]\x00...
-               // Note: to behave identicaly on different platforms,
-               // full command line including argv[0] should be matched
-               // replace 0x00 with spaces
-               for(int j = 0; j < len - 1; j++)
-               {
-                  if (processCmdLine[j] == 0)
-                  {
-                     processCmdLine[j] = ' ';
-                  }
-               }
-               cmdFound = RegexpMatchA(processCmdLine, cmdLineFilter, TRUE);
-            }
-            else
-            {
-               cmdFound = RegexpMatchA("", cmdLineFilter, TRUE);
-            }
-            fclose(hFile);
-            free(processCmdLine);
-         } // hFile != NULL
-         else
-         {
-            cmdFound = RegexpMatchA("", cmdLineFilter, TRUE);
-         }
-      } // cmdLineFilter
-      else
-      {
-         cmdFound = true;
+         if (MatchProcess(snapshot->get(i), procNameFilter, cmdLineFilter))
+            found++;
       }
+   }
 
-      if (procFound && cmdFound)
-      {
-         if ((plist != NULL) && (pProcName != NULL))
-         {
-            Process *p = new Process(nPid, pProcName);
-            // Parse rest of /proc/pid/stat file
-            if (pProcStat != NULL)
-            {
-               if (sscanf(pProcStat, " %c %d %d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu %*u %*u %*d %*d %ld %*d %*u %lu %ld ",
-                          &p->state, &p->parent, &p->group, &p->minflt, &p->majflt,
-                          &p->utime, &p->ktime, &p->threads, &p->vmsize, &p->rss) != 10)
-               {
-                  AgentWriteDebugLog(2, _T("Error parsing /proc/%d/stat"), nPid);
-               }
-            }
-            p->fd = ReadProcessHandles(nPid);
-            plist->add(p);
-         }
-         found++;
-      }
+   UnlockProcessSnapshot();
+	return found;
+}
 
-      free(nameList[count]);
+/**
+ * Handler for Agent.ProcessSnapshot.* parameters
+ */
+LONG H_ProcessSnapshotInfo(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
+{
+   s_snapshotLock.lock();
+   switch(*arg)
+   {
+      case 'A':   // age
+         ret_uint64(value, (s_snapshot != NULL) ? (UINT64)(GetCurrentTimeMs() - s_snapshotTimestamp) : 0);
+         break;
+      case 'C':   // refresh count
+         ret_uint64(value, s_snapshotRefreshCount);
+         break;
+      case 'P':   // number of processes
+         ret_uint(value, (s_snapshot != NULL) ? (UINT32)s_snapshot->size() : 0);
+         break;
+      case 'T':   // refresh time
+         ret_uint(value, s_snapshotRefreshTime);
+         break;
    }
-   free(nameList);
-	return found;
+   s_snapshotLock.unlock();
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -327,7 +518,7 @@ LONG H_ProcessCount(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, Abs
 		}
 	}
 
-	nCount = ProcRead(NULL, (*pArg != _T('T')) ? procNameFilter : NULL, (*pArg == _T('E')) ? cmdLineFilter : NULL);
+	nCount = ProcCount((*pArg != _T('T')) ? procNameFilter : NULL, (*pArg == _T('E')) ? cmdLineFilter : NULL);
 
 	if (nCount >= 0)
 	{
@@ -343,19 +534,17 @@ LONG H_ProcessCount(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, Abs
  */
 LONG H_ThreadCount(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
 {
-	int i, sum, count, ret = SYSINFO_RC_ERROR;
-	ObjectArray<Process> procList(128, 128, true);
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
+      return SYSINFO_RC_ERROR;
 
-	count = ProcRead(&procList, NULL, NULL);
-	if (count >= 0)
-	{
-		for(i = 0, sum = 0; i < procList.size(); i++)
-			sum += procList.get(i)->threads;
-		ret_int(value, sum);
-		ret = SYSINFO_RC_SUCCESS;
-	}
+	int sum = 0;
+	for(int i = 0; i < snapshot->size(); i++)
+		sum += snapshot->get(i)->threads;
+   UnlockProcessSnapshot();
 
-	return ret;
+	ret_int(value, sum);
+	return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -363,22 +552,21 @@ LONG H_ThreadCount(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractC
  */
 LONG H_HandleCount(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
 {
-	int i, sum, count, ret = SYSINFO_RC_ERROR;
-	ObjectArray<Process> procList(128, 128, true);
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
+      return SYSINFO_RC_ERROR;
 
-	count = ProcRead(&procList, NULL, NULL);
-	if (count >= 0)
-	{
-		for(i = 0, sum = 0; i < procList.size(); i++)
-      {
-         if (procList.get(i)->fd != NULL)
-            sum += procList.get(i)->fd->size();
-      }
-		ret_int(value, sum);
-		ret = SYSINFO_RC_SUCCESS;
-	}
+	int sum = 0;
+	for(int i = 0; i < snapshot->size(); i++)
+   {
+      ObjectArray<FileDescriptor> *fd = snapshot->get(i)->getHandles();
+      if (fd != NULL)
+         sum += fd->size();
+   }
+   UnlockProcessSnapshot();
 
-	return ret;
+	ret_int(value, sum);
+	return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -423,24 +611,26 @@ LONG H_ProcessDetails(const TCHAR *param, const TCHAR *arg, TCHAR *value, Abstra
 	AgentGetParameterArgA(param, 3, cmdLineFilter, MAX_PATH);
 	StrStripA(cmdLineFilter);
 
-	ObjectArray<Process> procList(128, 128, true);
-	count = ProcRead(&procList, procNameFilter, (cmdLineFilter[0] != 0) ? cmdLineFilter : NULL);
-	AgentWriteDebugLog(5, _T("H_ProcessDetails(\"%hs\"): ProcRead() returns %d"), param, count);
-	if (count == -1)
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
 		return SYSINFO_RC_ERROR;
 
 	long pageSize = getpagesize();
 	long ticksPerSecond = sysconf(_SC_CLK_TCK);
-	for(i = 0, finalVal = 0; i < procList.size(); i++)
+	for(i = 0, count = 0, finalVal = 0; i < snapshot->size(); i++)
 	{
-      Process *p = procList.get(i);
+      Process *p = snapshot->get(i);
+      if (!MatchProcess(p, procNameFilter, (cmdLineFilter[0] != 0) ? cmdLineFilter : NULL))
+         continue;
+      count++;
+
 		switch(CAST_FROM_POINTER(arg, int))
 		{
 			case PROCINFO_CPUTIME:
 				currVal = (p->ktime + p->utime) * 1000 / ticksPerSecond;
 				break;
 			case PROCINFO_HANDLES:
-				currVal = (p->fd != NULL) ? p->fd->size() : 0;
+				currVal = (p->getHandles() != NULL) ? p->getHandles()->size() : 0;
 				break;
 			case PROCINFO_KTIME:
 				currVal = p->ktime * 1000 / ticksPerSecond;
@@ -479,8 +669,10 @@ LONG H_ProcessDetails(const TCHAR *param, const TCHAR *arg, TCHAR *value, Abstra
 				break;
 		}
 	}
+   UnlockProcessSnapshot();
+	AgentWriteDebugLog(5, _T("H_ProcessDetails(\"%s\"): %d matching processes"), param, count);
 
-	if (type == INFOTYPE_AVG)
+	if ((type == INFOTYPE_AVG) && (count > 0))
 		finalVal /= count;
 
 	ret_int64(value, finalVal);
@@ -492,23 +684,19 @@ LONG H_ProcessDetails(const TCHAR *param, const TCHAR *arg, TCHAR *value, Abstra
  */
 LONG H_ProcessList(const TCHAR *pszParam, const TCHAR *pArg, StringList *value, AbstractCommSession *session)
 {
-   int nRet = SYSINFO_RC_ERROR;
-
-	ObjectArray<Process> procList(128, 128, true);
-   int nCount = ProcRead(&procList, NULL, NULL);
-   if (nCount >= 0)
-   {    
-      nRet = SYSINFO_RC_SUCCESS;
-
-      for(int i = 0; i < procList.size(); i++)
-      {         
-         Process *p = procList.get(i);
-         TCHAR szBuff[128];
-         _sntprintf(szBuff, sizeof(szBuff), _T("%d %hs"), p->pid, p->name);
-         value->add(szBuff);
-      }         
-   }    
-   return nRet;
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
+      return SYSINFO_RC_ERROR;
+
+   for(int i = 0; i < snapshot->size(); i++)
+   {         
+      Process *p = snapshot->get(i);
+      TCHAR szBuff[128];
+      _sntprintf(szBuff, sizeof(szBuff), _T("%d %hs"), p->pid, p->name);
+      value->add(szBuff);
+   }         
+   UnlockProcessSnapshot();
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -527,36 +715,33 @@ LONG H_ProcessTable(const TCHAR *cmd, const TCHAR *arg, Table *value, AbstractCo
    value->addColumn(_T("PAGE_FAULTS"), DCI_DT_UINT64, _T("Page Faults"));
    value->addColumn(_T("CMDLINE"), DCI_DT_STRING, _T("Command Line"));
 
-   int rc = SYSINFO_RC_ERROR;
-
-	ObjectArray<Process> procList(128, 128, true);
-   int nCount = ProcRead(&procList, NULL, NULL);
-   if (nCount >= 0)
-   {    
-      rc = SYSINFO_RC_SUCCESS;
-
-      UINT64 pageSize = getpagesize();
-      UINT64 ticksPerSecond = sysconf(_SC_CLK_TCK);
-      for(int i = 0; i < procList.size(); i++)
-      {         
-         Process *p = procList.get(i);
-         value->addRow();
-         value->set(0, p->pid);
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
+      return SYSINFO_RC_ERROR;
+
+   UINT64 pageSize = getpagesize();
+   UINT64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+   for(int i = 0; i < snapshot->size(); i++)
+   {         
+      Process *p = snapshot->get(i);
+      ObjectArray<FileDescriptor> *fd = p->getHandles();
+      value->addRow();
+      value->set(0, p->pid);
 #ifdef UNICODE
-         value->setPreallocated(1, WideStringFromMBString(p->name));
+      value->setPreallocated(1, WideStringFromMBString(p->name));
 #else
-         value->set(1, p->name);
+      value->set(1, p->name);
 #endif
-         value->set(2, (UINT32)p->threads);
-         value->set(3, (UINT32)((p->fd != NULL) ? p->fd->size() : 0));
-         value->set(4, (UINT64)p->ktime * 1000 / ticksPerSecond);
-         value->set(5, (UINT64)p->utime * 1000 / ticksPerSecond);
-         value->set(6, (UINT64)p->vmsize);
-         value->set(7, (UINT64)p->rss * pageSize);
-         value->set(8, (UINT64)p->minflt + (UINT64)p->majflt);
-      }         
-   }    
-   return rc;
+      value->set(2, (UINT32)p->threads);
+      value->set(3, (UINT32)((fd != NULL) ? fd->size() : 0));
+      value->set(4, (UINT64)p->ktime * 1000 / ticksPerSecond);
+      value->set(5, (UINT64)p->utime * 1000 / ticksPerSecond);
+      value->set(6, (UINT64)p->vmsize);
+      value->set(7, (UINT64)p->rss * pageSize);
+      value->set(8, (UINT64)p->minflt + (UINT64)p->majflt);
+   }         
+   UnlockProcessSnapshot();
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -569,35 +754,32 @@ LONG H_OpenFilesTable(const TCHAR *cmd, const TCHAR *arg, Table *value, Abstract
    value->addColumn(_T("HANDLE"), DCI_DT_UINT, _T("Handle"), true);
    value->addColumn(_T("NAME"), DCI_DT_STRING, _T("Name"));
 
-   int rc = SYSINFO_RC_ERROR;
-
-	ObjectArray<Process> procList(128, 128, true);
-   int nCount = ProcRead(&procList, NULL, NULL);
-   if (nCount >= 0)
-   {    
-      rc = SYSINFO_RC_SUCCESS;
-
-      for(int i = 0; i < procList.size(); i++)
-      {         
-         Process *p = procList.get(i);
-         if (p->fd != NULL)
-         {
-            for(int j = 0; j < p->fd->size(); j++)
-            {
-               FileDescriptor *f = p->fd->get(j);
-               value->addRow();
-               value->set(0, p->pid);
-               value->set(2, f->handle);
+   ObjectArray<Process> *snapshot = LockProcessSnapshot();
+   if (snapshot == NULL)
+      return SYSINFO_RC_ERROR;
+
+   for(int i = 0; i < snapshot->size(); i++)
+   {         
+      Process *p = snapshot->get(i);
+      ObjectArray<FileDescriptor> *fd = p->getHandles();
+      if (fd == NULL)
+         continue;
+
+      for(int j = 0; j < fd->size(); j++)
+      {
+         FileDescriptor *f = fd->get(j);
+         value->addRow();
+         value->set(0, p->pid);
+         value->set(2, f->handle);
 #ifdef UNICODE
-               value->setPreallocated(1, WideStringFromMBString(p->name));
-               value->setPreallocated(3, WideStringFromMBString(f->name));
+         value->setPreallocated(1, WideStringFromMBString(p->name));
+         value->setPreallocated(3, WideStringFromMBString(f->name));
 #else
-               value->set(1, p->name);
-               value->set(3, f->name);
+         value->set(1, p->name);
+         value->set(3, f->name);
 #endif
-            }
-         }
-      }         
-   }    
-   return rc;
+      }
+   }         
+   UnlockProcessSnapshot();
+   return SYSINFO_RC_SUCCESS;
 }
@@ -32,6 +32,16 @@ static CONDITION s_shutdownCondition = INVALID_CONDITION_HANDLE;
  */
 static ObjectArray<LogParser> s_parsers(16, 16, true);
 
+/**
+ * Parsers for regular files (all monitored by single thread)
+ */
+static ObjectArray<LogParser> s_fileParsers(16, 16, false);
+
+/**
+ * File monitoring thread
+ */
+static THREAD s_fileMonitorThread = INVALID_THREAD_HANDLE;
+
 /**
  * Offline (missed during agent's downtime) events processing flag
  */
@@ -42,7 +52,7 @@ static bool s_processOfflineEvents;
  */
 THREAD_RESULT THREAD_CALL ParserThreadFile(void *arg)
 {
-	((LogParser *)arg)->monitorFile(s_shutdownCondition);
+	LogParser::monitorFiles(&s_fileParsers, s_shutdownCondition);
 	return THREAD_OK;
 }
 
@@ -119,12 +129,13 @@ static LONG H_ParserList(const TCHAR *cmd, const TCHAR *arg, StringList *value,
 static void SubagentShutdown()
 {
 	if (s_shutdownCondition != INVALID_CONDITION_HANDLE)
-		ConditionSet(s_shutdownCondition);
+		LogParser::stopFileMonitoring(s_shutdownCondition);
 
 	for(int i = 0; i < s_parsers.size(); i++)
 	{
 		ThreadJoin(s_parsers.get(i)->getThread());
 	}
+	ThreadJoin(s_fileMonitorThread);
 
    CleanupLogParserLibrary();
 }
@@ -287,12 +298,14 @@ static BOOL SubagentInit(Config *config)
 		}
 		else	// regular file
 		{
-			p->setThread(ThreadCreateEx(ParserThreadFile, 0, p));
+			s_fileParsers.add(p);
 		}
 #else
-		p->setThread(ThreadCreateEx(ParserThreadFile, 0, p));
+		s_fileParsers.add(p);
 #endif
 	}
+	if (s_fileParsers.size() > 0)
+		s_fileMonitorThread = ThreadCreateEx(ParserThreadFile, 0, NULL);
 
 	return TRUE;
 }
@@ -164,6 +164,16 @@ static void SetLastError(ORACLE_CONN *pConn)
 	GetErrorFromHandle(&pConn->lastErrorCode, pConn->lastErrorText);
 }
 
+/**
+ * Check if last OCILIB call failed. Needed after OCI_FetchNext() which returns false
+ * both at the end of result set and on error. Warnings are not treated as failures.
+ */
+static bool IsLastCallFailed()
+{
+	OCI_Error *handle = OCI_GetLastError();
+	return (handle != NULL) && (OCI_ErrorGetType(handle) != OCI_ERR_WARNING);
+}
+
 /**
  * Check if last error was cause by lost connection to server
  */
@@ -173,23 +183,59 @@ static DWORD IsConnectionError(ORACLE_CONN *pConn)
 	return (nStatus == true) ? DBERR_OTHER_ERROR : DBERR_CONNECTION_LOST;
 }
 
+/**
+ * Destroy result of buffered query
+ */
 static void DestroyQueryResult(ORACLE_RESULT *pResult)
 {
-	int i, nCount;
-
-	nCount = pResult->nCols * pResult->nRows;
-
-	for(i = 0; i < nCount; i++)
-		free(pResult->pData[i]);
+	ORACLE_RESULT_BLOCK *block = pResult->blocks;
+	while(block != NULL)
+	{
+		ORACLE_RESULT_BLOCK *next = block->next;
+		free(block);
+		block = next;
+	}
 	free(pResult->pData);
 
-	for(i = 0; i < pResult->nCols; i++)
-		free(pResult->columnNames[i]);
-	free(pResult->columnNames);
+	if(pResult->columnNames != NULL)
+	{
+		for(int i = 0; i < pResult->nCols; i++)
+			free(pResult->columnNames[i]);
+		free(pResult->columnNames);
+	}
 
 	free(pResult);
 }
 
+/**
+ * Allocate space for string of given length (without terminating zero) in result's data blocks.
+ * Strings longer than block size get dedicated block so that current block can still be filled.
+ */
+static WCHAR *AllocResultString(ORACLE_RESULT *pResult, size_t len)
+{
+	ORACLE_RESULT_BLOCK *block = pResult->blocks;
+	if((block == NULL) || (block->size - block->used < len + 1))
+	{
+		size_t size = max(len + 1, (size_t)ORACLE_RESULT_BLOCK_SIZE);
+		block = (ORACLE_RESULT_BLOCK *)malloc(sizeof(ORACLE_RESULT_BLOCK) + (size - 1) * sizeof(WCHAR));
+		block->size = size;
+		block->used = 0;
+		if((size > ORACLE_RESULT_BLOCK_SIZE) && (pResult->blocks != NULL))
+		{
+			block->next = pResult->blocks->next;
+			pResult->blocks->next = block;
+		}
+		else
+		{
+			block->next = pResult->blocks;
+			pResult->blocks = block;
+		}
+	}
+	WCHAR *s = &block->data[block->used];
+	block->used += len + 1;
+	return s;
+}
+
 /**
  * Connect to database
  */
@@ -228,8 +274,14 @@ extern "C" DBDRV_CONNECTION EXPORT DrvConnect(const char *host, const char *logi
 		    pConn->lastErrorCode = 0;
 		    pConn->lastErrorText[0] = 0;
 		    pConn->prefetchLimit = 0;
+		    pConn->queryCache = new StringMap();
+		    pConn->queryCache->setIgnoreCase(false);
 
-		    OCI_SetStatementCacheSize(pConn->handleConnection, pConn->prefetchLimit);
+		    // Statement cache, fetch array size and prefetch size are set once for connection and
+		    // used as defaults by all statements created on it
+		    OCI_SetStatementCacheSize(pConn->handleConnection, ORACLE_STATEMENT_CACHE_SIZE);
+		    OCI_SetDefaultFetchSize(pConn->handleConnection, ORACLE_FETCH_ARRAY_SIZE);
+		    OCI_SetDefaultPrefetchSize(pConn->handleConnection, pConn->prefetchLimit);
 
  		    DrvQueryInternal(pConn, _T("ALTER SESSION SET NLS_LANGUAGE='AMERICAN' NLS_NUMERIC_CHARACTERS='.,'"), NULL);
  		    nxlog_debug(5, _T("ORACLE: connected to %i.%i.%i"), OCI_GetServerMajorVersion(OCIConn), OCI_GetServerMinorVersion(OCIConn), OCI_GetServerRevisionVersion(OCIConn));
@@ -258,6 +310,7 @@ extern "C" void EXPORT DrvDisconnect(ORACLE_CONN *pConn)
 
 	OCI_ConnectionFree(pConn->handleConnection);
 	MutexDestroy(pConn->mutexQueryLock);
+	delete pConn->queryCache;
 	free(pConn);
 }
 
@@ -265,34 +318,30 @@ extern "C" void EXPORT DrvDisconnect(ORACLE_CONN *pConn)
 /**
  * Set prefetch limit
  */
-extern "C" void EXPORT DrvSetPrefetchLimit(ORACLE_CONN *pConn, int limit)
+extern "C" bool EXPORT DrvSetPrefetchLimit(ORACLE_CONN *pConn, int limit)
 {
-	if(pConn != NULL)
-		pConn->prefetchLimit = limit;
+	if(pConn == NULL)
+		return false;
+
+	MutexLock(pConn->mutexQueryLock);
+	pConn->prefetchLimit = limit;
+	bool success = OCI_SetDefaultPrefetchSize(pConn->handleConnection, limit) ? true : false;
+	MutexUnlock(pConn->mutexQueryLock);
+	return success;
 }
 
-static UCS2CHAR *ConvertQuery(WCHAR *query)
+/**
+ * Convert query from NetXMS portable format to native Oracle format (replace ? with :N).
+ * OCILIB is used in wide character mode, so conversion is done directly on WCHAR string.
+ */
+static WCHAR *ConvertQuery(const WCHAR *query, int count)
 {
-#if UNICODE_UCS4
-	UCS2CHAR *srcQuery = UCS2StringFromUCS4String(query);
-#else
-	UCS2CHAR *srcQuery = query;
-#endif
-	int count = NumCharsW(query, L'?');
-	if (count == 0)
-	{
-#if UNICODE_UCS4
-		return srcQuery;
-#else
-		return wcsdup(query);
-#endif
-	}
-
-	UCS2CHAR *dstQuery = (UCS2CHAR *)malloc((ucs2_strlen(srcQuery) + count * 3 + 1) * sizeof(UCS2CHAR));
+	WCHAR *dstQuery = (WCHAR *)malloc((wcslen(query) + count * 3 + 1) * sizeof(WCHAR));
 	bool inString = false;
 	int pos = 1;
-	UCS2CHAR *src, *dst;
-	for(src = srcQuery, dst = dstQuery; *src != 0; src++)
+	const WCHAR *src;
+	WCHAR *dst;
+	for(src = query, dst = dstQuery; *src != 0; src++)
 	{
 		switch(*src)
 		{
@@ -336,12 +385,31 @@ static UCS2CHAR *ConvertQuery(WCHAR *query)
 		}
 	}
 	*dst = 0;
-#if UNICODE_UCS4
-	free(srcQuery);
-#endif
 	return dstQuery;
 }
 
+/**
+ * Get query in native Oracle format. Converted queries are cached per connection.
+ * Returned string is valid until next call. Must be called with connection lock held.
+ */
+static const WCHAR *GetNativeQuery(ORACLE_CONN *pConn, const WCHAR *query)
+{
+	int count = NumCharsW(query, L'?');
+	if (count == 0)
+		return query;
+
+	const WCHAR *nativeQuery = pConn->queryCache->get(query);
+	if (nativeQuery == NULL)
+	{
+		if (pConn->queryCache->size() >= MAX_QUERY_CACHE_SIZE)
+			pConn->queryCache->clear();
+		WCHAR *converted = ConvertQuery(query, count);
+		pConn->queryCache->setPreallocated(wcsdup(query), converted);
+		nativeQuery = converted;
+	}
+	return nativeQuery;
+}
+
 /**
  * Prepare statement
  */
@@ -350,12 +418,9 @@ extern "C" ORACLE_STATEMENT EXPORT *DrvPrepare(ORACLE_CONN *pConn, WCHAR *pwszQu
 	ORACLE_STATEMENT *stmt = NULL;
 	OCI_Statement *handleStmt = OCI_StatementCreate(pConn->handleConnection);
 
-	UCS2CHAR *ucs2Query = ConvertQuery(pwszQuery);
-	WCHAR *wcs2Query = UCS4StringFromUCS2String(ucs2Query);
-
 	MutexLock(pConn->mutexQueryLock);
 	OCI_AllowRebinding(handleStmt, true);
-	if(OCI_Prepare(handleStmt, (otext*)wcs2Query) == true)
+	if(OCI_Prepare(handleStmt, (otext*)GetNativeQuery(pConn, pwszQuery)) == true)
 	{	
 		stmt = (ORACLE_STATEMENT*)malloc(sizeof(ORACLE_STATEMENT));
 		stmt->connection = pConn;
@@ -373,9 +438,6 @@ extern "C" ORACLE_STATEMENT EXPORT *DrvPrepare(ORACLE_CONN *pConn, WCHAR *pwszQu
 		SetLastError(pConn);
 		*pdwError = IsConnectionError(pConn);
 	}
-	free(wcs2Query);
-	free(ucs2Query);
-
 	if(errorText != NULL)
 	{
 		wcsncpy(errorText, pConn->lastErrorText, DBDRV_MAX_ERROR_TEXT);
@@ -444,13 +506,12 @@ static void BindNormal(ORACLE_STATEMENT *stmt, int pos, int sqlType, int cType,
 		case DB_CTYPE_STRING:
 		{
 #if UNICODE_UCS4
-		sqlBuffer = wcsdup((WCHAR *)buffer);
-		stmt->buffers->set(pos - 1, sqlBuffer);
-
-		if(allocType == DB_BIND_DYNAMIC)
-			free(buffer);
+		// OCILIB may convert bound strings in place on UCS-4 systems, so only dynamic buffers can be used directly
+		bool copy = (allocType != DB_BIND_DYNAMIC);
 #else
-		if(allocType == DB_BIND_TRANSIENT)
+		bool copy = (allocType == DB_BIND_TRANSIENT);
+#endif
+		if(copy)
 		{
 			sqlBuffer = wcsdup((WCHAR *)buffer);
 			stmt->buffers->set(pos - 1, sqlBuffer);
@@ -461,7 +522,6 @@ static void BindNormal(ORACLE_STATEMENT *stmt, int pos, int sqlType, int cType,
 			if(allocType == DB_BIND_DYNAMIC)
 				stmt->buffers->set(pos - 1, sqlBuffer);
 		}
-#endif
 		if(sqlType == DB_SQLTYPE_CLOB)
 		{	
 			OCI_Lob *lob = OCI_LobCreate(stmt->connection->handleConnection, OCI_CLOB);
@@ -474,11 +534,7 @@ static void BindNormal(ORACLE_STATEMENT *stmt, int pos, int sqlType, int cType,
 		}
 		break;
 		case DB_CTYPE_UTF8_STRING:
-#if UNICODE_UCS4
-			sqlBuffer = UCS2StringFromUTF8String((char *)buffer);
-#else
 			sqlBuffer = WideStringFromUTF8String((char *)buffer);
-#endif
 			stmt->buffers->set(pos - 1, sqlBuffer);
 
 			if(allocType == DB_BIND_DYNAMIC)
@@ -712,11 +768,7 @@ static void BindBatch(ORACLE_STATEMENT *stmt, int pos, int sqlType, int cType, v
          	}
 			break;
 		case DB_CTYPE_UTF8_STRING:
-#if UNICODE_UCS4
-         sqlBuffer = UCS2StringFromUTF8String((char *)buffer);
-#else
          sqlBuffer = WideStringFromUTF8String((char *)buffer);
-#endif
          if (allocType == DB_BIND_DYNAMIC)
             free(buffer);
          bind->set(sqlBuffer);
@@ -898,12 +950,6 @@ static DWORD DrvQueryInternal(ORACLE_CONN *pConn, const WCHAR *pwszQuery, WCHAR
 {
 	DWORD dwResult = -1;
 
-#if UNICODE_UCS4
-	UCS2CHAR *ucs2Query = UCS2StringFromUCS4String(pwszQuery);
-#else
-	const UCS2CHAR *ucs2Query = pwszQuery;
-#endif
-
 	MutexLock(pConn->mutexQueryLock);
 	OCI_Statement *handleStmt = OCI_StatementCreate(pConn->handleConnection);
 	if(OCI_ExecuteStmt(handleStmt, pwszQuery) == true)
@@ -925,10 +971,6 @@ static DWORD DrvQueryInternal(ORACLE_CONN *pConn, const WCHAR *pwszQuery, WCHAR
 	OCI_Commit(pConn->handleConnection);
 	OCI_StatementFree(handleStmt);
 	MutexUnlock(pConn->mutexQueryLock);
-
-#if UNICODE_UCS4
-	free(ucs2Query);
-#endif
 	return dwResult;
 }
 
@@ -941,159 +983,111 @@ extern "C" DWORD EXPORT DrvQuery(ORACLE_CONN *conn, const WCHAR *query, WCHAR *e
 }
 
 /**
- * Process SELECT results
+ * Process SELECT results. Rows are fetched from server in arrays (fetch size is set as default
+ * for connection) into OCILIB column buffers allocated once per statement; field values are
+ * copied from these buffers directly into result's data blocks.
  */
 static ORACLE_RESULT *ProcessQueryResults(ORACLE_CONN *pConn, OCI_Statement *handleStmt, DWORD *pdwError)
 {
-	bool nStatus;
-	unsigned int nWidth;
-	ORACLE_RESULT *pResult = (ORACLE_RESULT *)malloc(sizeof(ORACLE_RESULT));
-	OCI_Resultset *resultSet;
-	resultSet = OCI_GetResultset(handleStmt);
+	OCI_Resultset *resultSet = OCI_GetResultset(handleStmt);
+	if(resultSet == NULL)
+	{
+		SetLastError(pConn);
+		*pdwError = IsConnectionError(pConn);
+		return NULL;
+	}
+
+	ORACLE_RESULT *pResult = (ORACLE_RESULT *)calloc(1, sizeof(ORACLE_RESULT));
+	pResult->nCols = OCI_GetColumnCount(resultSet);
+	*pdwError = DBERR_SUCCESS;
 
-	if(resultSet != NULL)
+	bool *isLob = NULL;
+	if(pResult->nCols > 0)
 	{
-		pResult->nCols = OCI_GetColumnCount(resultSet);
-		pResult->nRows = 0;
-		pResult->pData = NULL;
-		pResult->columnNames = NULL;
-		
-		if(pResult->nCols > 0)
+		pResult->columnNames = (char **)calloc(pResult->nCols, sizeof(char *));
+		isLob = (bool *)malloc(pResult->nCols * sizeof(bool));
+		for(int i = 0; i < pResult->nCols; i++)
 		{
-			// Get table column names
-			pResult->columnNames = (char **)calloc(pResult->nCols, sizeof(char *));
-			//pBuffers = (ORACLE_FETCH_BUFFER *)calloc(pResult->nCols, sizeof(ORACLE_FETCH_BUFFER));
-
-			for(int i = 0; i < pResult->nCols; i++)
+			OCI_Column *col = OCI_GetColumn(resultSet, i + 1);
+			if(col == NULL)
 			{
-				OCI_Column *col;
-				if (col = OCI_GetColumn(resultSet, i + 1))
-				{
-					nStatus = OCI_SUCCESS;
-					// Columns name
-					pResult->columnNames[i] = MBStringFromWideString(OCI_ColumnGetName(col));
-				}
-				else
-				{
-					nStatus = OCI_NO_DATA;
-					SetLastError(pConn);
-					*pdwError = IsConnectionError(pConn);
-				}
+				SetLastError(pConn);
+				*pdwError = IsConnectionError(pConn);
+				break;
 			}
+			pResult->columnNames[i] = MBStringFromWideString(OCI_ColumnGetName(col));
+			isLob[i] = (OCI_ColumnGetType(col) == OCI_CDT_LOB);
+		}
+	}
+
+	int nPos = 0;
+	while((*pdwError == DBERR_SUCCESS) && (pResult->nCols > 0) && OCI_FetchNext(resultSet))
+	{
+		if(pResult->nRows == pResult->allocatedRows)
+		{
+			pResult->allocatedRows = (pResult->allocatedRows > 0) ? pResult->allocatedRows * 2 : ORACLE_FETCH_ARRAY_SIZE;
+			pResult->pData = (const WCHAR **)realloc(pResult->pData, sizeof(WCHAR *) * pResult->nCols * pResult->allocatedRows);
 		}
+		pResult->nRows++;
 
-		// Fetch data
-		if(nStatus == OCI_SUCCESS)
+		for(int i = 0; i < pResult->nCols; i++, nPos++)
 		{
-			int nPos = 0;
+			pResult->pData[nPos] = L"";
+			if(OCI_IsNull(resultSet, i + 1))
+				continue;
 
-			while(1)
+			if(isLob[i])
 			{
-				if(OCI_FetchNext(resultSet) == false)
+				OCI_Lob *lob = OCI_GetLob(resultSet, i + 1);
+				if(lob == NULL)
 				{
-					*pdwError = DBERR_SUCCESS;
-					break;
+					SetLastError(pConn);
+					*pdwError = IsConnectionError(pConn);
+					continue;
 				}
 
-				// New row
-				pResult->nRows++;
-				pResult->pData = (WCHAR **)realloc(pResult->pData, sizeof(WCHAR *) * pResult->nCols * pResult->nRows);
-
-				for(int i = 0; i < pResult->nCols; i++)
+				unsigned int length = (unsigned int)OCI_LobGetLength(lob);
+				if(length > 0)
 				{
-					OCI_Column *col = OCI_GetColumn(resultSet, i + 1);
-
-					if(col == NULL)
-					{
-						nStatus = OCI_NO_DATA;
-						SetLastError(pConn);
-						*pdwError = IsConnectionError(pConn);
-						continue;
-					}
-
-					unsigned int type = OCI_ColumnGetType(col);
-
-					if(OCI_IsNull(resultSet, i + 1) == true)
-					{
-						pResult->pData[nPos] = (WCHAR *)nx_memdup("\0\0\0", sizeof(WCHAR));
-					}
-					else if(type == OCI_CDT_LOB)
-					{
-						OCI_Lob *lob = OCI_GetLob(resultSet, i + 1);
-
-						if(lob != NULL)
-						{
-							int length = OCI_LobGetLength(lob);
-
-							if(length > 0)
-							{
-								int max_chars = length, max_bytes = 0;
-								WCHAR *result = (WCHAR *)malloc((length + 1) * sizeof(WCHAR));
-								pResult->pData[nPos] = (WCHAR *)malloc((length + 1) * sizeof(WCHAR));
-
-								if(OCI_LobRead2(lob, (WCHAR*)result, (unsigned int*)&max_chars, (unsigned int*)&max_bytes))
-								{
-									wcsncpy(pResult->pData[nPos], result, length);
-									pResult->pData[nPos][length] = 0;
-								}
-								free(result);							
-							}
-							else
-							{
-								pResult->pData[nPos] = (WCHAR *)nx_memdup("\0\0\0", sizeof(WCHAR));
-							}
-						}
-						else
-						{
-							nStatus = OCI_NO_DATA;
-							SetLastError(pConn);
-							*pdwError = IsConnectionError(pConn);
-							continue;
-						}
-						// ----
-					}
+					unsigned int chars = length, bytes = 0;
+					WCHAR *value = AllocResultString(pResult, length);
+					if(OCI_LobRead2(lob, value, &chars, &bytes))
+						value[min(chars, length)] = 0;
 					else
-					{
-						UCS2CHAR *result = UCS2StringFromUCS4String(OCI_GetString(resultSet, i + 1));
-						int length = ucs2_strlen(result);
-						bool emptyFlag = false;
-						
-						// If there is only end of string symbols, the result should be empty
-						if(length == 2 && _tcsicmp(OCI_GetString(resultSet, i + 1), _T("\r\n")) == 0)
-							pResult->pData[nPos] = (WCHAR *)nx_memdup("\0\0\0", sizeof(WCHAR));
-						else
-						{
-							pResult->pData[nPos] = (WCHAR *)malloc((length + 1) * sizeof(WCHAR));
-#if UNICODE_UCS4
-							ucs2_to_ucs4(result, length, pResult->pData[nPos], length + 1);
-#else
-							memcpy(pResult->pData[nPos], result, length);
-#endif
-							pResult->pData[nPos][length] = 0;
-						}
-						
-						if(NULL != result)
-						{
-							free(result);
-						}
-					}
-					nPos++;
+						value[0] = 0;
+					pResult->pData[nPos] = value;
 				}
 			}
-		}
+			else
+			{
+				// OCILIB returns strings in wide character encoding already, so no conversion is needed
+				const WCHAR *value = (const WCHAR *)OCI_GetString(resultSet, i + 1);
 
-		if(*pdwError != DBERR_SUCCESS)
-		{
-			DestroyQueryResult(pResult);
-			pResult = NULL;
+				// If there is only end of string symbols, the result should be empty
+				if((value != NULL) && (*value != 0) && wcscmp(value, L"\r\n"))
+				{
+					size_t len = wcslen(value);
+					WCHAR *copy = AllocResultString(pResult, len);
+					memcpy(copy, value, (len + 1) * sizeof(WCHAR));
+					pResult->pData[nPos] = copy;
+				}
+			}
 		}
 	}
-	else
+	free(isLob);
+
+	// Fetch loop ended on OCI_FetchNext() - check if it was end of data or error
+	if((*pdwError == DBERR_SUCCESS) && (pResult->nCols > 0) && IsLastCallFailed())
 	{
 		SetLastError(pConn);
 		*pdwError = IsConnectionError(pConn);
 	}
 
+	if(*pdwError != DBERR_SUCCESS)
+	{
+		DestroyQueryResult(pResult);
+		pResult = NULL;
+	}
 	return pResult;
 }
 
@@ -1104,22 +1098,11 @@ extern "C" DBDRV_RESULT EXPORT DrvSelect(ORACLE_CONN *pConn, WCHAR *pwszQuery, D
 {
 	ORACLE_RESULT *pResult = NULL;
 
-	OCI_SetStatementCacheSize(pConn->handleConnection, pConn->prefetchLimit);
-	OCI_Statement *handleStmt = OCI_StatementCreate(pConn->handleConnection);
-
-#if UNICODE_UCS4
-	char *ucs2Query = MBStringFromWideString(pwszQuery);
-#else
-	const UCS2CHAR *ucs2Query = pwszQuery;
-#endif
-	OCI_SetPrefetchMemory(handleStmt, pConn->prefetchLimit);
-	OCI_SetPrefetchSize(handleStmt, pConn->prefetchLimit);
-
 	MutexLock(pConn->mutexQueryLock);
+	OCI_Statement *handleStmt = OCI_StatementCreate(pConn->handleConnection);
 	if(OCI_ExecuteStmt(handleStmt, pwszQuery) == true)
 	{
 		pResult = ProcessQueryResults(pConn, handleStmt, pdwError);
-		*pdwError = DBERR_SUCCESS;
 	}
 	else
 	{
@@ -1135,10 +1118,6 @@ extern "C" DBDRV_RESULT EXPORT DrvSelect(ORACLE_CONN *pConn, WCHAR *pwszQuery, D
 	}
 	MutexUnlock(pConn->mutexQueryLock);
 
-#if UNICODE_UCS4
-	free(ucs2Query);
-#endif
-
 	return pResult;
 }
 
@@ -1149,15 +1128,10 @@ extern "C" DBDRV_RESULT EXPORT DrvSelectPrepared(ORACLE_CONN *pConn, ORACLE_STAT
 {
 	ORACLE_RESULT *pResult = NULL;
 
-	OCI_SetPrefetchMemory(stmt->handleStmt, pConn->prefetchLimit);
-	OCI_SetPrefetchSize(stmt->handleStmt, pConn->prefetchLimit);
-	OCI_SetStatementCacheSize(pConn->handleConnection, pConn->prefetchLimit);
-
 	MutexLock(pConn->mutexQueryLock);
 	if(OCI_Execute(stmt->handleStmt) == true)
 	{
 		pResult = ProcessQueryResults(pConn, stmt->handleStmt, pdwError);
-		*pdwError = DBERR_SUCCESS;
 	}
 	else
 	{
@@ -1254,37 +1228,26 @@ extern "C" void EXPORT DrvFreeResult(ORACLE_RESULT *pResult)
  */
 static void DestroyUnbufferedQueryResult(ORACLE_UNBUFFERED_RESULT *result, bool freeStatement)
 {
-	int i;
-
 	if(freeStatement)
 		OCI_StatementFree(result->handleStmt);
 
-	free(result->pBuffers);
-
-	for(i = 0; i < result->nCols; i++)
+	for(int i = 0; i < result->nCols; i++)
+	{
+		free(result->pBuffers[i].lobBuffer);
 		free(result->columnNames[i]);
+	}
+	free(result->pBuffers);
 	free(result->columnNames);
 	free(result);
 }
 
-
 /**
- * Free Fetch allocated memory result
+ * Free memory allocated for current row of unbuffered result. Field values are either
+ * located in OCILIB fetch buffers or in per-column LOB buffers reused for each row,
+ * so there is nothing to free here.
  */
-
 extern "C" void EXPORT DrvFetchFreeResult(ORACLE_UNBUFFERED_RESULT *result)
 {
-	if(result == NULL)
-		return;
-
-	for(int i = 0; i < result->nCols; i++)
-	{
-		safe_free(result->pBuffers[i].pData);
-		if (result->pBuffers[i].lobLocator != NULL) // this maybe not needed anymore
-		{
-			free(result->pBuffers[i].lobLocator);
-		}
-	}
 }
 
 /**
@@ -1292,42 +1255,30 @@ extern "C" void EXPORT DrvFetchFreeResult(ORACLE_UNBUFFERED_RESULT *result)
  */
 static ORACLE_UNBUFFERED_RESULT *ProcessUnbufferedQueryResults(ORACLE_CONN *pConn, OCI_Statement *handleStmt, DWORD *pdwError)
 {
-	// #FIX - rework the code similar to ProcessQueryResults function.
-	ORACLE_UNBUFFERED_RESULT *result = (ORACLE_UNBUFFERED_RESULT *)malloc(sizeof(ORACLE_UNBUFFERED_RESULT));
-	result->handleStmt = handleStmt;
-	result->connection = pConn;
-
-	OCI_Resultset *resultSet;
-	resultSet = OCI_GetResultset(handleStmt);
-	result->nCols = OCI_GetColumnCount(resultSet);
-
 	*pdwError = DBERR_SUCCESS;
 
-	if(resultSet != NULL)
-	{
-		if(result->nCols > 0)
-		{
-			result->columnNames = (char **)calloc(result->nCols, sizeof(char *));
-			result->pBuffers = (ORACLE_FETCH_BUFFER *)calloc(result->nCols, sizeof(ORACLE_FETCH_BUFFER));
+	OCI_Resultset *resultSet = OCI_GetResultset(handleStmt);
+	if(resultSet == NULL)
+		return NULL;
 
-			for(int i = 0; i < result->nCols; i++)
-			{
-				OCI_Column *col = OCI_GetColumn(resultSet, i + 1);
-				result->columnNames[i] = MBStringFromWideString(OCI_ColumnGetName(col));
-			}
-		}
-		else
-		{
-			free(result);
-			result = NULL;
-		}
-	}
-	else
+	int nCols = OCI_GetColumnCount(resultSet);
+	if(nCols <= 0)
+		return NULL;
+
+	ORACLE_UNBUFFERED_RESULT *result = (ORACLE_UNBUFFERED_RESULT *)malloc(sizeof(ORACLE_UNBUFFERED_RESULT));
+	result->handleStmt = handleStmt;
+	result->connection = pConn;
+	result->nCols = nCols;
+	result->columnNames = (char **)calloc(nCols, sizeof(char *));
+	result->pBuffers = (ORACLE_FETCH_BUFFER *)calloc(nCols, sizeof(ORACLE_FETCH_BUFFER));
+	for(int i = 0; i < nCols; i++)
 	{
-		free(result);
-		result = NULL;
+		OCI_Column *col = OCI_GetColumn(resultSet, i + 1);
+		result->columnNames[i] = MBStringFromWideString(OCI_ColumnGetName(col));
+		result->pBuffers[i].isLob = (OCI_ColumnGetType(col) == OCI_CDT_LOB);
+		result->pBuffers[i].isNull = true;
+		result->pBuffers[i].pData = L"";
 	}
-
 	return result;
 }
 
@@ -1340,7 +1291,6 @@ extern "C" DBDRV_UNBUFFERED_RESULT EXPORT DrvSelectUnbuffered(ORACLE_CONN *pConn
 
 	MutexLock(pConn->mutexQueryLock);
 
-	OCI_SetStatementCacheSize(pConn->handleConnection, 0);
 	OCI_Statement *handleStmt = OCI_StatementCreate(pConn->handleConnection);
 
 	if (OCI_SFM_SCROLLABLE == mode)
@@ -1360,9 +1310,6 @@ extern "C" DBDRV_UNBUFFERED_RESULT EXPORT DrvSelectUnbuffered(ORACLE_CONN *pConn
 
 	if(OCI_Prepare(handleStmt, (otext *)pwszQuery) == true)
 	{	
-		OCI_SetPrefetchMemory(handleStmt, 0);
-		OCI_SetPrefetchSize(handleStmt, 0);
-
 		if(OCI_Execute(handleStmt) == true)
 		{
 			result = ProcessUnbufferedQueryResults(pConn, handleStmt, pdwError);
@@ -1401,10 +1348,6 @@ extern "C" DBDRV_UNBUFFERED_RESULT EXPORT DrvSelectPreparedUnbuffered(ORACLE_CON
 
 	MutexLock(pConn->mutexQueryLock);
 
-	OCI_SetPrefetchMemory(stmt->handleStmt, 0);
-	OCI_SetPrefetchSize(stmt->handleStmt, 0);
-	OCI_SetStatementCacheSize(pConn->handleConnection, 0);
-
 	if(OCI_Execute(stmt->handleStmt) == true)
 	{
 		result = ProcessUnbufferedQueryResults(pConn, stmt->handleStmt, pdwError);
@@ -1466,104 +1409,83 @@ extern "C" bool EXPORT DrvFetchSeek(ORACLE_UNBUFFERED_RESULT *result, UINT32 mod
 }
 
 /**
- * Fetch next result line from unbuffered SELECT results
+ * Fetch next result line from unbuffered SELECT results. Rows are fetched from server in arrays,
+ * and field values are not copied - they remain in OCILIB fetch buffers until next call.
  */
 extern "C" bool EXPORT DrvFetch(ORACLE_UNBUFFERED_RESULT *result)
 {
-	bool success;
-
 	if(result == NULL)
 		return false;
 
 	OCI_Resultset *resultSet = OCI_GetResultset(result->handleStmt);
-
-	if(OCI_FetchNext(resultSet) == true)
+	if(!OCI_FetchNext(resultSet))
 	{
-		success = true;
+		// Fetch API cannot return error code, so error is kept as connection's last error and logged
+		if(IsLastCallFailed())
+		{
+			SetLastError(result->connection);
+			nxlog_debug(4, _T("OCILIB: fetch failed (%s)"), result->connection->lastErrorText);
+		}
+		return false;
+	}
 
-		for(int i = 0; i < result->nCols; i++)
+	bool success = true;
+	for(int i = 0; i < result->nCols; i++)
+	{
+		ORACLE_FETCH_BUFFER *buffer = &result->pBuffers[i];
+		buffer->pData = L"";
+		buffer->nLength = 0;
+		buffer->isNull = OCI_IsNull(resultSet, i + 1) ? true : false;
+		if(buffer->isNull)
+			continue;
+
+		if(!buffer->isLob)
 		{
-			OCI_Column *col = OCI_GetColumn(resultSet, i + 1);
+			const WCHAR *value = (const WCHAR *)OCI_GetString(resultSet, i + 1);
 
-			if(OCI_IsNull(resultSet, i + 1) == true)
-			{
-				result->pBuffers[i].pData = (WCHAR *)nx_memdup("\0\0\0", sizeof(WCHAR));
-				result->pBuffers[i].isNull = 1;
-				result->pBuffers[i].nLength = 0;
-			}
-			else if(OCI_ColumnGetType(col) != OCI_CDT_LOB)
+			// If there is only end of string symbols, the result should be empty
+			if((value != NULL) && wcscmp(value, L"\r\n"))
 			{
-				UCS2CHAR *ucs2string = UCS2StringFromUCS4String(OCI_GetString(resultSet, i + 1));
-				int len = ucs2_strlen(ucs2string);
-				
-				// If there is only end of string symbols, the result should be empty
-				if(len == 2 && _tcsicmp(OCI_GetString(resultSet, i + 1), _T("\r\n")) == 0)
-					result->pBuffers[i].pData = (WCHAR *)nx_memdup("\0\0\0", sizeof(WCHAR));
-				else
-				{	
-					result->pBuffers[i].pData = (WCHAR*)malloc(sizeof(WCHAR) * (len + 1));
-#if UNICODE_UCS4
-					ucs2_to_ucs4(ucs2string, len, result->pBuffers[i].pData, len + 1);
-#else
-					memcpy(result->pBuffers[i].pData, ucs2string, len);
-#endif
-					result->pBuffers[i].pData[len] = 0;
-					result->pBuffers[i].isNull = 0;
-					result->pBuffers[i].nLength = len * sizeof(WCHAR);
-				}
-				
-				if (NULL != ucs2string)
-				{
-					free(ucs2string);
-				}	
+				buffer->pData = value;
+				buffer->nLength = (UINT32)wcslen(value);
 			}
-			else
-			{
-				OCI_Lob *lob = OCI_GetLob(resultSet, i + 1);
-				if(lob != NULL)
-				{
-					ub2 nWidth = OCI_LobGetLength(lob);
+			continue;
+		}
 
-					if(nWidth > 0)
-					{
-						unsigned int max_len = nWidth, max_byte = 0;
-						result->pBuffers[i].pData = (WCHAR *)malloc((nWidth + 1) * sizeof(WCHAR));
-						WCHAR *pLob = (WCHAR*)malloc((nWidth + 1) * sizeof(WCHAR));
+		OCI_Lob *lob = OCI_GetLob(resultSet, i + 1);
+		if(lob == NULL)
+		{
+			SetLastError(result->connection);
+			success = false;
+			continue;
+		}
 
-						if(OCI_LobRead2(lob, (WCHAR*)pLob, (unsigned int*)&max_len, (unsigned int*)&max_byte))
-						{
-							wcsncpy(result->pBuffers[i].pData, pLob, nWidth);
-							result->pBuffers[i].pData[nWidth] = 0;
-							result->pBuffers[i].isNull = 0;
-							result->pBuffers[i].nLength = max_len * sizeof(WCHAR);
-						}
-						else
-						{
-							SetLastError(result->connection);
-							success = false;
-						}
+		unsigned int length = (unsigned int)OCI_LobGetLength(lob);
+		if(length == 0)
+		{
+			buffer->isNull = true;
+			continue;
+		}
 
-						free(pLob);
-					}
-					else
-					{
-						result->pBuffers[i].pData = (WCHAR *)nx_memdup("\0\0\0", sizeof(WCHAR));
-						result->pBuffers[i].isNull = 1;
-						result->pBuffers[i].nLength = 0;
-					}
-				}
-				else
-				{
-					SetLastError(result->connection);
-					success = false;
-				}
-			}
+		if(length + 1 > buffer->lobBufferSize)
+		{
+			buffer->lobBufferSize = length + 1;
+			buffer->lobBuffer = (WCHAR *)realloc(buffer->lobBuffer, buffer->lobBufferSize * sizeof(WCHAR));
+		}
+
+		unsigned int chars = length, bytes = 0;
+		if(OCI_LobRead2(lob, buffer->lobBuffer, &chars, &bytes))
+		{
+			chars = min(chars, length);
+			buffer->lobBuffer[chars] = 0;
+			buffer->pData = buffer->lobBuffer;
+			buffer->nLength = chars;
+		}
+		else
+		{
+			SetLastError(result->connection);
+			success = false;
 		}
-	}
-	else
-	{
-		SetLastError(result->connection);
-		success = false;
 	}
 	return success;
 }
@@ -1582,7 +1504,7 @@ extern "C" LONG EXPORT DrvGetFieldLengthUnbuffered(ORACLE_UNBUFFERED_RESULT *res
 	if(result->pBuffers[nColumn].isNull)
 		return 0;
 
-	return (LONG)(result->pBuffers[nColumn].nLength / sizeof(WCHAR));
+	return (LONG)result->pBuffers[nColumn].nLength;
 }
 
 /**
@@ -1590,8 +1512,6 @@ extern "C" LONG EXPORT DrvGetFieldLengthUnbuffered(ORACLE_UNBUFFERED_RESULT *res
  */
 extern "C" WCHAR EXPORT *DrvGetFieldUnbuffered(ORACLE_UNBUFFERED_RESULT *result, int nColumn, WCHAR *pBuffer, int nBufSize)
 {
-	int nLen;
-
 	if(result == NULL)
 		return NULL;
 
@@ -1602,18 +1522,10 @@ extern "C" WCHAR EXPORT *DrvGetFieldUnbuffered(ORACLE_UNBUFFERED_RESULT *result,
 	{
 		*pBuffer = 0;
 	}
-	else if(result->pBuffers[nColumn].lobLocator != NULL)
-	{
-		ub4 length = 0;
-	}
 	else
 	{
-		nLen = min(nBufSize - 1, ((int)(result->pBuffers[nColumn].nLength / sizeof(WCHAR))));
-#if _WIN32
-		wcsncpy_s(pBuffer, nBufSize, result->pBuffers[nColumn]->pData, _TRUNCATE);
-#else
+		int nLen = min(nBufSize - 1, (int)result->pBuffers[nColumn].nLength);
 		memcpy(pBuffer, result->pBuffers[nColumn].pData, nLen * sizeof(WCHAR));
-#endif
 		pBuffer[nLen] = 0;
 	}
 
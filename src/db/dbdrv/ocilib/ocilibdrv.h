@@ -45,15 +45,36 @@
 #include <ocilib.h>
 
 /**
- * Fetch buffer
+ * Maximum number of converted queries cached per connection
+ */
+#define MAX_QUERY_CACHE_SIZE  256
+
+/**
+ * Number of rows fetched from server in single round trip
+ */
+#define ORACLE_FETCH_ARRAY_SIZE  256
+
+/**
+ * Size (in characters) of single data block in buffered result
+ */
+#define ORACLE_RESULT_BLOCK_SIZE 65536
+
+/**
+ * Size of OCI statement cache for connection
+ */
+#define ORACLE_STATEMENT_CACHE_SIZE 32
+
+/**
+ * Fetch buffer for single column of unbuffered result
  */
 struct ORACLE_FETCH_BUFFER
 {
-	WCHAR *pData;
-   OCILobLocator *lobLocator;
-	ub2 nLength;
-	ub2 nCode;
-	sb2 isNull;
+   const WCHAR *pData;     // Points to OCILIB define buffer or to lobBuffer
+   WCHAR *lobBuffer;       // Buffer for LOB content (allocated on first use and reused for next rows)
+   UINT32 lobBufferSize;   // Size of LOB buffer in characters
+   UINT32 nLength;         // Length of value in characters
+   bool isLob;
+   bool isNull;
 };
 
 /**
@@ -71,6 +92,7 @@ struct ORACLE_CONN
 	sb4 lastErrorCode;
 	WCHAR lastErrorText[DBDRV_MAX_ERROR_TEXT];
    ub4 prefetchLimit;
+   StringMap *queryCache;  // Source query -> query with Oracle style placeholders
 };
 
 /**
@@ -116,6 +138,17 @@ struct ORACLE_STATEMENT
    int batchSize;
 };
 
+/**
+ * Data block for field values in buffered result
+ */
+struct ORACLE_RESULT_BLOCK
+{
+   ORACLE_RESULT_BLOCK *next;
+   size_t size;
+   size_t used;
+   WCHAR data[1];
+};
+
 /**
  * Result set
  */
@@ -123,10 +156,15 @@ struct ORACLE_RESULT
 {
 	int nRows;
 	int nCols;
-	WCHAR **pData;
+	int allocatedRows;
+	const WCHAR **pData;    // Field values, located in data blocks
 	char **columnNames;
+	ORACLE_RESULT_BLOCK *blocks;
 };
 
+/**
+ * Unbuffered result set
+ */
 struct ORACLE_UNBUFFERED_RESULT
 {
    ORACLE_CONN *connection;
@@ -97,6 +97,9 @@ struct db_statement_t
 	DB_HANDLE m_connection;
 	DBDRV_STATEMENT m_statement;
 	TCHAR *m_query;
+   UINT32 m_queryHash;
+   UINT32 m_fingerprint;
+   bool m_cacheable;
 };
 
 /**
@@ -116,6 +119,7 @@ struct db_handle_t
    char *m_dbName;
    char *m_schema;
    ObjectArray<db_statement_t> *m_preparedStatements;
+   ObjectArray<db_statement_t> *m_statementCache;   // Idle statements, least recently used first
 };
 
 /**
@@ -136,12 +140,17 @@ struct db_unbuffered_result_t
 	DB_DRIVER m_driver;
 	DB_HANDLE m_connection;
 	DBDRV_UNBUFFERED_RESULT m_data;
+   UINT32 m_fingerprint;
+   UINT32 m_rows;
 };
 
 /**
  * Internal functions
  */
 void __DBWriteLog(WORD level, const TCHAR *format, ...);
+UINT32 GetQueryFingerprint(const TCHAR *query);
+void UpdateQueryStats(UINT32 fingerprint, const TCHAR *query, INT64 elapsed, bool success, UINT32 rows);
+void AddQueryStatsRows(UINT32 fingerprint, UINT32 rows);
 
 /**
  * Global variables
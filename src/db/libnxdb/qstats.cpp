@@ -0,0 +1,271 @@
+/*
+** NetXMS - Network Management System
+** Database Abstraction Library
+** Copyright (C) 2003-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation; either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: qstats.cpp
+**
+**/
+
+#include "libnxdb.h"
+#include <uthash.h>
+
+/**
+ * Maximum number of tracked query fingerprints
+ */
+#define MAX_TRACKED_FINGERPRINTS    512
+
+/**
+ * Upper bounds (in milliseconds) for all latency histogram buckets except last
+ */
+static const UINT32 s_histogramBounds[DB_QUERY_HISTOGRAM_SIZE - 1] = { 1, 10, 100, 1000, 10000 };
+
+/**
+ * Statistics table entry
+ */
+struct QueryStatsEntry
+{
+   UT_hash_handle hh;
+   UINT32 fingerprint;
+   LIBNXDB_QUERY_STATS stats;
+};
+
+/**
+ * Statistics table
+ */
+static QueryStatsEntry *s_queryStats = NULL;
+static int s_queryStatsSize = 0;
+static UINT64 s_untrackedQueries = 0;
+static MUTEX s_queryStatsLock = MutexCreate();
+
+/**
+ * Check if given character can be part of identifier
+ */
+inline bool IsIdentifierChar(TCHAR ch)
+{
+   return _istalnum(ch) || (ch == _T('_')) || (ch == _T('$'));
+}
+
+/**
+ * Check if minus sign at current position of normalized text is unary
+ * (not preceded by operand)
+ */
+static bool IsUnaryMinus(const TCHAR *buffer, size_t pos)
+{
+   if ((pos > 0) && (buffer[pos - 1] == _T(' ')))
+      pos--;
+   if (pos == 0)
+      return true;
+   TCHAR ch = buffer[pos - 1];
+   return !IsIdentifierChar(ch) && (ch != _T(')')) && (ch != _T('?'));
+}
+
+/**
+ * Normalize query text by replacing literals (including hexadecimal numbers)
+ * with ? (lists of literals are collapsed into single ?), replacing numeric suffixes of table names like
+ * idata_NNN with N, and collapsing whitespace. Returns hash of normalized text.
+ */
+UINT32 LIBNXDB_EXPORTABLE DBNormalizeQuery(const TCHAR *query, TCHAR *buffer, size_t size)
+{
+   size_t pos = 0;
+   const TCHAR *p = query;
+   while((*p != 0) && (pos < size - 1))
+   {
+      if (*p == _T('\''))
+      {
+         for(p++; *p != 0; p++)
+         {
+            if (*p == _T('\''))
+            {
+               if (*(p + 1) != _T('\''))
+               {
+                  p++;
+                  break;
+               }
+               p++;
+            }
+         }
+         buffer[pos++] = _T('?');
+      }
+      else if ((_istdigit(*p) && ((p == query) || !IsIdentifierChar(*(p - 1)))) ||
+               ((*p == _T('-')) && _istdigit(*(p + 1)) && IsUnaryMinus(buffer, pos)))
+      {
+         if (*p == _T('-'))
+            p++;
+         if ((*p == _T('0')) && ((*(p + 1) == _T('x')) || (*(p + 1) == _T('X'))) && _istxdigit(*(p + 2)))
+         {
+            for(p += 2; _istxdigit(*p); p++);
+         }
+         else
+         {
+            while(_istdigit(*p) || (*p == _T('.')))
+               p++;
+         }
+         buffer[pos++] = _T('?');
+      }
+      else if (_istspace(*p))
+      {
+         while(_istspace(*p))
+            p++;
+         if ((pos > 0) && (*p != 0))
+            buffer[pos++] = _T(' ');
+         continue;
+      }
+      else if (IsIdentifierChar(*p))
+      {
+         size_t start = pos, suffix = 0;
+         while(IsIdentifierChar(*p) && (pos < size - 1))
+         {
+            if (*p == _T('_'))
+               suffix = pos + 1;
+            buffer[pos++] = *p++;
+         }
+         if ((suffix > start) && (suffix < pos))
+         {
+            size_t i;
+            for(i = suffix; (i < pos) && _istdigit(buffer[i]); i++);
+            if (i == pos)
+            {
+               buffer[suffix] = _T('N');
+               pos = suffix + 1;
+            }
+         }
+         continue;
+      }
+      else
+      {
+         buffer[pos++] = *p++;
+      }
+
+      // Collapse "?,?" and "?, ?" into single "?"
+      if ((pos >= 3) && (buffer[pos - 1] == _T('?')))
+      {
+         size_t i = pos - 2;
+         if ((buffer[i] == _T(' ')) && (i > 0))
+            i--;
+         if ((buffer[i] == _T(',')) && (i > 0) && (buffer[i - 1] == _T('?')))
+            pos = i;
+      }
+   }
+   buffer[pos] = 0;
+
+   UINT32 hash = 2166136261U;
+   for(size_t i = 0; i < pos; i++)
+   {
+      hash ^= (UINT32)buffer[i];
+      hash *= 16777619U;
+   }
+   return hash;
+}
+
+/**
+ * Get fingerprint (hash of normalized text) for given query
+ */
+UINT32 GetQueryFingerprint(const TCHAR *query)
+{
+   TCHAR buffer[MAX_QUERY_FINGERPRINT_LENGTH];
+   return DBNormalizeQuery(query, buffer, MAX_QUERY_FINGERPRINT_LENGTH);
+}
+
+/**
+ * Update statistics for query with given fingerprint. Query text is only used if
+ * there are no entry for this fingerprint yet.
+ */
+void UpdateQueryStats(UINT32 fingerprint, const TCHAR *query, INT64 elapsed, bool success, UINT32 rows)
+{
+   MutexLock(s_queryStatsLock);
+
+   QueryStatsEntry *entry;
+   HASH_FIND(hh, s_queryStats, &fingerprint, sizeof(UINT32), entry);
+   if (entry == NULL)
+   {
+      if (s_queryStatsSize >= MAX_TRACKED_FINGERPRINTS)
+      {
+         s_untrackedQueries++;
+         MutexUnlock(s_queryStatsLock);
+         return;
+      }
+      entry = (QueryStatsEntry *)malloc(sizeof(QueryStatsEntry));
+      memset(entry, 0, sizeof(QueryStatsEntry));
+      entry->fingerprint = fingerprint;
+      DBNormalizeQuery(query, entry->stats.fingerprint, MAX_QUERY_FINGERPRINT_LENGTH);
+      HASH_ADD(hh, s_queryStats, fingerprint, sizeof(UINT32), entry);
+      s_queryStatsSize++;
+   }
+
+   entry->stats.count++;
+   if (!success)
+      entry->stats.failed++;
+   entry->stats.totalTime += elapsed;
+   if ((UINT32)elapsed > entry->stats.maxTime)
+      entry->stats.maxTime = (UINT32)elapsed;
+   entry->stats.rows += rows;
+
+   int bucket;
+   for(bucket = 0; (bucket < DB_QUERY_HISTOGRAM_SIZE - 1) && ((UINT32)elapsed >= s_histogramBounds[bucket]); bucket++);
+   entry->stats.histogram[bucket]++;
+
+   MutexUnlock(s_queryStatsLock);
+}
+
+/**
+ * Add number of rows fetched by unbuffered query to statistics
+ */
+void AddQueryStatsRows(UINT32 fingerprint, UINT32 rows)
+{
+   MutexLock(s_queryStatsLock);
+   QueryStatsEntry *entry;
+   HASH_FIND(hh, s_queryStats, &fingerprint, sizeof(UINT32), entry);
+   if (entry != NULL)
+      entry->stats.rows += rows;
+   MutexUnlock(s_queryStatsLock);
+}
+
+/**
+ * Get copy of query statistics. Returned array should be destroyed by caller.
+ */
+StructArray<LIBNXDB_QUERY_STATS> LIBNXDB_EXPORTABLE *DBGetQueryStatistics(UINT64 *untrackedQueries)
+{
+   MutexLock(s_queryStatsLock);
+   StructArray<LIBNXDB_QUERY_STATS> *stats = new StructArray<LIBNXDB_QUERY_STATS>(s_queryStatsSize, 16);
+   QueryStatsEntry *entry, *tmp;
+   HASH_ITER(hh, s_queryStats, entry, tmp)
+   {
+      stats->add(&entry->stats);
+   }
+   if (untrackedQueries != NULL)
+      *untrackedQueries = s_untrackedQueries;
+   MutexUnlock(s_queryStatsLock);
+   return stats;
+}
+
+/**
+ * Reset query statistics
+ */
+void LIBNXDB_EXPORTABLE DBResetQueryStatistics()
+{
+   MutexLock(s_queryStatsLock);
+   QueryStatsEntry *entry, *tmp;
+   HASH_ITER(hh, s_queryStats, entry, tmp)
+   {
+      HASH_DEL(s_queryStats, entry);
+      free(entry);
+   }
+   s_queryStatsSize = 0;
+   s_untrackedQueries = 0;
+   MutexUnlock(s_queryStatsLock);
+}
@@ -36,12 +36,30 @@ static UINT64 s_perfNonSelectQueries = 0;
 static UINT64 s_perfTotalQueries = 0;
 static UINT64 s_perfLongRunningQueries = 0;
 static UINT64 s_perfFailedQueries = 0;
+static UINT64 s_perfStatementCacheHits = 0;
+static UINT64 s_perfStatementCacheMisses = 0;
+static UINT64 s_perfStatementCacheEvictions = 0;
+
+/**
+ * Maximum number of idle prepared statements kept per connection
+ */
+static int s_statementCacheSize = 32;
 
 /**
  * Session init callback
  */
 static void (*s_sessionInitCb)(DB_HANDLE session) = NULL;
 
+/**
+ * Destroy prepared statement and underlying driver statement
+ */
+static void DestroyStatement(DB_STATEMENT hStmt)
+{
+   hStmt->m_driver->m_fpDrvFreeStatement(hStmt->m_statement);
+   free(hStmt->m_query);
+   free(hStmt);
+}
+
 /**
  * Invalidate all prepared statements on connection
  */
@@ -55,6 +73,32 @@ static void InvalidatePreparedStatements(DB_HANDLE hConn)
       stmt->m_connection = NULL;
    }
    hConn->m_preparedStatements->clear();
+
+   for(int i = 0; i < hConn->m_statementCache->size(); i++)
+      DestroyStatement(hConn->m_statementCache->get(i));
+   hConn->m_statementCache->clear();
+}
+
+/**
+ * Calculate hash of query text for statement cache lookup (FNV-1a)
+ */
+static UINT32 CalculateQueryHash(const TCHAR *query)
+{
+   UINT32 hash = 2166136261U;
+   for(const TCHAR *p = query; *p != 0; p++)
+   {
+      hash ^= (UINT32)*p;
+      hash *= 16777619U;
+   }
+   return hash;
+}
+
+/**
+ * Set maximum number of idle prepared statements cached per connection (0 to disable caching)
+ */
+void LIBNXDB_EXPORTABLE DBSetStatementCacheSize(int size)
+{
+   s_statementCacheSize = max(size, 0);
 }
 
 /**
@@ -93,6 +137,7 @@ DB_HANDLE LIBNXDB_EXPORTABLE DBConnect(DB_DRIVER driver, const TCHAR *server, co
          hConn->m_mutexTransLock = MutexCreateRecursive();
          hConn->m_transactionLevel = 0;
          hConn->m_preparedStatements = new ObjectArray<db_statement_t>(4, 4, false);
+         hConn->m_statementCache = new ObjectArray<db_statement_t>(16, 16, false);
 #ifdef UNICODE
          hConn->m_dbName = mbDatabase;
          hConn->m_login = mbLogin;
@@ -150,6 +195,7 @@ void LIBNXDB_EXPORTABLE DBDisconnect(DB_HANDLE hConn)
    safe_free(hConn->m_server);
    safe_free(hConn->m_schema);
    delete hConn->m_preparedStatements;
+   delete hConn->m_statementCache;
    free(hConn);
 }
 
@@ -303,6 +349,7 @@ bool LIBNXDB_EXPORTABLE DBQueryEx(DB_HANDLE hConn, const TCHAR *szQuery, TCHAR *
       nxlog_debug(3, _T("Long running query: \"%s\" [%d ms]"), szQuery, (int)ms);
       s_perfLongRunningQueries++;
    }
+   UpdateQueryStats(GetQueryFingerprint(szQuery), szQuery, ms, dwResult == DBERR_SUCCESS, 0);
    
    MutexUnlock(hConn->m_mutexTransLock);
 
@@ -377,6 +424,8 @@ DB_RESULT LIBNXDB_EXPORTABLE DBSelectEx(DB_HANDLE hConn, const TCHAR *szQuery, T
       nxlog_debug(3, _T("Long running query: \"%s\" [%d ms]"), szQuery, (int)ms);
       s_perfLongRunningQueries++;
    }
+   UpdateQueryStats(GetQueryFingerprint(szQuery), szQuery, ms, hResult != NULL,
+                    (hResult != NULL) ? (UINT32)hConn->m_driver->m_fpDrvGetNumRows(hResult) : 0);
    MutexUnlock(hConn->m_mutexTransLock);
 
 #ifndef UNICODE
@@ -847,6 +896,8 @@ DB_UNBUFFERED_RESULT LIBNXDB_EXPORTABLE DBSelectUnbufferedEx(DB_HANDLE hConn, co
       nxlog_debug(3, _T("Long running query: \"%s\" [%d ms]"), szQuery, (int)ms);
       s_perfLongRunningQueries++;
    }
+   UINT32 fingerprint = GetQueryFingerprint(szQuery);
+   UpdateQueryStats(fingerprint, szQuery, ms, hResult != NULL, 0);
    if (hResult == NULL)
    {
       s_perfFailedQueries++;
@@ -873,6 +924,8 @@ DB_UNBUFFERED_RESULT LIBNXDB_EXPORTABLE DBSelectUnbufferedEx(DB_HANDLE hConn, co
 		result->m_driver = hConn->m_driver;
 		result->m_connection = hConn;
 		result->m_data = hResult;
+      result->m_fingerprint = fingerprint;
+      result->m_rows = 0;
 	}
 	
 	if(unlockOnResult)
@@ -897,7 +950,10 @@ DB_UNBUFFERED_RESULT LIBNXDB_EXPORTABLE DBSelectUnbuffered(DB_HANDLE hConn, cons
  */
 bool LIBNXDB_EXPORTABLE DBFetch(DB_UNBUFFERED_RESULT hResult)
 {
-	return hResult->m_driver->m_fpDrvFetch(hResult->m_data);
+	if (!hResult->m_driver->m_fpDrvFetch(hResult->m_data))
+      return false;
+   hResult->m_rows++;
+   return true;
 }
 
 /**
@@ -1145,6 +1201,8 @@ void LIBNXDB_EXPORTABLE DBFreeResult(DB_UNBUFFERED_RESULT hResult)
 {
 	hResult->m_driver->m_fpDrvFreeUnbufferedResult(hResult->m_data);
 	MutexUnlock(hResult->m_connection->m_mutexTransLock);
+   if (hResult->m_rows > 0)
+      AddQueryStatsRows(hResult->m_fingerprint, hResult->m_rows);
 	free(hResult);
 }
 
@@ -1159,6 +1217,34 @@ DB_STATEMENT LIBNXDB_EXPORTABLE DBPrepareEx(DB_HANDLE hConn, const TCHAR *query,
 	DB_STATEMENT result = NULL;
 	INT64 ms;
 
+   // Reuse idle statement with same query text if available
+   UINT32 hash = CalculateQueryHash(query);
+   if (s_statementCacheSize > 0)
+   {
+      MutexLock(hConn->m_mutexTransLock);
+      for(int i = hConn->m_statementCache->size() - 1; i >= 0; i--)
+      {
+         db_statement_t *stmt = hConn->m_statementCache->get(i);
+         if ((stmt->m_queryHash == hash) && !_tcscmp(stmt->m_query, query))
+         {
+            hConn->m_statementCache->remove(i);
+            hConn->m_preparedStatements->add(stmt);
+            result = stmt;
+            break;
+         }
+      }
+      MutexUnlock(hConn->m_mutexTransLock);
+
+      if (result != NULL)
+      {
+         s_perfStatementCacheHits++;
+         if (hConn->m_driver->m_dumpSql)
+            nxlog_debug(9, _T("{%p} Cached prepare: \"%s\""), result, query);
+         return result;
+      }
+      s_perfStatementCacheMisses++;
+   }
+
 #ifdef UNICODE
 #define pwszQuery query
 #define wcErrorText errorText
@@ -1188,6 +1274,9 @@ DB_STATEMENT LIBNXDB_EXPORTABLE DBPrepareEx(DB_HANDLE hConn, const TCHAR *query,
 		result->m_connection = hConn;
 		result->m_statement = stmt;
 		result->m_query = _tcsdup(query);
+      result->m_queryHash = hash;
+      result->m_fingerprint = GetQueryFingerprint(query);
+      result->m_cacheable = true;
 	}
 	else
 	{
@@ -1242,13 +1331,27 @@ void LIBNXDB_EXPORTABLE DBFreeStatement(DB_STATEMENT hStmt)
    if (hStmt == NULL)
       return;
 
-   if (hStmt->m_connection != NULL)
+   DB_HANDLE hConn = hStmt->m_connection;
+   if (hConn != NULL)
    {
-      hStmt->m_connection->m_preparedStatements->remove(hStmt);
+      MutexLock(hConn->m_mutexTransLock);
+      hConn->m_preparedStatements->remove(hStmt);
+      if (hStmt->m_cacheable && (s_statementCacheSize > 0))
+      {
+         // Keep statement for reuse, evicting least recently used ones if cache is full
+         while(hConn->m_statementCache->size() >= s_statementCacheSize)
+         {
+            DestroyStatement(hConn->m_statementCache->get(0));
+            hConn->m_statementCache->remove(0);
+            s_perfStatementCacheEvictions++;
+         }
+         hConn->m_statementCache->add(hStmt);
+         MutexUnlock(hConn->m_mutexTransLock);
+         return;
+      }
+      MutexUnlock(hConn->m_mutexTransLock);
    }
-   hStmt->m_driver->m_fpDrvFreeStatement(hStmt->m_statement);
-   free(hStmt->m_query);
-	free(hStmt);
+   DestroyStatement(hStmt);
 }
 
 /**
@@ -1266,6 +1369,7 @@ bool LIBNXDB_EXPORTABLE DBOpenBatch(DB_STATEMENT hStmt)
 {
    if (!IS_VALID_STATEMENT_HANDLE(hStmt) || (hStmt->m_driver->m_fpDrvOpenBatch == NULL))
       return false;
+   hStmt->m_cacheable = false;   // driver keeps batch state in statement
    return hStmt->m_driver->m_fpDrvOpenBatch(hStmt->m_statement);
 }
 
@@ -1474,6 +1578,7 @@ bool LIBNXDB_EXPORTABLE DBExecuteEx(DB_STATEMENT hStmt, TCHAR *errorText)
       nxlog_debug(3, _T("Long running query: \"%s\" [%d ms]"), hStmt->m_query, (int)ms);
       s_perfLongRunningQueries++;
    }
+   UpdateQueryStats(hStmt->m_fingerprint, hStmt->m_query, ms, dwResult == DBERR_SUCCESS, 0);
 
    // Do reconnect if needed, but don't retry statement execution
    // because it will fail anyway
@@ -1558,6 +1663,8 @@ DB_RESULT LIBNXDB_EXPORTABLE DBSelectPreparedEx(DB_STATEMENT hStmt, TCHAR *error
       nxlog_debug(3, _T("Long running query: \"%s\" [%d ms]"), hStmt->m_query, (int)ms);
       s_perfLongRunningQueries++;
    }
+   UpdateQueryStats(hStmt->m_fingerprint, hStmt->m_query, ms, hResult != NULL,
+                    (hResult != NULL) ? (UINT32)hConn->m_driver->m_fpDrvGetNumRows(hResult) : 0);
 
    // Do reconnect if needed, but don't retry statement execution
    // because it will fail anyway
@@ -1650,6 +1757,7 @@ DB_UNBUFFERED_RESULT LIBNXDB_EXPORTABLE DBSelectPreparedUnbufferedEx(DB_STATEMEN
       nxlog_debug(3, _T("Long running query: \"%s\" [%d ms]"), hStmt->m_query, (int)ms);
       s_perfLongRunningQueries++;
    }
+   UpdateQueryStats(hStmt->m_fingerprint, hStmt->m_query, ms, hResult != NULL, 0);
 
    // Do reconnect if needed, but don't retry statement execution
    // because it will fail anyway
@@ -1688,6 +1796,8 @@ DB_UNBUFFERED_RESULT LIBNXDB_EXPORTABLE DBSelectPreparedUnbufferedEx(DB_STATEMEN
       result->m_driver = hConn->m_driver;
       result->m_connection = hConn;
       result->m_data = hResult;
+      result->m_fingerprint = hStmt->m_fingerprint;
+      result->m_rows = 0;
    }
 
    return result;
@@ -1868,4 +1978,7 @@ void LIBNXDB_EXPORTABLE DBGetPerfCounters(LIBNXDB_PERF_COUNTERS *counters)
    counters->nonSelectQueries = s_perfNonSelectQueries;
    counters->selectQueries = s_perfSelectQueries;
    counters->totalQueries = s_perfTotalQueries;
+   counters->statementCacheHits = s_perfStatementCacheHits;
+   counters->statementCacheMisses = s_perfStatementCacheMisses;
+   counters->statementCacheEvictions = s_perfStatementCacheEvictions;
 }
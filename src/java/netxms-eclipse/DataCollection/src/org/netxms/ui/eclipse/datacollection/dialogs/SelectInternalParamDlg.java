@@ -85,6 +85,10 @@ public class SelectInternalParamDlg extends AbstractSelectParamDlg
          list.add(new AgentParameter("Server.DBWriter.Requests.RawData", "DB writer requests (raw DCI data)", DataCollectionItem.DT_UINT64)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.ReceivedSNMPTraps", "SNMP traps received since server start", DataCollectionItem.DT_UINT64)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.ReceivedSyslogMessages", "Syslog messages received since server start", DataCollectionItem.DT_UINT64)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.Syncer.CycleTime", "Syncer: duration of last cycle (milliseconds)", DataCollectionItem.DT_UINT)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.Syncer.ObjectsDeleted", "Syncer: objects deleted during last cycle", DataCollectionItem.DT_UINT)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.Syncer.ObjectsSaved", "Syncer: objects saved during last cycle", DataCollectionItem.DT_UINT)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.Syncer.Queries", "Syncer: database queries executed during last cycle", DataCollectionItem.DT_UINT64)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.ThreadPool.ActiveRequests(*)", "Thread pool {instance}: active requests", DataCollectionItem.DT_INT)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.ThreadPool.CurrSize(*)", "Thread pool {instance}: current size", DataCollectionItem.DT_INT)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.ThreadPool.Load(*)", "Thread pool {instance}: current load", DataCollectionItem.DT_INT)); //$NON-NLS-1$
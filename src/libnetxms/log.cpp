@@ -30,6 +30,45 @@
 
 #define MAX_LOG_HISTORY_SIZE	128
 
+/**
+ * Number of log buffer shards used by background writer
+ */
+#define LOG_BUFFER_SHARD_BITS    4
+#define LOG_BUFFER_SHARDS        (1 << LOG_BUFFER_SHARD_BITS)
+
+/**
+ * Maximum size of single log buffer shard in bytes
+ */
+#define LOG_BUFFER_SHARD_SIZE    (1024 * 1024)
+
+/**
+ * Initial allocation for log buffer shard
+ */
+#define LOG_BUFFER_SHARD_INITIAL_SIZE  16384
+
+/**
+ * Log record header in shard buffer (followed by record text without terminating zero)
+ */
+struct LogRecordHeader
+{
+   UINT32 seq;       // Global record sequence number
+   UINT32 length;    // Text length in characters
+};
+
+/**
+ * Log buffer shard. Writing threads are mapped to shards by thread ID, so concurrent
+ * writers rarely compete for same shard lock. Shard contents are picked up by background
+ * writer thread, which merges records from all shards by sequence number.
+ */
+struct LogBufferShard
+{
+   MUTEX mutex;
+   BYTE *data;
+   size_t size;
+   size_t allocated;
+   UINT32 dropped;
+};
+
 /**
  * Static data
  */
@@ -53,10 +92,54 @@ static int s_logHistorySize = 4;		// Keep up 4 previous log files
 static TCHAR s_dailyLogSuffixTemplate[64] = _T("%Y%m%d");
 static time_t m_currentDayStart = 0;
 static NxLogConsoleWriter m_consoleWriter = (NxLogConsoleWriter)_tprintf;
-static String s_logBuffer;
+static UINT64 s_logFileSize = 0;
+static LogBufferShard s_logShards[LOG_BUFFER_SHARDS];
+static VolatileCounter s_logRecordSeq = 0;
+static UINT64 s_droppedMessages = 0;
 static THREAD s_writerThread = INVALID_THREAD_HANDLE;
-static CONDITION s_writerStopCondition = INVALID_CONDITION_HANDLE;
+static CONDITION s_writerWakeupCondition = INVALID_CONDITION_HANDLE;
+static bool s_writerStop = false;
 static NxLogDebugWriter s_debugWriter = NULL;
+static StructArray<DebugTagInfo> s_debugTags(0, 16);
+static RWLOCK s_debugTagLock = RWLockCreate();
+static int s_maxDebugLevel = 0;     // Highest of global and all tag debug levels
+static volatile int s_debugTagCount = 0;
+static volatile INT32 s_debugTagGeneration = 0;  // Changed on every change of tag or global debug levels
+
+/**
+ * Cached effective debug level for single tag. Level is stored together with
+ * tag configuration generation it was resolved for (as (generation << 4) | level),
+ * so any configuration change invalidates all cached levels at once.
+ */
+struct DebugTagCacheEntry
+{
+   volatile bool ready;
+   volatile INT32 level;
+   TCHAR tag[MAX_DEBUG_TAG_LENGTH];
+};
+
+#define DEBUG_TAG_CACHE_SIZE     128
+#define DEBUG_TAG_CACHE_PROBES   4
+
+static DebugTagCacheEntry s_debugTagCache[DEBUG_TAG_CACHE_SIZE];
+static MUTEX s_debugTagCacheLock = MutexCreate();
+
+/**
+ * Recalculate highest debug level. Must be called with tag lock held.
+ */
+static void UpdateMaxDebugLevel()
+{
+   int level = s_debugLevel;
+   for(int i = 0; i < s_debugTags.size(); i++)
+   {
+      DebugTagInfo *t = s_debugTags.get(i);
+      if (t->level > level)
+         level = t->level;
+   }
+   s_maxDebugLevel = level;
+   s_debugTagCount = s_debugTags.size();
+   s_debugTagGeneration = (s_debugTagGeneration + 1) & 0x0FFFFFFF;
+}
 
 /**
  * Set debug level
@@ -64,7 +147,133 @@ static NxLogDebugWriter s_debugWriter = NULL;
 void LIBNETXMS_EXPORTABLE nxlog_set_debug_level(int level)
 {
    if ((level >= 0) && (level <= 9))
+   {
+      RWLockWriteLock(s_debugTagLock, INFINITE);
       s_debugLevel = level;
+      UpdateMaxDebugLevel();
+      RWLockUnlock(s_debugTagLock);
+   }
+}
+
+/**
+ * Set debug level for given tag. Level applies to tag itself and all its subtags
+ * (for example, level set for "snmp" applies to "snmp.trap" unless it has own level).
+ * Negative level removes tag specific setting.
+ */
+void LIBNETXMS_EXPORTABLE nxlog_set_debug_level_tag(const TCHAR *tag, int level)
+{
+   if ((tag == NULL) || (tag[0] == 0) || (level > 9))
+      return;
+
+   RWLockWriteLock(s_debugTagLock, INFINITE);
+   int i;
+   for(i = 0; i < s_debugTags.size(); i++)
+      if (!_tcsicmp(s_debugTags.get(i)->tag, tag))
+         break;
+   if (level >= 0)
+   {
+      if (i < s_debugTags.size())
+      {
+         s_debugTags.get(i)->level = level;
+      }
+      else
+      {
+         DebugTagInfo t;
+         nx_strncpy(t.tag, tag, MAX_DEBUG_TAG_LENGTH);
+         t.level = level;
+         s_debugTags.add(&t);
+      }
+   }
+   else if (i < s_debugTags.size())
+   {
+      s_debugTags.remove(i);
+   }
+   UpdateMaxDebugLevel();
+   RWLockUnlock(s_debugTagLock);
+}
+
+/**
+ * Find cache entry for given tag, creating new one if possible.
+ * Returns NULL if tag cannot be cached.
+ */
+static DebugTagCacheEntry *FindDebugTagCacheEntry(const TCHAR *tag)
+{
+   UINT32 hash = 0;
+   size_t len;
+   for(len = 0; tag[len] != 0; len++)
+      hash = hash * 31 + (UINT32)tag[len];
+   if (len >= MAX_DEBUG_TAG_LENGTH)
+      return NULL;
+
+   for(int i = 0; i < DEBUG_TAG_CACHE_PROBES; i++)
+   {
+      DebugTagCacheEntry *entry = &s_debugTagCache[(hash + i) % DEBUG_TAG_CACHE_SIZE];
+      if (!entry->ready)
+      {
+         MutexLock(s_debugTagCacheLock);
+         if (!entry->ready)
+         {
+            memcpy(entry->tag, tag, (len + 1) * sizeof(TCHAR));
+            entry->level = -1;
+            entry->ready = true;
+            MutexUnlock(s_debugTagCacheLock);
+            return entry;
+         }
+         MutexUnlock(s_debugTagCacheLock);
+      }
+      if (!_tcscmp(entry->tag, tag))
+         return entry;
+   }
+   return NULL;
+}
+
+/**
+ * Get effective debug level for given tag (set for tag itself or
+ * for closest parent tag, or global debug level)
+ */
+int LIBNETXMS_EXPORTABLE nxlog_get_debug_level_tag(const TCHAR *tag)
+{
+   if (s_debugTagCount == 0)
+      return s_debugLevel;
+
+   DebugTagCacheEntry *entry = FindDebugTagCacheEntry(tag);
+   if (entry != NULL)
+   {
+      INT32 cached = entry->level;
+      if ((cached >= 0) && ((cached >> 4) == s_debugTagGeneration))
+         return cached & 0x0F;
+   }
+
+   RWLockReadLock(s_debugTagLock, INFINITE);
+   int level = s_debugLevel;
+   size_t matchLen = 0;
+   for(int i = 0; i < s_debugTags.size(); i++)
+   {
+      DebugTagInfo *t = s_debugTags.get(i);
+      size_t len = _tcslen(t->tag);
+      if ((len > matchLen) && !_tcsnicmp(t->tag, tag, len) && ((tag[len] == 0) || (tag[len] == _T('.'))))
+      {
+         level = t->level;
+         matchLen = len;
+      }
+   }
+   INT32 generation = s_debugTagGeneration;
+   RWLockUnlock(s_debugTagLock);
+
+   if (entry != NULL)
+      entry->level = (generation << 4) | level;
+   return level;
+}
+
+/**
+ * Get all tags with individual debug levels. Returned array should be destroyed by caller.
+ */
+StructArray<DebugTagInfo> LIBNETXMS_EXPORTABLE *nxlog_get_debug_tags()
+{
+   RWLockReadLock(s_debugTagLock, INFINITE);
+   StructArray<DebugTagInfo> *tags = new StructArray<DebugTagInfo>(&s_debugTags);
+   RWLockUnlock(s_debugTagLock);
+   return tags;
 }
 
 /**
@@ -75,6 +284,14 @@ int LIBNETXMS_EXPORTABLE nxlog_get_debug_level()
    return s_debugLevel;
 }
 
+/**
+ * Get number of log messages dropped by background writer because of log buffer overflow
+ */
+UINT64 LIBNETXMS_EXPORTABLE nxlog_get_dropped_count()
+{
+   return s_droppedMessages;
+}
+
 /**
  * Set additional debug writer callback. It will be called for each line written with nxlog_debug.
  */
@@ -245,11 +462,14 @@ static bool RotateLog(bool needLock)
 #else
    m_logFileHandle = _tfopen(m_logFileName, _T("w"));
 #endif
+   s_logFileSize = 0;
    if (m_logFileHandle != NULL)
    {
       s_flags |= NXLOG_IS_OPEN;
       TCHAR buffer[32];
-      _ftprintf(m_logFileHandle, _T("%s Log file truncated.\n"), FormatLogTimestamp(buffer));
+      int len = _ftprintf(m_logFileHandle, _T("%s Log file truncated.\n"), FormatLogTimestamp(buffer));
+      if (len > 0)
+         s_logFileSize = len;
       fflush(m_logFileHandle);
 #ifndef _WIN32
       int fd = fileno(m_logFileHandle);
@@ -271,15 +491,113 @@ bool LIBNETXMS_EXPORTABLE nxlog_rotate()
 	return RotateLog(true);
 }
 
+/**
+ * Get log buffer shard for calling thread
+ */
+inline LogBufferShard *GetLogBufferShard()
+{
+   UINT32 id = (UINT32)((size_t)GetCurrentThreadId());
+   return &s_logShards[(id * 2654435761U) >> (32 - LOG_BUFFER_SHARD_BITS)];   // multiplicative hash, thread IDs often have low bits zeroed
+}
+
+/**
+ * Add record to log buffer. Record is dropped if buffer shard is full.
+ */
+static void AddToLogBuffer(const TCHAR *timestamp, const TCHAR *loglevel, const TCHAR *message)
+{
+   size_t tlen = _tcslen(timestamp);
+   size_t llen = _tcslen(loglevel);
+   size_t mlen = _tcslen(message);
+   LogRecordHeader header;
+   header.length = (UINT32)(tlen + llen + mlen + 1);
+   size_t recordSize = sizeof(LogRecordHeader) + header.length * sizeof(TCHAR);
+
+   LogBufferShard *shard = GetLogBufferShard();
+   MutexLock(shard->mutex);
+
+   // Single oversized record is still accepted into empty shard
+   if ((shard->size > 0) && (shard->size + recordSize > LOG_BUFFER_SHARD_SIZE))
+   {
+      shard->dropped++;
+      MutexUnlock(shard->mutex);
+      ConditionSet(s_writerWakeupCondition);
+      return;
+   }
+
+   if (shard->size + recordSize > shard->allocated)
+   {
+      size_t size = (shard->allocated > 0) ? shard->allocated * 2 : LOG_BUFFER_SHARD_INITIAL_SIZE;
+      if (size > LOG_BUFFER_SHARD_SIZE)
+         size = LOG_BUFFER_SHARD_SIZE;
+      if (size < shard->size + recordSize)
+         size = shard->size + recordSize;
+      shard->data = (BYTE *)realloc(shard->data, size);
+      shard->allocated = size;
+   }
+
+   // Sequence number is assigned under shard lock so records within shard are always ordered
+   header.seq = (UINT32)InterlockedIncrement(&s_logRecordSeq);
+   BYTE *p = shard->data + shard->size;
+   memcpy(p, &header, sizeof(LogRecordHeader));
+   p += sizeof(LogRecordHeader);
+   memcpy(p, timestamp, tlen * sizeof(TCHAR));
+   p += tlen * sizeof(TCHAR);
+   *((TCHAR *)p) = _T(' ');
+   p += sizeof(TCHAR);
+   memcpy(p, loglevel, llen * sizeof(TCHAR));
+   p += llen * sizeof(TCHAR);
+   memcpy(p, message, mlen * sizeof(TCHAR));
+
+   bool wakeup = (shard->size < LOG_BUFFER_SHARD_SIZE / 2) && (shard->size + recordSize >= LOG_BUFFER_SHARD_SIZE / 2);
+   shard->size += recordSize;
+   MutexUnlock(shard->mutex);
+
+   // Wake up writer early if shard is filling up
+   if (wakeup)
+      ConditionSet(s_writerWakeupCondition);
+}
+
+/**
+ * Write data to log file
+ */
+static void WriteToLogFile(const char *data, size_t size)
+{
+#ifdef _WIN32
+   fwrite(data, 1, size, m_logFileHandle);
+#else
+   // write is used here because on linux fwrite is not working
+   // after calling fwprintf on a stream
+   size_t offset = 0;
+   while(size > 0)
+   {
+      int bw = write(fileno(m_logFileHandle), &data[offset], size);
+      if (bw < 0)
+         break;
+      size -= bw;
+      offset += bw;
+   }
+#endif
+}
+
 /**
  * Background writer thread
  */
 static THREAD_RESULT THREAD_CALL BackgroundWriterThread(void *arg)
 {
+   // Buffers taken from shards on previous iteration - given back to shards on next one
+   BYTE *data[LOG_BUFFER_SHARDS];
+   size_t size[LOG_BUFFER_SHARDS], allocated[LOG_BUFFER_SHARDS], pos[LOG_BUFFER_SHARDS];
+   memset(data, 0, sizeof(data));
+   memset(allocated, 0, sizeof(allocated));
+
+   TCHAR *output = NULL;
+   size_t outputSize = 0;
+
    bool stop = false;
    while(!stop)
    {
-      stop = ConditionWait(s_writerStopCondition, 1000);
+      ConditionWait(s_writerWakeupCondition, 1000);
+      stop = s_writerStop;
 
 	   // Check for new day start
       time_t t = time(NULL);
@@ -288,61 +606,99 @@ static THREAD_RESULT THREAD_CALL BackgroundWriterThread(void *arg)
 		   RotateLog(FALSE);
 	   }
 
-      MutexLock(m_mutexLogAccess);
-      if (!s_logBuffer.isEmpty())
+      // Swap shard buffers with buffers processed on previous iteration
+      size_t total = 0;
+      UINT32 dropped = 0;
+      for(int i = 0; i < LOG_BUFFER_SHARDS; i++)
       {
-         if (s_flags & NXLOG_PRINT_TO_STDOUT)
-            m_consoleWriter(_T("%s"), s_logBuffer.getBuffer());
+         LogBufferShard *shard = &s_logShards[i];
+         MutexLock(shard->mutex);
+         BYTE *tmpData = shard->data;
+         size_t tmpAllocated = shard->allocated;
+         size[i] = shard->size;
+         shard->data = data[i];
+         shard->allocated = allocated[i];
+         shard->size = 0;
+         dropped += shard->dropped;
+         shard->dropped = 0;
+         MutexUnlock(shard->mutex);
+         data[i] = tmpData;
+         allocated[i] = tmpAllocated;
+         pos[i] = 0;
+         total += size[i];
+      }
+
+      if ((total == 0) && (dropped == 0))
+         continue;
 
-         size_t buflen = s_logBuffer.length();
-         char *data = s_logBuffer.getUTF8String();
-         s_logBuffer.clear();
-         MutexUnlock(m_mutexLogAccess);
+      // Merge records from all shards in sequence order
+      size_t required = total / sizeof(TCHAR) + 256;
+      if (required > outputSize)
+      {
+         outputSize = required;
+         output = (TCHAR *)realloc(output, outputSize * sizeof(TCHAR));
+      }
+
+      size_t outLen = 0;
+      if (dropped > 0)
+      {
+         s_droppedMessages += dropped;
+         TCHAR timestamp[32];
+         outLen = _sntprintf(output, 256, _T("%s [WARN ] %u log messages dropped because of log buffer overflow\n"),
+                             FormatLogTimestamp(timestamp), dropped);
+      }
 
-         if (s_flags & NXLOG_DEBUG_MODE)
+      while(true)
+      {
+         int next = -1;
+         LogRecordHeader header, nextHeader;
+         for(int i = 0; i < LOG_BUFFER_SHARDS; i++)
          {
-            char marker[64];
-            sprintf(marker, "##(" INT64_FMTA ")" INT64_FMTA " @" INT64_FMTA "\n",
-                    (INT64)buflen, (INT64)strlen(data), GetCurrentTimeMs());
-#ifdef _WIN32
-            fwrite(marker, 1, strlen(marker), m_logFileHandle);
-#else
-            write(fileno(m_logFileHandle), marker, strlen(marker));
-#endif
+            if (pos[i] >= size[i])
+               continue;
+            memcpy(&header, data[i] + pos[i], sizeof(LogRecordHeader));
+            if ((next == -1) || ((INT32)(header.seq - nextHeader.seq) < 0))
+            {
+               next = i;
+               memcpy(&nextHeader, &header, sizeof(LogRecordHeader));
+            }
          }
+         if (next == -1)
+            break;
 
-#ifdef _WIN32
-			fwrite(data, 1, strlen(data), m_logFileHandle);
-#else
-         // write is used here because on linux fwrite is not working
-         // after calling fwprintf on a stream
-			size_t size = strlen(data);
-			size_t offset = 0;
-			do
-			{
-			   int bw = write(fileno(m_logFileHandle), &data[offset], size);
-			   if (bw < 0)
-			      break;
-			   size -= bw;
-			   offset += bw;
-			} while(size > 0);
-#endif
-         free(data);
-
-	      // Check log size
-	      if ((m_logFileHandle != NULL) && (s_rotationMode == NXLOG_ROTATION_BY_SIZE) && (s_maxLogSize != 0))
-	      {
-	         NX_STAT_STRUCT st;
-		      NX_FSTAT(fileno(m_logFileHandle), &st);
-		      if ((UINT64)st.st_size >= s_maxLogSize)
-			      RotateLog(FALSE);
-	      }
+         memcpy(&output[outLen], data[next] + pos[next] + sizeof(LogRecordHeader), nextHeader.length * sizeof(TCHAR));
+         outLen += nextHeader.length;
+         pos[next] += sizeof(LogRecordHeader) + nextHeader.length * sizeof(TCHAR);
       }
-      else
+      output[outLen] = 0;
+
+      if (s_flags & NXLOG_PRINT_TO_STDOUT)
+         m_consoleWriter(_T("%s"), output);
+
+      char *text = UTF8StringFromTString(output);
+      size_t textLen = strlen(text);
+
+      if (s_flags & NXLOG_DEBUG_MODE)
       {
-         MutexUnlock(m_mutexLogAccess);
+         char marker[64];
+         sprintf(marker, "##(" INT64_FMTA ")" INT64_FMTA " @" INT64_FMTA "\n",
+                 (INT64)outLen, (INT64)textLen, GetCurrentTimeMs());
+         WriteToLogFile(marker, strlen(marker));
+         s_logFileSize += strlen(marker);
       }
+
+      WriteToLogFile(text, textLen);
+      s_logFileSize += textLen;
+      free(text);
+
+      // Check log size
+      if ((m_logFileHandle != NULL) && (s_rotationMode == NXLOG_ROTATION_BY_SIZE) && (s_maxLogSize != 0) && (s_logFileSize >= s_maxLogSize))
+         RotateLog(FALSE);
    }
+
+   for(int i = 0; i < LOG_BUFFER_SHARDS; i++)
+      free(data[i]);
+   free(output);
    return THREAD_OK;
 }
 
@@ -395,6 +751,10 @@ bool LIBNETXMS_EXPORTABLE nxlog_open(const TCHAR *logName, UINT32 flags,
                    FormatLogTimestamp(buffer), s_rotationMode, s_maxLogSize);
          fflush(m_logFileHandle);
 
+         NX_STAT_STRUCT st;
+         if (NX_FSTAT(fileno(m_logFileHandle), &st) == 0)
+            s_logFileSize = (UINT64)st.st_size;
+
 #ifndef _WIN32
          int fd = fileno(m_logFileHandle);
          fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
@@ -402,8 +762,16 @@ bool LIBNETXMS_EXPORTABLE nxlog_open(const TCHAR *logName, UINT32 flags,
 
          if (s_flags & NXLOG_BACKGROUND_WRITER)
          {
-            s_logBuffer.setAllocationStep(8192);
-            s_writerStopCondition = ConditionCreate(TRUE);
+            for(int i = 0; i < LOG_BUFFER_SHARDS; i++)
+            {
+               s_logShards[i].mutex = MutexCreate();
+               s_logShards[i].data = NULL;
+               s_logShards[i].size = 0;
+               s_logShards[i].allocated = 0;
+               s_logShards[i].dropped = 0;
+            }
+            s_writerStop = false;
+            s_writerWakeupCondition = ConditionCreate(FALSE);
             s_writerThread = ThreadCreateEx(BackgroundWriterThread, 0, NULL);
          }
       }
@@ -433,9 +801,17 @@ void LIBNETXMS_EXPORTABLE nxlog_close()
       {
          if (s_flags & NXLOG_BACKGROUND_WRITER)
          {
-            ConditionSet(s_writerStopCondition);
+            s_writerStop = true;
+            ConditionSet(s_writerWakeupCondition);
             ThreadJoin(s_writerThread);
-            ConditionDestroy(s_writerStopCondition);
+            ConditionDestroy(s_writerWakeupCondition);
+            s_writerWakeupCondition = INVALID_CONDITION_HANDLE;
+            for(int i = 0; i < LOG_BUFFER_SHARDS; i++)
+            {
+               MutexDestroy(s_logShards[i].mutex);
+               free(s_logShards[i].data);
+               s_logShards[i].data = NULL;
+            }
          }
          if (m_logFileHandle != NULL)
             fclose(m_logFileHandle);
@@ -475,15 +851,7 @@ static void WriteLogToFile(TCHAR *message, const WORD wType)
 
    if (s_flags & NXLOG_BACKGROUND_WRITER)
    {
-      MutexLock(m_mutexLogAccess);
-
-	   FormatLogTimestamp(buffer);
-      s_logBuffer.append(buffer);
-      s_logBuffer.append(_T(" "));
-      s_logBuffer.append(loglevel);
-      s_logBuffer.append(message);
-
-      MutexUnlock(m_mutexLogAccess);
+      AddToLogBuffer(FormatLogTimestamp(buffer), loglevel, message);
    }
    else
    {
@@ -500,20 +868,17 @@ static void WriteLogToFile(TCHAR *message, const WORD wType)
 	   FormatLogTimestamp(buffer);
       if (m_logFileHandle != NULL)
 	   {
-         _ftprintf(m_logFileHandle, _T("%s %s%s"), buffer, loglevel, message);
+         int len = _ftprintf(m_logFileHandle, _T("%s %s%s"), buffer, loglevel, message);
+         if (len > 0)
+            s_logFileSize += len;
 		   fflush(m_logFileHandle);
 	   }
       if (s_flags & NXLOG_PRINT_TO_STDOUT)
          m_consoleWriter(_T("%s %s%s"), buffer, loglevel, message);
 
-	   // Check log size
-	   if ((m_logFileHandle != NULL) && (s_rotationMode == NXLOG_ROTATION_BY_SIZE) && (s_maxLogSize != 0))
-	   {
-	      NX_STAT_STRUCT st;
-		   NX_FSTAT(fileno(m_logFileHandle), &st);
-		   if ((UINT64)st.st_size >= s_maxLogSize)
-			   RotateLog(FALSE);
-	   }
+	   // Check log size (size is tracked in characters written, so it is not exact for non-ASCII text)
+	   if ((m_logFileHandle != NULL) && (s_rotationMode == NXLOG_ROTATION_BY_SIZE) && (s_maxLogSize != 0) && (s_logFileSize >= s_maxLogSize))
+		   RotateLog(FALSE);
 
       MutexUnlock(m_mutexLogAccess);
    }
@@ -830,3 +1195,38 @@ void LIBNETXMS_EXPORTABLE nxlog_debug2(int level, const TCHAR *format, va_list a
    if (s_debugWriter != NULL)
       s_debugWriter(buffer);
 }
+
+/**
+ * Write debug message with tag
+ */
+void LIBNETXMS_EXPORTABLE nxlog_debug_tag2(const TCHAR *tag, int level, const TCHAR *format, va_list args)
+{
+   // Fast check - nothing is logged above highest configured level
+   if ((level > s_maxDebugLevel) || (level > nxlog_get_debug_level_tag(tag)))
+      return;
+
+   TCHAR buffer[8192];
+   int len = _sntprintf(buffer, 8192, _T("[%s] "), tag);
+   if ((len < 0) || (len >= 8192))
+      len = 0;
+   _vsntprintf(&buffer[len], 8192 - len, format, args);
+   buffer[8191] = 0;
+   nxlog_write(s_debugMsg, NXLOG_DEBUG, "s", buffer);
+
+   if (s_debugWriter != NULL)
+      s_debugWriter(buffer);
+}
+
+/**
+ * Write debug message with tag
+ */
+void LIBNETXMS_EXPORTABLE nxlog_debug_tag(const TCHAR *tag, int level, const TCHAR *format, ...)
+{
+   if (level > s_maxDebugLevel)
+      return;
+
+   va_list args;
+   va_start(args, format);
+   nxlog_debug_tag2(tag, level, format, args);
+   va_end(args);
+}
@@ -23,6 +23,7 @@
 
 #include "libnetxms.h"
 #include <nxcpapi.h>
+#include <uthash.h>
 
 /** 
  * Interval between checking messages TTL in milliseconds
@@ -34,6 +35,43 @@
  */
 #define ALLOCATION_STEP       16
 
+/**
+ * Thread waiting for message. Each waiter has it's own wakeup object so
+ * incoming message wakes up only one thread waiting for that message.
+ */
+struct WaitQueueWaiter
+{
+   WaitQueueWaiter *next;
+   bool signaled;
+#if defined(_WIN32)
+   int slot;
+#elif defined(_USE_GNU_PTH)
+   pth_cond_t condition;
+#else
+   pthread_cond_t condition;
+#endif
+};
+
+/**
+ * Index entry - messages and waiters for given message code and ID
+ */
+struct WaitQueueIndexEntry
+{
+   UT_hash_handle hh;
+   UINT64 key;
+   int head;      // first queued message (oldest)
+   int tail;      // last queued message
+   WaitQueueWaiter *waiters;
+};
+
+/**
+ * Build index key
+ */
+inline UINT64 IndexKey(UINT16 isBinary, UINT16 code, UINT32 id)
+{
+   return ((UINT64)isBinary << 48) | ((UINT64)code << 32) | (UINT64)id;
+}
+
 /**
  * Housekeeper data
  */
@@ -50,8 +88,12 @@ MsgWaitQueue::MsgWaitQueue()
    m_holdTime = 30000;      // Default message TTL is 30 seconds
    m_size = 0;
    m_allocated = 0;
+   m_firstFree = -1;
    m_elements = NULL;
-   m_sequence = 1;
+   m_index = NULL;
+   m_freeIndexEntries = NULL;
+   m_wakeups = 0;
+   m_spuriousWakeups = 0;
 #if defined(_WIN32)
    InitializeCriticalSectionAndSpinCount(&m_mutex, 4000);
    memset(m_wakeupEvents, 0, MAX_MSGQUEUE_WAITERS * sizeof(HANDLE));
@@ -59,10 +101,8 @@ MsgWaitQueue::MsgWaitQueue()
    memset(m_waiters, 0, MAX_MSGQUEUE_WAITERS);
 #elif defined(_USE_GNU_PTH)
    pth_mutex_init(&m_mutex);
-   pth_cond_init(&m_wakeupCondition);
 #else
    pthread_mutex_init(&m_mutex, NULL);
-   pthread_cond_init(&m_wakeupCondition, NULL);
 #endif
 
    // register new queue
@@ -90,6 +130,19 @@ MsgWaitQueue::~MsgWaitQueue()
    clear();
    safe_free(m_elements);
 
+   WaitQueueIndexEntry *entry, *tmp;
+   HASH_ITER(hh, m_index, entry, tmp)
+   {
+      HASH_DEL(m_index, entry);
+      free(entry);
+   }
+   while(m_freeIndexEntries != NULL)
+   {
+      entry = m_freeIndexEntries;
+      m_freeIndexEntries = (WaitQueueIndexEntry *)entry->hh.next;
+      free(entry);
+   }
+
 #if defined(_WIN32)
    DeleteCriticalSection(&m_mutex);
    for(int i = 0; i < MAX_MSGQUEUE_WAITERS; i++)
@@ -99,10 +152,29 @@ MsgWaitQueue::~MsgWaitQueue()
    // nothing to do if libpth is used
 #else
    pthread_mutex_destroy(&m_mutex);
-   pthread_cond_destroy(&m_wakeupCondition);
 #endif
 }
 
+/**
+ * Destroy queued message at given position and return element to free list.
+ * Element should be already unlinked from index.
+ */
+void MsgWaitQueue::destroyMessage(int index)
+{
+   if (m_elements[index].isBinary)
+   {
+      free(m_elements[index].msg);
+   }
+   else
+   {
+      delete (NXCPMessage *)(m_elements[index].msg);
+   }
+   m_elements[index].msg = NULL;
+   m_elements[index].next = m_firstFree;
+   m_firstFree = index;
+   m_size--;
+}
+
 /**
  * Clear queue
  */
@@ -126,92 +198,149 @@ void MsgWaitQueue::clear()
    }
    m_size = 0;
    m_allocated = 0;
+   m_firstFree = -1;
    safe_free_and_null(m_elements);
+
+   // Keep index entries only for active waiters
+   WaitQueueIndexEntry *entry, *tmp;
+   HASH_ITER(hh, m_index, entry, tmp)
+   {
+      entry->head = -1;
+      entry->tail = -1;
+      releaseIndexEntry(entry);
+   }
+
    unlock();
 }
 
 /**
- * Put message into queue
+ * Find index entry for given message code and ID. If entry does not exist and
+ * create is true new entry will be added. Queue must be locked by caller.
  */
-void MsgWaitQueue::put(NXCPMessage *pMsg)
+WaitQueueIndexEntry *MsgWaitQueue::getIndexEntry(UINT16 isBinary, UINT16 code, UINT32 id, bool create)
 {
-   lock();
-
-   int pos;
-   if (m_size == m_allocated)
+   UINT64 key = IndexKey(isBinary, code, id);
+   WaitQueueIndexEntry *entry;
+   HASH_FIND(hh, m_index, &key, sizeof(UINT64), entry);
+   if ((entry == NULL) && create)
    {
-      pos = m_allocated;
-      m_allocated += ALLOCATION_STEP;
-      m_elements = (WAIT_QUEUE_ELEMENT *)realloc(m_elements, sizeof(WAIT_QUEUE_ELEMENT) * m_allocated);
-      memset(&m_elements[pos], 0, sizeof(WAIT_QUEUE_ELEMENT) * ALLOCATION_STEP);
-   }
-   else
-   {
-      for(pos = 0; m_elements[pos].msg != NULL; pos++);
+      if (m_freeIndexEntries != NULL)
+      {
+         entry = m_freeIndexEntries;
+         m_freeIndexEntries = (WaitQueueIndexEntry *)entry->hh.next;
+      }
+      else
+      {
+         entry = (WaitQueueIndexEntry *)malloc(sizeof(WaitQueueIndexEntry));
+      }
+      memset(entry, 0, sizeof(WaitQueueIndexEntry));
+      entry->key = key;
+      entry->head = -1;
+      entry->tail = -1;
+      HASH_ADD(hh, m_index, key, sizeof(UINT64), entry);
    }
-	
-   m_elements[pos].code = pMsg->getCode();
-   m_elements[pos].isBinary = 0;
-   m_elements[pos].id = pMsg->getId();
-   m_elements[pos].ttl = m_holdTime;
-   m_elements[pos].msg = pMsg;
-   m_elements[pos].sequence = m_sequence++;
-   m_size++;
+   return entry;
+}
+
+/**
+ * Remove index entry if it has no queued messages and no waiters. Queue must be locked by caller.
+ */
+void MsgWaitQueue::releaseIndexEntry(WaitQueueIndexEntry *entry)
+{
+   if ((entry->head != -1) || (entry->waiters != NULL))
+      return;
+
+   HASH_DEL(m_index, entry);
+   entry->hh.next = m_freeIndexEntries;
+   m_freeIndexEntries = entry;
+}
+
+/**
+ * Wake up first waiter which is not signaled yet if there are messages in given index entry.
+ * Queue must be locked by caller.
+ */
+void MsgWaitQueue::wakeupWaiter(WaitQueueIndexEntry *entry)
+{
+   if (entry->head == -1)
+      return;
 
+   for(WaitQueueWaiter *w = entry->waiters; w != NULL; w = w->next)
+   {
+      if (!w->signaled)
+      {
+         w->signaled = true;
+         m_wakeups++;
 #if defined(_WIN32)
-   for(int i = 0; i < MAX_MSGQUEUE_WAITERS; i++)
-      if (m_waiters[i])
-         SetEvent(m_wakeupEvents[i]);
+         if (w->slot != -1)
+            SetEvent(m_wakeupEvents[w->slot]);
 #elif defined(_USE_GNU_PTH)
-   pth_cond_notify(&m_wakeupCondition, TRUE);
+         pth_cond_notify(&w->condition, FALSE);
 #else
-   pthread_cond_broadcast(&m_wakeupCondition);
+         pthread_cond_signal(&w->condition);
 #endif
-
-   unlock();
+         break;
+      }
+   }
 }
 
 /**
- * Put raw message into queue
+ * Put message into queue and wake up waiting thread
  */
-void MsgWaitQueue::put(NXCP_MESSAGE *pMsg)
+void MsgWaitQueue::putInternal(void *msg, UINT16 code, UINT32 id, UINT16 isBinary)
 {
    lock();
 
-   int pos;
-   if (m_size == m_allocated)
+   if (m_firstFree == -1)
    {
-      pos = m_allocated;
+      int pos = m_allocated;
       m_allocated += ALLOCATION_STEP;
       m_elements = (WAIT_QUEUE_ELEMENT *)realloc(m_elements, sizeof(WAIT_QUEUE_ELEMENT) * m_allocated);
       memset(&m_elements[pos], 0, sizeof(WAIT_QUEUE_ELEMENT) * ALLOCATION_STEP);
+      for(int i = pos; i < m_allocated - 1; i++)
+         m_elements[i].next = i + 1;
+      m_elements[m_allocated - 1].next = -1;
+      m_firstFree = pos;
    }
-   else
-   {
-      for(pos = 0; m_elements[pos].msg != NULL; pos++);
-   }
 
-   m_elements[pos].code = pMsg->code;
-   m_elements[pos].isBinary = 1;
-   m_elements[pos].id = pMsg->id;
+   int pos = m_firstFree;
+   m_firstFree = m_elements[pos].next;
+
+   m_elements[pos].code = code;
+   m_elements[pos].isBinary = isBinary;
+   m_elements[pos].id = id;
    m_elements[pos].ttl = m_holdTime;
-   m_elements[pos].msg = pMsg;
-   m_elements[pos].sequence = m_sequence++;
+   m_elements[pos].msg = msg;
+   m_elements[pos].next = -1;
    m_size++;
 
-#ifdef _WIN32
-   for(int i = 0; i < MAX_MSGQUEUE_WAITERS; i++)
-      if (m_waiters[i])
-         SetEvent(m_wakeupEvents[i]);
-#elif defined(_USE_GNU_PTH)
-   pth_cond_notify(&m_wakeupCondition, TRUE);
-#else
-   pthread_cond_broadcast(&m_wakeupCondition);
-#endif
+   WaitQueueIndexEntry *entry = getIndexEntry(isBinary, code, id, true);
+   if (entry->tail != -1)
+      m_elements[entry->tail].next = pos;
+   else
+      entry->head = pos;
+   entry->tail = pos;
+
+   wakeupWaiter(entry);
 
    unlock();
 }
 
+/**
+ * Put message into queue
+ */
+void MsgWaitQueue::put(NXCPMessage *pMsg)
+{
+   putInternal(pMsg, pMsg->getCode(), pMsg->getId(), 0);
+}
+
+/**
+ * Put raw message into queue
+ */
+void MsgWaitQueue::put(NXCP_MESSAGE *pMsg)
+{
+   putInternal(pMsg, pMsg->code, pMsg->id, 1);
+}
+
 /**
  * Wait for message with specific code and ID
  * Function return pointer to the message on success or
@@ -221,66 +350,72 @@ void *MsgWaitQueue::waitForMessageInternal(UINT16 isBinary, UINT16 wCode, UINT32
 {
    lock();
 
-#ifdef _WIN32
-   int slot = -1;
+   WaitQueueIndexEntry *entry = getIndexEntry(isBinary, wCode, dwId, true);
+
+   // Register as waiter
+   WaitQueueWaiter waiter;
+   waiter.next = NULL;
+   waiter.signaled = false;
+#if defined(_WIN32)
+   waiter.slot = -1;
+#elif defined(_USE_GNU_PTH)
+   pth_cond_init(&waiter.condition);
+#else
+   pthread_cond_init(&waiter.condition, NULL);
 #endif
+   WaitQueueWaiter **last = &entry->waiters;
+   while(*last != NULL)
+      last = &((*last)->next);
+   *last = &waiter;
 
-   do
+   void *msg = NULL;
+   while(true)
    {
-      UINT64 minSeq = _ULL(0xFFFFFFFFFFFFFFFF);
-      int index = -1;
-      for(int i = 0; i < m_allocated; i++)
-		{
-         if ((m_elements[i].msg != NULL) && 
-             (m_elements[i].id == dwId) &&
-             (m_elements[i].code == wCode) &&
-             (m_elements[i].isBinary == isBinary))
-         {
-            if (m_elements[i].sequence < minSeq)
-            {
-               minSeq = m_elements[i].sequence;
-               index = i;
-            }
-         }
-		}
-
-      if (index != -1)
+      if (entry->head != -1)
       {
-         void *msg = m_elements[index].msg;
+         int index = entry->head;
+         msg = m_elements[index].msg;
+         entry->head = m_elements[index].next;
+         if (entry->head == -1)
+            entry->tail = -1;
          m_elements[index].msg = NULL;
+         m_elements[index].next = m_firstFree;
+         m_firstFree = index;
          m_size--;
-#ifdef _WIN32
-         if (slot != -1)
-            m_waiters[slot] = 0;    // release waiter slot
-#endif
-         unlock();
-         return msg;
+         break;
       }
 
+      if (waiter.signaled)
+      {
+         m_spuriousWakeups++;   // message was taken by another thread
+         waiter.signaled = false;
+      }
+
+      if (dwTimeOut == 0)
+         break;
+
       INT64 startTime = GetCurrentTimeMs();
-       
+
 #if defined(_WIN32)
       // Find free slot if needed
-      if (slot == -1)
+      if (waiter.slot == -1)
       {
-         for(slot = 0; slot < MAX_MSGQUEUE_WAITERS; slot++)
-            if (!m_waiters[slot])
+         for(int i = 0; i < MAX_MSGQUEUE_WAITERS; i++)
+            if (!m_waiters[i])
             {
-               m_waiters[slot] = 1;
-               if (m_wakeupEvents[slot] == NULL)
-                  m_wakeupEvents[slot] = CreateEvent(NULL, FALSE, FALSE, NULL);
+               m_waiters[i] = 1;
+               if (m_wakeupEvents[i] == NULL)
+                  m_wakeupEvents[i] = CreateEvent(NULL, FALSE, FALSE, NULL);
+               else
+                  ResetEvent(m_wakeupEvents[i]);
+               waiter.slot = i;
                break;
             }
-
-         if (slot == MAX_MSGQUEUE_WAITERS)
-         {
-            slot = -1;
-         }
       }
 
       LeaveCriticalSection(&m_mutex);
-      if (slot != -1)
-         WaitForSingleObject(m_wakeupEvents[slot], dwTimeOut);
+      if (waiter.slot != -1)
+         WaitForSingleObject(m_wakeupEvents[waiter.slot], dwTimeOut);
       else
          Sleep(50);  // Just sleep if there are no waiter slots (highly unlikely during normal operation)
       EnterCriticalSection(&m_mutex);
@@ -290,13 +425,13 @@ void *MsgWaitQueue::waitForMessageInternal(UINT16 isBinary, UINT16 wCode, UINT32
 	   ts.tv_sec = dwTimeOut / 1000;
 	   ts.tv_nsec = (dwTimeOut % 1000) * 1000000;
 #ifdef _NETWARE
-	   pthread_cond_timedwait(&m_wakeupCondition, &m_mutex, &ts);
+	   pthread_cond_timedwait(&waiter.condition, &m_mutex, &ts);
 #else
-      pthread_cond_reltimedwait_np(&m_wakeupCondition, &m_mutex, &ts);
+      pthread_cond_reltimedwait_np(&waiter.condition, &m_mutex, &ts);
 #endif
 #elif defined(_USE_GNU_PTH)
       pth_event_t ev = pth_event(PTH_EVENT_TIME, pth_timeout(dwTimeOut / 1000, (dwTimeOut % 1000) * 1000));
-      pth_cond_await(&m_wakeupCondition, &m_mutex, ev);
+      pth_cond_await(&waiter.condition, &m_mutex, ev);
       pth_event_free(ev, PTH_FREE_ALL);
 #else
 	   struct timeval now;
@@ -309,20 +444,31 @@ void *MsgWaitQueue::waitForMessageInternal(UINT16 isBinary, UINT16 wCode, UINT32
 	   ts.tv_sec += now.tv_usec / 1000000;
 	   ts.tv_nsec = (now.tv_usec % 1000000) * 1000;
 
-	   pthread_cond_timedwait(&m_wakeupCondition, &m_mutex, &ts);
+	   pthread_cond_timedwait(&waiter.condition, &m_mutex, &ts);
 #endif   /* _WIN32 */
 
       UINT32 sleepTime = (UINT32)(GetCurrentTimeMs() - startTime);
       dwTimeOut -= min(sleepTime, dwTimeOut);
-   } while(dwTimeOut > 0);
+   }
 
-#ifdef _WIN32
-   if (slot != -1)
-      m_waiters[slot] = 0;    // release waiter slot
+   // Unregister waiter
+   for(last = &entry->waiters; *last != &waiter; last = &((*last)->next));
+   *last = waiter.next;
+#if defined(_WIN32)
+   if (waiter.slot != -1)
+      m_waiters[waiter.slot] = 0;    // release waiter slot
+#elif defined(_USE_GNU_PTH)
+   // nothing to do if libpth is used
+#else
+   pthread_cond_destroy(&waiter.condition);
 #endif
 
+   // Pass remaining messages to other waiters
+   wakeupWaiter(entry);
+   releaseIndexEntry(entry);
+
    unlock();
-   return NULL;
+   return msg;
 }
 
 /**
@@ -333,29 +479,33 @@ void MsgWaitQueue::housekeeperRun()
    lock();
    if (m_size > 0)
    {
-      for(int i = 0; i < m_allocated; i++)
-	   {
-         if (m_elements[i].msg == NULL)
-            continue;
-
-         if (m_elements[i].ttl <= TTL_CHECK_INTERVAL)
+      WaitQueueIndexEntry *entry, *tmp;
+      HASH_ITER(hh, m_index, entry, tmp)
+      {
+         int prev = -1;
+         int curr = entry->head;
+         while(curr != -1)
          {
-            if (m_elements[i].isBinary)
+            int next = m_elements[curr].next;
+            if (m_elements[curr].ttl <= TTL_CHECK_INTERVAL)
             {
-               safe_free(m_elements[i].msg);
+               if (prev != -1)
+                  m_elements[prev].next = next;
+               else
+                  entry->head = next;
+               if (entry->tail == curr)
+                  entry->tail = prev;
+               destroyMessage(curr);
             }
             else
             {
-               delete (NXCPMessage *)(m_elements[i].msg);
+               m_elements[curr].ttl -= TTL_CHECK_INTERVAL;
+               prev = curr;
             }
-            m_elements[i].msg = NULL;
-            m_size--;
+            curr = next;
          }
-         else
-         {
-            m_elements[i].ttl -= TTL_CHECK_INTERVAL;
-         }
-	   }
+         releaseIndexEntry(entry);
+      }
 
       // compact queue if possible
       if ((m_allocated > ALLOCATION_STEP) && (m_size == 0))
@@ -363,6 +513,10 @@ void MsgWaitQueue::housekeeperRun()
          m_allocated = ALLOCATION_STEP;
          free(m_elements);
          m_elements = (WAIT_QUEUE_ELEMENT *)calloc(m_allocated, sizeof(WAIT_QUEUE_ELEMENT));
+         for(int i = 0; i < m_allocated - 1; i++)
+            m_elements[i].next = i + 1;
+         m_elements[m_allocated - 1].next = -1;
+         m_firstFree = 0;
       }
    }
    unlock();
@@ -414,7 +568,8 @@ EnumerationCallbackResult MsgWaitQueue::diagInfoCallback(const void *key, const
 {
    MsgWaitQueue *q = (MsgWaitQueue *)object;
    TCHAR buffer[256];
-   _sntprintf(buffer, 256, _T("   %p size=%d holdTime=%d\n"), q, q->m_size, q->m_holdTime);
+   _sntprintf(buffer, 256, _T("   %p size=%d holdTime=%d wakeups=") UINT64_FMT _T(" spuriousWakeups=") UINT64_FMT _T("\n"),
+              q, q->m_size, q->m_holdTime, q->m_wakeups, q->m_spuriousWakeups);
    ((String *)arg)->append(buffer);
    return _CONTINUE;
 }
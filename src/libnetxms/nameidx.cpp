@@ -0,0 +1,180 @@
+/*
+** NetXMS - Network Management System
+** NetXMS Foundation Library
+** Copyright (C) 2003-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published
+** by the Free Software Foundation; either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: nameidx.cpp
+**
+**/
+
+#include "libnetxms.h"
+
+/**
+ * Maximum length of indexed part of the name
+ */
+#define MAX_KEY_LENGTH  256
+
+/**
+ * Constructor
+ */
+WildcardNameIndex::WildcardNameIndex() : m_keys(true)
+{
+   m_keys.setIgnoreCase(false);
+}
+
+/**
+ * Destructor
+ */
+WildcardNameIndex::~WildcardNameIndex()
+{
+}
+
+/**
+ * Get index key for given name (part before argument list converted to upper case).
+ * Returns false if key cannot be used for hash lookup (contains wildcards or too long).
+ */
+bool WildcardNameIndex::getKey(const TCHAR *name, TCHAR *key, size_t size)
+{
+   size_t i;
+   for(i = 0; (name[i] != 0) && (name[i] != _T('(')); i++)
+   {
+      if ((name[i] == _T('*')) || (name[i] == _T('?')) || (i == size - 1))
+         return false;
+      key[i] = name[i];
+   }
+   key[i] = 0;
+   _tcsupr(key);
+   return true;
+}
+
+/**
+ * Add name to index. Returns ID assigned to new name.
+ */
+int WildcardNameIndex::add(const TCHAR *name)
+{
+   int id = m_names.size();
+   TCHAR *uname = _tcsdup(name);
+   _tcsupr(uname);
+   m_names.addPreallocated(uname);
+
+   TCHAR key[MAX_KEY_LENGTH];
+   if (getKey(name, key, MAX_KEY_LENGTH))
+   {
+      IntegerArray<INT32> *ids = m_keys.get(key);
+      if (ids == NULL)
+      {
+         ids = new IntegerArray<INT32>(4, 4);
+         m_keys.set(key, ids);
+      }
+      ids->add(id);
+   }
+   else
+   {
+      m_patterns.add(id);
+   }
+   return id;
+}
+
+/**
+ * Remove all names from index
+ */
+void WildcardNameIndex::clear()
+{
+   m_names.clear();
+   m_keys.clear();
+   m_patterns.clear();
+}
+
+/**
+ * Find first name matching given string. Returns ID of matching name or -1 if there are no match.
+ */
+int WildcardNameIndex::find(const TCHAR *name) const
+{
+   TCHAR buffer[MAX_KEY_LENGTH];
+   size_t len = _tcslen(name);
+   TCHAR *uname = (len < MAX_KEY_LENGTH) ? buffer : (TCHAR *)malloc((len + 1) * sizeof(TCHAR));
+   memcpy(uname, name, (len + 1) * sizeof(TCHAR));
+   _tcsupr(uname);
+
+   int result = -1;
+
+   TCHAR key[MAX_KEY_LENGTH];
+   if (getKey(uname, key, MAX_KEY_LENGTH))
+   {
+      IntegerArray<INT32> *ids = m_keys.get(key);
+      if (ids != NULL)
+      {
+         for(int i = 0; i < ids->size(); i++)
+         {
+            INT32 id = ids->get(i);
+            if (MatchString(m_names.get(id), uname, true))
+            {
+               result = id;
+               break;
+            }
+         }
+      }
+   }
+
+   // Patterns added before found name take precedence
+   for(int i = 0; i < m_patterns.size(); i++)
+   {
+      INT32 id = m_patterns.get(i);
+      if ((result != -1) && (id > result))
+         break;
+      if (MatchString(m_names.get(id), uname, true))
+      {
+         result = id;
+         break;
+      }
+   }
+
+   if (uname != buffer)
+      free(uname);
+   return result;
+}
+
+/**
+ * Find name equal to given one (ignoring case). Returns ID of found name or -1.
+ */
+int WildcardNameIndex::findExact(const TCHAR *name) const
+{
+   TCHAR key[MAX_KEY_LENGTH];
+   if (getKey(name, key, MAX_KEY_LENGTH))
+   {
+      IntegerArray<INT32> *ids = m_keys.get(key);
+      if (ids != NULL)
+      {
+         for(int i = 0; i < ids->size(); i++)
+         {
+            INT32 id = ids->get(i);
+            if (!_tcsicmp(m_names.get(id), name))
+               return id;
+         }
+      }
+   }
+   else
+   {
+      for(int i = 0; i < m_patterns.size(); i++)
+      {
+         INT32 id = m_patterns.get(i);
+         if (!_tcsicmp(m_names.get(id), name))
+            return id;
+      }
+   }
+   return -1;
+}
@@ -27,6 +27,11 @@
 #include <share.h>
 #endif
 
+#if HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
+
 
 #if defined(_WIN32)
 #define NX_STAT _tstati64
@@ -427,172 +432,517 @@ static void SeekToZero(int fh, int chsize)
 }
 
 /**
- * File parser thread
+ * Open monitored file. Returns true if file was successfully opened.
  */
-bool LogParser::monitorFile(CONDITION stopCondition, bool readFromCurrPos)
+bool LogParser::openMonitoredFile()
 {
-	TCHAR fname[MAX_PATH], temp[MAX_PATH];
-	NX_STAT_STRUCT st, stn;
-	size_t size;
-	int fh;
-	bool readFromStart = !readFromCurrPos;
+	NX_STAT_STRUCT st;
 
-	if (m_fileName == NULL)
+	ExpandFileName(getFileName(), m_currentFile, MAX_PATH, true);
+	if (CALL_STAT(m_currentFile, &st) != 0)
 	{
-		LogParserTrace(0, _T("LogParser: parser thread will not start, file name not set"));
+		setStatus(LPS_NO_FILE);
 		return false;
 	}
 
-	LogParserTrace(0, _T("LogParser: parser thread for file \"%s\" started"), m_fileName);
-	while(true)
-	{
-		ExpandFileName(getFileName(), fname, MAX_PATH, true);
-		if (CALL_STAT(fname, &st) == 0)
-		{
 #ifdef _WIN32
-			fh = _tsopen(fname, O_RDONLY, _SH_DENYNO);
+	m_fileHandle = _tsopen(m_currentFile, O_RDONLY, _SH_DENYNO);
 #else
-			fh = _topen(fname, O_RDONLY);
+	m_fileHandle = _topen(m_currentFile, O_RDONLY);
 #endif
-			if (fh != -1)
-			{
-				setStatus(LPS_RUNNING);
-				LogParserTrace(3, _T("LogParser: file \"%s\" (pattern \"%s\") successfully opened"), fname, m_fileName);
+	if (m_fileHandle == -1)
+	{
+		setStatus(LPS_OPEN_ERROR);
+		return false;
+	}
 
-            if (m_fileEncoding == -1)
-            {
-               m_fileEncoding = ScanFileEncoding(fh);
-               lseek(fh, 0, SEEK_SET);
-            }
+	setStatus(LPS_RUNNING);
+	LogParserTrace(3, _T("LogParser: file \"%s\" (pattern \"%s\") successfully opened"), m_currentFile, m_fileName);
 
-				size = (size_t)st.st_size;
-				if (readFromStart)
-				{
-					LogParserTrace(5, _T("LogParser: parsing existing records in file \"%s\""), fname);
-					off_t resetPos = ParseNewRecords(this, fh);
-               lseek(fh, resetPos, SEEK_SET);
-				}
-				else if (m_preallocatedFile)
-				{
-				   SeekToZero(fh, getCharSize());
-				}
-				else
-				{
-					lseek(fh, 0, SEEK_END);
-				}
+   if (m_fileEncoding == -1)
+   {
+      m_fileEncoding = ScanFileEncoding(m_fileHandle);
+      lseek(m_fileHandle, 0, SEEK_SET);
+   }
 
-				while(true)
-				{
-					if (ConditionWait(stopCondition, 5000))
-						goto stop_parser;
+	m_fileSize = (size_t)st.st_size;
+	if (m_readFromStart)
+	{
+		LogParserTrace(5, _T("LogParser: parsing existing records in file \"%s\""), m_currentFile);
+		off_t resetPos = ParseNewRecords(this, m_fileHandle);
+      lseek(m_fileHandle, resetPos, SEEK_SET);
+	}
+	else if (m_preallocatedFile)
+	{
+	   SeekToZero(m_fileHandle, getCharSize());
+	}
+	else
+	{
+		lseek(m_fileHandle, 0, SEEK_END);
+	}
+	return true;
+}
 
-					// Check if file name was changed
-					ExpandFileName(getFileName(), temp, MAX_PATH, true);
-					if (_tcscmp(temp, fname))
-					{
-						LogParserTrace(5, _T("LogParser: file name change for \"%s\" (\"%s\" -> \"%s\")"), m_fileName, fname, temp);
-						readFromStart = true;
-						break;
-					}
+/**
+ * Close monitored file
+ */
+void LogParser::closeMonitoredFile()
+{
+   if (m_fileHandle != -1)
+   {
+      _close(m_fileHandle);
+      m_fileHandle = -1;
+   }
+}
+
+/**
+ * Check monitored file for new records, name change, and rotation.
+ * Returns false if file was closed and should be re-opened.
+ */
+bool LogParser::checkMonitoredFile()
+{
+	TCHAR temp[MAX_PATH];
+	NX_STAT_STRUCT st, stn;
+
+	// Check if file name was changed
+	ExpandFileName(getFileName(), temp, MAX_PATH, true);
+	if (_tcscmp(temp, m_currentFile))
+	{
+		LogParserTrace(5, _T("LogParser: file name change for \"%s\" (\"%s\" -> \"%s\")"), m_fileName, m_currentFile, temp);
+		m_readFromStart = true;
+		closeMonitoredFile();
+		return false;
+	}
 
 #ifdef _NETWARE
-					if (fgetstat(fh, &st, ST_SIZE_BIT | ST_NAME_BIT) < 0)
-					{
-						LogParserTrace(1, _T("LogParser: fgetstat(%d) failed, errno=%d"), fh, errno);
-						readFromStart = true;
-						break;
-					}
+	if (fgetstat(m_fileHandle, &st, ST_SIZE_BIT | ST_NAME_BIT) < 0)
+	{
+		LogParserTrace(1, _T("LogParser: fgetstat(%d) failed, errno=%d"), m_fileHandle, errno);
+		m_readFromStart = true;
+		closeMonitoredFile();
+		return false;
+	}
 #else
-					if (NX_FSTAT(fh, &st) < 0)
-					{
-						LogParserTrace(1, _T("LogParser: fstat(%d) failed, errno=%d"), fh, errno);
-						readFromStart = true;
-						break;
-					}
+	if (NX_FSTAT(m_fileHandle, &st) < 0)
+	{
+		LogParserTrace(1, _T("LogParser: fstat(%d) failed, errno=%d"), m_fileHandle, errno);
+		m_readFromStart = true;
+		closeMonitoredFile();
+		return false;
+	}
 #endif
 
-					if (CALL_STAT(fname, &stn) < 0)
-					{
-						LogParserTrace(1, _T("LogParser: stat(%s) failed, errno=%d"), fname, errno);
-						readFromStart = true;
-						break;
-					}
-
+	bool rotated = false;
+	if (CALL_STAT(m_currentFile, &stn) < 0)
+	{
+		LogParserTrace(1, _T("LogParser: stat(%s) failed, errno=%d"), m_currentFile, errno);
+		rotated = true;
+	}
 #ifdef _WIN32
-					if (st.st_ctime != stn.st_ctime)
-					{
-						LogParserTrace(3, _T("LogParser: creation time for fstat(%d) is not equal to creation time for stat(%s), assume file rename"), fh, fname);
-						readFromStart = true;
-						break;
-					}
+	else if (st.st_ctime != stn.st_ctime)
+	{
+		LogParserTrace(3, _T("LogParser: creation time for fstat(%d) is not equal to creation time for stat(%s), assume file rename"), m_fileHandle, m_currentFile);
+		rotated = true;
+	}
 #else
-					if ((st.st_ino != stn.st_ino) || (st.st_dev != stn.st_dev))
-					{
-						LogParserTrace(3, _T("LogParser: file device or inode differs for stat(%d) and fstat(%s), assume file rename"), fh, fname);
-						readFromStart = true;
-						break;
-					}
+	else if ((st.st_ino != stn.st_ino) || (st.st_dev != stn.st_dev))
+	{
+		LogParserTrace(3, _T("LogParser: file device or inode differs for stat(%d) and fstat(%s), assume file rename"), m_fileHandle, m_currentFile);
+		rotated = true;
+	}
 #endif
+	if (rotated)
+	{
+		// Old file is still accessible via open handle, so read records
+		// written to it before rotation
+		if ((size_t)st.st_size > m_fileSize)
+			ParseNewRecords(this, m_fileHandle);
+		m_readFromStart = true;
+		closeMonitoredFile();
+		return false;
+	}
 
-					if ((size_t)st.st_size != size)
-					{
-						if ((size_t)st.st_size < size)
-						{
-							// File was cleared, start from the beginning
-							lseek(fh, 0, SEEK_SET);
-							LogParserTrace(3, _T("LogParser: file \"%s\" st_size != size"), fname);
-						}
-						size = (size_t)st.st_size;
-						LogParserTrace(6, _T("LogParser: new data available in file \"%s\""), fname);
-						off_t resetPos = ParseNewRecords(this, fh);
-						lseek(fh, resetPos, SEEK_SET);
-					}
-					else if (m_preallocatedFile)
-					{
-					   char buffer[4];
-					   int bytes = _read(fh, buffer, 4);
-					   if ((bytes == 4) && memcmp(buffer, "\x00\x00\x00\x00", 4))
-					   {
-                     lseek(fh, -4, SEEK_CUR);
-	                  LogParserTrace(6, _T("LogParser: new data available in file \"%s\""), fname);
-	                  off_t resetPos = ParseNewRecords(this, fh);
-	                  lseek(fh, resetPos, SEEK_SET);
-					   }
-					   else
-					   {
-                     off_t pos = lseek(fh, -bytes, SEEK_CUR);
-                     if (pos > 0)
-                     {
-                        int readSize = min(pos, 4);
-                        lseek(fh, -readSize, SEEK_CUR);
-                        int bytes = _read(fh, buffer, readSize);
-                        if (!memcmp(buffer, "\x00\x00\x00\x00", readSize))
-                        {
-                           LogParserTrace(6, _T("LogParser: detected reset of preallocated file \"%s\""), fname);
-                           lseek(fh, 0, SEEK_SET);
-                           off_t resetPos = ParseNewRecords(this, fh);
-                           lseek(fh, resetPos, SEEK_SET);
-                        }
-                     }
-					   }
-					}
-				}
-				_close(fh);
-			}
-			else
-			{
-				setStatus(LPS_OPEN_ERROR);
-			}
-		}
-		else
+	if ((size_t)st.st_size != m_fileSize)
+	{
+		if ((size_t)st.st_size < m_fileSize)
 		{
-			setStatus(LPS_NO_FILE);
-			if (ConditionWait(stopCondition, 10000))
-				break;
+			// File was cleared, start from the beginning
+			lseek(m_fileHandle, 0, SEEK_SET);
+			LogParserTrace(3, _T("LogParser: file \"%s\" st_size != size"), m_currentFile);
 		}
+		m_fileSize = (size_t)st.st_size;
+		LogParserTrace(6, _T("LogParser: new data available in file \"%s\""), m_currentFile);
+		off_t resetPos = ParseNewRecords(this, m_fileHandle);
+		lseek(m_fileHandle, resetPos, SEEK_SET);
 	}
+	else if (m_preallocatedFile)
+	{
+	   char buffer[4];
+	   int bytes = _read(m_fileHandle, buffer, 4);
+	   if ((bytes == 4) && memcmp(buffer, "\x00\x00\x00\x00", 4))
+	   {
+         lseek(m_fileHandle, -4, SEEK_CUR);
+         LogParserTrace(6, _T("LogParser: new data available in file \"%s\""), m_currentFile);
+         off_t resetPos = ParseNewRecords(this, m_fileHandle);
+         lseek(m_fileHandle, resetPos, SEEK_SET);
+	   }
+	   else
+	   {
+         off_t pos = lseek(m_fileHandle, -bytes, SEEK_CUR);
+         if (pos > 0)
+         {
+            int readSize = min(pos, 4);
+            lseek(m_fileHandle, -readSize, SEEK_CUR);
+            int bytes = _read(m_fileHandle, buffer, readSize);
+            if (!memcmp(buffer, "\x00\x00\x00\x00", readSize))
+            {
+               LogParserTrace(6, _T("LogParser: detected reset of preallocated file \"%s\""), m_currentFile);
+               lseek(m_fileHandle, 0, SEEK_SET);
+               off_t resetPos = ParseNewRecords(this, m_fileHandle);
+               lseek(m_fileHandle, resetPos, SEEK_SET);
+            }
+         }
+	   }
+	}
+	return true;
+}
+
+#if HAVE_SYS_INOTIFY_H
+
+/**
+ * Events on directory entries which may indicate new data, rotation, or file (re)creation
+ */
+#define NOTIFY_EVENT_MASK  (IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_DELETE_SELF)
+
+/**
+ * Set inotify watch on directory containing current file. Watching directory instead of
+ * file itself allows detection of file rotation and re-creation without polling.
+ */
+void LogParser::updateFileWatch(int notifyHandle, ObjectArray<LogParser> *parsers)
+{
+   TCHAR dir[MAX_PATH];
+   nx_strncpy(dir, m_currentFile, MAX_PATH);
+   TCHAR *s = _tcsrchr(dir, FS_PATH_SEPARATOR_CHAR);
+   if (s == dir)
+      *(s + 1) = 0;
+   else if (s != NULL)
+      *s = 0;
+   else
+      _tcscpy(dir, _T("."));
+
+#ifdef UNICODE
+   char *mbdir = MBStringFromWideString(dir);
+   int wd = inotify_add_watch(notifyHandle, mbdir, NOTIFY_EVENT_MASK);
+   free(mbdir);
+#else
+   int wd = inotify_add_watch(notifyHandle, dir, NOTIFY_EVENT_MASK);
+#endif
+   if (wd == m_watchDescriptor)
+      return;
+
+   if (wd == -1)
+      LogParserTrace(4, _T("LogParser: cannot set watch on directory \"%s\" (%s)"), dir, _tcserror(errno));
+   else
+      LogParserTrace(6, _T("LogParser: watching directory \"%s\" for changes in file \"%s\""), dir, m_currentFile);
+
+   // Re-check file on next iteration in case it was changed before watch was set
+   m_fileChanged = true;
+
+   // Remove old watch if no other parser is using it
+   int oldWatch = m_watchDescriptor;
+   m_watchDescriptor = wd;
+   if (oldWatch != -1)
+   {
+      for(int i = 0; i < parsers->size(); i++)
+         if (parsers->get(i)->m_watchDescriptor == oldWatch)
+            return;
+      inotify_rm_watch(notifyHandle, oldWatch);
+   }
+}
+
+/**
+ * Wakeup pipe of running file monitor
+ */
+struct FileMonitorWakeup
+{
+   CONDITION stopCondition;
+   int writeHandle;
+};
+
+/**
+ * Wakeup pipes of all running file monitors
+ */
+static StructArray<FileMonitorWakeup> s_fileMonitors(4, 4);
+static MUTEX s_fileMonitorsLock = MutexCreate();
+
+/**
+ * Register wakeup pipe for file monitor
+ */
+static void RegisterFileMonitor(CONDITION stopCondition, int writeHandle)
+{
+   FileMonitorWakeup w;
+   w.stopCondition = stopCondition;
+   w.writeHandle = writeHandle;
+   MutexLock(s_fileMonitorsLock);
+   s_fileMonitors.add(&w);
+   MutexUnlock(s_fileMonitorsLock);
+}
+
+/**
+ * Unregister wakeup pipe for file monitor
+ */
+static void UnregisterFileMonitor(int writeHandle)
+{
+   MutexLock(s_fileMonitorsLock);
+   for(int i = 0; i < s_fileMonitors.size(); i++)
+   {
+      if (s_fileMonitors.get(i)->writeHandle == writeHandle)
+      {
+         s_fileMonitors.remove(i);
+         break;
+      }
+   }
+   MutexUnlock(s_fileMonitorsLock);
+}
+
+/**
+ * Wait for inotify events and mark affected parsers. Blocks until inotify event,
+ * wakeup by stopFileMonitoring(), or timeout. Returns true if stop condition is set.
+ */
+bool LogParser::waitForFileEvents(int notifyHandle, int wakeupHandle, ObjectArray<LogParser> *parsers, CONDITION stopCondition, UINT32 timeout)
+{
+   // Stop may be requested before wakeup pipe was registered
+   if (ConditionWait(stopCondition, 0))
+      return true;
+
+   struct pollfd pfd[2];
+   pfd[0].fd = notifyHandle;
+   pfd[0].events = POLLIN;
+   pfd[0].revents = 0;
+   pfd[1].fd = wakeupHandle;
+   pfd[1].events = POLLIN;
+   pfd[1].revents = 0;
+   if (poll(pfd, (wakeupHandle != -1) ? 2 : 1, (int)timeout) <= 0)
+      return ConditionWait(stopCondition, 0);
+
+   if (pfd[1].revents & POLLIN)
+   {
+      char buffer[64];
+      while(read(wakeupHandle, buffer, sizeof(buffer)) > 0);
+   }
+
+   if (pfd[0].revents & POLLIN)
+   {
+      UINT64 buffer[1024];  // aligned for struct inotify_event
+      ssize_t bytes;
+      while((bytes = read(notifyHandle, buffer, sizeof(buffer))) > 0)
+      {
+         for(char *curr = (char *)buffer; curr < (char *)buffer + bytes; )
+         {
+            struct inotify_event *e = (struct inotify_event *)curr;
+            curr += sizeof(struct inotify_event) + e->len;
+
+            if (e->mask & IN_Q_OVERFLOW)
+            {
+               LogParserTrace(4, _T("LogParser: inotify event queue overflow"));
+               for(int i = 0; i < parsers->size(); i++)
+                  parsers->get(i)->m_fileChanged = true;
+               continue;
+            }
+
+            TCHAR name[MAX_PATH];
+            if (e->len > 0)
+            {
+#ifdef UNICODE
+               MultiByteToWideChar(CP_ACP, MB_PRECOMPOSED, e->name, -1, name, MAX_PATH);
+#else
+               nx_strncpy(name, e->name, MAX_PATH);
+#endif
+            }
+            else
+            {
+               name[0] = 0;
+            }
+
+            for(int i = 0; i < parsers->size(); i++)
+            {
+               LogParser *p = parsers->get(i);
+               if (p->m_watchDescriptor != e->wd)
+                  continue;
+               if (e->mask & IN_IGNORED)
+               {
+                  // Watched directory was deleted or unmounted
+                  p->m_watchDescriptor = -1;
+                  p->m_fileChanged = true;
+                  continue;
+               }
+               if (e->len == 0)
+               {
+                  p->m_fileChanged = true;   // event on directory itself
+                  continue;
+               }
+               const TCHAR *fname = _tcsrchr(p->m_currentFile, FS_PATH_SEPARATOR_CHAR);
+               fname = (fname != NULL) ? fname + 1 : p->m_currentFile;
+               if (!_tcscmp(fname, name))
+                  p->m_fileChanged = true;
+            }
+         }
+      }
+   }
+   return ConditionWait(stopCondition, 0);
+}
+
+#endif   /* HAVE_SYS_INOTIFY_H */
+
+/**
+ * Stop file monitors using given stop condition. Sets stop condition and wakes up
+ * monitors blocked waiting for inotify events.
+ */
+void LogParser::stopFileMonitoring(CONDITION stopCondition)
+{
+   ConditionSet(stopCondition);
+#if HAVE_SYS_INOTIFY_H
+   MutexLock(s_fileMonitorsLock);
+   for(int i = 0; i < s_fileMonitors.size(); i++)
+   {
+      FileMonitorWakeup *w = s_fileMonitors.get(i);
+      if (w->stopCondition == stopCondition)
+         write(w->writeHandle, "S", 1);
+   }
+   MutexUnlock(s_fileMonitorsLock);
+#endif
+}
 
-stop_parser:
-	LogParserTrace(0, _T("LogParser: parser thread for file \"%s\" stopped"), m_fileName);
+/**
+ * Interval between forced checks of all files when inotify is in use (seconds).
+ * Needed to detect changes not reported by inotify, like file name change
+ * due to macro expansion.
+ */
+#define FORCED_CHECK_INTERVAL    30
+
+/**
+ * Monitor set of files. Uses inotify where available to react on changes
+ * immediately, otherwise all files are polled every 5 seconds. When inotify
+ * is used, monitor should be stopped by stopFileMonitoring() - setting stop
+ * condition alone will be noticed only on next forced check.
+ */
+bool LogParser::monitorFiles(ObjectArray<LogParser> *parsers, CONDITION stopCondition, bool readFromCurrPos)
+{
+   int count = 0;
+   for(int i = 0; i < parsers->size(); i++)
+   {
+      LogParser *p = parsers->get(i);
+      p->m_fileHandle = -1;
+      p->m_readFromStart = !readFromCurrPos;
+      p->m_fileChanged = true;
+      p->m_watchDescriptor = -1;
+      if (p->m_fileName == NULL)
+      {
+         LogParserTrace(0, _T("LogParser: parser \"%s\" will not start, file name not set"), CHECK_NULL(p->m_name));
+         continue;
+      }
+      LogParserTrace(0, _T("LogParser: parser thread for file \"%s\" started"), p->m_fileName);
+      count++;
+   }
+   if (count == 0)
+      return false;
+
+#if HAVE_SYS_INOTIFY_H
+   int notifyHandle = inotify_init();
+   int wakeupPipe[2] = { -1, -1 };
+   if (notifyHandle != -1)
+   {
+      fcntl(notifyHandle, F_SETFL, fcntl(notifyHandle, F_GETFL) | O_NONBLOCK);
+      if (pipe(wakeupPipe) == 0)
+      {
+         fcntl(wakeupPipe[0], F_SETFL, fcntl(wakeupPipe[0], F_GETFL) | O_NONBLOCK);
+         fcntl(wakeupPipe[1], F_SETFL, fcntl(wakeupPipe[1], F_GETFL) | O_NONBLOCK);
+         RegisterFileMonitor(stopCondition, wakeupPipe[1]);
+      }
+      else
+      {
+         LogParserTrace(3, _T("LogParser: cannot create wakeup pipe (%s)"), _tcserror(errno));
+         wakeupPipe[0] = -1;
+         wakeupPipe[1] = -1;
+      }
+      LogParserTrace(3, _T("LogParser: using inotify for monitoring %d file(s)"), count);
+   }
+   else
+   {
+      LogParserTrace(3, _T("LogParser: inotify_init() failed (%s), using polling"), _tcserror(errno));
+   }
+#else
+   int notifyHandle = -1;
+#endif
+
+   time_t nextForcedCheck = 0;
+   while(true)
+   {
+      time_t now = time(NULL);
+      bool forcedCheck = (notifyHandle == -1) || (now >= nextForcedCheck);
+      if (forcedCheck)
+         nextForcedCheck = now + FORCED_CHECK_INTERVAL;
+
+      for(int i = 0; i < parsers->size(); i++)
+      {
+         LogParser *p = parsers->get(i);
+         if ((p->m_fileName == NULL) || (!forcedCheck && !p->m_fileChanged))
+            continue;
+         p->m_fileChanged = false;
+
+         if ((p->m_fileHandle != -1) && p->checkMonitoredFile())
+            continue;
+
+         // File is not open yet or was closed due to rotation or name change
+         p->openMonitoredFile();
+#if HAVE_SYS_INOTIFY_H
+         if (notifyHandle != -1)
+            p->updateFileWatch(notifyHandle, parsers);
+#endif
+      }
+
+#if HAVE_SYS_INOTIFY_H
+      if (notifyHandle != -1)
+      {
+         // Wait for file events until next forced check
+         int remaining = (int)(nextForcedCheck - time(NULL));
+         UINT32 timeout = (UINT32)max(min(remaining, FORCED_CHECK_INTERVAL), 0) * 1000;
+         if (waitForFileEvents(notifyHandle, wakeupPipe[0], parsers, stopCondition, timeout))
+            break;
+         continue;
+      }
+#endif
+      if (ConditionWait(stopCondition, 5000))
+         break;
+   }
+
+   for(int i = 0; i < parsers->size(); i++)
+   {
+      LogParser *p = parsers->get(i);
+      if (p->m_fileName == NULL)
+         continue;
+      p->closeMonitoredFile();
+      LogParserTrace(0, _T("LogParser: parser thread for file \"%s\" stopped"), p->m_fileName);
+   }
+#if HAVE_SYS_INOTIFY_H
+   if (notifyHandle != -1)
+      _close(notifyHandle);
+   if (wakeupPipe[0] != -1)
+   {
+      UnregisterFileMonitor(wakeupPipe[1]);
+      _close(wakeupPipe[0]);
+      _close(wakeupPipe[1]);
+   }
+#endif
 	return true;
 }
+
+/**
+ * File parser thread
+ */
+bool LogParser::monitorFile(CONDITION stopCondition, bool readFromCurrPos)
+{
+   ObjectArray<LogParser> parsers(1, 1, false);
+   parsers.add(this);
+   return monitorFiles(&parsers, stopCondition, readFromCurrPos);
+}
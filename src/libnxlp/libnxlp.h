@@ -30,6 +30,57 @@
 
 void LogParserTrace(int level, const TCHAR *format, ...);
 
+TCHAR *ExtractRequiredLiteral(const TCHAR *regexp);
+
+/**
+ * Prefilter transition
+ */
+struct PrefilterTransition
+{
+   TCHAR ch;
+   int node;
+};
+
+/**
+ * Prefilter automaton node
+ */
+struct PrefilterNode
+{
+   PrefilterTransition *transitions;
+   int transitionCount;
+   int *patterns;
+   int patternCount;
+   int fail;
+   int output;
+};
+
+/**
+ * Multi-pattern matcher (Aho-Corasick automaton) used to select rules
+ * which can possibly match given line
+ */
+class LogParserPrefilter
+{
+private:
+   PrefilterNode *m_nodes;
+   int m_nodeCount;
+   int m_allocated;
+   int m_root[256];
+   int m_patternCount;
+
+   int createNode();
+   int findTransition(int node, TCHAR ch) const;
+
+public:
+   LogParserPrefilter();
+   ~LogParserPrefilter();
+
+   void addPattern(const TCHAR *pattern, int id);
+   void build();
+   void match(const TCHAR *text, bool *found) const;
+
+   int getPatternCount() const { return m_patternCount; }
+};
+
 #ifdef _WIN32
 THREAD_RESULT THREAD_CALL ParserThreadEventLog(void *);
 THREAD_RESULT THREAD_CALL ParserThreadEventLogV6(void *);
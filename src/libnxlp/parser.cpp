@@ -112,9 +112,20 @@ LogParser::LogParser()
 	m_recordsProcessed = 0;
 	m_recordsMatched = 0;
 	m_processAllRules = false;
+	m_prefilterEnabled = true;
+	m_prefilterValid = false;
+	m_prefilter = NULL;
+	m_prefilterDefaults = NULL;
+	m_prefilterHits = NULL;
 	m_traceLevel = 0;
 	m_traceCallback = NULL;
 	_tcscpy(m_status, LPS_INIT);
+	m_fileHandle = -1;
+	m_fileSize = 0;
+	m_readFromStart = false;
+	m_fileChanged = false;
+	m_watchDescriptor = -1;
+	m_currentFile[0] = 0;
 #ifdef _WIN32
    m_marker = NULL;
 #endif
@@ -153,9 +164,20 @@ LogParser::LogParser(LogParser *src)
 	m_recordsProcessed = 0;
 	m_recordsMatched = 0;
 	m_processAllRules = src->m_processAllRules;
+	m_prefilterEnabled = src->m_prefilterEnabled;
+	m_prefilterValid = false;
+	m_prefilter = NULL;
+	m_prefilterDefaults = NULL;
+	m_prefilterHits = NULL;
 	m_traceLevel = src->m_traceLevel;
 	m_traceCallback = src->m_traceCallback;
 	_tcscpy(m_status, LPS_INIT);
+	m_fileHandle = -1;
+	m_fileSize = 0;
+	m_readFromStart = false;
+	m_fileChanged = false;
+	m_watchDescriptor = -1;
+	m_currentFile[0] = 0;
 #ifdef _WIN32
    m_marker = _tcsdup_ex(src->m_marker);
 #endif
@@ -167,6 +189,9 @@ LogParser::LogParser(LogParser *src)
 LogParser::~LogParser()
 {
    delete m_rules;
+   delete m_prefilter;
+   free(m_prefilterDefaults);
+   free(m_prefilterHits);
 	free(m_name);
 	free(m_fileName);
 #ifdef _WIN32
@@ -198,6 +223,7 @@ bool LogParser::addRule(LogParserRule *rule)
 	if (valid)
 	{
 	   m_rules->add(rule);
+	   m_prefilterValid = false;
 	}
 	else
 	{
@@ -246,6 +272,61 @@ const TCHAR *LogParser::checkContext(LogParserRule *rule)
 	}
 }
 
+/**
+ * Build prefilter from required literals of all rules
+ */
+void LogParser::buildPrefilter()
+{
+   delete_and_null(m_prefilter);
+   free(m_prefilterDefaults);
+   free(m_prefilterHits);
+
+   int count = m_rules->size();
+   m_prefilterDefaults = (bool *)malloc(sizeof(bool) * (count + 1));
+   m_prefilterHits = (bool *)malloc(sizeof(bool) * (count + 1));
+   int filtered = 0;
+   for(int i = 0; i < count; i++)
+   {
+      LogParserRule *rule = m_rules->get(i);
+      if ((rule->m_literal != NULL) && !rule->m_isInverted)
+      {
+         if (m_prefilter == NULL)
+            m_prefilter = new LogParserPrefilter();
+         m_prefilter->addPattern(rule->m_literal, i);
+         m_prefilterDefaults[i] = false;
+         filtered++;
+         trace(7, _T("rule %d \"%s\": required literal \"%s\""), i + 1, rule->getDescription(), rule->m_literal);
+      }
+      else
+      {
+         m_prefilterDefaults[i] = true;
+      }
+   }
+   if (m_prefilter != NULL)
+      m_prefilter->build();
+   m_prefilterValid = true;
+   trace(4, _T("Prefilter built (%d of %d rules can be prefiltered)"), filtered, count);
+}
+
+/**
+ * Run prefilter on given line. Returns array of flags indicating which rules
+ * can possibly match this line or NULL if prefilter is not used.
+ */
+const bool *LogParser::prefilter(const TCHAR *line)
+{
+   if (!m_prefilterEnabled)
+      return NULL;
+
+   if (!m_prefilterValid)
+      buildPrefilter();
+   if (m_prefilter == NULL)
+      return NULL;
+
+   memcpy(m_prefilterHits, m_prefilterDefaults, sizeof(bool) * m_rules->size());
+   m_prefilter->match(line, m_prefilterHits);
+   return m_prefilterHits;
+}
+
 /**
  * Match log record
  */
@@ -261,6 +342,7 @@ bool LogParser::matchLogRecord(bool hasAttributes, const TCHAR *source, UINT32 e
 		trace(5, _T("Match line: \"%s\""), line);
 
 	m_recordsProcessed++;
+	const bool *candidates = prefilter(line);
 	int i;
 	for(i = 0; i < m_rules->size(); i++)
 	{
@@ -268,9 +350,20 @@ bool LogParser::matchLogRecord(bool hasAttributes, const TCHAR *source, UINT32 e
 		trace(6, _T("checking rule %d \"%s\""), i + 1, rule->getDescription());
 		if ((state = checkContext(rule)) != NULL)
 		{
-			bool ruleMatched = hasAttributes ?
-			   rule->matchEx(source, eventId, level, line, m_cb, objectId, m_userArg) :
-				rule->match(line, m_cb, objectId, m_userArg);
+		   bool ruleMatched;
+		   if ((candidates != NULL) && !candidates[i])
+		   {
+		      // Required literal not found in line, so regular expression cannot match
+		      trace(6, _T("  required literal \"%s\" not found"), rule->m_literal);
+		      rule->incCheckCount(objectId);
+		      ruleMatched = false;
+		   }
+		   else
+		   {
+		      ruleMatched = hasAttributes ?
+		         rule->matchEx(source, eventId, level, line, m_cb, objectId, m_userArg) :
+		         rule->match(line, m_cb, objectId, m_userArg);
+		   }
 			if (ruleMatched)
 			{
 				trace(5, _T("rule %d \"%s\" matched"), i + 1, rule->getDescription());
@@ -0,0 +1,403 @@
+/*
+** NetXMS - Network Management System
+** Log Parsing Library
+** Copyright (C) 2003-2017 Raden Solutions
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation; either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: prefilter.cpp
+**
+**/
+
+#include "libnxlp.h"
+
+/**
+ * Minimal length of literal to be used for prefiltering
+ */
+#define MIN_LITERAL_LENGTH    3
+
+/**
+ * Skip bracket expression. Pointer should point to opening bracket.
+ * Returns pointer to first character after closing bracket.
+ */
+static const TCHAR *SkipBracketExpression(const TCHAR *p)
+{
+   p++;
+   if (*p == _T('^'))
+      p++;
+   if (*p == _T(']'))
+      p++;
+   while((*p != 0) && (*p != _T(']')))
+   {
+      if ((*p == _T('[')) && ((*(p + 1) == _T(':')) || (*(p + 1) == _T('.')) || (*(p + 1) == _T('='))))
+      {
+         TCHAR delimiter = *(p + 1);
+         p += 2;
+         while((*p != 0) && !((*p == delimiter) && (*(p + 1) == _T(']'))))
+            p++;
+         if (*p != 0)
+            p += 2;
+      }
+      else
+      {
+         p++;
+      }
+   }
+   return (*p != 0) ? p + 1 : p;
+}
+
+/**
+ * Skip subexpression. Pointer should point to opening parenthesis.
+ * Returns pointer to first character after closing parenthesis.
+ */
+static const TCHAR *SkipSubexpression(const TCHAR *p)
+{
+   int level = 0;
+   while(*p != 0)
+   {
+      switch(*p)
+      {
+         case _T('\\'):
+            p++;
+            if (*p != 0)
+               p++;
+            break;
+         case _T('['):
+            p = SkipBracketExpression(p);
+            break;
+         case _T('('):
+            level++;
+            p++;
+            break;
+         case _T(')'):
+            level--;
+            p++;
+            if (level == 0)
+               return p;
+            break;
+         default:
+            p++;
+            break;
+      }
+   }
+   return p;
+}
+
+/**
+ * Check if escaped character is matched literally. TRE gives special meaning to
+ * alphanumeric escapes (macros like \w or \d, assertions like \b or \B, back
+ * references and character codes) and to word and string boundary assertions
+ * \<, \>, \` and \'.
+ */
+inline bool IsLiteralEscape(TCHAR ch)
+{
+   return !_istalnum(ch) && (_tcschr(_T("<>`'"), ch) == NULL);
+}
+
+/**
+ * Extract longest literal substring which must be present in any line matching
+ * given regular expression (extended POSIX syntax as implemented by TRE).
+ * Only top level sequence is analyzed; subexpressions, bracket expressions and
+ * special characters terminate current literal. Returns NULL if no suitable
+ * literal can be found. Returned string is converted to lower case and should
+ * be freed by caller.
+ */
+TCHAR *ExtractRequiredLiteral(const TCHAR *regexp)
+{
+   if (regexp == NULL)
+      return NULL;
+
+   size_t len = _tcslen(regexp);
+   TCHAR *current = (TCHAR *)malloc((len + 1) * sizeof(TCHAR));
+   TCHAR *best = (TCHAR *)malloc((len + 1) * sizeof(TCHAR));
+   size_t currLen = 0, bestLen = 0;
+   bool lastIsLiteral = false;   // true if last atom is literal character added to current literal
+
+   const TCHAR *p = regexp;
+   while(*p != 0)
+   {
+      bool endOfLiteral = true;
+      bool wasLiteral = lastIsLiteral;
+      lastIsLiteral = false;
+      switch(*p)
+      {
+         case _T('|'):  // alternation at top level - no required literal
+            free(current);
+            free(best);
+            return NULL;
+         case _T('*'):
+         case _T('?'):
+            if (wasLiteral)
+               currLen--;  // previous character is optional
+            p++;
+            break;
+         case _T('+'):  // previous character is required but can be repeated
+            p++;
+            break;
+         case _T('{'):
+            if (wasLiteral)
+               currLen--;  // repetition count may be zero
+            while((*p != 0) && (*p != _T('}')))
+               p++;
+            if (*p != 0)
+               p++;
+            break;
+         case _T('('):
+            p = SkipSubexpression(p);
+            break;
+         case _T('['):
+            p = SkipBracketExpression(p);
+            break;
+         case _T('\\'):
+            p++;
+            if (*p == 0)
+               break;
+            if (*p == _T('Q'))   // literal mode - not supported
+            {
+               free(current);
+               free(best);
+               return NULL;
+            }
+            if (!IsLiteralEscape(*p))
+            {
+               // Macro, assertion, back reference, or hex character code
+               if (*p == _T('x'))
+               {
+                  p++;
+                  if (*p == _T('{'))
+                  {
+                     while((*p != 0) && (*p != _T('}')))
+                        p++;
+                     if (*p != 0)
+                        p++;
+                  }
+                  else
+                  {
+                     for(int i = 0; (i < 2) && _istxdigit(*p); i++)
+                        p++;
+                  }
+               }
+               else
+               {
+                  p++;
+               }
+               break;
+            }
+            current[currLen++] = _totlower(*p);
+            p++;
+            lastIsLiteral = true;
+            endOfLiteral = false;
+            break;
+         case _T('.'):
+         case _T('^'):
+         case _T('$'):
+         case _T(')'):
+            p++;
+            break;
+         default:
+            current[currLen++] = _totlower(*p);
+            p++;
+            lastIsLiteral = true;
+            endOfLiteral = false;
+            break;
+      }
+
+      if (endOfLiteral)
+      {
+         if (currLen > bestLen)
+         {
+            memcpy(best, current, currLen * sizeof(TCHAR));
+            bestLen = currLen;
+         }
+         currLen = 0;
+      }
+   }
+   if (currLen > bestLen)
+   {
+      memcpy(best, current, currLen * sizeof(TCHAR));
+      bestLen = currLen;
+   }
+   free(current);
+
+   if (bestLen < MIN_LITERAL_LENGTH)
+   {
+      free(best);
+      return NULL;
+   }
+   best[bestLen] = 0;
+   return best;
+}
+
+/**
+ * Prefilter constructor
+ */
+LogParserPrefilter::LogParserPrefilter()
+{
+   m_nodes = NULL;
+   m_nodeCount = 0;
+   m_allocated = 0;
+   memset(m_root, 0, sizeof(m_root));
+   m_patternCount = 0;
+   createNode();  // root node
+}
+
+/**
+ * Prefilter destructor
+ */
+LogParserPrefilter::~LogParserPrefilter()
+{
+   for(int i = 0; i < m_nodeCount; i++)
+   {
+      free(m_nodes[i].transitions);
+      free(m_nodes[i].patterns);
+   }
+   free(m_nodes);
+}
+
+/**
+ * Create new node and return its index
+ */
+int LogParserPrefilter::createNode()
+{
+   if (m_nodeCount == m_allocated)
+   {
+      m_allocated += 256;
+      m_nodes = (PrefilterNode *)realloc(m_nodes, sizeof(PrefilterNode) * m_allocated);
+   }
+   memset(&m_nodes[m_nodeCount], 0, sizeof(PrefilterNode));
+   return m_nodeCount++;
+}
+
+/**
+ * Find transition from given node by given character. Returns -1 if there are no such transition.
+ */
+inline int LogParserPrefilter::findTransition(int node, TCHAR ch) const
+{
+   if (node == 0)
+   {
+      if ((unsigned int)ch < 256)
+         return (m_root[ch] != 0) ? m_root[ch] : -1;
+   }
+   const PrefilterNode *n = &m_nodes[node];
+   for(int i = 0; i < n->transitionCount; i++)
+      if (n->transitions[i].ch == ch)
+         return n->transitions[i].node;
+   return -1;
+}
+
+/**
+ * Add pattern. Pattern should be in lower case.
+ */
+void LogParserPrefilter::addPattern(const TCHAR *pattern, int id)
+{
+   int node = 0;
+   for(const TCHAR *p = pattern; *p != 0; p++)
+   {
+      int next = findTransition(node, *p);
+      if (next == -1)
+      {
+         next = createNode();
+         PrefilterNode *n = &m_nodes[node];
+         if ((node == 0) && ((unsigned int)*p < 256))
+         {
+            m_root[*p] = next;
+         }
+         else
+         {
+            n->transitions = (PrefilterTransition *)realloc(n->transitions, sizeof(PrefilterTransition) * (n->transitionCount + 1));
+            n->transitions[n->transitionCount].ch = *p;
+            n->transitions[n->transitionCount].node = next;
+            n->transitionCount++;
+         }
+      }
+      node = next;
+   }
+
+   PrefilterNode *n = &m_nodes[node];
+   n->patterns = (int *)realloc(n->patterns, sizeof(int) * (n->patternCount + 1));
+   n->patterns[n->patternCount++] = id;
+   if (id >= m_patternCount)
+      m_patternCount = id + 1;
+}
+
+/**
+ * Calculate failure and output links for all nodes (breadth first)
+ */
+void LogParserPrefilter::build()
+{
+   int *queue = (int *)malloc(sizeof(int) * m_nodeCount);
+   int head = 0, tail = 0;
+
+   // Direct children of root fail to root
+   for(int i = 0; i < 256; i++)
+   {
+      if (m_root[i] != 0)
+      {
+         m_nodes[m_root[i]].fail = 0;
+         queue[tail++] = m_root[i];
+      }
+   }
+   for(int i = 0; i < m_nodes[0].transitionCount; i++)
+   {
+      int child = m_nodes[0].transitions[i].node;
+      m_nodes[child].fail = 0;
+      queue[tail++] = child;
+   }
+
+   while(head < tail)
+   {
+      int node = queue[head++];
+      PrefilterNode *n = &m_nodes[node];
+      n->output = (n->patternCount > 0) ? node : m_nodes[n->fail].output;
+      for(int i = 0; i < n->transitionCount; i++)
+      {
+         TCHAR ch = n->transitions[i].ch;
+         int child = n->transitions[i].node;
+
+         int f = n->fail;
+         int next;
+         while(((next = findTransition(f, ch)) == -1) && (f != 0))
+            f = m_nodes[f].fail;
+         m_nodes[child].fail = ((next != -1) && (next != child)) ? next : 0;
+         queue[tail++] = child;
+      }
+   }
+
+   free(queue);
+}
+
+/**
+ * Scan text and mark all patterns found in it. Text is converted to lower case on the fly.
+ * Array of flags should have at least getPatternCount() elements and is not cleared by this method.
+ */
+void LogParserPrefilter::match(const TCHAR *text, bool *found) const
+{
+   int node = 0;
+   for(const TCHAR *p = text; *p != 0; p++)
+   {
+      TCHAR ch = _totlower(*p);
+      int next;
+      while(((next = findTransition(node, ch)) == -1) && (node != 0))
+         node = m_nodes[node].fail;
+      node = (next != -1) ? next : 0;
+
+      for(int o = m_nodes[node].output; o != 0; o = m_nodes[m_nodes[o].fail].output)
+      {
+         const PrefilterNode *n = &m_nodes[o];
+         for(int i = 0; i < n->patternCount; i++)
+            found[n->patterns[i]] = true;
+      }
+   }
+}
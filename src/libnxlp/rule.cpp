@@ -37,6 +37,7 @@ LogParserRule::LogParserRule(LogParser *parser, const TCHAR *name, const TCHAR *
 	expandMacros(regexp, expandedRegexp);
 	m_regexp = _tcsdup(expandedRegexp);
 	m_isValid = (_tregcomp(&m_preg, expandedRegexp, REG_EXTENDED | REG_ICASE) == 0);
+	m_literal = m_isValid ? ExtractRequiredLiteral(m_regexp) : NULL;
 	m_eventCode = eventCode;
 	m_eventName = (eventName != NULL) ? _tcsdup(eventName) : NULL;
 	m_numParams = numParams;
@@ -69,6 +70,7 @@ LogParserRule::LogParserRule(LogParserRule *src, LogParser *parser)
 	m_name = _tcsdup_ex(src->m_name);
 	m_regexp = _tcsdup(src->m_regexp);
 	m_isValid = (_tregcomp(&m_preg, m_regexp, REG_EXTENDED | REG_ICASE) == 0);
+	m_literal = _tcsdup_ex(src->m_literal);
 	m_eventCode = src->m_eventCode;
 	m_eventName = (src->m_eventName != NULL) ? _tcsdup(src->m_eventName) : NULL;
 	m_numParams = src->m_numParams;
@@ -112,6 +114,7 @@ LogParserRule::~LogParserRule()
 	free(m_description);
 	free(m_source);
 	free(m_regexp);
+	free(m_literal);
 	free(m_eventName);
 	free(m_context);
 	free(m_contextToChange);
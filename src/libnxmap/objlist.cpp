@@ -96,6 +96,19 @@ ObjLink::~ObjLink()
  * nxmap_ObjList class implementation
  */
 
+/**
+ * Link type used to mark links of removed objects until link list is compacted
+ */
+#define LINK_TYPE_REMOVED  (-1)
+
+/**
+ * Build hash key for unordered pair of object IDs
+ */
+inline UINT64 LinkKey(UINT32 id1, UINT32 id2)
+{
+   return (id1 < id2) ? (((UINT64)id1 << 32) | (UINT64)id2) : (((UINT64)id2 << 32) | (UINT64)id1);
+}
+
 /**
  * Constructors
  */
@@ -104,14 +117,24 @@ nxmap_ObjList::nxmap_ObjList()
 {
    m_objectList = new IntegerArray<UINT32>(16, 16);
    m_linkList = new ObjectArray<ObjLink>(16, 16, true);
+   m_objectListSorted = true;
+   m_removedLinks = 0;
+   m_objects = new HashMap<UINT32, ObjectArray<ObjLink> >(true);
+   m_links = new HashMap<UINT64, ObjLink>(false);
 }
 
 nxmap_ObjList::nxmap_ObjList(NXCPMessage *msg)
 {
    m_objectList = new IntegerArray<UINT32>(16, 16);
    m_linkList = new ObjectArray<ObjLink>(16, 16, true);
+   m_objectListSorted = false;
+   m_removedLinks = 0;
+   m_objects = new HashMap<UINT32, ObjectArray<ObjLink> >(true);
+   m_links = new HashMap<UINT64, ObjLink>(false);
 
 	msg->getFieldAsInt32Array(VID_OBJECT_LIST, m_objectList);
+	for(int i = 0; i < m_objectList->size(); i++)
+	   m_objects->set(m_objectList->get(i), NULL);
 
    int linksCount = msg->getFieldAsInt32(VID_NUM_LINKS);
 	UINT32 dwId = VID_OBJECT_LINKS_BASE;
@@ -126,6 +149,7 @@ nxmap_ObjList::nxmap_ObjList(NXCPMessage *msg)
 		obj->config = msg->getFieldAsString(dwId++);
 		obj->flags = msg->getFieldAsUInt32(dwId++);
 		m_linkList->add(obj);
+		registerLink(obj);
 	}
 }
 
@@ -136,13 +160,27 @@ nxmap_ObjList::nxmap_ObjList(nxmap_ObjList *src)
 {
    int i;
 
+   m_objects = new HashMap<UINT32, ObjectArray<ObjLink> >(true);
+   m_links = new HashMap<UINT64, ObjLink>(false);
+
    m_objectList = new IntegerArray<UINT32>(src->m_objectList->size(), 16);
    for(i = 0; i < src->m_objectList->size(); i++)
+   {
       m_objectList->add(src->m_objectList->get(i));
+      m_objects->set(src->m_objectList->get(i), NULL);
+   }
+   m_objectListSorted = src->m_objectListSorted;
+   m_removedLinks = 0;
 
    m_linkList = new ObjectArray<ObjLink>(src->m_linkList->size(), 16, true);
 	for(i = 0; i < src->m_linkList->size(); i++)
-      m_linkList->add(new ObjLink(src->m_linkList->get(i)));
+	{
+	   if (src->m_linkList->get(i)->type == LINK_TYPE_REMOVED)
+	      continue;
+	   ObjLink *link = new ObjLink(src->m_linkList->get(i));
+      m_linkList->add(link);
+      registerLink(link);
+	}
 }
 
 /**
@@ -152,6 +190,8 @@ nxmap_ObjList::~nxmap_ObjList()
 {
    delete m_objectList;
    delete m_linkList;
+   delete m_objects;
+   delete m_links;
 }
 
 /**
@@ -159,8 +199,12 @@ nxmap_ObjList::~nxmap_ObjList()
  */
 void nxmap_ObjList::clear()
 {
+   m_links->clear();
+   m_objects->clear();
    m_linkList->clear();
    m_objectList->clear();
+   m_objectListSorted = true;
+   m_removedLinks = 0;
 }
 
 /**
@@ -173,15 +217,84 @@ static int CompareObjectId(const void *e1, const void *e2)
    return (id1 < id2) ? -1 : ((id1 > id2) ? 1 : 0);
 }
 
+/**
+ * Sort object list by object ID. List is sorted lazily, only when accessed from outside.
+ */
+void nxmap_ObjList::sortObjects()
+{
+   if (!m_objectListSorted)
+   {
+      m_objectList->sort(CompareObjectId);
+      m_objectListSorted = true;
+   }
+}
+
+/**
+ * Remove links of removed objects from link list, preserving order of remaining links
+ */
+void nxmap_ObjList::compactLinks()
+{
+   if (m_removedLinks == 0)
+      return;
+
+   ObjectArray<ObjLink> *linkList = new ObjectArray<ObjLink>(max(m_linkList->size() - m_removedLinks, 16), 16, true);
+   for(int i = 0; i < m_linkList->size(); i++)
+   {
+      ObjLink *link = m_linkList->get(i);
+      if (link->type == LINK_TYPE_REMOVED)
+         delete link;
+      else
+         linkList->add(link);
+   }
+   m_linkList->setOwner(false);
+   delete m_linkList;
+   m_linkList = linkList;
+   m_removedLinks = 0;
+}
+
+/**
+ * Register link in link index and in adjacency lists of linked objects
+ */
+void nxmap_ObjList::registerLink(ObjLink *link)
+{
+   UINT64 key = LinkKey(link->id1, link->id2);
+   if (!m_links->contains(key))
+      m_links->set(key, link);
+
+   UINT32 ids[2] = { link->id1, link->id2 };
+   for(int i = 0; i < ((link->id1 != link->id2) ? 2 : 1); i++)
+   {
+      if (!m_objects->contains(ids[i]))
+         continue;
+      ObjectArray<ObjLink> *links = m_objects->get(ids[i]);
+      if (links == NULL)
+      {
+         links = new ObjectArray<ObjLink>(4, 4, false);
+         m_objects->set(ids[i], links);
+      }
+      links->add(link);
+   }
+}
+
+/**
+ * Find link between two objects (in any direction)
+ */
+ObjLink *nxmap_ObjList::findLink(UINT32 id1, UINT32 id2)
+{
+   return m_links->get(LinkKey(id1, id2));
+}
+
 /**
  * Add object to list
  */
 void nxmap_ObjList::addObject(UINT32 id)
 {
-   if (!isObjectExist(id))
+   if (!m_objects->contains(id))
    {
+      if (m_objectListSorted && (m_objectList->size() > 0) && (m_objectList->get(m_objectList->size() - 1) > id))
+         m_objectListSorted = false;
       m_objectList->add(id);
-      m_objectList->sort(CompareObjectId);
+      m_objects->set(id, NULL);
    }
 }
 
@@ -190,16 +303,38 @@ void nxmap_ObjList::addObject(UINT32 id)
  */
 void nxmap_ObjList::removeObject(UINT32 id)
 {
-   m_objectList->remove(id);
+   if (!m_objects->contains(id))
+      return;
 
-   for(int i = 0; i < m_linkList->size(); i++)
+   ObjectArray<ObjLink> *links = m_objects->get(id);
+   if ((links != NULL) && (links->size() > 0))
    {
-      if ((m_linkList->get(i)->id1 == id) || (m_linkList->get(i)->id2 == id))
+      for(int i = 0; i < links->size(); i++)
       {
-         m_linkList->remove(i);
-         i--;
+         ObjLink *link = links->get(i);
+         UINT64 key = LinkKey(link->id1, link->id2);
+         if (m_links->get(key) == link)
+            m_links->remove(key);
+
+         UINT32 peerId = (link->id1 == id) ? link->id2 : link->id1;
+         if (peerId != id)
+         {
+            ObjectArray<ObjLink> *peerLinks = m_objects->get(peerId);
+            if (peerLinks != NULL)
+               peerLinks->remove(link);
+         }
+
+         // Actual removal from link list is deferred until list is accessed
+         link->type = LINK_TYPE_REMOVED;
+         m_removedLinks++;
       }
    }
+   m_objects->remove(id);
+
+   sortObjects();
+   UINT32 *p = (UINT32 *)bsearch(&id, m_objectList->getBuffer(), m_objectList->size(), sizeof(UINT32), CompareObjectId);
+   if (p != NULL)
+      m_objectList->remove((int)(p - m_objectList->getBuffer()));
 }
 
 /**
@@ -207,27 +342,14 @@ void nxmap_ObjList::removeObject(UINT32 id)
  */
 void nxmap_ObjList::linkObjects(UINT32 id1, UINT32 id2, int linkType, const TCHAR *linkName)
 {
-   bool linkExists = false;
-   if ((m_objectList->indexOf(id1) != -1) && (m_objectList->indexOf(id2) != -1))  // if both objects exist
+   if (m_objects->contains(id1) && m_objects->contains(id2) && (findLink(id1, id2) == NULL))  // if both objects exist and not linked yet
    {
-      // Check for duplicate links
-      for(int i = 0; i < m_linkList->size(); i++)
-      {
-         if (((m_linkList->get(i)->id1 == id1) && (m_linkList->get(i)->id2 == id2)) ||
-             ((m_linkList->get(i)->id2 == id1) && (m_linkList->get(i)->id1 == id2)))
-         {
-            linkExists = true;
-            break;
-         }
-      }
-      if (!linkExists)
-      {
-         ObjLink *link = new ObjLink();
-         link->id1 = id1;
-         link->id2 = id2;
-         link->type = linkType;
-			m_linkList->add(link);
-      }
+      ObjLink *link = new ObjLink();
+      link->id1 = id1;
+      link->id2 = id2;
+      link->type = linkType;
+      m_linkList->add(link);
+      registerLink(link);
    }
 }
 
@@ -247,74 +369,50 @@ static void UpdatePortNames(ObjLink *link, const TCHAR *port1, const TCHAR *port
  */
 void nxmap_ObjList::linkObjectsEx(UINT32 id1, UINT32 id2, const TCHAR *port1, const TCHAR *port2, UINT32 portId1, UINT32 portId2)
 {
-   bool linkExists = false;
-   if ((m_objectList->indexOf(id1) != -1) && (m_objectList->indexOf(id2) != -1))  // if both objects exist
+   if (!m_objects->contains(id1) || !m_objects->contains(id2))  // both objects should exist
+      return;
+
+   ObjLink *link = findLink(id1, id2);
+   if (link != NULL)
    {
-      // Check for duplicate links
-      for(int i = 0; i < m_linkList->size(); i++)
+      // Existing link may be stored in reverse direction
+      bool reverse = (link->id1 != id1);
+      UINT32 linkPortId1 = reverse ? portId2 : portId1;
+      UINT32 linkPortId2 = reverse ? portId1 : portId2;
+
+      int j;
+      for(j = 0; j < link->portIdCount; j++)
       {
-			if ((m_linkList->get(i)->id1 == id1) && (m_linkList->get(i)->id2 == id2))
-			{
-				int j;
-				for(j = 0; j < m_linkList->get(i)->portIdCount; j++)
-				{
-					// assume point-to-point interfaces, therefore "or" is enough
-					if ((m_linkList->get(i)->portIdArray1[j] == portId1) || (m_linkList->get(i)->portIdArray2[j] == portId2))
-               {
-                  linkExists = true;
-                  break;
-               }
-				}
-				if (!linkExists && (m_linkList->get(i)->portIdCount < MAX_PORT_COUNT))
-				{
-					m_linkList->get(i)->portIdArray1[j] = portId1;
-					m_linkList->get(i)->portIdArray2[j] = portId2;
-					m_linkList->get(i)->portIdCount++;
-					UpdatePortNames(m_linkList->get(i), port1, port2);
-					m_linkList->get(i)->type = LINK_TYPE_MULTILINK;
-               linkExists = true;
-				}
-				break;
-			}
-			if ((m_linkList->get(i)->id1 == id2) && (m_linkList->get(i)->id2 == id1))
-			{
-				int j;
-				for(j = 0; j < m_linkList->get(i)->portIdCount; j++)
-				{
-					// assume point-to-point interfaces, therefore or is enough
-					if ((m_linkList->get(i)->portIdArray1[j] == portId2) || (m_linkList->get(i)->portIdArray2[j] == portId1))
-					{
-                  linkExists = true;
-                  break;
-               }
-				}
-				if (!linkExists && (m_linkList->get(i)->portIdCount < MAX_PORT_COUNT))
-				{
-					m_linkList->get(i)->portIdArray1[j] = portId2;
-					m_linkList->get(i)->portIdArray2[j] = portId1;
-					m_linkList->get(i)->portIdCount++;
-					UpdatePortNames(m_linkList->get(i), port2, port1);
-					m_linkList->get(i)->type = LINK_TYPE_MULTILINK;
-               linkExists = true;
-				}
-				break;
-			}
+         // assume point-to-point interfaces, therefore "or" is enough
+         if ((link->portIdArray1[j] == linkPortId1) || (link->portIdArray2[j] == linkPortId2))
+            return;
       }
-      if (!linkExists)
+      if (link->portIdCount < MAX_PORT_COUNT)
       {
-         ObjLink* obj = new ObjLink();
-         obj->id1 = id1;
-         obj->id2 = id2;
-         obj->type = LINK_TYPE_NORMAL;
-			obj->portIdCount = 1;
-			obj->portIdArray1[0] = portId1;
-			obj->portIdArray2[0] = portId2;
-			nx_strncpy(obj->port1, port1, MAX_CONNECTOR_NAME);
-			nx_strncpy(obj->port2, port2, MAX_CONNECTOR_NAME);
-			obj->config = NULL;
-			m_linkList->add(obj);
+         link->portIdArray1[j] = linkPortId1;
+         link->portIdArray2[j] = linkPortId2;
+         link->portIdCount++;
+         if (reverse)
+            UpdatePortNames(link, port2, port1);
+         else
+            UpdatePortNames(link, port1, port2);
+         link->type = LINK_TYPE_MULTILINK;
       }
+      return;
    }
+
+   ObjLink* obj = new ObjLink();
+   obj->id1 = id1;
+   obj->id2 = id2;
+   obj->type = LINK_TYPE_NORMAL;
+   obj->portIdCount = 1;
+   obj->portIdArray1[0] = portId1;
+   obj->portIdArray2[0] = portId2;
+   nx_strncpy(obj->port1, port1, MAX_CONNECTOR_NAME);
+   nx_strncpy(obj->port2, port2, MAX_CONNECTOR_NAME);
+   obj->config = NULL;
+   m_linkList->add(obj);
+   registerLink(obj);
 }
 
 /**
@@ -322,6 +420,9 @@ void nxmap_ObjList::linkObjectsEx(UINT32 id1, UINT32 id2, const TCHAR *port1, co
  */
 void nxmap_ObjList::createMessage(NXCPMessage *msg)
 {
+   sortObjects();
+   compactLinks();
+
 	// Object list
 	msg->setField(VID_NUM_OBJECTS, m_objectList->size());
 	if (m_objectList->size() > 0)
@@ -348,13 +449,8 @@ void nxmap_ObjList::createMessage(NXCPMessage *msg)
  */
 bool nxmap_ObjList::isLinkExist(UINT32 objectId1, UINT32 objectId2)
 {
-   for(int i = 0; i < m_linkList->size(); i++)
-   {
-      ObjLink *l = m_linkList->get(i);
-		if ((l->id1 == objectId1) && (l->id2 == objectId2))
-			return true;
-	}
-	return false;
+   ObjLink *l = findLink(objectId1, objectId2);
+   return (l != NULL) && (l->id1 == objectId1) && (l->id2 == objectId2);
 }
 
 /**
@@ -362,5 +458,5 @@ bool nxmap_ObjList::isLinkExist(UINT32 objectId1, UINT32 objectId2)
  */
 bool nxmap_ObjList::isObjectExist(UINT32 objectId)
 {
-   return bsearch(&objectId, m_objectList->getBuffer(), m_objectList->size(), sizeof(UINT32), CompareObjectId) != NULL;
+   return m_objects->contains(objectId);
 }
@@ -78,6 +78,197 @@
    } \
 }
 
+/**
+ * Header of memory block holding NXSL_Value. Pointer to owning pool is NULL
+ * for values allocated directly from heap.
+ */
+union ValueBlockHeader
+{
+   NXSL_ValuePool *pool;
+   ValueBlockHeader *next;
+   INT64 align1;
+   double align2;
+};
+
+/**
+ * Size of single pool block (header and value)
+ */
+#define VALUE_BLOCK_SIZE   (sizeof(ValueBlockHeader) + ((sizeof(NXSL_Value) + sizeof(ValueBlockHeader) - 1) / sizeof(ValueBlockHeader)) * sizeof(ValueBlockHeader))
+
+/**
+ * Get key identifying current thread
+ */
+inline UINT64 CurrentThreadKey()
+{
+   return (UINT64)((size_t)GetCurrentThreadId());
+}
+
+/**
+ * Create value pool
+ */
+NXSL_ValuePool::NXSL_ValuePool(int chunkSize)
+{
+   m_chunks = NULL;
+   m_freeList = NULL;
+   m_remoteFreeList = NULL;
+   m_remoteLock = MutexCreate();
+   m_chunkSize = chunkSize;
+   m_activeBlocks = 1;
+   m_owner = CurrentThreadKey();
+   m_detached = false;
+   m_allocations = 0;
+   m_chunkAllocations = 0;
+}
+
+/**
+ * Destroy value pool
+ */
+NXSL_ValuePool::~NXSL_ValuePool()
+{
+   ValueBlockHeader *chunk = (ValueBlockHeader *)m_chunks;
+   while(chunk != NULL)
+   {
+      ValueBlockHeader *next = chunk->next;
+      ::free(chunk);
+      chunk = next;
+   }
+   MutexDestroy(m_remoteLock);
+}
+
+/**
+ * Allocate memory for new value. Returned pointer points to value area (after block header).
+ */
+void *NXSL_ValuePool::allocate(size_t size)
+{
+   ValueBlockHeader *block;
+   if (size > sizeof(NXSL_Value))
+   {
+      block = (ValueBlockHeader *)malloc(sizeof(ValueBlockHeader) + size);
+      block->pool = NULL;
+      return block + 1;
+   }
+
+   if ((m_freeList == NULL) && (m_remoteFreeList != NULL))
+   {
+      // Take blocks returned by other threads
+      MutexLock(m_remoteLock);
+      m_freeList = m_remoteFreeList;
+      m_remoteFreeList = NULL;
+      MutexUnlock(m_remoteLock);
+   }
+
+   if (m_freeList == NULL)
+   {
+      // First block in chunk is used as link to next chunk
+      BYTE *chunk = (BYTE *)malloc(sizeof(ValueBlockHeader) + VALUE_BLOCK_SIZE * m_chunkSize);
+      ((ValueBlockHeader *)chunk)->next = (ValueBlockHeader *)m_chunks;
+      m_chunks = chunk;
+      m_chunkAllocations++;
+
+      BYTE *curr = chunk + sizeof(ValueBlockHeader);
+      for(int i = 0; i < m_chunkSize; i++, curr += VALUE_BLOCK_SIZE)
+      {
+         ((ValueBlockHeader *)curr)->next = (ValueBlockHeader *)m_freeList;
+         m_freeList = curr;
+      }
+   }
+
+   block = (ValueBlockHeader *)m_freeList;
+   m_freeList = block->next;
+   block->pool = this;
+   InterlockedIncrement(&m_activeBlocks);
+   m_allocations++;
+   return block + 1;
+}
+
+/**
+ * Return block to pool. Block is put directly to free list when value is destroyed
+ * by owning thread, or to remote free list otherwise. Blocks are not reused after
+ * pool is detached from VM. Pool is destroyed after it is detached and last active
+ * block is returned.
+ */
+void NXSL_ValuePool::deallocate(void *p)
+{
+   if (!m_detached)
+   {
+      ValueBlockHeader *block = (ValueBlockHeader *)p - 1;
+      if (m_owner == CurrentThreadKey())
+      {
+         block->next = (ValueBlockHeader *)m_freeList;
+         m_freeList = block;
+      }
+      else
+      {
+         MutexLock(m_remoteLock);
+         block->next = (ValueBlockHeader *)m_remoteFreeList;
+         m_remoteFreeList = block;
+         MutexUnlock(m_remoteLock);
+      }
+   }
+   if (InterlockedDecrement(&m_activeBlocks) == 0)
+      delete this;
+}
+
+/**
+ * Make calling thread owner of the pool. Should be called by thread which is
+ * going to use VM owning this pool.
+ */
+void NXSL_ValuePool::setOwner()
+{
+   m_owner = CurrentThreadKey();
+}
+
+/**
+ * Detach pool from owning VM. Pool will be destroyed immediately if there
+ * are no active values allocated from it, or after last such value is destroyed.
+ */
+void NXSL_ValuePool::detach()
+{
+   m_detached = true;
+   if (InterlockedDecrement(&m_activeBlocks) == 0)
+      delete this;
+}
+
+/**
+ * Allocate value from heap
+ */
+void *NXSL_Value::operator new(size_t size)
+{
+   ValueBlockHeader *block = (ValueBlockHeader *)malloc(sizeof(ValueBlockHeader) + size);
+   block->pool = NULL;
+   return block + 1;
+}
+
+/**
+ * Allocate value from given pool (or from heap if pool is NULL)
+ */
+void *NXSL_Value::operator new(size_t size, NXSL_ValuePool *pool)
+{
+   return (pool != NULL) ? pool->allocate(size) : operator new(size);
+}
+
+/**
+ * Destroy value allocated either from heap or from pool
+ */
+void NXSL_Value::operator delete(void *p)
+{
+   if (p == NULL)
+      return;
+   ValueBlockHeader *block = (ValueBlockHeader *)p - 1;
+   if (block->pool != NULL)
+      block->pool->deallocate(p);
+   else
+      free(block);
+}
+
+/**
+ * Placement delete (called only if constructor fails)
+ */
+void NXSL_Value::operator delete(void *p, NXSL_ValuePool *pool)
+{
+   operator delete(p);
+}
+
 /**
  * Create "null" value
  */
@@ -127,12 +318,12 @@ NXSL_Value::NXSL_Value(const NXSL_Value *value)
       m_bStringIsValid = value->m_bStringIsValid;
       if (m_bStringIsValid)
       {
-         m_dwStrLen = value->m_dwStrLen;
-         m_pszValStr = (TCHAR *)nx_memdup(value->m_pszValStr, (m_dwStrLen + 1) * sizeof(TCHAR));
+         setString(value->m_pszValStr, value->m_dwStrLen);
       }
       else
       {
          m_pszValStr = NULL;
+         m_dwStrLen = 0;
       }
 		m_name = (value->m_name != NULL) ? _tcsdup(value->m_name) : NULL;
    }
@@ -140,6 +331,8 @@ NXSL_Value::NXSL_Value(const NXSL_Value *value)
    {
       m_nDataType = NXSL_DT_NULL;
       m_pszValStr = NULL;
+      m_dwStrLen = 0;
+      m_bStringIsValid = FALSE;
 		m_name = NULL;
    }
 #ifdef UNICODE
@@ -300,16 +493,10 @@ NXSL_Value::NXSL_Value(double dValue)
 NXSL_Value::NXSL_Value(const TCHAR *value)
 {
    m_nDataType = NXSL_DT_STRING;
-	if (value != NULL)
-	{
-		m_dwStrLen = (UINT32)_tcslen(value);
-		m_pszValStr = _tcsdup(value);
-	}
-	else
-	{
-		m_dwStrLen = 0;
-		m_pszValStr = _tcsdup(_T(""));
-	}
+   if (value != NULL)
+      setString(value, (UINT32)_tcslen(value));
+   else
+      setString(_T(""), 0);
 #ifdef UNICODE
 	m_valueMBStr = NULL;
 #endif
@@ -333,8 +520,7 @@ NXSL_Value::NXSL_Value(const char *value)
 	}
 	else
 	{
-		m_dwStrLen = 0;
-		m_pszValStr = _tcsdup(_T(""));
+		setString(_T(""), 0);
 	}
 	m_valueMBStr = NULL;
    m_bStringIsValid = TRUE;
@@ -350,17 +536,7 @@ NXSL_Value::NXSL_Value(const char *value)
 NXSL_Value::NXSL_Value(const TCHAR *value, UINT32 dwLen)
 {
    m_nDataType = NXSL_DT_STRING;
-   m_dwStrLen = dwLen;
-   m_pszValStr = (TCHAR *)malloc((dwLen + 1) * sizeof(TCHAR));
-	if (value != NULL)
-	{
-		memcpy(m_pszValStr, value, dwLen * sizeof(TCHAR));
-	   m_pszValStr[dwLen] = 0;
-	}
-	else
-	{
-		memset(m_pszValStr, 0, (dwLen + 1) * sizeof(TCHAR));
-	}
+   setString(value, dwLen);
 #ifdef UNICODE
 	m_valueMBStr = NULL;
 #endif
@@ -375,7 +551,7 @@ NXSL_Value::NXSL_Value(const TCHAR *value, UINT32 dwLen)
 NXSL_Value::~NXSL_Value()
 {
 	free(m_name);
-   free(m_pszValStr);
+   freeString();
 #ifdef UNICODE
 	free(m_valueMBStr);
 #endif
@@ -408,11 +584,7 @@ NXSL_Value::~NXSL_Value()
 void NXSL_Value::set(INT32 nValue)
 {
    m_nDataType = NXSL_DT_INT32;
-	safe_free_and_null(m_pszValStr);
-#ifdef UNICODE
-	safe_free_and_null(m_valueMBStr);
-#endif
-   m_bStringIsValid = FALSE;
+   invalidateString();
    m_value.nInt32 = nValue;
 }
 
@@ -457,7 +629,7 @@ void NXSL_Value::updateString()
 {
    TCHAR szBuffer[64];
 
-   safe_free(m_pszValStr);
+   freeString();
 #ifdef UNICODE
 	safe_free_and_null(m_valueMBStr);
 #endif
@@ -497,11 +669,25 @@ void NXSL_Value::updateString()
          szBuffer[0] = 0;
          break;
    }
-   m_dwStrLen = (UINT32)_tcslen(szBuffer);
-   m_pszValStr = _tcsdup(szBuffer);
+   setString(szBuffer, (UINT32)_tcslen(szBuffer));
    m_bStringIsValid = TRUE;
 }
 
+/**
+ * Set string representation. Short strings are kept in internal buffer
+ * to avoid heap allocation. Existing string representation should be freed by caller.
+ */
+void NXSL_Value::setString(const TCHAR *value, UINT32 len)
+{
+   m_dwStrLen = len;
+   m_pszValStr = (len < NXSL_SHORT_STRING_LENGTH) ? m_stringBuffer : (TCHAR *)malloc((len + 1) * sizeof(TCHAR));
+   if (value != NULL)
+      memcpy(m_pszValStr, value, len * sizeof(TCHAR));
+   else
+      memset(m_pszValStr, 0, len * sizeof(TCHAR));
+   m_pszValStr[len] = 0;
+}
+
 /**
  * Convert to another data type
  */
@@ -708,7 +894,15 @@ void NXSL_Value::concatenate(const TCHAR *pszString, UINT32 dwLen)
 		safe_free_and_null(m_valueMBStr);
 	}
 #endif
-   m_pszValStr = (TCHAR *)realloc(m_pszValStr, (m_dwStrLen + dwLen + 1) * sizeof(TCHAR));
+   if (m_pszValStr != m_stringBuffer)
+   {
+      m_pszValStr = (TCHAR *)realloc(m_pszValStr, (m_dwStrLen + dwLen + 1) * sizeof(TCHAR));
+   }
+   else if (m_dwStrLen + dwLen >= NXSL_SHORT_STRING_LENGTH)
+   {
+      m_pszValStr = (TCHAR *)malloc((m_dwStrLen + dwLen + 1) * sizeof(TCHAR));
+      memcpy(m_pszValStr, m_stringBuffer, m_dwStrLen * sizeof(TCHAR));
+   }
    memcpy(&m_pszValStr[m_dwStrLen], pszString, dwLen * sizeof(TCHAR));
    m_dwStrLen += dwLen;
    m_pszValStr[m_dwStrLen] = 0;
@@ -153,6 +153,8 @@ NXSL_VM::NXSL_VM(NXSL_Environment *env, NXSL_Storage *storage)
    m_pRetValue = NULL;
 	m_userData = NULL;
 	m_nBindPos = 0;
+   m_valuePool = new NXSL_ValuePool();
+   m_instructionCount = 0;
 	if (storage != NULL)
 	{
       m_localStorage = NULL;
@@ -189,6 +191,10 @@ NXSL_VM::~NXSL_VM()
    delete m_modules;
 
    safe_free(m_errorText);
+
+   // Values allocated from pool may still be referenced outside VM,
+   // so pool will be destroyed when last of them is destroyed
+   m_valuePool->detach();
 }
 
 /**
@@ -272,6 +278,7 @@ bool NXSL_VM::run(ObjectArray<NXSL_Value> *args,
    TCHAR szBuffer[32];
 
 	m_cp = INVALID_ADDRESS;
+   m_valuePool->setOwner();
 
    // Delete previous return value
    delete_and_null(m_pRetValue);
@@ -497,19 +504,20 @@ void NXSL_VM::execute()
    int i, nRet;
    bool constructor;
 
+   m_instructionCount++;
    cp = m_instructionSet->get(m_cp);
    switch(cp->m_nOpCode)
    {
       case OPCODE_PUSH_CONSTANT:
-         m_dataStack->push(new NXSL_Value(cp->m_operand.m_pConstant));
+         m_dataStack->push(new(m_valuePool) NXSL_Value(cp->m_operand.m_pConstant));
          break;
       case OPCODE_PUSH_VARIABLE:
          pVar = findOrCreateVariable(cp->m_operand.m_pszString);
-         m_dataStack->push(new NXSL_Value(pVar->getValue()));
+         m_dataStack->push(new(m_valuePool) NXSL_Value(pVar->getValue()));
          break;
       case OPCODE_PUSH_CONSTREF:
          pVar = m_constants->find(cp->m_operand.m_pszString);
-         m_dataStack->push((pVar != NULL) ? new NXSL_Value(pVar->getValue()) : new NXSL_Value());
+         m_dataStack->push((pVar != NULL) ? new(m_valuePool) NXSL_Value(pVar->getValue()) : new(m_valuePool) NXSL_Value());
          break;
       case OPCODE_NEW_ARRAY:
          m_dataStack->push(new NXSL_Value(new NXSL_Array()));
@@ -524,7 +532,7 @@ void NXSL_VM::execute()
 				pValue = (NXSL_Value *)m_dataStack->peek();
 				if (pValue != NULL)
 				{
-					pVar->setValue(new NXSL_Value(pValue));
+					pVar->setValue(new(m_valuePool) NXSL_Value(pValue));
 				}
 				else
 				{
@@ -976,7 +984,7 @@ void NXSL_VM::execute()
          }
          break;
       case OPCODE_RET_NULL:
-         m_dataStack->push(new NXSL_Value);
+         m_dataStack->push(new(m_valuePool) NXSL_Value);
       case OPCODE_RETURN:
          if (m_dwSubLevel > 0)
          {
@@ -1083,7 +1091,7 @@ void NXSL_VM::execute()
          pValue = pVar->getValue();
          if (pValue->isNumeric())
          {
-            m_dataStack->push(new NXSL_Value(pValue));
+            m_dataStack->push(new(m_valuePool) NXSL_Value(pValue));
             if (cp->m_nOpCode == OPCODE_INC)
                pValue->increment();
             else
@@ -1104,7 +1112,7 @@ void NXSL_VM::execute()
                pValue->increment();
             else
                pValue->decrement();
-            m_dataStack->push(new NXSL_Value(pValue));
+            m_dataStack->push(new(m_valuePool) NXSL_Value(pValue));
          }
          else
          {
@@ -1577,6 +1585,7 @@ void NXSL_VM::doBinaryOperation(int nOpCode)
    int nType;
    LONG nResult;
    bool dynamicValues = false;
+   bool boolResult = false;
 
    switch(nOpCode)
    {
@@ -1649,23 +1658,25 @@ void NXSL_VM::doBinaryOperation(int nOpCode)
                      case OPCODE_EQ:
                      case OPCODE_NE:
                         nResult = pVal1->EQ(pVal2);
-                        pRes = new NXSL_Value((nOpCode == OPCODE_EQ) ? nResult : !nResult);
+                        if (nOpCode == OPCODE_NE)
+                           nResult = !nResult;
+                        boolResult = true;
                         break;
                      case OPCODE_LT:
                         nResult = pVal1->LT(pVal2);
-                        pRes = new NXSL_Value(nResult);
+                        boolResult = true;
                         break;
                      case OPCODE_LE:
                         nResult = pVal1->LE(pVal2);
-                        pRes = new NXSL_Value(nResult);
+                        boolResult = true;
                         break;
                      case OPCODE_GT:
                         nResult = pVal1->GT(pVal2);
-                        pRes = new NXSL_Value(nResult);
+                        boolResult = true;
                         break;
                      case OPCODE_GE:
                         nResult = pVal1->GE(pVal2);
-                        pRes = new NXSL_Value(nResult);
+                        boolResult = true;
                         break;
                      case OPCODE_LSHIFT:
                         pRes = pVal1;
@@ -1694,20 +1705,36 @@ void NXSL_VM::doBinaryOperation(int nOpCode)
                         break;
                      case OPCODE_AND:
                         nResult = (pVal1->isNonZero() && pVal2->isNonZero());
-                        pRes = new NXSL_Value(nResult);
+                        boolResult = true;
                         break;
                      case OPCODE_OR:
                         nResult = (pVal1->isNonZero() || pVal2->isNonZero());
-                        pRes = new NXSL_Value(nResult);
+                        boolResult = true;
                         break;
                      case OPCODE_CASE:
                      case OPCODE_CASE_CONST:
-                        pRes = new NXSL_Value((LONG)pVal1->EQ(pVal2));
+                        nResult = pVal1->EQ(pVal2);
+                        boolResult = true;
                         break;
                      default:
                         error(NXSL_ERR_INTERNAL);
                         break;
                   }
+
+                  if (boolResult)
+                  {
+                     // Reuse first operand for result if it was taken from stack
+                     if (dynamicValues)
+                     {
+                        pRes = pVal1;
+                        pRes->set((INT32)nResult);
+                        pVal1 = NULL;
+                     }
+                     else
+                     {
+                        pRes = new(m_valuePool) NXSL_Value((INT32)nResult);
+                     }
+                  }
                }
                else
                {
@@ -1744,7 +1771,7 @@ void NXSL_VM::doBinaryOperation(int nOpCode)
                      else
                         nResult = 0;
                   }
-                  pRes = new NXSL_Value((nOpCode == OPCODE_NE) ? !nResult : nResult);
+                  pRes = new(m_valuePool) NXSL_Value((nOpCode == OPCODE_NE) ? !nResult : nResult);
                   break;
                case OPCODE_CONCAT:
                   if (pVal1->isString())
@@ -1754,7 +1781,7 @@ void NXSL_VM::doBinaryOperation(int nOpCode)
                   }
                   else
                   {
-                     pRes = new NXSL_Value(_T(""));
+                     pRes = new(m_valuePool) NXSL_Value(_T(""));
                   }
                   pszText2 = pVal2->getValueAsString(&dwLen2);
                   pRes->concatenate(pszText2, dwLen2);
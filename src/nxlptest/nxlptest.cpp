@@ -44,6 +44,7 @@ static TCHAR m_helpText[] =
    _T("Usage:\n")
    _T("   nxlptest [options] parser\n\n")
    _T("Where valid options are:\n")
+   _T("   -b count   : Run throughput benchmark on input file (count passes)\n")
 	_T("   -f file    : Input file (overrides parser settings)\n")
    _T("   -h         : Show this help\n")
 	_T("   -i         : Uses standard input instead of file defined in parser\n" )
@@ -77,6 +78,63 @@ static THREAD_RESULT THREAD_CALL ParserThread(void *arg)
 	return THREAD_OK;
 }
 
+/**
+ * Run parser over given set of lines and return elapsed time in milliseconds
+ */
+static INT64 RunBenchmarkPass(LogParser *parser, StringList *lines, int passes, int *matches)
+{
+   *matches = 0;
+   INT64 start = GetCurrentTimeMs();
+   for(int n = 0; n < passes; n++)
+   {
+      for(int i = 0; i < lines->size(); i++)
+         if (parser->matchLine(lines->get(i)))
+            (*matches)++;
+   }
+   return GetCurrentTimeMs() - start;
+}
+
+/**
+ * Measure parser throughput with and without prefilter
+ */
+static int RunBenchmark(LogParser *parser, int passes)
+{
+   FILE *f = _tfopen(parser->getFileName(), _T("r"));
+   if (f == NULL)
+   {
+      _tprintf(_T("ERROR: cannot open input file %s (%s)\n"), parser->getFileName(), _tcserror(errno));
+      return 2;
+   }
+
+   StringList lines;
+   TCHAR buffer[8192];
+   while(_fgetts(buffer, 8192, f) != NULL)
+   {
+      TCHAR *eol = _tcspbrk(buffer, _T("\r\n"));
+      if (eol != NULL)
+         *eol = 0;
+      lines.add(buffer);
+   }
+   fclose(f);
+
+   _tprintf(_T("Benchmark: %d rules, %d lines, %d passes\n"), parser->getRuleCount(), lines.size(), passes);
+   if (lines.size() == 0)
+      return 0;
+
+   parser->setCallback(NULL);
+   parser->setTraceLevel(0);
+   for(int pf = 0; pf < 2; pf++)
+   {
+      parser->setPrefilterFlag(pf == 1);
+      int matches;
+      INT64 elapsed = RunBenchmarkPass(parser, &lines, passes, &matches);
+      double total = (double)lines.size() * passes;
+      _tprintf(_T("   prefilter %-3s: %d matches, ") INT64_FMT _T(" ms, %0.0f lines/sec\n"), (pf == 1) ? _T("on") : _T("off"),
+               matches, elapsed, total * 1000.0 / (double)((elapsed > 0) ? elapsed : 1));
+   }
+   return 0;
+}
+
 #ifndef _WIN32
 
 bool s_stop = false;
@@ -93,7 +151,7 @@ static void OnBreak(int sig)
  */
 int main(int argc, char *argv[])
 {
-	int rc = 0, ch, traceLevel = -1;
+	int rc = 0, ch, traceLevel = -1, benchmarkPasses = 0;
 	BYTE *xml;
 	UINT32 size;
 	TCHAR *inputFile = NULL;
@@ -102,7 +160,7 @@ int main(int argc, char *argv[])
 
    // Parse command line
    opterr = 1;
-	while((ch = getopt(argc, argv, "f:hit:v")) != -1)
+	while((ch = getopt(argc, argv, "b:f:hit:v")) != -1)
    {
 		switch(ch)
 		{
@@ -113,6 +171,9 @@ int main(int argc, char *argv[])
 				_tprintf(_T("NetXMS Log Parsing Tester  Version ") NETXMS_VERSION_STRING _T("\n")
 				         _T("Copyright (c) 2009-2017 Victor Kirhenshtein\n\n"));
             return 0;
+			case 'b':
+				benchmarkPasses = strtol(optarg, NULL, 0);
+				break;
 			case 'f':
 #ifdef UNICODE
 				inputFile = WideStringFromMBString(optarg);
@@ -161,6 +222,14 @@ int main(int argc, char *argv[])
 			if (inputFile != NULL)
 				parser->setFileName(inputFile);
 
+			if (benchmarkPasses > 0)
+			{
+				rc = RunBenchmark(parser, benchmarkPasses);
+				free(xml);
+				CleanupLogParserLibrary();
+				return rc;
+			}
+
 			m_stopCondition = ConditionCreate(TRUE);
 			thread = ThreadCreateEx(ParserThread, 0, parser);
 #ifdef _WIN32
@@ -186,7 +255,7 @@ int main(int argc, char *argv[])
 			while(!s_stop)
             ThreadSleepMs(500);
 #endif
-			ConditionSet(m_stopCondition);
+			LogParser::stopFileMonitoring(m_stopCondition);
 			ThreadJoin(thread);
 			ConditionDestroy(m_stopCondition);
 		}
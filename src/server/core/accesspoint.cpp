@@ -167,7 +167,7 @@ BOOL AccessPoint::saveToDatabase(DB_HANDLE hdb)
 	}
 
    // Save data collection items
-   if (bResult)
+   if (bResult && (m_modified & MODIFY_DATA_COLLECTION))
    {
 		lockDciAccess(false);
       for(int i = 0; i < m_dcObjects->size(); i++)
@@ -180,7 +180,7 @@ BOOL AccessPoint::saveToDatabase(DB_HANDLE hdb)
 
    // Clear modifications flag and unlock object
 	if (bResult)
-		m_isModified = false;
+		m_modified = 0;
    unlockProperties();
 
    return bResult;
@@ -416,6 +416,7 @@ void AccessPoint::updateState(AccessPointState state)
    }
    setModified();
 	unlockProperties();
+   propagateStatus();
 
    if ((state == AP_ADOPTED) || (state == AP_UNADOPTED) || (state == AP_DOWN))
    {
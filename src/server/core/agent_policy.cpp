@@ -121,7 +121,7 @@ BOOL AgentPolicy::saveToDatabase(DB_HANDLE hdb)
 
 	// Clear modifications flag and unlock object
 	if (success)
-		m_isModified = false;
+		m_modified = 0;
    unlockProperties();
 
    return success;
@@ -30,6 +30,122 @@ static MUTEX m_mutex = INVALID_MUTEX_HANDLE;
 static Condition m_condShutdown(true);
 static THREAD m_hWatchdogThread = INVALID_THREAD_HANDLE;
 
+/**
+ * Active alarms of single object with number of outstanding and acknowledged alarms for each severity
+ */
+class ObjectAlarms
+{
+public:
+   ObjectArray<Alarm> alarms;
+   int activeCount[5];
+
+   ObjectAlarms() : alarms(8, 8, false) { memset(activeCount, 0, sizeof(activeCount)); }
+};
+
+/**
+ * Alarm indexes (all protected by m_mutex)
+ */
+static HashMap<UINT32, Alarm> m_alarmById(false);
+static StringObjectMap<ObjectArray<Alarm> > m_alarmsByKey(true);
+static HashMap<UINT32, ObjectAlarms> m_alarmsByObject(true);
+
+/**
+ * Check if alarm affects object status (outstanding or acknowledged)
+ */
+inline bool IsAlarmActive(const Alarm *alarm)
+{
+   return ((alarm->getState() & ALARM_STATE_MASK) < ALARM_STATE_RESOLVED) && (alarm->getCurrentSeverity() < 5);
+}
+
+/**
+ * Add alarm to per-object index and update object's severity counters
+ */
+static void AddToObjectIndex(Alarm *alarm)
+{
+   ObjectAlarms *oa = m_alarmsByObject.get(alarm->getSourceObject());
+   if (oa == NULL)
+   {
+      oa = new ObjectAlarms();
+      m_alarmsByObject.set(alarm->getSourceObject(), oa);
+   }
+   oa->alarms.add(alarm);
+   if (IsAlarmActive(alarm))
+      oa->activeCount[alarm->getCurrentSeverity()]++;
+}
+
+/**
+ * Remove alarm from per-object index and update object's severity counters.
+ * Should be called before any change to alarm's source object, state, or severity.
+ */
+static void RemoveFromObjectIndex(Alarm *alarm)
+{
+   ObjectAlarms *oa = m_alarmsByObject.get(alarm->getSourceObject());
+   if (oa == NULL)
+      return;
+   oa->alarms.remove(alarm);
+   if (IsAlarmActive(alarm))
+      oa->activeCount[alarm->getCurrentSeverity()]--;
+   if (oa->alarms.size() == 0)
+      m_alarmsByObject.remove(alarm->getSourceObject());
+}
+
+/**
+ * Add alarm to active alarm list and all indexes
+ */
+static void AddActiveAlarm(Alarm *alarm)
+{
+   m_alarmList->add(alarm);
+   m_alarmById.set(alarm->getAlarmId(), alarm);
+   if (alarm->getKey()[0] != 0)
+   {
+      ObjectArray<Alarm> *list = m_alarmsByKey.get(alarm->getKey());
+      if (list == NULL)
+      {
+         list = new ObjectArray<Alarm>(4, 4, false);
+         m_alarmsByKey.set(alarm->getKey(), list);
+      }
+      list->add(alarm);
+   }
+   AddToObjectIndex(alarm);
+}
+
+/**
+ * Remove alarm from active alarm list and all indexes and destroy it
+ */
+static void RemoveActiveAlarm(Alarm *alarm)
+{
+   RemoveFromObjectIndex(alarm);
+   if (alarm->getKey()[0] != 0)
+   {
+      ObjectArray<Alarm> *list = m_alarmsByKey.get(alarm->getKey());
+      if (list != NULL)
+      {
+         list->remove(alarm);
+         if (list->size() == 0)
+            m_alarmsByKey.remove(alarm->getKey());
+      }
+   }
+   m_alarmById.remove(alarm->getAlarmId());
+   m_alarmList->remove(alarm);
+}
+
+/**
+ * Find active alarm by ID
+ */
+inline Alarm *FindAlarmById(UINT32 alarmId)
+{
+   return m_alarmById.get(alarmId);
+}
+
+/**
+ * Find active alarm by key (first one registered if there are multiple alarms with same key)
+ */
+static Alarm *FindAlarmByKey(const TCHAR *key)
+{
+   ObjectArray<Alarm> *list = m_alarmsByKey.get(key);
+   return ((list != NULL) && (list->size() > 0)) ? list->get(0) : NULL;
+}
+
 /**
  * Get number of comments for alarm
  */
@@ -540,25 +656,23 @@ void NXCORE_EXPORTABLE CreateNewAlarm(TCHAR *message, TCHAR *key, int state, int
    {
       MutexLock(m_mutex);
 
-      for(int i = 0; i < m_alarmList->size(); i++)
+      Alarm *alarm = FindAlarmByKey(pszExpKey);
+      if (alarm != NULL)
       {
-         Alarm *alarm = m_alarmList->get(i);
-			if (!_tcscmp(pszExpKey, alarm->getKey()))
+         RemoveFromObjectIndex(alarm);
+         alarm->updateFromEvent(event, state, severity, timeout, timeoutEvent, ackTimeout, pszExpMsg, alarmCategoryList);
+         AddToObjectIndex(alarm);
+         if (!alarm->isEventRelated(event->getId()))
          {
-			   alarm->updateFromEvent(event, state, severity, timeout, timeoutEvent, ackTimeout, pszExpMsg, alarmCategoryList);
-            if (!alarm->isEventRelated(event->getId()))
-            {
-               alarmId = alarm->getAlarmId();		// needed for correct update of related events
-               updateRelatedEvent = true;
-               alarm->addRelatedEvent(event->getId());
-            }
-            // Open helpdesk issue
-            if (openHelpdeskIssue)
-               alarm->openHelpdeskIssue(NULL);
-
-            newAlarm = false;
-            break;
+            alarmId = alarm->getAlarmId();		// needed for correct update of related events
+            updateRelatedEvent = true;
+            alarm->addRelatedEvent(event->getId());
          }
+         // Open helpdesk issue
+         if (openHelpdeskIssue)
+            alarm->openHelpdeskIssue(NULL);
+
+         newAlarm = false;
       }
 
       MutexUnlock(m_mutex);
@@ -579,7 +693,7 @@ void NXCORE_EXPORTABLE CreateNewAlarm(TCHAR *message, TCHAR *key, int state, int
       {
          MutexLock(m_mutex);
          DbgPrintf(7, _T("AlarmManager: adding new active alarm, current alarm count %d"), m_alarmList->size());
-         m_alarmList->add(alarm);
+         AddActiveAlarm(alarm);
          MutexUnlock(m_mutex);
       }
 
@@ -649,15 +763,11 @@ UINT32 NXCORE_EXPORTABLE AckAlarmById(UINT32 alarmId, ClientSession *session, bo
    UINT32 dwObject, dwRet = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
-      {
-         dwRet = alarm->acknowledge(session, sticky, acknowledgmentActionTime);
-         dwObject = alarm->getSourceObject();
-         break;
-      }
+      dwRet = alarm->acknowledge(session, sticky, acknowledgmentActionTime);
+      dwObject = alarm->getSourceObject();
    }
    MutexUnlock(m_mutex);
 
@@ -760,54 +870,46 @@ void NXCORE_EXPORTABLE ResolveAlarmsById(IntegerArray<UINT32> *alarmIds, Integer
    time_t changeTime = time(NULL);
    for(int i = 0; i < alarmIds->size(); i++)
    {
-      int n;
-      for(n = 0; n < m_alarmList->size(); n++)
+      Alarm *alarm = FindAlarmById(alarmIds->get(i));
+      if (alarm == NULL)
       {
-         Alarm *alarm = m_alarmList->get(n);
-         NetObj *object = GetAlarmSourceObject(alarmIds->get(i), true);
-         if (alarm->getAlarmId() == alarmIds->get(i))
-         {
-            // If alarm is open in helpdesk, it cannot be terminated
-            if (alarm->getHelpDeskState() != ALARM_HELPDESK_OPEN)
-            {
-               if (session != NULL)
-               {
-                  // If user does not have the required object access rights, the alarm cannot be terminated
-                  if (!object->checkAccessRights(session->getUserId(), terminate ? OBJECT_ACCESS_TERM_ALARMS : OBJECT_ACCESS_UPDATE_ALARMS))
-                  {
-                     failIds->add(alarmIds->get(i));
-                     failCodes->add(RCC_ACCESS_DENIED);
-                     break;
-                  }
-
-                  WriteAuditLog(AUDIT_OBJECTS, TRUE, session->getUserId(), session->getWorkstation(), session->getId(), object->getId(),
-                     _T("%s alarm %d (%s) on object %s"), terminate ? _T("Terminated") : _T("Resolved"),
-                     alarm->getAlarmId(), alarm->getMessage(), object->getName());
-               }
-
-               alarm->resolve((session != NULL) ? session->getUserId() : 0, NULL, terminate, false);
-               processedAlarms.add(alarm->getAlarmId());
-               if (!updatedObjects.contains(object->getId()))
-                  updatedObjects.add(object->getId());
-               if (terminate)
-               {
-                  m_alarmList->remove(n);
-                  n--;
-               }
-            }
-            else
-            {
-               failIds->add(alarmIds->get(i));
-               failCodes->add(RCC_ALARM_OPEN_IN_HELPDESK);
-            }
-            break;
-         }
+         failIds->add(alarmIds->get(i));
+         failCodes->add(RCC_INVALID_ALARM_ID);
+         continue;
       }
-      if (n == m_alarmList->size())
+
+      // If alarm is open in helpdesk, it cannot be terminated
+      if (alarm->getHelpDeskState() == ALARM_HELPDESK_OPEN)
       {
          failIds->add(alarmIds->get(i));
-         failCodes->add(RCC_INVALID_ALARM_ID);
+         failCodes->add(RCC_ALARM_OPEN_IN_HELPDESK);
+         continue;
+      }
+
+      if (session != NULL)
+      {
+         // If user does not have the required object access rights, the alarm cannot be terminated
+         NetObj *object = FindObjectById(alarm->getSourceObject());
+         if ((object == NULL) || !object->checkAccessRights(session->getUserId(), terminate ? OBJECT_ACCESS_TERM_ALARMS : OBJECT_ACCESS_UPDATE_ALARMS))
+         {
+            failIds->add(alarmIds->get(i));
+            failCodes->add(RCC_ACCESS_DENIED);
+            continue;
+         }
+
+         WriteAuditLog(AUDIT_OBJECTS, TRUE, session->getUserId(), session->getWorkstation(), session->getId(), object->getId(),
+            _T("%s alarm %d (%s) on object %s"), terminate ? _T("Terminated") : _T("Resolved"),
+            alarm->getAlarmId(), alarm->getMessage(), object->getName());
       }
+
+      RemoveFromObjectIndex(alarm);
+      alarm->resolve((session != NULL) ? session->getUserId() : 0, NULL, terminate, false);
+      AddToObjectIndex(alarm);
+      processedAlarms.add(alarm->getAlarmId());
+      if (!updatedObjects.contains(alarm->getSourceObject()))
+         updatedObjects.add(alarm->getSourceObject());
+      if (terminate)
+         RemoveActiveAlarm(alarm);
    }
    MutexUnlock(m_mutex);
 
@@ -828,43 +930,53 @@ void NXCORE_EXPORTABLE ResolveAlarmsById(IntegerArray<UINT32> *alarmIds, Integer
  */
 void NXCORE_EXPORTABLE ResolveAlarmByKey(const TCHAR *pszKey, bool useRegexp, bool terminate, Event *pEvent)
 {
-   UINT32 *pdwObjectList = (UINT32 *)malloc(sizeof(UINT32) * m_alarmList->size());
+   IntegerArray<UINT32> updatedObjects;
+   ObjectArray<Alarm> alarms(16, 16, false);
 
    MutexLock(m_mutex);
-   int numObjects = 0;
-   for(int i = 0; i < m_alarmList->size(); i++)
+
+   // Collect matching alarms first because resolve may change indexes
+   if (useRegexp)
    {
-      Alarm *alarm = m_alarmList->get(i);
-		if ((useRegexp ? RegexpMatch(alarm->getKey(), pszKey, TRUE) : !_tcscmp(pszKey, alarm->getKey())) &&
-         (alarm->getHelpDeskState() != ALARM_HELPDESK_OPEN))
+      for(int i = 0; i < m_alarmList->size(); i++)
       {
-         // Add alarm's source object to update list
-         int j;
-         for(j = 0; j < numObjects; j++)
-         {
-            if (pdwObjectList[j] == alarm->getSourceObject())
-               break;
-         }
-         if (j == numObjects)
-         {
-            pdwObjectList[numObjects++] = alarm->getSourceObject();
-         }
-
-         // Resolve or terminate alarm
-         alarm->resolve(0, pEvent, terminate, true);
-			if (terminate)
-			{
-            m_alarmList->remove(i);
-				i--;
-			}
+         Alarm *alarm = m_alarmList->get(i);
+         if (RegexpMatch(alarm->getKey(), pszKey, TRUE))
+            alarms.add(alarm);
       }
    }
+   else
+   {
+      ObjectArray<Alarm> *list = m_alarmsByKey.get(pszKey);
+      if (list != NULL)
+      {
+         for(int i = 0; i < list->size(); i++)
+            alarms.add(list->get(i));
+      }
+   }
+
+   for(int i = 0; i < alarms.size(); i++)
+   {
+      Alarm *alarm = alarms.get(i);
+      if (alarm->getHelpDeskState() == ALARM_HELPDESK_OPEN)
+         continue;
+
+      // Add alarm's source object to update list
+      if (!updatedObjects.contains(alarm->getSourceObject()))
+         updatedObjects.add(alarm->getSourceObject());
+
+      // Resolve or terminate alarm
+      RemoveFromObjectIndex(alarm);
+      alarm->resolve(0, pEvent, terminate, true);
+      AddToObjectIndex(alarm);
+      if (terminate)
+         RemoveActiveAlarm(alarm);
+   }
    MutexUnlock(m_mutex);
 
    // Update status of objects
-   for(int i = 0; i < numObjects; i++)
-      UpdateObjectStatus(pdwObjectList[i]);
-   free(pdwObjectList);
+   for(int i = 0; i < updatedObjects.size(); i++)
+      UpdateObjectStatus(updatedObjects.get(i));
 }
 
 /**
@@ -890,10 +1002,12 @@ UINT32 NXCORE_EXPORTABLE ResolveAlarmByHDRef(const TCHAR *hdref, ClientSession *
                alarm->getAlarmId(), alarm->getMessage(), GetObjectName(objectId, _T("")));
          }
 
+         RemoveFromObjectIndex(alarm);
          alarm->resolve((session != NULL) ? session->getUserId() : 0, NULL, terminate, true);
+         AddToObjectIndex(alarm);
 			if (terminate)
 			{
-            m_alarmList->remove(i);
+            RemoveActiveAlarm(alarm);
 			}
          DbgPrintf(5, _T("Alarm with helpdesk reference \"%s\" %s"), hdref, terminate ? _T("terminated") : _T("resolved"));
          rcc = RCC_SUCCESS;
@@ -966,17 +1080,13 @@ UINT32 OpenHelpdeskIssue(UINT32 alarmId, ClientSession *session, TCHAR *hdref)
    *hdref = 0;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
-      {
-         if (alarm->checkCategoryAccess(session))
-            rcc = alarm->openHelpdeskIssue(hdref);
-         else
-            rcc = RCC_ACCESS_DENIED;
-         break;
-      }
+      if (alarm->checkCategoryAccess(session))
+         rcc = alarm->openHelpdeskIssue(hdref);
+      else
+         rcc = RCC_ACCESS_DENIED;
    }
    MutexUnlock(m_mutex);
    return rcc;
@@ -990,28 +1100,24 @@ UINT32 GetHelpdeskIssueUrlFromAlarm(UINT32 alarmId, UINT32 userId, TCHAR *url, s
    UINT32 rcc = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
    {
-      if (m_alarmList->get(i)->getAlarmId() == alarmId)
+      if (alarm->checkCategoryAccess(session))
       {
-         if (m_alarmList->get(i)->checkCategoryAccess(session))
+         if ((alarm->getHelpDeskState() != ALARM_HELPDESK_IGNORED) && (alarm->getHelpDeskRef()[0] != 0))
          {
-            if ((m_alarmList->get(i)->getHelpDeskState() != ALARM_HELPDESK_IGNORED) && (m_alarmList->get(i)->getHelpDeskRef()[0] != 0))
-            {
-               rcc = GetHelpdeskIssueUrl(m_alarmList->get(i)->getHelpDeskRef(), url, size);
-            }
-            else
-            {
-               rcc = RCC_OUT_OF_STATE_REQUEST;
-            }
-            break;
+            rcc = GetHelpdeskIssueUrl(alarm->getHelpDeskRef(), url, size);
          }
          else
          {
-            rcc = RCC_ACCESS_DENIED;
-            break;
+            rcc = RCC_OUT_OF_STATE_REQUEST;
          }
       }
+      else
+      {
+         rcc = RCC_ACCESS_DENIED;
+      }
    }
    MutexUnlock(m_mutex);
    return rcc;
@@ -1025,24 +1131,20 @@ UINT32 UnlinkHelpdeskIssueById(UINT32 alarmId, ClientSession *session)
    UINT32 rcc = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
+      if (session != NULL)
       {
-         if (session != NULL)
-         {
-            WriteAuditLog(AUDIT_OBJECTS, TRUE, session->getUserId(), session->getWorkstation(), session->getId(),
-               alarm->getSourceObject(), _T("Helpdesk issue %s unlinked from alarm %d (%s) on object %s"),
-               alarm->getHelpDeskRef(), alarm->getAlarmId(), alarm->getMessage(),
-               GetObjectName(alarm->getSourceObject(), _T("")));
-         }
-         alarm->unlinkFromHelpdesk();
-			NotifyClients(NX_NOTIFY_ALARM_CHANGED, alarm);
-			alarm->updateInDatabase();
-         rcc = RCC_SUCCESS;
-         break;
+         WriteAuditLog(AUDIT_OBJECTS, TRUE, session->getUserId(), session->getWorkstation(), session->getId(),
+            alarm->getSourceObject(), _T("Helpdesk issue %s unlinked from alarm %d (%s) on object %s"),
+            alarm->getHelpDeskRef(), alarm->getAlarmId(), alarm->getMessage(),
+            GetObjectName(alarm->getSourceObject(), _T("")));
       }
+      alarm->unlinkFromHelpdesk();
+      NotifyClients(NX_NOTIFY_ALARM_CHANGED, alarm);
+      alarm->updateInDatabase();
+      rcc = RCC_SUCCESS;
    }
    MutexUnlock(m_mutex);
 
@@ -1086,21 +1188,17 @@ UINT32 UnlinkHelpdeskIssueByHDRef(const TCHAR *hdref, ClientSession *session)
  */
 void NXCORE_EXPORTABLE DeleteAlarm(UINT32 alarmId, bool objectCleanup)
 {
-   DWORD dwObject;
+   DWORD dwObject = 0;
 
    // Delete alarm from in-memory list
    if (!objectCleanup)  // otherwise already locked
       MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
-      {
-         dwObject = alarm->getSourceObject();
-         NotifyClients(NX_NOTIFY_ALARM_DELETED, alarm);
-         m_alarmList->remove(i);
-         break;
-      }
+      dwObject = alarm->getSourceObject();
+      NotifyClients(NX_NOTIFY_ALARM_DELETED, alarm);
+      RemoveActiveAlarm(alarm);
    }
    if (!objectCleanup)
       MutexUnlock(m_mutex);
@@ -1131,15 +1229,18 @@ bool DeleteObjectAlarms(UINT32 objectId, DB_HANDLE hdb)
 {
 	MutexLock(m_mutex);
 
-	// go through from end because m_alarmList->size() is decremented by DeleteAlarm()
-	for(int i = m_alarmList->size() - 1; i >= 0; i--)
+   ObjectAlarms *oa = m_alarmsByObject.get(objectId);
+   if (oa != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-		if (alarm->getSourceObject() == objectId)
+      // go through from end because object's alarm list is shrinked by DeleteAlarm()
+      for(int i = oa->alarms.size() - 1; i >= 0; i--)
       {
-			DeleteAlarm(alarm->getAlarmId(), true);
+         bool last = (oa->alarms.size() == 1);
+         DeleteAlarm(oa->alarms.get(i)->getAlarmId(), true);
+         if (last)
+            break;   // object entry destroyed together with last alarm
       }
-	}
+   }
 
 	MutexUnlock(m_mutex);
 
@@ -1221,21 +1322,17 @@ UINT32 NXCORE_EXPORTABLE GetAlarm(UINT32 alarmId, UINT32 userId, NXCPMessage *ms
    UINT32 rcc = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
+      if (alarm->checkCategoryAccess(session))
       {
-         if (alarm->checkCategoryAccess(session))
-         {
-            alarm->fillMessage(msg);
-            rcc = RCC_SUCCESS;
-         }
-         else
-         {
-            rcc = RCC_ACCESS_DENIED;
-         }
-         break;
+         alarm->fillMessage(msg);
+         rcc = RCC_SUCCESS;
+      }
+      else
+      {
+         rcc = RCC_ACCESS_DENIED;
       }
    }
    MutexUnlock(m_mutex);
@@ -1252,23 +1349,9 @@ UINT32 NXCORE_EXPORTABLE GetAlarmEvents(UINT32 alarmId, UINT32 userId, NXCPMessa
    UINT32 dwRet = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
-   {
-      if (m_alarmList->get(i)->getAlarmId() == alarmId)
-      {
-         if (m_alarmList->get(i)->checkCategoryAccess(session))
-         {
-            dwRet = RCC_SUCCESS;
-            break;
-         }
-         else
-         {
-            dwRet = RCC_ACCESS_DENIED;
-            break;
-         }
-      }
-   }
-
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
+      dwRet = alarm->checkCategoryAccess(session) ? RCC_SUCCESS : RCC_ACCESS_DENIED;
    MutexUnlock(m_mutex);
 
 	// we don't call FillAlarmEventsMessage from within loop
@@ -1288,15 +1371,9 @@ NetObj NXCORE_EXPORTABLE *GetAlarmSourceObject(UINT32 alarmId, bool alreadyLocke
 
    if(!alreadyLocked)
       MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
-   {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
-      {
-         dwObjectId = alarm->getSourceObject();
-         break;
-      }
-   }
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
+      dwObjectId = alarm->getSourceObject();
 
    if(!alreadyLocked)
       MutexUnlock(m_mutex);
@@ -1333,14 +1410,16 @@ int GetMostCriticalStatusForObject(UINT32 dwObjectId)
    int iStatus = STATUS_UNKNOWN;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   ObjectAlarms *oa = m_alarmsByObject.get(dwObjectId);
+   if (oa != NULL)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if ((alarm->getSourceObject() == dwObjectId) &&
-			 ((alarm->getState() & ALARM_STATE_MASK) < ALARM_STATE_RESOLVED) &&
-          ((alarm->getCurrentSeverity() > iStatus) || (iStatus == STATUS_UNKNOWN)))
+      for(int severity = 4; severity >= 0; severity--)
       {
-         iStatus = (int)alarm->getCurrentSeverity();
+         if (oa->activeCount[severity] > 0)
+         {
+            iStatus = severity;
+            break;
+         }
       }
    }
    MutexUnlock(m_mutex);
@@ -1536,15 +1615,9 @@ UINT32 UpdateAlarmComment(UINT32 alarmId, UINT32 noteId, const TCHAR *text, UINT
    UINT32 rcc = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
-   {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
-      {
-         rcc = alarm->updateAlarmComment(noteId, text, userId, true);
-         break;
-      }
-   }
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
+      rcc = alarm->updateAlarmComment(noteId, text, userId, true);
    MutexUnlock(m_mutex);
 
    return rcc;
@@ -1592,15 +1665,9 @@ UINT32 DeleteAlarmCommentByID(UINT32 alarmId, UINT32 noteId)
    UINT32 rcc = RCC_INVALID_ALARM_ID;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
-   {
-      Alarm *alarm = m_alarmList->get(i);
-      if (alarm->getAlarmId() == alarmId)
-      {
-         rcc = alarm->deleteComment(noteId);
-         break;
-      }
-   }
+   Alarm *alarm = FindAlarmById(alarmId);
+   if (alarm != NULL)
+      rcc = alarm->deleteComment(noteId);
    MutexUnlock(m_mutex);
 
    return rcc;
@@ -1673,13 +1740,25 @@ ObjectArray<Alarm> NXCORE_EXPORTABLE *GetAlarms(UINT32 objectId, bool recursive)
    ObjectArray<Alarm> *result = new ObjectArray<Alarm>(16, 16, true);
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
+   if ((objectId != 0) && !recursive)
    {
-      Alarm *alarm = m_alarmList->get(i);
-      if ((objectId == 0) || (alarm->getSourceObject() == objectId) ||
-          (recursive && IsParentObject(objectId, alarm->getSourceObject())))
+      ObjectAlarms *oa = m_alarmsByObject.get(objectId);
+      if (oa != NULL)
       {
-         result->add(new Alarm(alarm, true));
+         for(int i = 0; i < oa->alarms.size(); i++)
+            result->add(new Alarm(oa->alarms.get(i), true));
+      }
+   }
+   else
+   {
+      for(int i = 0; i < m_alarmList->size(); i++)
+      {
+         Alarm *alarm = m_alarmList->get(i);
+         if ((objectId == 0) || (alarm->getSourceObject() == objectId) ||
+             (recursive && IsParentObject(objectId, alarm->getSourceObject())))
+         {
+            result->add(new Alarm(alarm, true));
+         }
       }
    }
    MutexUnlock(m_mutex);
@@ -1698,15 +1777,9 @@ int F_FindAlarmById(int argc, NXSL_Value **argv, NXSL_Value **result, NXSL_VM *v
    Alarm *alarm = NULL;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
-   {
-      Alarm *a = m_alarmList->get(i);
-      if (a->getAlarmId() == alarmId)
-      {
-         alarm = new Alarm(a, false);
-         break;
-      }
-   }
+   Alarm *a = FindAlarmById(alarmId);
+   if (a != NULL)
+      alarm = new Alarm(a, false);
    MutexUnlock(m_mutex);
 
    *result = (alarm != NULL) ? new NXSL_Value(new NXSL_Object(&g_nxslAlarmClass, alarm)) : new NXSL_Value();
@@ -1725,15 +1798,9 @@ int F_FindAlarmByKey(int argc, NXSL_Value **argv, NXSL_Value **result, NXSL_VM *
    Alarm *alarm = NULL;
 
    MutexLock(m_mutex);
-   for(int i = 0; i < m_alarmList->size(); i++)
-   {
-      Alarm *a = m_alarmList->get(i);
-      if (!_tcscmp(a->getKey(), key))
-      {
-         alarm = new Alarm(a, false);
-         break;
-      }
-   }
+   Alarm *a = FindAlarmByKey(key);
+   if (a != NULL)
+      alarm = new Alarm(a, false);
    MutexUnlock(m_mutex);
 
    *result = (alarm != NULL) ? new NXSL_Value(new NXSL_Object(&g_nxslAlarmClass, alarm)) : new NXSL_Value();
@@ -1746,6 +1813,7 @@ int F_FindAlarmByKey(int argc, NXSL_Value **argv, NXSL_Value **result, NXSL_VM *
 bool InitAlarmManager()
 {
    m_alarmList = new ObjectArray<Alarm>(64, 64, true);
+   m_alarmsByKey.setIgnoreCase(false);
    m_mutex = MutexCreate();
 	m_hWatchdogThread = INVALID_THREAD_HANDLE;
 
@@ -1768,7 +1836,7 @@ bool InitAlarmManager()
    {
       for(int i = 0; i < count; i++)
       {
-         m_alarmList->add(new Alarm(hdb, hResult, i));
+         AddActiveAlarm(new Alarm(hdb, hResult, i));
       }
    }
 
@@ -1787,5 +1855,8 @@ void ShutdownAlarmManager()
 	m_condShutdown.set();
 	ThreadJoin(m_hWatchdogThread);
    MutexDestroy(m_mutex);
+   m_alarmsByObject.clear();
+   m_alarmsByKey.clear();
+   m_alarmById.clear();
    delete m_alarmList;
 }
@@ -86,7 +86,7 @@ BOOL AgentPolicyConfig::saveToDatabase(DB_HANDLE hdb)
 
 	// Clear modifications flag and unlock object
 	if (success)
-		m_isModified = false;
+		m_modified = 0;
    unlockProperties();
 
    return success;
@@ -219,7 +219,7 @@ BOOL Chassis::saveToDatabase(DB_HANDLE hdb)
    }
    unlockProperties();
 
-   if (success)
+   if (success && (m_modified & MODIFY_DATA_COLLECTION))
    {
       lockDciAccess(false);
       for(int i = 0; (i < m_dcObjects->size()) && success; i++)
@@ -387,7 +387,7 @@ void Chassis::setBindUnderController(bool doBind)
       m_flags |= CHF_BIND_UNDER_CONTROLLER;
    else
       m_flags &= ~CHF_BIND_UNDER_CONTROLLER;
-   setModified(false);
+   setModified(MODIFY_OTHER, false);
    unlockProperties();
    updateControllerBinding();
 }
@@ -232,7 +232,7 @@ BOOL Cluster::saveToDatabase(DB_HANDLE hdb)
    }
    unlockProperties();
 
-   if (success)
+   if (success && (m_modified & MODIFY_DATA_COLLECTION))
    {
 		lockDciAccess(false);
       for(int i = 0; (i < m_dcObjects->size()) && success; i++)
@@ -360,7 +360,7 @@ BOOL Cluster::saveToDatabase(DB_HANDLE hdb)
 
    // Clear modifications flag
    lockProperties();
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
    return success;
 }
@@ -219,7 +219,7 @@ BOOL ConditionObject::saveToDatabase(DB_HANDLE hdb)
    saveACLToDB(hdb);
 
    // Unlock object and clear modification flag
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
    return TRUE;
 }
@@ -518,12 +518,7 @@ void ConditionObject::check()
 
    // Cause parent object(s) to recalculate it's status
    if (iOldStatus != m_status)
-   {
-      lockParentList(false);
-      for(int i = 0; i < m_parentList->size(); i++)
-         m_parentList->get(i)->calculateCompoundStatus();
-      unlockParentList();
-   }
+      propagateStatus();
 }
 
 /**
@@ -93,6 +93,42 @@ static void DumpIndex(CONSOLE_CTX pCtx, ObjectIndex *index)
    index->forEach(DumpIndexCallbackById, pCtx);
 }
 
+/**
+ * Compare query statistics by total execution time (descending)
+ */
+static int CompareQueryStats(const void *e1, const void *e2)
+{
+   return COMPARE_NUMBERS(((LIBNXDB_QUERY_STATS *)e2)->totalTime, ((LIBNXDB_QUERY_STATS *)e1)->totalTime);
+}
+
+/**
+ * Show database query statistics (top queries by total execution time)
+ */
+static void ShowQueryStats(CONSOLE_CTX pCtx, int count)
+{
+   UINT64 untracked;
+   StructArray<LIBNXDB_QUERY_STATS> *stats = DBGetQueryStatistics(&untracked);
+   stats->sort(CompareQueryStats);
+
+   ConsoleWrite(pCtx, _T("\x1b[1m     Count   Failed   Total ms   Avg ms   Max ms       Rows  <1ms/<10ms/<100ms/<1s/<10s/>10s\x1b[0m\n"));
+   for(int i = 0; (i < stats->size()) && (i < count); i++)
+   {
+      LIBNXDB_QUERY_STATS *s = stats->get(i);
+      TCHAR calls[32], failed[32], totalTime[32], rows[32];
+      _sntprintf(calls, 32, UINT64_FMT, s->count);
+      _sntprintf(failed, 32, UINT64_FMT, s->failed);
+      _sntprintf(totalTime, 32, UINT64_FMT, s->totalTime);
+      _sntprintf(rows, 32, UINT64_FMT, s->rows);
+      ConsolePrintf(pCtx, _T("%10s %8s %10s %8.1f %8u %10s  ") UINT64_FMT _T("/") UINT64_FMT _T("/") UINT64_FMT _T("/") UINT64_FMT _T("/") UINT64_FMT _T("/") UINT64_FMT _T("\n   %s\n"),
+               calls, failed, totalTime, (double)s->totalTime / (double)s->count,
+               s->maxTime, rows, s->histogram[0], s->histogram[1], s->histogram[2], s->histogram[3],
+               s->histogram[4], s->histogram[5], s->fingerprint);
+   }
+   ConsolePrintf(pCtx, _T("\n%d of %d query fingerprints shown, ") UINT64_FMT _T(" queries not tracked\n\n"),
+            min(count, stats->size()), stats->size(), untracked);
+   delete stats;
+}
+
 /**
  * Process command entered from command line in standalone mode
  * Return TRUE if command was _T("down")
@@ -121,7 +157,7 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
    if (IsCommand(_T("DEBUG"), szBuffer, 2))
    {
       // Get argument
-      ExtractWord(pArg, szBuffer);
+      pArg = ExtractWord(pArg, szBuffer);
       int level = (int)_tcstol(szBuffer, &eptr, 0);
       if ((*eptr == 0) && (level >= 0) && (level <= 9))
       {
@@ -133,12 +169,40 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          nxlog_set_debug_level(0);
          ConsoleWrite(pCtx, _T("Debug mode turned off\n"));
       }
-      else
+      else if (szBuffer[0] == 0)
       {
-         if (szBuffer[0] == 0)
-            ConsoleWrite(pCtx, _T("ERROR: Missing argument\n\n"));
+         ConsoleWrite(pCtx, _T("ERROR: Missing argument\n\n"));
+      }
+      else if (_istalpha(szBuffer[0]) && (_tcslen(szBuffer) < MAX_DEBUG_TAG_LENGTH))
+      {
+         // Debug level for specific tag
+         TCHAR tag[MAX_DEBUG_TAG_LENGTH];
+         _tcscpy(tag, szBuffer);
+         ExtractWord(pArg, szBuffer);
+         level = (int)_tcstol(szBuffer, &eptr, 0);
+         if ((*eptr == 0) && (szBuffer[0] != 0) && (level >= 0) && (level <= 9))
+         {
+            nxlog_set_debug_level_tag(tag, level);
+            ConsolePrintf(pCtx, _T("Debug level for tag \"%s\" set to %d\n"), tag, level);
+         }
+         else if (IsCommand(_T("OFF"), szBuffer, 2))
+         {
+            nxlog_set_debug_level_tag(tag, 0);
+            ConsolePrintf(pCtx, _T("Debug output for tag \"%s\" turned off\n"), tag);
+         }
+         else if (IsCommand(_T("DEFAULT"), szBuffer, 3))
+         {
+            nxlog_set_debug_level_tag(tag, -1);
+            ConsolePrintf(pCtx, _T("Debug level for tag \"%s\" reset to default\n"), tag);
+         }
          else
+         {
             ConsoleWrite(pCtx, _T("ERROR: Invalid debug level\n\n"));
+         }
+      }
+      else
+      {
+         ConsoleWrite(pCtx, _T("ERROR: Invalid debug level\n\n"));
       }
    }
    else if (IsCommand(_T("DOWN"), szBuffer, 4))
@@ -367,6 +431,19 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          ConsoleWrite(pCtx, _T("Usage POLL [CONFIGURATION|STATUS|TOPOLOGY] <node>\n"));
       }
    }
+   else if (IsCommand(_T("RESET"), szBuffer, 5))
+   {
+      ExtractWord(pArg, szBuffer);
+      if (IsCommand(_T("QUERYSTATS"), szBuffer, 1))
+      {
+         DBResetQueryStatistics();
+         ConsoleWrite(pCtx, _T("Database query statistics reset\n\n"));
+      }
+      else
+      {
+         ConsoleWrite(pCtx, _T("Invalid subcommand\n\n"));
+      }
+   }
    else if (IsCommand(_T("SET"), szBuffer, 3))
    {
       pArg = ExtractWord(pArg, szBuffer);
@@ -456,11 +533,33 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          ConsolePrintf(pCtx, _T("   Long running ... ") INT64_FMT _T("\n"), counters.longRunningQueries);
          ConsolePrintf(pCtx, _T("   Failed ......... ") INT64_FMT _T("\n"), counters.failedQueries);
 
+         ConsolePrintf(pCtx, _T("Prepared statement cache:\n"));
+         ConsolePrintf(pCtx, _T("   Hits ........... ") INT64_FMT _T("\n"), counters.statementCacheHits);
+         ConsolePrintf(pCtx, _T("   Misses ......... ") INT64_FMT _T("\n"), counters.statementCacheMisses);
+         ConsolePrintf(pCtx, _T("   Evictions ...... ") INT64_FMT _T("\n"), counters.statementCacheEvictions);
+
          ConsolePrintf(pCtx, _T("Background writer requests:\n"));
          ConsolePrintf(pCtx, _T("   DCI data ....... ") INT64_FMT _T("\n"), g_idataWriteRequests);
          ConsolePrintf(pCtx, _T("   DCI raw data ... ") INT64_FMT _T("\n"), g_rawDataWriteRequests);
          ConsolePrintf(pCtx, _T("   Others ......... ") INT64_FMT _T("\n"), g_otherWriteRequests);
       }
+      else if (IsCommand(_T("DEBUG"), szBuffer, 3))
+      {
+         ConsolePrintf(pCtx, _T("Global debug level: %d\n"), nxlog_get_debug_level());
+         StructArray<DebugTagInfo> *tags = nxlog_get_debug_tags();
+         if (tags->size() > 0)
+         {
+            ConsolePrintf(pCtx, _T("\n %-32s | Level\n"), _T("Tag"));
+            ConsolePrintf(pCtx, _T("----------------------------------+------\n"));
+            for(int i = 0; i < tags->size(); i++)
+            {
+               DebugTagInfo *t = tags->get(i);
+               ConsolePrintf(pCtx, _T(" %-32s | %d\n"), t->tag, t->level);
+            }
+         }
+         delete tags;
+         ConsolePrintf(pCtx, _T("\n"));
+      }
       else if (IsCommand(_T("FDB"), szBuffer, 3))
       {
          // Get argument
@@ -708,6 +807,10 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          StrStrip(szBuffer);
          DumpObjects(pCtx, (szBuffer[0] != 0) ? szBuffer : NULL);
       }
+      else if (IsCommand(_T("PDS"), szBuffer, 2))
+      {
+         ShowPerfDataStorageStats(pCtx);
+      }
       else if (IsCommand(_T("PE"), szBuffer, 2))
       {
          ShowPredictionEngines(pCtx);
@@ -725,10 +828,17 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          ShowQueueStats(pCtx, g_dciRawDataWriterQueue, _T("Database writer (raw DCI values)"));
          ShowQueueStats(pCtx, g_pEventQueue, _T("Event processor"));
          ShowQueueStats(pCtx, &g_nodePollerQueue, _T("Node poller"));
+         ConsolePrintf(pCtx, _T("%-32s : %d\n"), _T("Status propagation"), GetStatusPropagationQueueSize());
          ShowQueueStats(pCtx, &g_syslogProcessingQueue, _T("Syslog processing"));
          ShowQueueStats(pCtx, &g_syslogWriteQueue, _T("Syslog writer"));
          ConsolePrintf(pCtx, _T("\n"));
       }
+      else if (IsCommand(_T("QUERYSTATS"), szBuffer, 4))
+      {
+         ExtractWord(pArg, szBuffer);
+         int count = _tcstol(szBuffer, &eptr, 0);
+         ShowQueryStats(pCtx, ((*eptr == 0) && (count > 0)) ? count : 20);
+      }
       else if (IsCommand(_T("ROUTING-TABLE"), szBuffer, 1))
       {
          UINT32 dwNode;
@@ -788,6 +898,39 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          ConsoleWrite(pCtx, _T("\n\x1b[1mMOBILE DEVICE SESSIONS\x1b[0m\n============================================================\n"));
          DumpMobileDeviceSessions(pCtx);
       }
+      else if (IsCommand(_T("SNMP"), szBuffer, 2))
+      {
+         LIBNXSNMP_WALK_COUNTERS counters;
+         SnmpGetWalkCounters(&counters);
+         ConsolePrintf(pCtx, _T("SNMP walk counters:\n"));
+         ConsolePrintf(pCtx, _T("   Walks ............ ") UINT64_FMT _T("\n"), counters.walks);
+         ConsolePrintf(pCtx, _T("   Requests ......... ") UINT64_FMT _T("\n"), counters.requests);
+         ConsolePrintf(pCtx, _T("   GETBULK requests . ") UINT64_FMT _T("\n"), counters.bulkRequests);
+         ConsolePrintf(pCtx, _T("   Variables ........ ") UINT64_FMT _T("\n"), counters.varbinds);
+         ConsolePrintf(pCtx, _T("   GETBULK fallbacks  ") UINT64_FMT _T("\n"), counters.bulkFallbacks);
+         ConsolePrintf(pCtx, _T("   Requests per walk  %0.2f\n"), (counters.walks > 0) ? (double)counters.requests / (double)counters.walks : 0.0);
+         UINT64 keyCacheHits, keyCacheMisses;
+         int keyCacheSize;
+         SnmpGetKeyCacheCounters(&keyCacheHits, &keyCacheMisses, &keyCacheSize);
+         ConsolePrintf(pCtx, _T("\nSNMPv3 localized key cache:\n"));
+         ConsolePrintf(pCtx, _T("   Hits ............. ") UINT64_FMT _T("\n"), keyCacheHits);
+         ConsolePrintf(pCtx, _T("   Misses ........... ") UINT64_FMT _T("\n"), keyCacheMisses);
+         ConsolePrintf(pCtx, _T("   Entries .......... %d\n"), keyCacheSize);
+         if (g_snmpEngine != NULL)
+         {
+            SNMP_AsyncEngineStats stats;
+            g_snmpEngine->getStats(&stats);
+            ConsolePrintf(pCtx, _T("\nAsynchronous SNMP engine:\n"));
+            ConsolePrintf(pCtx, _T("   Requests ......... ") UINT64_FMT _T("\n"), stats.requests);
+            ConsolePrintf(pCtx, _T("   Responses ........ ") UINT64_FMT _T("\n"), stats.responses);
+            ConsolePrintf(pCtx, _T("   Timeouts ......... ") UINT64_FMT _T("\n"), stats.timeouts);
+            ConsolePrintf(pCtx, _T("   Retransmissions .. ") UINT64_FMT _T("\n"), stats.retransmissions);
+            ConsolePrintf(pCtx, _T("   Unmatched ........ ") UINT64_FMT _T("\n"), stats.unmatchedResponses);
+            ConsolePrintf(pCtx, _T("   In flight ........ %d\n"), stats.inFlight);
+            ConsolePrintf(pCtx, _T("   Waiting .......... %d\n"), stats.waiting);
+            ConsolePrintf(pCtx, _T("   Targets .......... %d\n"), stats.targets);
+         }
+      }
       else if (IsCommand(_T("STATS"), szBuffer, 2))
       {
          ShowServerStats(pCtx);
@@ -1109,6 +1252,8 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
             _T("   at +<seconds>|<schedule> <script> [<parameters>]\n")
             _T("                             - Schedule script execution task\n")
             _T("   debug [<level>|off]       - Set debug level (valid range is 0..9)\n")
+            _T("   debug <tag> <level>|off|default\n")
+            _T("                             - Set debug level for given tag and its subtags\n")
             _T("   down                      - Shutdown NetXMS server\n")
             _T("   exec <script> [<params>]  - Executes NXSL script from script library\n")
             _T("   exit                      - Exit from remote session\n")
@@ -1122,10 +1267,12 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
             _T("   ping <address>            - Send ICMP echo request to given IP address\n")
             _T("   poll <type> <node>        - Initiate node poll\n")
             _T("   raise <exception>         - Raise exception\n")
+            _T("   reset querystats          - Reset database query statistics\n")
             _T("   set <variable> <value>    - Set value of server configuration variable\n")
             _T("   show components <node>    - Show physical components of given node\n")
             _T("   show dbcp                 - Show active sessions in database connection pool\n")
             _T("   show dbstats              - Show DB library statistics\n")
+            _T("   show debug                - Show debug levels\n")
             _T("   show fdb <node>           - Show forwarding database for node\n")
             _T("   show flags                - Show internal server flags\n")
             _T("   show heap                 - Show heap information\n")
@@ -1133,11 +1280,14 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
             _T("   show modules              - Show loaded server modules\n")
             _T("   show msgwq                - Show message wait queues information\n")
             _T("   show objects [<filter>]   - Dump network objects to screen\n")
+            _T("   show pds                  - Show performance data storage drivers statistics\n")
             _T("   show pe                   - Show registered prediction engines\n")
             _T("   show pollers              - Show poller threads state information\n")
             _T("   show queues               - Show internal queues statistics\n")
+            _T("   show querystats [<count>] - Show top database queries by total execution time\n")
             _T("   show routing-table <node> - Show cached routing table for node\n")
             _T("   show sessions             - Show active client sessions\n")
+            _T("   show snmp                 - Show SNMP walk and engine statistics\n")
             _T("   show stats                - Show server statistics\n")
             _T("   show topology <node>      - Collect and show link layer topology for node\n")
             _T("   show users                - Show users\n")
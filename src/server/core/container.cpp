@@ -138,48 +138,55 @@ BOOL Container::saveToDatabase(DB_HANDLE hdb)
 
    saveCommonProperties(hdb);
 
-	DB_STATEMENT hStmt;
-   if (IsDatabaseRecordExist(hdb, _T("object_containers"), _T("id"), m_id))
-	{
-		hStmt = DBPrepare(hdb, _T("UPDATE object_containers SET object_class=?,flags=?,auto_bind_filter=? WHERE id=?"));
-	}
-   else
-	{
-		hStmt = DBPrepare(hdb, _T("INSERT INTO object_containers (object_class,flags,auto_bind_filter,id) VALUES (?,?,?,?)"));
-	}
-	if (hStmt == NULL)
-	{
-		unlockProperties();
-		return FALSE;
-	}
+   BOOL success = TRUE;
+   if (m_modified & MODIFY_OTHER)
+   {
+      DB_STATEMENT hStmt;
+      if (IsDatabaseRecordExist(hdb, _T("object_containers"), _T("id"), m_id))
+      {
+         hStmt = DBPrepare(hdb, _T("UPDATE object_containers SET object_class=?,flags=?,auto_bind_filter=? WHERE id=?"));
+      }
+      else
+      {
+         hStmt = DBPrepare(hdb, _T("INSERT INTO object_containers (object_class,flags,auto_bind_filter,id) VALUES (?,?,?,?)"));
+      }
+      if (hStmt == NULL)
+      {
+         unlockProperties();
+         return FALSE;
+      }
 
-	DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, (LONG)getObjectClass());
-	DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, m_flags);
-	DBBind(hStmt, 3, DB_SQLTYPE_TEXT, m_bindFilterSource, DB_BIND_STATIC);
-	DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, m_id);
-	BOOL success = DBExecute(hStmt);
-	DBFreeStatement(hStmt);
+      DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, (LONG)getObjectClass());
+      DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, m_flags);
+      DBBind(hStmt, 3, DB_SQLTYPE_TEXT, m_bindFilterSource, DB_BIND_STATIC);
+      DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, m_id);
+      success = DBExecute(hStmt);
+      DBFreeStatement(hStmt);
+   }
 
 	if (success)
 	{
-		TCHAR query[256];
-
-		// Update members list
-		_sntprintf(query, sizeof(query) / sizeof(TCHAR), _T("DELETE FROM container_members WHERE container_id=%d"), m_id);
-		DBQuery(hdb, query);
-		lockChildList(false);
-		for(int i = 0; i < m_childList->size(); i++)
+		if (m_modified & MODIFY_RELATIONS)
 		{
-			_sntprintf(query, sizeof(query) / sizeof(TCHAR), _T("INSERT INTO container_members (container_id,object_id) VALUES (%d,%d)"), m_id, m_childList->get(i)->getId());
+			TCHAR query[256];
+
+			// Update members list
+			_sntprintf(query, sizeof(query) / sizeof(TCHAR), _T("DELETE FROM container_members WHERE container_id=%d"), m_id);
 			DBQuery(hdb, query);
+			lockChildList(false);
+			for(int i = 0; i < m_childList->size(); i++)
+			{
+				_sntprintf(query, sizeof(query) / sizeof(TCHAR), _T("INSERT INTO container_members (container_id,object_id) VALUES (%d,%d)"), m_id, m_childList->get(i)->getId());
+				DBQuery(hdb, query);
+			}
+			unlockChildList();
 		}
-		unlockChildList();
 
 		// Save access list
 		saveACLToDB(hdb);
 
 		// Clear modifications flag and unlock object
-		m_isModified = false;
+		m_modified = 0;
 	}
 
    unlockProperties();
@@ -238,6 +245,7 @@ void Container::calculateCompoundStatus(BOOL bForcedRecalc)
 		m_status = STATUS_NORMAL;
 		setModified();
 		unlockProperties();
+		propagateStatus();
 	}
 }
 
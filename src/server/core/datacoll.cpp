@@ -22,6 +22,11 @@
 
 #include "nxcore.h"
 
+/**
+ * Debug tag
+ */
+#define DEBUG_TAG _T("dc.collector")
+
 /**
  * Interval between DCI polling
  */
@@ -183,6 +188,18 @@ static void *GetTableData(DataCollectionTarget *dcTarget, DCTable *table, UINT32
    {
       switch(table->getDataSource())
       {
+         case DS_INTERNAL:
+            if (dcTarget->getObjectClass() == OBJECT_NODE)
+            {
+               *error = ((Node *)dcTarget)->getInternalTable(table->getName(), &result);
+               if ((*error == DCE_SUCCESS) && (result != NULL))
+                  table->updateResultColumns(result);
+            }
+            else
+            {
+               *error = DCE_NOT_SUPPORTED;
+            }
+            break;
 		   case DS_NATIVE_AGENT:
 			   if (dcTarget->getObjectClass() == OBJECT_NODE)
             {
@@ -215,6 +232,139 @@ static void *GetTableData(DataCollectionTarget *dcTarget, DCTable *table, UINT32
 	return result;
 }
 
+/**
+ * Transform and store received value into database or handle error
+ */
+static void ProcessCollectedData(DCObject *pItem, time_t currTime, void *data, UINT32 error)
+{
+   switch(error)
+   {
+      case DCE_SUCCESS:
+         if (pItem->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
+            pItem->setStatus(ITEM_STATUS_ACTIVE, true);
+         if (!((DataCollectionTarget *)pItem->getOwner())->processNewDCValue(pItem, currTime, data))
+         {
+            // value processing failed, convert to data collection error
+            pItem->processNewError(false);
+         }
+         break;
+      case DCE_COLLECTION_ERROR:
+         if (pItem->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
+            pItem->setStatus(ITEM_STATUS_ACTIVE, true);
+         pItem->processNewError(false);
+         break;
+      case DCE_NO_SUCH_INSTANCE:
+         if (pItem->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
+            pItem->setStatus(ITEM_STATUS_ACTIVE, true);
+         pItem->processNewError(true);
+         break;
+      case DCE_COMM_ERROR:
+         pItem->processNewError(false);
+         break;
+      case DCE_NOT_SUPPORTED:
+         // Change item's status
+         pItem->setStatus(ITEM_STATUS_NOT_SUPPORTED, true);
+         break;
+   }
+}
+
+/**
+ * Complete collection cycle for DC object: notify polling session and release references
+ */
+static void FinishCollection(DCObject *pItem, DataCollectionTarget *target)
+{
+   // Send session notification when force poll is performed
+   if (pItem->getPollingSession() != NULL)
+   {
+      ClientSession *session = pItem->processForcePoll();
+      session->notify(NX_NOTIFY_FORCE_DCI_POLL, pItem->getOwnerId());
+      session->decRefCount();
+   }
+
+   // Decrement node's usage counter
+   target->decRefCount();
+   if ((pItem->getSourceNode() != 0) && (pItem->getOwner() != NULL))
+   {
+      pItem->getOwner()->decRefCount();
+   }
+}
+
+/**
+ * Result of asynchronous data collection
+ */
+struct AsyncCollectionResult
+{
+   DCItem *dci;
+   DataCollectionTarget *target;
+   time_t pollTime;
+   UINT32 error;
+   TCHAR *value;
+};
+
+/**
+ * Process result of asynchronous data collection (executed by main thread pool)
+ */
+static void CompleteAsyncDataCollection(void *arg)
+{
+   AsyncCollectionResult *result = (AsyncCollectionResult *)arg;
+   DCItem *pItem = result->dci;
+
+   if (!IsShutdownInProgress())
+      ProcessCollectedData(pItem, result->pollTime, result->value, result->error);
+   FinishCollection(pItem, result->target);
+
+   if (pItem->isScheduledForDeletion())
+   {
+      nxlog_debug_tag(DEBUG_TAG, 7, _T("CompleteAsyncDataCollection(): about to destroy DC object %d \"%s\""), pItem->getId(), pItem->getName());
+      pItem->deleteFromDatabase();
+      delete pItem;
+   }
+   else
+   {
+      // Update item's last poll time and clear busy flag so item can be polled again
+      pItem->setLastPollTime(result->pollTime);
+      pItem->clearBusyFlag();
+   }
+
+   free(result->value);
+   delete result;
+}
+
+/**
+ * Callback for asynchronous SNMP request (called by SNMP engine thread)
+ */
+static void AsyncSnmpCollectionCallback(UINT32 error, const TCHAR *value, void *context)
+{
+   AsyncCollectionResult *result = (AsyncCollectionResult *)context;
+   result->error = error;
+   result->value = _tcsdup(value);
+   ThreadPoolExecute(g_mainThreadPool, CompleteAsyncDataCollection, result);
+}
+
+/**
+ * Start asynchronous data collection for DCI if possible. Returns true if
+ * request was submitted and DCI will be completed asynchronously.
+ */
+static bool StartAsyncDataCollection(DCObject *pItem, DataCollectionTarget *target, time_t currTime)
+{
+   if ((pItem->getType() != DCO_TYPE_ITEM) || (pItem->getDataSource() != DS_SNMP_AGENT) ||
+       (target->getObjectClass() != OBJECT_NODE) || ((DCItem *)pItem)->isInterpretSnmpRawValue())
+      return false;
+
+   AsyncCollectionResult *result = new AsyncCollectionResult;
+   result->dci = (DCItem *)pItem;
+   result->target = target;
+   result->pollTime = currTime;
+   result->error = DCE_COMM_ERROR;
+   result->value = NULL;
+   if (!((Node *)target)->getItemFromSNMPAsync(pItem->getSnmpPort(), pItem->getName(), AsyncSnmpCollectionCallback, result))
+   {
+      delete result;
+      return false;
+   }
+   return true;
+}
+
 /**
  * Data collector
  */
@@ -230,7 +380,7 @@ static THREAD_RESULT THREAD_CALL DataCollector(void *pArg)
 
 		if (pItem->isScheduledForDeletion())
 		{
-	      nxlog_debug(7, _T("DataCollector(): about to destroy DC object %d \"%s\" owner=%d"),
+	      nxlog_debug_tag(DEBUG_TAG, 7, _T("DataCollector(): about to destroy DC object %d \"%s\" owner=%d"),
 			            pItem->getId(), pItem->getName(), (target != NULL) ? (int)target->getId() : -1);
 			pItem->deleteFromDatabase();
 			delete pItem;
@@ -239,7 +389,7 @@ static THREAD_RESULT THREAD_CALL DataCollector(void *pArg)
 
 		if (target == NULL)
 		{
-         nxlog_debug(3, _T("DataCollector: attempt to collect information for non-existing node (DCI=%d \"%s\")"),
+         nxlog_debug_tag(DEBUG_TAG, 3, _T("DataCollector: attempt to collect information for non-existing node (DCI=%d \"%s\")"),
                      pItem->getId(), pItem->getName());
 
          // Update item's last poll time and clear busy flag so item can be polled again
@@ -248,7 +398,7 @@ static THREAD_RESULT THREAD_CALL DataCollector(void *pArg)
 		   continue;
 		}
 
-      DbgPrintf(8, _T("DataCollector(): processing DC object %d \"%s\" owner=%d sourceNode=%d"),
+      nxlog_debug_tag(DEBUG_TAG, 8, _T("DataCollector(): processing DC object %d \"%s\" owner=%d sourceNode=%d"),
 		          pItem->getId(), pItem->getName(), (target != NULL) ? (int)target->getId() : -1, pItem->getSourceNode());
       UINT32 sourceNodeId = target->getEffectiveSourceNode(pItem);
 		if (sourceNodeId != 0)
@@ -280,6 +430,9 @@ static THREAD_RESULT THREAD_CALL DataCollector(void *pArg)
       time_t currTime = time(NULL);
       if (target != NULL)
       {
+         if (!IsShutdownInProgress() && StartAsyncDataCollection(pItem, target, currTime))
+            continue;   // DCI will be completed by SNMP engine callback
+
          if (!IsShutdownInProgress())
          {
             void *data;
@@ -297,57 +450,15 @@ static THREAD_RESULT THREAD_CALL DataCollector(void *pArg)
                   break;
             }
 
-            // Transform and store received value into database or handle error
-            switch(dwError)
-            {
-               case DCE_SUCCESS:
-                  if (pItem->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
-                     pItem->setStatus(ITEM_STATUS_ACTIVE, true);
-                  if (!((DataCollectionTarget *)pItem->getOwner())->processNewDCValue(pItem, currTime, data))
-                  {
-                     // value processing failed, convert to data collection error
-                     pItem->processNewError(false);
-                  }
-                  break;
-               case DCE_COLLECTION_ERROR:
-                  if (pItem->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
-                     pItem->setStatus(ITEM_STATUS_ACTIVE, true);
-                  pItem->processNewError(false);
-                  break;
-               case DCE_NO_SUCH_INSTANCE:
-                  if (pItem->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
-                     pItem->setStatus(ITEM_STATUS_ACTIVE, true);
-                  pItem->processNewError(true);
-                  break;
-               case DCE_COMM_ERROR:
-                  pItem->processNewError(false);
-                  break;
-               case DCE_NOT_SUPPORTED:
-                  // Change item's status
-                  pItem->setStatus(ITEM_STATUS_NOT_SUPPORTED, true);
-                  break;
-            }
-         }
-
-         // Send session notification when force poll is performed
-         if (pItem->getPollingSession() != NULL)
-         {
-            ClientSession *session = pItem->processForcePoll();
-            session->notify(NX_NOTIFY_FORCE_DCI_POLL, pItem->getOwnerId());
-            session->decRefCount();
+            ProcessCollectedData(pItem, currTime, data, dwError);
          }
 
-         // Decrement node's usage counter
-         target->decRefCount();
-			if ((pItem->getSourceNode() != 0) && (pItem->getOwner() != NULL))
-			{
-				pItem->getOwner()->decRefCount();
-			}
+         FinishCollection(pItem, target);
       }
       else     /* target == NULL */
       {
 			Template *n = pItem->getOwner();
-         nxlog_debug(5, _T("DataCollector: attempt to collect information for non-existing or inaccessible node (DCI=%d \"%s\" target=%d sourceNode=%d)"),
+         nxlog_debug_tag(DEBUG_TAG, 5, _T("DataCollector: attempt to collect information for non-existing or inaccessible node (DCI=%d \"%s\" target=%d sourceNode=%d)"),
 			            pItem->getId(), pItem->getName(), (n != NULL) ? (int)n->getId() : -1, sourceNodeId);
       }
 
@@ -357,7 +468,7 @@ static THREAD_RESULT THREAD_CALL DataCollector(void *pArg)
    }
 
    free(pBuffer);
-   DbgPrintf(1, _T("Data collector thread terminated"));
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Data collector thread terminated"));
    return THREAD_OK;
 }
 
@@ -370,7 +481,7 @@ static void QueueItems(NetObj *object, void *data)
       return;
 
    WatchdogNotify(*((UINT32 *)data));
-	nxlog_debug(8, _T("ItemPoller: calling DataCollectionTarget::queueItemsForPolling for object %s [%d]"),
+	nxlog_debug_tag(DEBUG_TAG, 8, _T("ItemPoller: calling DataCollectionTarget::queueItemsForPolling for object %s [%d]"),
 				   object->getName(), object->getId());
 	((DataCollectionTarget *)object)->queueItemsForPolling(&g_dataCollectionQueue);
 }
@@ -393,7 +504,7 @@ static THREAD_RESULT THREAD_CALL ItemPoller(void *pArg)
       if (SleepAndCheckForShutdown(ITEM_POLLING_INTERVAL))
          break;      // Shutdown has arrived
       WatchdogNotify(watchdogId);
-		DbgPrintf(8, _T("ItemPoller: wakeup"));
+		nxlog_debug_tag(DEBUG_TAG, 8, _T("ItemPoller: wakeup"));
 
       qwStart = GetCurrentTimeMs();
 		g_idxNodeById.forEach(QueueItems, &watchdogId);
@@ -413,7 +524,7 @@ static THREAD_RESULT THREAD_CALL ItemPoller(void *pArg)
          dwSum += dwTimingHistory[i];
       g_dwAvgDCIQueuingTime = dwSum / (60 / ITEM_POLLING_INTERVAL);
    }
-   DbgPrintf(1, _T("Item poller thread terminated"));
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Item poller thread terminated"));
    return THREAD_OK;
 }
 
@@ -486,19 +597,19 @@ static THREAD_RESULT THREAD_CALL StatCollector(void *pArg)
  */
 THREAD_RESULT THREAD_CALL CacheLoader(void *arg)
 {
-   DbgPrintf(2, _T("DCI cache loader thread started"));
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("DCI cache loader thread started"));
    while(true)
    {
       DCItem *dci = (DCItem *)g_dciCacheLoaderQueue.getOrBlock();
       if (dci == INVALID_POINTER_VALUE)
          break;
 
-      DbgPrintf(6, _T("Loading cache for DCI %s [%d] on %s [%d]"),
+      nxlog_debug_tag(DEBUG_TAG, 6, _T("Loading cache for DCI %s [%d] on %s [%d]"),
                 dci->getName(), dci->getId(), dci->getOwnerName(), dci->getOwnerId());
       dci->reloadCache();
       dci->getOwner()->decRefCount();
    }
-   DbgPrintf(2, _T("DCI cache loader thread stopped"));
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("DCI cache loader thread stopped"));
    return THREAD_OK;
 }
 
@@ -22,6 +22,11 @@
 
 #include "nxcore.h"
 
+/**
+ * Debug tag
+ */
+#define DEBUG_TAG _T("db.writer")
+
 /**
  * Generic DB writer queue
  */
@@ -61,7 +66,7 @@ void NXCORE_EXPORTABLE QueueSQLRequest(const TCHAR *query)
 	_tcscpy(rq->query, query);
 	rq->bindCount = 0;
    g_dbWriterQueue->put(rq);
-	DbgPrintf(8, _T("SQL request queued: %s"), query);
+	nxlog_debug_tag(DEBUG_TAG, 8, _T("SQL request queued: %s"), query);
 	g_otherWriteRequests++;
 }
 
@@ -100,7 +105,7 @@ void NXCORE_EXPORTABLE QueueSQLRequest(const TCHAR *query, int bindCount, int *s
 	}
 
    g_dbWriterQueue->put(rq);
-	DbgPrintf(8, _T("SQL request queued: %s"), query);
+	nxlog_debug_tag(DEBUG_TAG, 8, _T("SQL request queued: %s"), query);
    g_otherWriteRequests++;
 }
 
@@ -207,6 +207,8 @@ DCObject::DCObject(ConfigEntry *config, Template *owner)
  */
 DCObject::~DCObject()
 {
+   if (g_flags & AF_PERFDATA_STORAGE_DRIVER_LOADED)
+      PerfDataStorageRemoveRequests(this);
    safe_free(m_transformationScriptSource);
    delete m_transformationScript;
    delete m_schedules;
@@ -416,6 +418,8 @@ void DCObject::setStatus(int status, bool generateEvent)
 		static const TCHAR *originName[8] = { _T("Internal"), _T("NetXMS Agent"), _T("SNMP"), _T("CheckPoint SNMP"), _T("Push"), _T("WinPerf"), _T("iLO"), _T("Script") };
 		PostEvent(eventCode[status], m_owner->getId(), "dssds", m_id, m_name, m_description, m_source, originName[m_source]);
 	}
+	if (generateEvent && (m_owner != NULL) && (m_status != (BYTE)status))
+		m_owner->markAsModified(MODIFY_DATA_COLLECTION, false);  // status change detected by data collection should be saved by syncer
 	m_status = (BYTE)status;
 }
 
@@ -0,0 +1,134 @@
+/*
+** NetXMS - Network Management System
+** Copyright (C) 2003-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: dcpartition.cpp
+**
+**/
+
+#include "nxcore.h"
+
+/**
+ * Time ahead of current time covered by pre-created partitions (in seconds)
+ */
+#define PARTITION_PRECREATE_TIME    (7 * 86400)
+
+/**
+ * Partition interval in seconds (0 if data tables are not partitioned)
+ */
+static UINT32 s_partitionInterval = 0;
+
+/**
+ * Initialize data table partitioning. Partitioning is enabled by nxdbmgr
+ * by setting metadata variable DataPartitionInterval (partition size in days).
+ */
+void InitDataPartitioning()
+{
+   INT32 days = MetaDataReadInt32(_T("DataPartitionInterval"), 0);
+   if (days <= 0)
+      return;
+
+   if (g_dbSyntax != DB_SYNTAX_PGSQL)
+   {
+      nxlog_debug(1, _T("Data table partitioning is only supported for PostgreSQL"));
+      return;
+   }
+
+   s_partitionInterval = (UINT32)days * 86400;
+   nxlog_debug(1, _T("Data tables are partitioned by time (partition interval %d days)"), days);
+}
+
+/**
+ * Check if data tables are partitioned
+ */
+bool IsDataPartitioningEnabled()
+{
+   return s_partitionInterval != 0;
+}
+
+/**
+ * Create partitions of given data table for current period and periods
+ * within PARTITION_PRECREATE_TIME from now
+ */
+static void CreatePartitions(DB_HANDLE hdb, const TCHAR *prefix, UINT32 objectId, time_t now)
+{
+   UINT32 first = (UINT32)(now / s_partitionInterval);
+   UINT32 last = (UINT32)((now + PARTITION_PRECREATE_TIME) / s_partitionInterval);
+   for(UINT32 p = first; p <= last; p++)
+   {
+      TCHAR query[256];
+      _sntprintf(query, 256, _T("CREATE TABLE IF NOT EXISTS %s_%u_p%u PARTITION OF %s_%u FOR VALUES FROM (") INT64_FMT _T(") TO (") INT64_FMT _T(")"),
+               prefix, objectId, p, prefix, objectId, (INT64)p * s_partitionInterval, (INT64)(p + 1) * s_partitionInterval);
+      DBQuery(hdb, query);
+   }
+}
+
+/**
+ * Create missing partitions of data tables for given object
+ */
+void CreateDataPartitions(DB_HANDLE hdb, UINT32 objectId)
+{
+   if (s_partitionInterval == 0)
+      return;
+
+   time_t now = time(NULL);
+   CreatePartitions(hdb, _T("idata"), objectId, now);
+   CreatePartitions(hdb, _T("tdata"), objectId, now);
+}
+
+/**
+ * Drop partitions of given data table (idata or tdata) which contain only
+ * records older than given cutoff time
+ */
+void DropExpiredDataPartitions(DB_HANDLE hdb, const TCHAR *prefix, UINT32 objectId, time_t cutoff)
+{
+   if (s_partitionInterval == 0)
+      return;
+
+   TCHAR query[512];
+   _sntprintf(query, 512,
+            _T("SELECT c.relname FROM pg_inherits i ")
+            _T("INNER JOIN pg_class c ON c.oid=i.inhrelid ")
+            _T("INNER JOIN pg_class p ON p.oid=i.inhparent ")
+            _T("WHERE p.relname='%s_%u'"), prefix, objectId);
+   DB_RESULT hResult = DBSelect(hdb, query);
+   if (hResult == NULL)
+      return;
+
+   TCHAR namePrefix[64];
+   _sntprintf(namePrefix, 64, _T("%s_%u_p"), prefix, objectId);
+   size_t prefixLen = _tcslen(namePrefix);
+
+   int count = DBGetNumRows(hResult);
+   for(int i = 0; i < count; i++)
+   {
+      TCHAR name[128];
+      DBGetField(hResult, i, 0, name, 128);
+      if (_tcsncmp(name, namePrefix, prefixLen))
+         continue;
+
+      TCHAR *eptr;
+      UINT32 period = _tcstoul(&name[prefixLen], &eptr, 10);
+      if ((*eptr != 0) || ((INT64)(period + 1) * s_partitionInterval > (INT64)cutoff))
+         continue;
+
+      DbgPrintf(4, _T("DropExpiredDataPartitions: dropping partition %s"), name);
+      _sntprintf(query, 512, _T("DROP TABLE %s"), name);
+      DBQuery(hdb, query);
+   }
+   DBFreeResult(hResult);
+}
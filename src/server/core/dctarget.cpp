@@ -156,11 +156,32 @@ void DataCollectionTarget::cleanDCIData(DB_HANDLE hdb)
    time_t now = time(NULL);
 
    lockDciAccess(false);
+
+   // With partitioned data tables records older than longest retention time
+   // are removed by dropping whole partitions, so DELETE is only needed
+   // for DCIs with shorter retention time
+   bool partitioned = IsDataPartitioningEnabled();
+   int maxItemRetention = 0;
+   int maxTableRetention = 0;
+   if (partitioned)
+   {
+      for(int i = 0; i < m_dcObjects->size(); i++)
+      {
+         DCObject *o = m_dcObjects->get(i);
+         if ((o->getType() == DCO_TYPE_ITEM) && (o->getEffectiveRetentionTime() > maxItemRetention))
+            maxItemRetention = o->getEffectiveRetentionTime();
+         else if ((o->getType() == DCO_TYPE_TABLE) && (o->getEffectiveRetentionTime() > maxTableRetention))
+            maxTableRetention = o->getEffectiveRetentionTime();
+      }
+   }
+
    for(int i = 0; i < m_dcObjects->size(); i++)
    {
       DCObject *o = m_dcObjects->get(i);
       if (o->getType() == DCO_TYPE_ITEM)
       {
+         if (partitioned && (o->getEffectiveRetentionTime() >= maxItemRetention))
+            continue;
          if (itemCount > 0)
             queryItems.append(_T(" OR "));
          queryItems.append(_T("(item_id="));
@@ -172,6 +193,8 @@ void DataCollectionTarget::cleanDCIData(DB_HANDLE hdb)
       }
       else if (o->getType() == DCO_TYPE_TABLE)
       {
+         if (partitioned && (o->getEffectiveRetentionTime() >= maxTableRetention))
+            continue;
          if (tableCount > 0)
             queryTables.append(_T(" OR "));
          queryTables.append(_T("(item_id="));
@@ -184,6 +207,15 @@ void DataCollectionTarget::cleanDCIData(DB_HANDLE hdb)
    }
    unlockDciAccess();
 
+   if (partitioned)
+   {
+      CreateDataPartitions(hdb, m_id);
+      if (maxItemRetention > 0)
+         DropExpiredDataPartitions(hdb, _T("idata"), m_id, now - maxItemRetention * 86400);
+      if (maxTableRetention > 0)
+         DropExpiredDataPartitions(hdb, _T("tdata"), m_id, now - maxTableRetention * 86400);
+   }
+
    if (itemCount > 0)
    {
       DbgPrintf(6, _T("DataCollectionTarget::cleanDCIData(%s [%d]): running query \"%s\""), m_name, m_id, (const TCHAR *)queryItems);
@@ -289,7 +321,7 @@ bool DataCollectionTarget::applyTemplateItem(UINT32 dwTemplateId, DCObject *dcOb
 	if (bResult)
 	{
 		lockProperties();
-		m_isModified = true;
+		setModified(MODIFY_DATA_COLLECTION, false);
 		unlockProperties();
 	}
    return bResult;
@@ -984,7 +1016,7 @@ void DataCollectionTarget::enterMaintenanceMode()
    lockProperties();
    m_maintenanceMode = true;
    m_maintenanceEventId = eventId;
-   setModified();
+   setModified(MODIFY_COMMON_PROPERTIES);
    unlockProperties();
 }
 
@@ -998,7 +1030,7 @@ void DataCollectionTarget::leaveMaintenanceMode()
    lockProperties();
    m_maintenanceMode = false;
    m_maintenanceEventId = 0;
-   setModified();
+   setModified(MODIFY_COMMON_PROPERTIES);
    unlockProperties();
 }
 
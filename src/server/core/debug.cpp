@@ -170,8 +170,13 @@ void ShowServerStats(CONSOLE_CTX console)
 	g_idxNodeById.forEach(DciCountCallback, &dciCount);
    ConsolePrintf(console, _T("Total number of objects:     %d\n")
                           _T("Number of monitored nodes:   %d\n")
-                          _T("Number of collectable DCIs:  %d\n\n"),
-	              g_idxObjectById.size(), g_idxNodeById.size(), dciCount);
+                          _T("Number of collectable DCIs:  %d\n")
+                          _T("Indexed FDB MAC addresses:   %d\n")
+                          _T("Last syncer cycle:           %u saved, %u deleted, ") UINT64_FMT _T(" queries, %u ms\n")
+                          _T("Syncer throughput:           %u objects/sec (%u threads)\n\n"),
+	              g_idxObjectById.size(), g_idxNodeById.size(), dciCount, MacLocationIndexSize(),
+	              g_syncerObjectsSaved, g_syncerObjectsDeleted, g_syncerQueries, g_syncerCycleTime,
+	              (g_syncerCycleTime > 0) ? (UINT32)((UINT64)g_syncerObjectsSaved * 1000 / g_syncerCycleTime) : g_syncerObjectsSaved, g_syncerThreads);
 }
 
 /**
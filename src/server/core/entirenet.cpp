@@ -49,7 +49,7 @@ BOOL Network::saveToDatabase(DB_HANDLE hdb)
    saveACLToDB(hdb);
 
    // Unlock object and clear modification flag
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
    return TRUE;
 }
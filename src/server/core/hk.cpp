@@ -137,11 +137,21 @@ static void CleanAlarmHistory(DB_HANDLE hdb)
 }
 
 /**
- * Callback for cleaning expired DCI data on node
+ * Callback for cleaning expired DCI data on data collection target
  */
 static void CleanDciData(NetObj *object, void *data)
 {
-	((DataCollectionTarget *)object)->cleanDCIData((DB_HANDLE)data);
+   if (object->isDataCollectionTarget())
+      ((DataCollectionTarget *)object)->cleanDCIData((DB_HANDLE)data);
+}
+
+/**
+ * Callback for creating data table partitions for data collection target
+ */
+static void CreateDciDataPartitions(NetObj *object, void *data)
+{
+   if (object->isDataCollectionTarget())
+      CreateDataPartitions((DB_HANDLE)data, object->getId());
 }
 
 /**
@@ -189,6 +199,14 @@ static THREAD_RESULT THREAD_CALL HouseKeeper(void *pArg)
    }
    DbgPrintf(2, _T("Housekeeper: wakeup time is %02d:%02d"), hour, minute);
 
+   // Make sure that partitions for new data exist (housekeeper may not run for a while)
+   if (IsDataPartitioningEnabled())
+   {
+      DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
+      g_idxObjectById.forEach(CreateDciDataPartitions, hdb);
+      DBConnectionPoolReleaseConnection(hdb);
+   }
+
    int sleepTime = GetSleepTime(hour, minute, 0);
    DbgPrintf(4, _T("Housekeeper: sleeping for %d seconds"), sleepTime);
 
@@ -250,9 +268,8 @@ static THREAD_RESULT THREAD_CALL HouseKeeper(void *pArg)
 			DeleteEmptySubnets();
 
 		// Remove expired DCI data
-		g_idxNodeById.forEach(CleanDciData, hdb);
-		g_idxClusterById.forEach(CleanDciData, hdb);
-		g_idxMobileDeviceById.forEach(CleanDciData, hdb);
+		// (all data collection targets, including access points and chassis)
+		g_idxObjectById.forEach(CleanDciData, hdb);
 
 		DBConnectionPoolReleaseConnection(hdb);
 
@@ -307,7 +307,7 @@ bool Interface::loadFromDatabase(DB_HANDLE hdb, UINT32 dwId)
             count++;
       }
       if ((count > 0) && (count == list->size())) // all loopback addresses
-   		m_flags |= IF_LOOPBACK;
+			m_flags |= IF_LOOPBACK;
       else
          m_flags &= ~IF_LOOPBACK;
    }
@@ -331,106 +331,110 @@ BOOL Interface::saveToDatabase(DB_HANDLE hdb)
 		return FALSE;
 	}
 
-   // Determine owning node's ID
-   Node *pNode = getParentNode();
-   if (pNode != NULL)
-      dwNodeId = pNode->getId();
-   else
-      dwNodeId = 0;
-
-   // Form and execute INSERT or UPDATE query
-	DB_STATEMENT hStmt;
-   if (IsDatabaseRecordExist(hdb, _T("interfaces"), _T("id"), m_id))
-	{
-		hStmt = DBPrepare(hdb,
-			_T("UPDATE interfaces SET node_id=?,if_type=?,if_index=?,mac_addr=?,flags=?,")
-			_T("required_polls=?,bridge_port=?,phy_slot=?,phy_port=?,")
-			_T("peer_node_id=?,peer_if_id=?,description=?,admin_state=?,")
-			_T("oper_state=?,dot1x_pae_state=?,dot1x_backend_state=?,")
-         _T("peer_proto=?,alias=?,mtu=?,speed=?,iftable_suffix=? WHERE id=?"));
-	}
-   else
-	{
-		hStmt = DBPrepare(hdb,
-			_T("INSERT INTO interfaces (node_id,if_type,if_index,mac_addr,")
-			_T("flags,required_polls,bridge_port,phy_slot,phy_port,peer_node_id,peer_if_id,description,")
-         _T("admin_state,oper_state,dot1x_pae_state,dot1x_backend_state,peer_proto,alias,mtu,speed,iftable_suffix,id) ")
-			_T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
-	}
-	if (hStmt == NULL)
-	{
-		unlockProperties();
-		return FALSE;
-	}
-
-	DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, dwNodeId);
-	DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, m_type);
-	DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, m_index);
-	DBBind(hStmt, 4, DB_SQLTYPE_VARCHAR, BinToStr(m_macAddr, MAC_ADDR_LENGTH, szMacStr), DB_BIND_STATIC);
-	DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, m_flags);
-	DBBind(hStmt, 6, DB_SQLTYPE_INTEGER, (LONG)m_requiredPollCount);
-	DBBind(hStmt, 7, DB_SQLTYPE_INTEGER, m_bridgePortNumber);
-	DBBind(hStmt, 8, DB_SQLTYPE_INTEGER, m_slotNumber);
-	DBBind(hStmt, 9, DB_SQLTYPE_INTEGER, m_portNumber);
-	DBBind(hStmt, 10, DB_SQLTYPE_INTEGER, m_peerNodeId);
-	DBBind(hStmt, 11, DB_SQLTYPE_INTEGER, m_peerInterfaceId);
-	DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, m_description, DB_BIND_STATIC);
-	DBBind(hStmt, 13, DB_SQLTYPE_INTEGER, (UINT32)m_adminState);
-	DBBind(hStmt, 14, DB_SQLTYPE_INTEGER, (UINT32)m_operState);
-	DBBind(hStmt, 15, DB_SQLTYPE_INTEGER, (UINT32)m_dot1xPaeAuthState);
-	DBBind(hStmt, 16, DB_SQLTYPE_INTEGER, (UINT32)m_dot1xBackendAuthState);
-	DBBind(hStmt, 17, DB_SQLTYPE_INTEGER, (INT32)m_peerDiscoveryProtocol);
-	DBBind(hStmt, 18, DB_SQLTYPE_VARCHAR, m_alias, DB_BIND_STATIC);
-	DBBind(hStmt, 19, DB_SQLTYPE_INTEGER, m_mtu);
-	DBBind(hStmt, 20, DB_SQLTYPE_BIGINT, m_speed);
-   if (m_ifTableSuffixLen > 0)
-   {
-      TCHAR buffer[128];
-      DBBind(hStmt, 21, DB_SQLTYPE_VARCHAR, SNMPConvertOIDToText(m_ifTableSuffixLen, m_ifTableSuffix, buffer, 128), DB_BIND_TRANSIENT);
-   }
-   else
+   BOOL success = TRUE;
+   if (m_modified & (MODIFY_OTHER | MODIFY_RELATIONS))
    {
-	   DBBind(hStmt, 21, DB_SQLTYPE_VARCHAR, NULL, DB_BIND_STATIC);
-   }
-	DBBind(hStmt, 22, DB_SQLTYPE_INTEGER, m_id);
-
-	BOOL success = DBExecute(hStmt);
-	DBFreeStatement(hStmt);
+      // Determine owning node's ID
+      Node *pNode = getParentNode();
+      if (pNode != NULL)
+         dwNodeId = pNode->getId();
+      else
+         dwNodeId = 0;
 
-   // Save IP addresses
-   if (success)
-   {
-      success = FALSE;
+      // Form and execute INSERT or UPDATE query
+		DB_STATEMENT hStmt;
+      if (IsDatabaseRecordExist(hdb, _T("interfaces"), _T("id"), m_id))
+		{
+			hStmt = DBPrepare(hdb,
+				_T("UPDATE interfaces SET node_id=?,if_type=?,if_index=?,mac_addr=?,flags=?,")
+				_T("required_polls=?,bridge_port=?,phy_slot=?,phy_port=?,")
+				_T("peer_node_id=?,peer_if_id=?,description=?,admin_state=?,")
+				_T("oper_state=?,dot1x_pae_state=?,dot1x_backend_state=?,")
+            _T("peer_proto=?,alias=?,mtu=?,speed=?,iftable_suffix=? WHERE id=?"));
+		}
+      else
+		{
+			hStmt = DBPrepare(hdb,
+				_T("INSERT INTO interfaces (node_id,if_type,if_index,mac_addr,")
+				_T("flags,required_polls,bridge_port,phy_slot,phy_port,peer_node_id,peer_if_id,description,")
+            _T("admin_state,oper_state,dot1x_pae_state,dot1x_backend_state,peer_proto,alias,mtu,speed,iftable_suffix,id) ")
+				_T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
+		}
+		if (hStmt == NULL)
+		{
+			unlockProperties();
+			return FALSE;
+		}
 
-		hStmt = DBPrepare(hdb, _T("DELETE FROM interface_address_list WHERE iface_id = ?"));
-      if (hStmt != NULL)
+		DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, dwNodeId);
+		DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, m_type);
+		DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, m_index);
+		DBBind(hStmt, 4, DB_SQLTYPE_VARCHAR, BinToStr(m_macAddr, MAC_ADDR_LENGTH, szMacStr), DB_BIND_STATIC);
+		DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, m_flags);
+		DBBind(hStmt, 6, DB_SQLTYPE_INTEGER, (LONG)m_requiredPollCount);
+		DBBind(hStmt, 7, DB_SQLTYPE_INTEGER, m_bridgePortNumber);
+		DBBind(hStmt, 8, DB_SQLTYPE_INTEGER, m_slotNumber);
+		DBBind(hStmt, 9, DB_SQLTYPE_INTEGER, m_portNumber);
+		DBBind(hStmt, 10, DB_SQLTYPE_INTEGER, m_peerNodeId);
+		DBBind(hStmt, 11, DB_SQLTYPE_INTEGER, m_peerInterfaceId);
+		DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, m_description, DB_BIND_STATIC);
+		DBBind(hStmt, 13, DB_SQLTYPE_INTEGER, (UINT32)m_adminState);
+		DBBind(hStmt, 14, DB_SQLTYPE_INTEGER, (UINT32)m_operState);
+		DBBind(hStmt, 15, DB_SQLTYPE_INTEGER, (UINT32)m_dot1xPaeAuthState);
+		DBBind(hStmt, 16, DB_SQLTYPE_INTEGER, (UINT32)m_dot1xBackendAuthState);
+		DBBind(hStmt, 17, DB_SQLTYPE_INTEGER, (INT32)m_peerDiscoveryProtocol);
+		DBBind(hStmt, 18, DB_SQLTYPE_VARCHAR, m_alias, DB_BIND_STATIC);
+		DBBind(hStmt, 19, DB_SQLTYPE_INTEGER, m_mtu);
+		DBBind(hStmt, 20, DB_SQLTYPE_BIGINT, m_speed);
+      if (m_ifTableSuffixLen > 0)
       {
-         DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, m_id);
-         success = DBExecute(hStmt);
-         DBFreeStatement(hStmt);
+         TCHAR buffer[128];
+         DBBind(hStmt, 21, DB_SQLTYPE_VARCHAR, SNMPConvertOIDToText(m_ifTableSuffixLen, m_ifTableSuffix, buffer, 128), DB_BIND_TRANSIENT);
       }
-   }
+      else
+      {
+		   DBBind(hStmt, 21, DB_SQLTYPE_VARCHAR, NULL, DB_BIND_STATIC);
+      }
+		DBBind(hStmt, 22, DB_SQLTYPE_INTEGER, m_id);
 
-   if (success && (m_ipAddressList.size() > 0))
-   {
-		hStmt = DBPrepare(hdb, _T("INSERT INTO interface_address_list (iface_id,ip_addr,ip_netmask) VALUES (?,?,?)"));
-      if (hStmt != NULL)
+		success = DBExecute(hStmt);
+		DBFreeStatement(hStmt);
+
+      // Save IP addresses
+      if (success)
       {
-         DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, m_id);
-         const ObjectArray<InetAddress> *list = m_ipAddressList.getList();
-         for(int i = 0; (i < list->size()) && success; i++)
+         success = FALSE;
+
+			hStmt = DBPrepare(hdb, _T("DELETE FROM interface_address_list WHERE iface_id = ?"));
+         if (hStmt != NULL)
          {
-            InetAddress *a = list->get(i);
-            TCHAR buffer[64];
-            DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, a->toString(buffer), DB_BIND_STATIC);
-            DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, a->getMaskBits());
+            DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, m_id);
             success = DBExecute(hStmt);
+            DBFreeStatement(hStmt);
          }
-         DBFreeStatement(hStmt);
       }
-      else
+
+      if (success && (m_ipAddressList.size() > 0))
       {
-         success = FALSE;
+			hStmt = DBPrepare(hdb, _T("INSERT INTO interface_address_list (iface_id,ip_addr,ip_netmask) VALUES (?,?,?)"));
+         if (hStmt != NULL)
+         {
+            DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, m_id);
+            const ObjectArray<InetAddress> *list = m_ipAddressList.getList();
+            for(int i = 0; (i < list->size()) && success; i++)
+            {
+               InetAddress *a = list->get(i);
+               TCHAR buffer[64];
+               DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, a->toString(buffer), DB_BIND_STATIC);
+               DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, a->getMaskBits());
+               success = DBExecute(hStmt);
+            }
+            DBFreeStatement(hStmt);
+         }
+         else
+         {
+            success = FALSE;
+         }
       }
    }
 
@@ -440,7 +444,7 @@ BOOL Interface::saveToDatabase(DB_HANDLE hdb)
 
    // Clear modifications flag and unlock object
 	if (success)
-		m_isModified = false;
+		m_modified = 0;
    unlockProperties();
 
    return success;
@@ -471,7 +475,7 @@ void Interface::statusPoll(ClientSession *session, UINT32 rqId, Queue *eventQueu
    Node *pNode = getParentNode();
    if (pNode == NULL)
    {
-      m_status = STATUS_UNKNOWN;
+      setStatus(STATUS_UNKNOWN);
       return;     // Cannot find parent node, which is VERY strange
    }
 
@@ -691,6 +695,9 @@ void Interface::statusPoll(ClientSession *session, UINT32 rqId, Queue *eventQueu
 	}
 	unlockProperties();
 
+	if (m_status != oldStatus)
+		propagateStatus();
+
 	sendPollerMsg(rqId, _T("      Interface status after poll is %s\r\n"), GetStatusAsText(m_status, true));
 	sendPollerMsg(rqId, _T("   Finished status poll on interface %s\r\n"), m_name);
 }
@@ -60,131 +60,95 @@ void BuildL2Topology(nxmap_ObjList &topology, Node *root, int nDepth, bool inclu
 }
 
 /**
- * Find connection point for interface
+ * Select connection point for interface from known locations of its MAC address
  */
-NetObj *FindInterfaceConnectionPoint(const BYTE *macAddr, int *type)
+static NetObj *SelectConnectionPoint(const BYTE *macAddr, const MacLocation *locations, int count, int *type)
 {
 	TCHAR macAddrText[32];
-	DbgPrintf(6, _T("Called FindInterfaceConnectionPoint(%s)"), MACToStr(macAddr, macAddrText));
+	MACToStr(macAddr, macAddrText);
 
    *type = CP_TYPE_INDIRECT;
+   DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): %d candidate locations found in index"), macAddrText, count);
 
 	NetObj *cp = NULL;
-	ObjectArray<NetObj> *nodes = g_idxNodeById.getObjects(true);
-
 	Node *bestMatchNode = NULL;
 	UINT32 bestMatchIfIndex = 0;
 	int bestMatchCount = 0x7FFFFFFF;
 
-	for(int i = 0; (i < nodes->size()) && (cp == NULL); i++)
+	for(int i = 0; (i < count) && (cp == NULL); i++)
 	{
-		Node *node = (Node *)nodes->get(i);
-		
-      ForwardingDatabase *fdb = node->getSwitchForwardingDatabase();
-		if (fdb != NULL)
+	   const MacLocation *location = &locations[i];
+		Node *node = (Node *)FindObjectById(location->nodeId, OBJECT_NODE);
+		if (node == NULL)
+		   continue;
+
+		if (location->source == MAC_LOCATION_FDB)
 		{
-			DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): FDB obtained for node %s [%d]"),
-			          macAddrText, node->getName(), (int)node->getId());
-         bool isStatic;
-			UINT32 ifIndex = fdb->findMacAddress(macAddr, &isStatic);
-			if (ifIndex != 0)
-			{
-			   DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): MAC address found on interface %d (%s)"),
-                      macAddrText, ifIndex, isStatic ? _T("static") : _T("dynamic"));
-				int count = fdb->getMacCountOnPort(ifIndex);
-				if (count == 1)
-				{
-               if (isStatic)
+		   DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): MAC address found on node %s [%d] interface %d (%s)"),
+		             macAddrText, node->getName(), (int)node->getId(), location->ifIndex, location->isStatic ? _T("static") : _T("dynamic"));
+         if (location->macCount == 1)
+         {
+            if (location->isStatic)
+            {
+               // keep it as best match and continue search for dynamic connection
+               bestMatchCount = 1;
+               bestMatchNode = node;
+               bestMatchIfIndex = location->ifIndex;
+            }
+            else
+            {
+               Interface *iface = node->findInterfaceByIndex(location->ifIndex);
+               if (iface != NULL)
                {
-                  // keep it as best match and continue search for dynamic connection
-   					bestMatchCount = count;
-					   bestMatchNode = node;
-					   bestMatchIfIndex = ifIndex;
+                  DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found interface %s [%d] on node %s [%d]"), macAddrText,
+                            iface->getName(), (int)iface->getId(), node->getName(), (int)node->getId());
+                  cp = iface;
+                  *type = CP_TYPE_DIRECT;
                }
                else
                {
-					   Interface *iface = node->findInterfaceByIndex(ifIndex);
-					   if (iface != NULL)
-					   {
-						   DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found interface %s [%d] on node %s [%d]"), macAddrText,
-									    iface->getName(), (int)iface->getId(), iface->getParentNode()->getName(), (int)iface->getParentNode()->getId());
-                     cp = iface;
-                     *type = CP_TYPE_DIRECT;
-					   }
-					   else
-					   {
-						   DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): cannot find interface object for node %s [%d] ifIndex %d"),
-									    macAddrText, node->getName(), node->getId(), ifIndex);
-					   }
+                  DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): cannot find interface object for node %s [%d] ifIndex %d"),
+                            macAddrText, node->getName(), node->getId(), location->ifIndex);
                }
-				}
-            else if (count < bestMatchCount)
-				{
-					bestMatchCount = count;
-					bestMatchNode = node;
-					bestMatchIfIndex = ifIndex;
-					DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found potential interface [ifIndex=%d] on node %s [%d], count %d"), 
-					          macAddrText, ifIndex, node->getName(), (int)node->getId(), count);
-				}
-			}
-			fdb->decRefCount();
+            }
+         }
+         else if (location->macCount < bestMatchCount)
+         {
+            bestMatchCount = location->macCount;
+            bestMatchNode = node;
+            bestMatchIfIndex = location->ifIndex;
+            DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found potential interface [ifIndex=%d] on node %s [%d], count %d"),
+                      macAddrText, location->ifIndex, node->getName(), (int)node->getId(), location->macCount);
+         }
 		}
-
-      if (node->isWirelessController())
-      {
-			DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): node %s [%d] is a wireless controller, checking associated stations"),
-			          macAddrText, node->getName(), (int)node->getId());
-         ObjectArray<WirelessStationInfo> *wsList = node->getWirelessStations();
-         if (wsList != NULL)
+		else if (node->isWirelessController())
+		{
+         AccessPoint *ap = (AccessPoint *)FindObjectById(location->apObjectId, OBJECT_ACCESSPOINT);
+         if (ap != NULL)
          {
-			   DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): %d wireless stations registered on node %s [%d]"),
-                      macAddrText, wsList->size(), node->getName(), (int)node->getId());
-
-            for(int i = 0; i < wsList->size(); i++)
-            {
-               WirelessStationInfo *ws = wsList->get(i);
-               if (!memcmp(ws->macAddr, macAddr, MAC_ADDR_LENGTH))
-               {
-                  AccessPoint *ap = (AccessPoint *)FindObjectById(ws->apObjectId, OBJECT_ACCESSPOINT);
-                  if (ap != NULL)
-                  {
-						   DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found matching wireless station on node %s [%d] AP %s"), macAddrText,
-									    node->getName(), (int)node->getId(), ap->getName());
-                     cp = ap;
-                     *type = CP_TYPE_WIRELESS;
-                  }
-                  else
-                  {
-                     Interface *iface = node->findInterfaceByIndex(ws->rfIndex);
-                     if (iface != NULL)
-                     {
-						      DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found matching wireless station on node %s [%d] interface %s"),
-                           macAddrText, node->getName(), (int)node->getId(), iface->getName());
-                        cp = iface;
-                        *type = CP_TYPE_WIRELESS;
-                     }
-                     else
-                     {
-						      DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found matching wireless station on node %s [%d] but cannot determine AP or interface"), 
-                           macAddrText, node->getName(), (int)node->getId());
-                     }
-                  }
-                  break;
-               }
-            }
-
-            delete wsList;
+            DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found matching wireless station on node %s [%d] AP %s"), macAddrText,
+                      node->getName(), (int)node->getId(), ap->getName());
+            cp = ap;
+            *type = CP_TYPE_WIRELESS;
          }
          else
          {
-			   DbgPrintf(6, _T("FindInterfaceConnectionPoint(%s): unable to get wireless stations from node %s [%d]"),
-			             macAddrText, node->getName(), (int)node->getId());
+            Interface *iface = node->findInterfaceByIndex(location->ifIndex);
+            if (iface != NULL)
+            {
+               DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found matching wireless station on node %s [%d] interface %s"),
+                         macAddrText, node->getName(), (int)node->getId(), iface->getName());
+               cp = iface;
+               *type = CP_TYPE_WIRELESS;
+            }
+            else
+            {
+               DbgPrintf(4, _T("FindInterfaceConnectionPoint(%s): found matching wireless station on node %s [%d] but cannot determine AP or interface"),
+                         macAddrText, node->getName(), (int)node->getId());
+            }
          }
-      }
-
-      node->decRefCount();
+		}
 	}
-	delete nodes;
 
 	if ((cp == NULL) && (bestMatchNode != NULL))
 	{
@@ -197,3 +161,58 @@ NetObj *FindInterfaceConnectionPoint(const BYTE *macAddr, int *type)
 	}
 	return cp;
 }
+
+/**
+ * Find connection point for interface
+ */
+NetObj *FindInterfaceConnectionPoint(const BYTE *macAddr, int *type)
+{
+	TCHAR macAddrText[32];
+	DbgPrintf(6, _T("Called FindInterfaceConnectionPoint(%s)"), MACToStr(macAddr, macAddrText));
+
+   MacLocation localBuffer[32];
+   MacLocation *locations = localBuffer;
+   int count = MacLocationIndexFind(macAddr, locations, 32);
+   if (count > 32)
+   {
+      locations = (MacLocation *)malloc(sizeof(MacLocation) * count);
+      count = min(MacLocationIndexFind(macAddr, locations, count), count);
+   }
+
+   NetObj *cp = SelectConnectionPoint(macAddr, locations, count, type);
+
+	if (locations != localBuffer)
+	   free(locations);
+	return cp;
+}
+
+/**
+ * Find connection point for first of given interface MAC addresses which has one.
+ * All addresses are resolved in MAC location index at once. On success index of
+ * matched address is returned via index argument.
+ */
+NetObj *FindInterfaceConnectionPoint(const BYTE *macAddrs, int count, int *index, int *type)
+{
+   DbgPrintf(6, _T("Called FindInterfaceConnectionPoint(%d addresses)"), count);
+
+   *type = CP_TYPE_INDIRECT;
+   if (count <= 0)
+      return NULL;
+
+   StructArray<MacLocation> locations(count * 2, 64);
+   int localOffsets[33];
+   int *offsets = (count < 33) ? localOffsets : (int *)malloc(sizeof(int) * (count + 1));
+   MacLocationIndexFind(macAddrs, count, &locations, offsets);
+
+   NetObj *cp = NULL;
+   for(int i = 0; (i < count) && (cp == NULL); i++)
+   {
+      cp = SelectConnectionPoint(&macAddrs[i * MAC_ADDR_LENGTH], locations.get(offsets[i]), offsets[i + 1] - offsets[i], type);
+      if (cp != NULL)
+         *index = i;
+   }
+
+   if (offsets != localOffsets)
+      free(offsets);
+   return cp;
+}
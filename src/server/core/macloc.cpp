@@ -0,0 +1,362 @@
+/*
+** NetXMS - Network Management System
+** Copyright (C) 2003-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: macloc.cpp
+**
+**/
+
+#include "nxcore.h"
+#include <uthash.h>
+
+/**
+ * Index entry - all known locations of single MAC address
+ */
+struct MacLocationEntry
+{
+   UT_hash_handle hh;
+   BYTE macAddr[MAC_ADDR_LENGTH];
+   int count;
+   int allocated;
+   MacLocation *locations;
+};
+
+/**
+ * MAC addresses contributed to index by single node
+ */
+struct NodeMacSources
+{
+   UT_hash_handle hh;
+   UINT32 nodeId;
+   ForwardingDatabase *fdb;
+   int wsCount;
+   BYTE *wsMacAddrs;
+};
+
+/**
+ * Index root
+ */
+static MacLocationEntry *s_index = NULL;
+
+/**
+ * Per-node sources
+ */
+static NodeMacSources *s_nodes = NULL;
+
+/**
+ * Number of MAC addresses in index
+ */
+static int s_indexSize = 0;
+
+/**
+ * Access lock
+ */
+static RWLOCK s_lock = RWLockCreate();
+
+/**
+ * Add location for MAC address. If location from same node and source already exists it is left unchanged.
+ */
+static void AddLocation(const BYTE *macAddr, const MacLocation *location)
+{
+   MacLocationEntry *entry;
+   HASH_FIND(hh, s_index, macAddr, MAC_ADDR_LENGTH, entry);
+   if (entry == NULL)
+   {
+      entry = (MacLocationEntry *)malloc(sizeof(MacLocationEntry));
+      memcpy(entry->macAddr, macAddr, MAC_ADDR_LENGTH);
+      entry->count = 0;
+      entry->allocated = 4;
+      entry->locations = (MacLocation *)malloc(sizeof(MacLocation) * entry->allocated);
+      HASH_ADD_KEYPTR(hh, s_index, entry->macAddr, MAC_ADDR_LENGTH, entry);
+      s_indexSize++;
+   }
+   else
+   {
+      for(int i = 0; i < entry->count; i++)
+         if ((entry->locations[i].nodeId == location->nodeId) && (entry->locations[i].source == location->source))
+            return;
+
+      if (entry->count == entry->allocated)
+      {
+         entry->allocated *= 2;
+         entry->locations = (MacLocation *)realloc(entry->locations, sizeof(MacLocation) * entry->allocated);
+      }
+   }
+   memcpy(&entry->locations[entry->count++], location, sizeof(MacLocation));
+}
+
+/**
+ * Remove location of MAC address provided by given node and source
+ */
+static void RemoveLocation(const BYTE *macAddr, UINT32 nodeId, BYTE source)
+{
+   MacLocationEntry *entry;
+   HASH_FIND(hh, s_index, macAddr, MAC_ADDR_LENGTH, entry);
+   if (entry == NULL)
+      return;
+
+   for(int i = 0; i < entry->count; i++)
+   {
+      if ((entry->locations[i].nodeId == nodeId) && (entry->locations[i].source == source))
+      {
+         entry->count--;
+         if (i < entry->count)
+            memcpy(&entry->locations[i], &entry->locations[entry->count], sizeof(MacLocation));
+         break;
+      }
+   }
+
+   if (entry->count == 0)
+   {
+      HASH_DEL(s_index, entry);
+      free(entry->locations);
+      free(entry);
+      s_indexSize--;
+   }
+}
+
+/**
+ * Remove all FDB locations provided by given node
+ */
+static void RemoveFdbLocations(NodeMacSources *sources)
+{
+   if (sources->fdb == NULL)
+      return;
+
+   for(int i = 0; i < sources->fdb->getSize(); i++)
+      RemoveLocation(sources->fdb->getEntry(i)->macAddr, sources->nodeId, MAC_LOCATION_FDB);
+   sources->fdb->decRefCount();
+   sources->fdb = NULL;
+}
+
+/**
+ * Remove all wireless station locations provided by given node
+ */
+static void RemoveWirelessLocations(NodeMacSources *sources)
+{
+   for(int i = 0; i < sources->wsCount; i++)
+      RemoveLocation(&sources->wsMacAddrs[i * MAC_ADDR_LENGTH], sources->nodeId, MAC_LOCATION_WIRELESS);
+   free(sources->wsMacAddrs);
+   sources->wsMacAddrs = NULL;
+   sources->wsCount = 0;
+}
+
+/**
+ * Get sources record for node (create new if needed)
+ */
+static NodeMacSources *GetNodeSources(UINT32 nodeId, bool create)
+{
+   NodeMacSources *sources;
+   HASH_FIND_INT(s_nodes, &nodeId, sources);
+   if ((sources == NULL) && create)
+   {
+      sources = (NodeMacSources *)malloc(sizeof(NodeMacSources));
+      memset(sources, 0, sizeof(NodeMacSources));
+      sources->nodeId = nodeId;
+      HASH_ADD_INT(s_nodes, nodeId, sources);
+   }
+   return sources;
+}
+
+/**
+ * Compare interface indexes
+ */
+static int CompareIfIndex(const void *p1, const void *p2)
+{
+   return COMPARE_NUMBERS(*((UINT32 *)p1), *((UINT32 *)p2));
+}
+
+/**
+ * Count occurrences of given value in sorted array
+ */
+static int CountInSortedArray(const UINT32 *data, int size, UINT32 value)
+{
+   int low = 0, high = size;
+   while(low < high)
+   {
+      int mid = (low + high) / 2;
+      if (data[mid] < value)
+         low = mid + 1;
+      else
+         high = mid;
+   }
+
+   int count = 0;
+   for(int i = low; (i < size) && (data[i] == value); i++)
+      count++;
+   return count;
+}
+
+/**
+ * Replace locations provided by node's forwarding database. FDB can be NULL.
+ */
+void MacLocationIndexUpdateFdb(UINT32 nodeId, ForwardingDatabase *fdb)
+{
+   // Pre-calculate number of MAC addresses on each port outside the lock
+   int size = (fdb != NULL) ? fdb->getSize() : 0;
+   UINT32 *ports = (size > 0) ? (UINT32 *)malloc(sizeof(UINT32) * size) : NULL;
+   for(int i = 0; i < size; i++)
+      ports[i] = fdb->getEntry(i)->ifIndex;
+   if (size > 0)
+      qsort(ports, size, sizeof(UINT32), CompareIfIndex);
+
+   RWLockWriteLock(s_lock, INFINITE);
+
+   NodeMacSources *sources = GetNodeSources(nodeId, fdb != NULL);
+   if (sources != NULL)
+   {
+      RemoveFdbLocations(sources);
+
+      if (fdb != NULL)
+      {
+         MacLocation location;
+         memset(&location, 0, sizeof(MacLocation));
+         location.nodeId = nodeId;
+         location.source = MAC_LOCATION_FDB;
+         for(int i = 0; i < size; i++)
+         {
+            FDB_ENTRY *e = fdb->getEntry(i);
+            if (e->ifIndex == 0)
+               continue;
+            location.ifIndex = e->ifIndex;
+            location.macCount = CountInSortedArray(ports, size, e->ifIndex);
+            location.isStatic = (e->type == 5);
+            AddLocation(e->macAddr, &location);
+         }
+         fdb->incRefCount();
+         sources->fdb = fdb;
+      }
+      else if (sources->wsCount == 0)
+      {
+         HASH_DEL(s_nodes, sources);
+         free(sources);
+      }
+   }
+
+   RWLockUnlock(s_lock);
+   free(ports);
+}
+
+/**
+ * Replace locations provided by wireless controller's station list. Station list can be NULL.
+ */
+void MacLocationIndexUpdateWirelessStations(UINT32 nodeId, ObjectArray<WirelessStationInfo> *stations)
+{
+   bool hasStations = (stations != NULL) && (stations->size() > 0);
+
+   RWLockWriteLock(s_lock, INFINITE);
+
+   NodeMacSources *sources = GetNodeSources(nodeId, hasStations);
+   if (sources != NULL)
+   {
+      RemoveWirelessLocations(sources);
+
+      if (hasStations)
+      {
+         sources->wsMacAddrs = (BYTE *)malloc(stations->size() * MAC_ADDR_LENGTH);
+
+         MacLocation location;
+         memset(&location, 0, sizeof(MacLocation));
+         location.nodeId = nodeId;
+         location.source = MAC_LOCATION_WIRELESS;
+         for(int i = 0; i < stations->size(); i++)
+         {
+            WirelessStationInfo *ws = stations->get(i);
+            location.ifIndex = ws->rfIndex;
+            location.apObjectId = ws->apObjectId;
+            AddLocation(ws->macAddr, &location);
+            memcpy(&sources->wsMacAddrs[i * MAC_ADDR_LENGTH], ws->macAddr, MAC_ADDR_LENGTH);
+         }
+         sources->wsCount = stations->size();
+      }
+      else if (sources->fdb == NULL)
+      {
+         HASH_DEL(s_nodes, sources);
+         free(sources);
+      }
+   }
+
+   RWLockUnlock(s_lock);
+}
+
+/**
+ * Remove all locations provided by given node
+ */
+void MacLocationIndexRemoveNode(UINT32 nodeId)
+{
+   RWLockWriteLock(s_lock, INFINITE);
+   NodeMacSources *sources = GetNodeSources(nodeId, false);
+   if (sources != NULL)
+   {
+      RemoveFdbLocations(sources);
+      RemoveWirelessLocations(sources);
+      HASH_DEL(s_nodes, sources);
+      free(sources);
+   }
+   RWLockUnlock(s_lock);
+}
+
+/**
+ * Find known locations of given MAC address. Up to size locations are copied into
+ * provided buffer. Returns total number of known locations.
+ */
+int MacLocationIndexFind(const BYTE *macAddr, MacLocation *buffer, int size)
+{
+   int count = 0;
+   RWLockReadLock(s_lock, INFINITE);
+   MacLocationEntry *entry;
+   HASH_FIND(hh, s_index, macAddr, MAC_ADDR_LENGTH, entry);
+   if (entry != NULL)
+   {
+      count = entry->count;
+      memcpy(buffer, entry->locations, sizeof(MacLocation) * min(count, size));
+   }
+   RWLockUnlock(s_lock);
+   return count;
+}
+
+/**
+ * Find known locations of multiple MAC addresses under single index lock. Locations
+ * of each address are appended to given array, locations of address i start at
+ * position offsets[i]. Offsets array should have room for count + 1 elements, last
+ * element is set to total number of locations.
+ */
+void MacLocationIndexFind(const BYTE *macAddrs, int count, StructArray<MacLocation> *locations, int *offsets)
+{
+   RWLockReadLock(s_lock, INFINITE);
+   for(int i = 0; i < count; i++)
+   {
+      offsets[i] = locations->size();
+      MacLocationEntry *entry;
+      HASH_FIND(hh, s_index, &macAddrs[i * MAC_ADDR_LENGTH], MAC_ADDR_LENGTH, entry);
+      if (entry != NULL)
+      {
+         for(int j = 0; j < entry->count; j++)
+            locations->add(&entry->locations[j]);
+      }
+   }
+   RWLockUnlock(s_lock);
+   offsets[count] = locations->size();
+}
+
+/**
+ * Get number of MAC addresses in location index
+ */
+int MacLocationIndexSize()
+{
+   return s_indexSize;
+}
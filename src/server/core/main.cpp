@@ -157,6 +157,7 @@ UINT32 g_thresholdRepeatInterval = 0;	// Disabled by default
 int g_requiredPolls = 1;
 DB_DRIVER g_dbDriver = NULL;
 ThreadPool NXCORE_EXPORTABLE *g_mainThreadPool = NULL;
+SNMP_AsyncEngine *g_snmpEngine = NULL;
 INT16 g_defaultAgentCacheMode = AGENT_CACHE_OFF;
 InetAddressList g_peerNodeAddrList;
 
@@ -373,6 +374,7 @@ static void LoadGlobalConfig()
 
 	UINT32 snmpTimeout = ConfigReadInt(_T("SNMPRequestTimeout"), 1500);
    SnmpSetDefaultTimeout(snmpTimeout);
+   SnmpSetDefaultMaxRepetitions(ConfigReadULong(_T("SNMPMaxRepetitions"), 20));
 }
 
 /**
@@ -741,6 +743,7 @@ BOOL NXCORE_EXPORTABLE Initialize()
       DBSetLongRunningThreshold(lrt);
 
    MetaDataPreLoad();
+   InitDataPartitioning();
 
 	// Read server ID
    TCHAR buffer[256];
@@ -823,6 +826,23 @@ retry_db_lock:
    g_mainThreadPool = ThreadPoolCreate(8, 256, _T("MAIN"));
    g_agentConnectionThreadPool = ThreadPoolCreate(4, 256, _T("AGENT"));
 
+   // Start asynchronous SNMP engine (request limit per target set to 0 disables engine)
+   int snmpRequestsPerTarget = ConfigReadInt(_T("SNMPMaxRequestsPerTarget"), 8);
+   if (snmpRequestsPerTarget > 0)
+   {
+      g_snmpEngine = new SNMP_AsyncEngine(snmpRequestsPerTarget);
+      if (g_snmpEngine->start())
+      {
+         nxlog_debug(2, _T("Asynchronous SNMP engine started (max %d requests per target)"), snmpRequestsPerTarget);
+      }
+      else
+      {
+         nxlog_debug(1, _T("Cannot start asynchronous SNMP engine, synchronous SNMP requests will be used"));
+         delete g_snmpEngine;
+         g_snmpEngine = NULL;
+      }
+   }
+
 	// Setup unique identifiers table
 	if (!InitIdTable())
 		return FALSE;
@@ -922,6 +942,7 @@ retry_db_lock:
 	m_thPollManager = ThreadCreateEx(PollManager, 0, NULL);
 
    StartHouseKeeper();
+   StartStatusPropagation();
 
 	// Start event processor
 	ThreadCreate(EventProcessor, 0, NULL);
@@ -1048,6 +1069,7 @@ void NXCORE_EXPORTABLE Shutdown()
 
 	StopSyslogServer();
 	StopHouseKeeper();
+	StopStatusPropagation();
 
 	// Wait for critical threads
 	ThreadJoin(m_thPollManager);
@@ -1056,6 +1078,10 @@ void NXCORE_EXPORTABLE Shutdown()
 
 	CloseAgentTunnels();
 
+	// Complete all outstanding SNMP requests
+	if (g_snmpEngine != NULL)
+	   g_snmpEngine->stop();
+
 	// Call shutdown functions for the modules
    // CALL_ALL_MODULES cannot be used here because it checks for shutdown flag
    for(UINT32 i = 0; i < g_dwNumModules; i++)
@@ -1073,6 +1099,8 @@ void NXCORE_EXPORTABLE Shutdown()
 	nxlog_debug(2, _T("All persistent storage values saved"));
 	DBConnectionPoolReleaseConnection(hdb);
 
+	ShutdownPerfDataStorageDrivers();
+
 	StopDBWriter();
 	nxlog_debug(1, _T("Database writer stopped"));
 
@@ -1093,6 +1121,7 @@ void NXCORE_EXPORTABLE Shutdown()
 
 	ThreadPoolDestroy(g_agentConnectionThreadPool);
    ThreadPoolDestroy(g_mainThreadPool);
+   delete_and_null(g_snmpEngine);
    MsgWaitQueue::shutdown();
    WatchdogShutdown();
 
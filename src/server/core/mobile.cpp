@@ -144,7 +144,7 @@ BOOL MobileDevice::saveToDatabase(DB_HANDLE hdb)
 	}
 
    // Save data collection items
-   if (bResult)
+   if (bResult && (m_modified & MODIFY_DATA_COLLECTION))
    {
 		lockDciAccess(false);
       for(int i = 0; i < m_dcObjects->size(); i++)
@@ -157,7 +157,7 @@ BOOL MobileDevice::saveToDatabase(DB_HANDLE hdb)
 
    // Clear modifications flag and unlock object
 	if (bResult)
-		m_isModified = false;
+		m_modified = 0;
    unlockProperties();
 
    return bResult;
@@ -334,6 +334,7 @@ void MobileDevice::calculateCompoundStatus(BOOL bForcedRecalc)
       m_status = STATUS_NORMAL;
       setModified();
       unlockProperties();
+      propagateStatus();
    }
 }
 
@@ -201,12 +201,9 @@ void NetworkMap::calculateCompoundStatus(BOOL bForcedRecalc)
          unlockProperties();
 
          // Cause parent object(s) to recalculate it's status
+         propagateStatus(bForcedRecalc ? true : false);
          if ((iOldStatus != m_status) || bForcedRecalc)
          {
-            lockParentList(false);
-            for(int i = 0; i < m_parentList->size(); i++)
-               m_parentList->get(i)->calculateCompoundStatus();
-            unlockParentList();
             lockProperties();
             setModified();
             unlockProperties();
@@ -218,10 +215,7 @@ void NetworkMap::calculateCompoundStatus(BOOL bForcedRecalc)
       if (m_status != STATUS_NORMAL)
       {
          m_status = STATUS_NORMAL;
-         lockParentList(false);
-         for(int i = 0; i < m_parentList->size(); i++)
-            m_parentList->get(i)->calculateCompoundStatus();
-         unlockParentList();
+         propagateStatus();
          lockProperties();
          setModified();
          unlockProperties();
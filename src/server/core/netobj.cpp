@@ -40,6 +40,11 @@ static const TCHAR *s_className[]=
       _T("AgentPolicyLogParser"), _T("Chassis")
    };
 
+/**
+ * Lock for child status counters and reported statuses (always acquired after object's list locks)
+ */
+static MUTEX s_childStatusLock = MutexCreate();
+
 /**
  * Default constructor
  */
@@ -55,9 +60,14 @@ NetObj::NetObj()
    m_rwlockParentList = RWLockCreate();
    m_rwlockChildList = RWLockCreate();
    m_status = STATUS_UNKNOWN;
+   m_reportedStatus = STATUS_UNKNOWN;
+   memset(m_childStatusCount, 0, sizeof(m_childStatusCount));
+   m_childStatusValid = false;
    m_name[0] = 0;
    m_comments = NULL;
-   m_isModified = false;
+   m_modified = 0;
+   m_modifiedDuringSave = 0;
+   m_saveInProgress = false;
    m_isDeleted = false;
    m_isHidden = false;
 	m_isSystem = false;
@@ -387,79 +397,83 @@ static EnumerationCallbackResult SaveModuleDataCallback(const TCHAR *key, const
  */
 bool NetObj::saveCommonProperties(DB_HANDLE hdb)
 {
-	DB_STATEMENT hStmt;
-	if (IsDatabaseRecordExist(hdb, _T("object_properties"), _T("object_id"), m_id))
-	{
-		hStmt = DBPrepare(hdb,
-                    _T("UPDATE object_properties SET name=?,status=?,")
-                    _T("is_deleted=?,inherit_access_rights=?,")
-                    _T("last_modified=?,status_calc_alg=?,status_prop_alg=?,")
-                    _T("status_fixed_val=?,status_shift=?,status_translation=?,")
-                    _T("status_single_threshold=?,status_thresholds=?,")
-                    _T("comments=?,is_system=?,location_type=?,latitude=?,")
-						  _T("longitude=?,location_accuracy=?,location_timestamp=?,")
-						  _T("guid=?,image=?,submap_id=?,country=?,city=?,")
-                    _T("street_address=?,postcode=?,maint_mode=?,maint_event_id=? WHERE object_id=?"));
-	}
-	else
-	{
-		hStmt = DBPrepare(hdb,
-                    _T("INSERT INTO object_properties (name,status,is_deleted,")
-                    _T("inherit_access_rights,last_modified,status_calc_alg,")
-                    _T("status_prop_alg,status_fixed_val,status_shift,status_translation,")
-                    _T("status_single_threshold,status_thresholds,comments,is_system,")
-						  _T("location_type,latitude,longitude,location_accuracy,location_timestamp,")
-						  _T("guid,image,submap_id,country,city,street_address,postcode,maint_mode,")
-						  _T("maint_event_id,object_id) ")
-                    _T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
-	}
-	if (hStmt == NULL)
-		return false;
+   DB_STATEMENT hStmt;
+   bool success = true;
+   if (m_modified & MODIFY_COMMON_PROPERTIES)
+   {
+		if (IsDatabaseRecordExist(hdb, _T("object_properties"), _T("object_id"), m_id))
+		{
+			hStmt = DBPrepare(hdb,
+                       _T("UPDATE object_properties SET name=?,status=?,")
+                       _T("is_deleted=?,inherit_access_rights=?,")
+                       _T("last_modified=?,status_calc_alg=?,status_prop_alg=?,")
+                       _T("status_fixed_val=?,status_shift=?,status_translation=?,")
+                       _T("status_single_threshold=?,status_thresholds=?,")
+                       _T("comments=?,is_system=?,location_type=?,latitude=?,")
+							  _T("longitude=?,location_accuracy=?,location_timestamp=?,")
+							  _T("guid=?,image=?,submap_id=?,country=?,city=?,")
+                       _T("street_address=?,postcode=?,maint_mode=?,maint_event_id=? WHERE object_id=?"));
+		}
+		else
+		{
+			hStmt = DBPrepare(hdb,
+                       _T("INSERT INTO object_properties (name,status,is_deleted,")
+                       _T("inherit_access_rights,last_modified,status_calc_alg,")
+                       _T("status_prop_alg,status_fixed_val,status_shift,status_translation,")
+                       _T("status_single_threshold,status_thresholds,comments,is_system,")
+							  _T("location_type,latitude,longitude,location_accuracy,location_timestamp,")
+							  _T("guid,image,submap_id,country,city,street_address,postcode,maint_mode,")
+							  _T("maint_event_id,object_id) ")
+                       _T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
+		}
+		if (hStmt == NULL)
+			return false;
 
-   TCHAR szTranslation[16], szThresholds[16], lat[32], lon[32];
-   for(int i = 0, j = 0; i < 4; i++, j += 2)
-   {
-      _sntprintf(&szTranslation[j], 16 - j, _T("%02X"), (BYTE)m_statusTranslation[i]);
-      _sntprintf(&szThresholds[j], 16 - j, _T("%02X"), (BYTE)m_statusThresholds[i]);
-   }
-	_sntprintf(lat, 32, _T("%f"), m_geoLocation.getLatitude());
-	_sntprintf(lon, 32, _T("%f"), m_geoLocation.getLongitude());
-
-	DBBind(hStmt, 1, DB_SQLTYPE_VARCHAR, m_name, DB_BIND_STATIC);
-	DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, (LONG)m_status);
-   DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, (LONG)(m_isDeleted ? 1 : 0));
-	DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, (LONG)(m_inheritAccessRights ? 1 : 0));
-	DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, (LONG)m_dwTimeStamp);
-	DBBind(hStmt, 6, DB_SQLTYPE_INTEGER, (LONG)m_statusCalcAlg);
-	DBBind(hStmt, 7, DB_SQLTYPE_INTEGER, (LONG)m_statusPropAlg);
-	DBBind(hStmt, 8, DB_SQLTYPE_INTEGER, (LONG)m_fixedStatus);
-	DBBind(hStmt, 9, DB_SQLTYPE_INTEGER, (LONG)m_statusShift);
-	DBBind(hStmt, 10, DB_SQLTYPE_VARCHAR, szTranslation, DB_BIND_STATIC);
-	DBBind(hStmt, 11, DB_SQLTYPE_INTEGER, (LONG)m_statusSingleThreshold);
-	DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, szThresholds, DB_BIND_STATIC);
-	DBBind(hStmt, 13, DB_SQLTYPE_VARCHAR, m_comments, DB_BIND_STATIC);
-   DBBind(hStmt, 14, DB_SQLTYPE_INTEGER, (LONG)(m_isSystem ? 1 : 0));
-	DBBind(hStmt, 15, DB_SQLTYPE_INTEGER, (LONG)m_geoLocation.getType());
-	DBBind(hStmt, 16, DB_SQLTYPE_VARCHAR, lat, DB_BIND_STATIC);
-	DBBind(hStmt, 17, DB_SQLTYPE_VARCHAR, lon, DB_BIND_STATIC);
-	DBBind(hStmt, 18, DB_SQLTYPE_INTEGER, (LONG)m_geoLocation.getAccuracy());
-	DBBind(hStmt, 19, DB_SQLTYPE_INTEGER, (UINT32)m_geoLocation.getTimestamp());
-	DBBind(hStmt, 20, DB_SQLTYPE_VARCHAR, m_guid);
-	DBBind(hStmt, 21, DB_SQLTYPE_VARCHAR, m_image);
-	DBBind(hStmt, 22, DB_SQLTYPE_INTEGER, m_submapId);
-	DBBind(hStmt, 23, DB_SQLTYPE_VARCHAR, m_postalAddress->getCountry(), DB_BIND_STATIC);
-	DBBind(hStmt, 24, DB_SQLTYPE_VARCHAR, m_postalAddress->getCity(), DB_BIND_STATIC);
-	DBBind(hStmt, 25, DB_SQLTYPE_VARCHAR, m_postalAddress->getStreetAddress(), DB_BIND_STATIC);
-	DBBind(hStmt, 26, DB_SQLTYPE_VARCHAR, m_postalAddress->getPostCode(), DB_BIND_STATIC);
-   DBBind(hStmt, 27, DB_SQLTYPE_VARCHAR, m_maintenanceMode ? _T("1") : _T("0"), DB_BIND_STATIC);
-   DBBind(hStmt, 28, DB_SQLTYPE_BIGINT, m_maintenanceEventId);
-	DBBind(hStmt, 29, DB_SQLTYPE_INTEGER, m_id);
-
-   bool success = DBExecute(hStmt);
-	DBFreeStatement(hStmt);
+      TCHAR szTranslation[16], szThresholds[16], lat[32], lon[32];
+      for(int i = 0, j = 0; i < 4; i++, j += 2)
+      {
+         _sntprintf(&szTranslation[j], 16 - j, _T("%02X"), (BYTE)m_statusTranslation[i]);
+         _sntprintf(&szThresholds[j], 16 - j, _T("%02X"), (BYTE)m_statusThresholds[i]);
+      }
+		_sntprintf(lat, 32, _T("%f"), m_geoLocation.getLatitude());
+		_sntprintf(lon, 32, _T("%f"), m_geoLocation.getLongitude());
+
+		DBBind(hStmt, 1, DB_SQLTYPE_VARCHAR, m_name, DB_BIND_STATIC);
+		DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, (LONG)m_status);
+      DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, (LONG)(m_isDeleted ? 1 : 0));
+		DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, (LONG)(m_inheritAccessRights ? 1 : 0));
+		DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, (LONG)m_dwTimeStamp);
+		DBBind(hStmt, 6, DB_SQLTYPE_INTEGER, (LONG)m_statusCalcAlg);
+		DBBind(hStmt, 7, DB_SQLTYPE_INTEGER, (LONG)m_statusPropAlg);
+		DBBind(hStmt, 8, DB_SQLTYPE_INTEGER, (LONG)m_fixedStatus);
+		DBBind(hStmt, 9, DB_SQLTYPE_INTEGER, (LONG)m_statusShift);
+		DBBind(hStmt, 10, DB_SQLTYPE_VARCHAR, szTranslation, DB_BIND_STATIC);
+		DBBind(hStmt, 11, DB_SQLTYPE_INTEGER, (LONG)m_statusSingleThreshold);
+		DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, szThresholds, DB_BIND_STATIC);
+		DBBind(hStmt, 13, DB_SQLTYPE_VARCHAR, m_comments, DB_BIND_STATIC);
+      DBBind(hStmt, 14, DB_SQLTYPE_INTEGER, (LONG)(m_isSystem ? 1 : 0));
+		DBBind(hStmt, 15, DB_SQLTYPE_INTEGER, (LONG)m_geoLocation.getType());
+		DBBind(hStmt, 16, DB_SQLTYPE_VARCHAR, lat, DB_BIND_STATIC);
+		DBBind(hStmt, 17, DB_SQLTYPE_VARCHAR, lon, DB_BIND_STATIC);
+		DBBind(hStmt, 18, DB_SQLTYPE_INTEGER, (LONG)m_geoLocation.getAccuracy());
+		DBBind(hStmt, 19, DB_SQLTYPE_INTEGER, (UINT32)m_geoLocation.getTimestamp());
+		DBBind(hStmt, 20, DB_SQLTYPE_VARCHAR, m_guid);
+		DBBind(hStmt, 21, DB_SQLTYPE_VARCHAR, m_image);
+		DBBind(hStmt, 22, DB_SQLTYPE_INTEGER, m_submapId);
+		DBBind(hStmt, 23, DB_SQLTYPE_VARCHAR, m_postalAddress->getCountry(), DB_BIND_STATIC);
+		DBBind(hStmt, 24, DB_SQLTYPE_VARCHAR, m_postalAddress->getCity(), DB_BIND_STATIC);
+		DBBind(hStmt, 25, DB_SQLTYPE_VARCHAR, m_postalAddress->getStreetAddress(), DB_BIND_STATIC);
+		DBBind(hStmt, 26, DB_SQLTYPE_VARCHAR, m_postalAddress->getPostCode(), DB_BIND_STATIC);
+      DBBind(hStmt, 27, DB_SQLTYPE_VARCHAR, m_maintenanceMode ? _T("1") : _T("0"), DB_BIND_STATIC);
+      DBBind(hStmt, 28, DB_SQLTYPE_BIGINT, m_maintenanceEventId);
+		DBBind(hStmt, 29, DB_SQLTYPE_INTEGER, m_id);
+
+      success = DBExecute(hStmt);
+		DBFreeStatement(hStmt);
+   }
 
    // Save custom attributes
-   if (success)
+   if (success && (m_modified & MODIFY_CUSTOM_ATTRIBUTES))
    {
 		TCHAR szQuery[512];
 		_sntprintf(szQuery, 512, _T("DELETE FROM object_custom_attributes WHERE object_id=%d"), m_id);
@@ -481,7 +495,7 @@ bool NetObj::saveCommonProperties(DB_HANDLE hdb)
    }
 
    // Save dashboard associations
-   if (success)
+   if (success && (m_modified & MODIFY_COMMON_PROPERTIES))
    {
       TCHAR szQuery[512];
       _sntprintf(szQuery, 512, _T("DELETE FROM dashboard_associations WHERE object_id=%d"), m_id);
@@ -507,7 +521,7 @@ bool NetObj::saveCommonProperties(DB_HANDLE hdb)
    }
 
    // Save module data
-   if (success && (m_moduleData != NULL))
+   if (success && (m_moduleData != NULL) && (m_modified & MODIFY_COMMON_PROPERTIES))
    {
       ModuleDataDatabaseCallbackParams data;
       data.id = m_id;
@@ -515,7 +529,7 @@ bool NetObj::saveCommonProperties(DB_HANDLE hdb)
       success = (m_moduleData->forEach(SaveModuleDataCallback, &data) == _CONTINUE);
    }
 
-	if (success)
+	if (success && (m_modified & MODIFY_COMMON_PROPERTIES))
 		success = saveTrustedNodes(hdb);
 
    return success;
@@ -535,7 +549,8 @@ void NetObj::addChild(NetObj *object)
    m_childList->add(object);
    unlockChildList();
 	incRefCount();
-   setModified();
+   invalidateChildStatus();
+   setModified(MODIFY_RELATIONS);
    DbgPrintf(7, _T("NetObj::addChild: this=%s [%d]; object=%s [%d]"), m_name, m_id, object->m_name, object->m_id);
 }
 
@@ -553,7 +568,8 @@ void NetObj::addParent(NetObj *object)
    m_parentList->add(object);
    unlockParentList();
 	incRefCount();
-   setModified();
+   object->invalidateChildStatus();
+   setModified(MODIFY_RELATIONS);
    DbgPrintf(7, _T("NetObj::addParent: this=%s [%d]; object=%s [%d]"), m_name, m_id, object->m_name, object->m_id);
 }
 
@@ -579,7 +595,8 @@ void NetObj::deleteChild(NetObj *object)
    m_childList->remove(i);
    unlockChildList();
 	decRefCount();
-   setModified();
+   invalidateChildStatus();
+   setModified(MODIFY_RELATIONS);
 }
 
 /**
@@ -604,7 +621,8 @@ void NetObj::deleteParent(NetObj *object)
    m_parentList->remove(i);
    unlockParentList();
 	decRefCount();
-   setModified();
+   object->invalidateChildStatus();
+   setModified(MODIFY_RELATIONS);
 }
 
 /**
@@ -662,6 +680,7 @@ void NetObj::deleteObject(NetObj *initiator)
    }
    m_childList->clear();
    unlockChildList();
+   invalidateChildStatus();
 
    // Remove references to this object from parent objects
    DbgPrintf(5, _T("NetObj::Delete(): clearing parent list for object %d"), m_id);
@@ -773,10 +792,13 @@ void NetObj::calculateCompoundStatus(BOOL bForcedRecalc)
       (getObjectClass() == OBJECT_NODE || getObjectClass() == OBJECT_MOBILEDEVICE || getObjectClass() == OBJECT_CLUSTER || getObjectClass() == OBJECT_ACCESSPOINT) ?
          ((DataCollectionTarget *)this)->getMostCriticalDCIStatus() : STATUS_UNKNOWN;
 
+   int childStatusCount[STATUS_UNKNOWN];
+   getChildStatusCounters(childStatusCount);
+
    int oldStatus = m_status;
-   int mostCriticalStatus, i, count, iStatusAlg;
+   int i, count, iStatusAlg;
    int nSingleThreshold, *pnThresholds;
-   int nRating[5], iChildStatus, nThresholds[4];
+   int nRating[5], nThresholds[4];
 
    lockProperties();
    if (m_statusCalcAlg == SA_CALCULATE_DEFAULT)
@@ -799,36 +821,19 @@ void NetObj::calculateCompoundStatus(BOOL bForcedRecalc)
    switch(iStatusAlg)
    {
       case SA_CALCULATE_MOST_CRITICAL:
-         lockChildList(false);
-         for(i = 0, count = 0, mostCriticalStatus = -1; i < m_childList->size(); i++)
-         {
-            iChildStatus = m_childList->get(i)->getPropagatedStatus();
-            if ((iChildStatus < STATUS_UNKNOWN) &&
-                (iChildStatus > mostCriticalStatus))
-            {
-               mostCriticalStatus = iChildStatus;
-               count++;
-            }
-         }
-         m_status = (count > 0) ? mostCriticalStatus : STATUS_UNKNOWN;
-         unlockChildList();
+         for(i = STATUS_CRITICAL; i >= STATUS_NORMAL; i--)
+            if (childStatusCount[i] > 0)
+               break;
+         m_status = (i >= STATUS_NORMAL) ? i : STATUS_UNKNOWN;
          break;
       case SA_CALCULATE_SINGLE_THRESHOLD:
       case SA_CALCULATE_MULTIPLE_THRESHOLDS:
-         // Step 1: calculate severity raitings
-         memset(nRating, 0, sizeof(int) * 5);
-         lockChildList(false);
-         for(i = 0, count = 0; i < m_childList->size(); i++)
+         // Step 1: calculate severity raitings (number of children with given or higher status)
+         for(i = STATUS_CRITICAL, count = 0; i >= STATUS_NORMAL; i--)
          {
-            iChildStatus = m_childList->get(i)->getPropagatedStatus();
-            if (iChildStatus < STATUS_UNKNOWN)
-            {
-               while(iChildStatus >= 0)
-                  nRating[iChildStatus--]++;
-               count++;
-            }
+            count += childStatusCount[i];
+            nRating[i] = count;
          }
-         unlockChildList();
 
          // Step 2: check what severity rating is above threshold
          if (count > 0)
@@ -893,15 +898,12 @@ void NetObj::calculateCompoundStatus(BOOL bForcedRecalc)
 
    unlockProperties();
 
-   // Cause parent object(s) to recalculate it's status
+   // Report new status to parent object(s) - they will recalculate own status asynchronously
+   propagateStatus(bForcedRecalc ? true : false);
    if ((oldStatus != m_status) || bForcedRecalc)
    {
-      lockParentList(false);
-      for(i = 0; i < m_parentList->size(); i++)
-         m_parentList->get(i)->calculateCompoundStatus();
-      unlockParentList();
       lockProperties();
-      setModified();
+      setModified(MODIFY_COMMON_PROPERTIES);
       unlockProperties();
    }
 }
@@ -957,6 +959,9 @@ static void EnumerationHandler(UINT32 dwUserId, UINT32 dwAccessRights, void *pAr
  */
 bool NetObj::saveACLToDB(DB_HANDLE hdb)
 {
+   if (!(m_modified & MODIFY_ACCESS_LIST))
+      return true;
+
    TCHAR szQuery[256];
    bool success = false;
    SAVE_PARAM sp;
@@ -1109,12 +1114,17 @@ static void BroadcastObjectChange(ClientSession *pSession, void *pArg)
  * Mark object as modified and put on client's notification queue
  * We assume that object is locked at the time of function call
  */
-void NetObj::setModified(bool notify)
+void NetObj::setModified(UINT32 flags, bool notify)
 {
    if (g_bModificationsLocked)
       return;
 
-   m_isModified = true;
+   // Register object in syncer's queue on first modification
+   if ((m_modified == 0) && (m_id != 0))
+      EnqueueModifiedObject(m_id);
+   m_modified |= flags;
+   if (m_saveInProgress)
+      m_modifiedDuringSave |= flags;
    m_dwTimeStamp = (UINT32)time(NULL);
 
    // Send event to all connected clients
@@ -1122,6 +1132,29 @@ void NetObj::setModified(bool notify)
       EnumerateClientSessions(BroadcastObjectChange, this);
 }
 
+/**
+ * Save modified object to database (used by syncer). Modification flags are taken
+ * as snapshot when save starts and returned to caller, so they can be restored if
+ * transaction is rolled back. Flags set while save is in progress are not cleared
+ * by save and will be handled on next save.
+ */
+bool NetObj::saveModified(DB_HANDLE hdb, UINT32 *flags)
+{
+   lockProperties();
+   *flags = m_modified;
+   m_modifiedDuringSave = 0;
+   m_saveInProgress = true;
+   unlockProperties();
+
+   bool success = (saveToDatabase(hdb) != FALSE);
+
+   lockProperties();
+   m_saveInProgress = false;
+   m_modified |= m_modifiedDuringSave;
+   unlockProperties();
+   return success;
+}
+
 /**
  * Modify object from NXCP message - common wrapper
  */
@@ -1131,6 +1164,7 @@ UINT32 NetObj::modifyFromMessage(NXCPMessage *msg)
    UINT32 rcc = modifyFromMessageInternal(msg);
    setModified();
    unlockProperties();
+   propagateStatus();   // propagation algorithm may be changed
    return rcc;
 }
 
@@ -1322,7 +1356,7 @@ void NetObj::dropUserAccess(UINT32 dwUserId)
    if (modified)
    {
       lockProperties();
-      setModified();
+      setModified(MODIFY_ACCESS_LIST);
       unlockProperties();
    }
 }
@@ -1360,10 +1394,7 @@ void NetObj::setMgmtStatus(BOOL bIsManaged)
    unlockChildList();
 
    // Cause parent object(s) to recalculate it's status
-   lockParentList(false);
-   for(int i = 0; i < m_parentList->size(); i++)
-      m_parentList->get(i)->calculateCompoundStatus();
-   unlockParentList();
+   propagateStatus(true);
 }
 
 /**
@@ -1578,6 +1609,100 @@ int NetObj::getPropagatedStatus()
    return iStatus;
 }
 
+/**
+ * Report propagated status to parent objects if it differs from previously reported one.
+ * Parents update their child status counters and are queued for status recalculation.
+ * If forced is true parents are queued even if propagated status was not changed.
+ */
+void NetObj::propagateStatus(bool forced)
+{
+   lockParentList(false);
+   MutexLock(s_childStatusLock);
+   int oldStatus = m_reportedStatus;
+   int newStatus = getPropagatedStatus();
+   bool changed = (oldStatus != newStatus);
+   if (changed)
+   {
+      m_reportedStatus = newStatus;
+      for(int i = 0; i < m_parentList->size(); i++)
+      {
+         NetObj *parent = m_parentList->get(i);
+         if (oldStatus < STATUS_UNKNOWN)
+            parent->m_childStatusCount[oldStatus]--;
+         if (newStatus < STATUS_UNKNOWN)
+            parent->m_childStatusCount[newStatus]++;
+      }
+   }
+   MutexUnlock(s_childStatusLock);
+
+   if (changed || forced)
+   {
+      for(int i = 0; i < m_parentList->size(); i++)
+         EnqueueStatusRecalculation(m_parentList->get(i)->getId());
+   }
+   unlockParentList();
+}
+
+/**
+ * Mark child status counters as out of sync with child list. Counters will be
+ * rebuilt on next status calculation.
+ */
+void NetObj::invalidateChildStatus()
+{
+   MutexLock(s_childStatusLock);
+   m_childStatusValid = false;
+   MutexUnlock(s_childStatusLock);
+}
+
+/**
+ * Get number of child objects for each propagated status (counters array should have
+ * STATUS_UNKNOWN elements). Counters are rebuilt from child list only after child list
+ * change, otherwise they are maintained incrementally by propagateStatus().
+ */
+void NetObj::getChildStatusCounters(int *counters)
+{
+   ObjectArray<NetObj> *unreported = NULL;
+
+   lockChildList(false);
+   MutexLock(s_childStatusLock);
+   if (!m_childStatusValid)
+   {
+      memset(m_childStatusCount, 0, sizeof(m_childStatusCount));
+      for(int i = 0; i < m_childList->size(); i++)
+      {
+         NetObj *object = m_childList->get(i);
+         if (object->m_reportedStatus < STATUS_UNKNOWN)
+            m_childStatusCount[object->m_reportedStatus]++;
+         if (object->getPropagatedStatus() != object->m_reportedStatus)
+         {
+            // Child status was changed without being reported to parents
+            if (unreported == NULL)
+               unreported = new ObjectArray<NetObj>(16, 16, false);
+            object->incRefCount();
+            unreported->add(object);
+         }
+      }
+      m_childStatusValid = true;
+   }
+   MutexUnlock(s_childStatusLock);
+   unlockChildList();
+
+   if (unreported != NULL)
+   {
+      for(int i = 0; i < unreported->size(); i++)
+      {
+         NetObj *object = unreported->get(i);
+         object->propagateStatus();
+         object->decRefCount();
+      }
+      delete unreported;
+   }
+
+   MutexLock(s_childStatusLock);
+   memcpy(counters, m_childStatusCount, sizeof(m_childStatusCount));
+   MutexUnlock(s_childStatusLock);
+}
+
 /**
  * Prepare object for deletion. Method should return only
  * when object deletion is safe
@@ -1595,7 +1720,7 @@ void NetObj::setComments(TCHAR *text)
    lockProperties();
    free(m_comments);
    m_comments = text;
-   setModified();
+   setModified(MODIFY_COMMON_PROPERTIES);
    unlockProperties();
 }
 
@@ -2051,7 +2176,7 @@ void NetObj::setStatusCalculation(int method, int arg1, int arg2, int arg3, int
       default:
          break;
    }
-   setModified();
+   setModified(MODIFY_COMMON_PROPERTIES);
    unlockProperties();
 }
 
@@ -2079,8 +2204,9 @@ void NetObj::setStatusPropagation(int method, int arg1, int arg2, int arg3, int
       default:
          break;
    }
-   setModified();
+   setModified(MODIFY_COMMON_PROPERTIES);
    unlockProperties();
+   propagateStatus();
 }
 
 /**
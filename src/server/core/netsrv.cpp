@@ -122,7 +122,7 @@ BOOL NetworkService::saveToDatabase(DB_HANDLE hdb)
    saveACLToDB(hdb);
 
    // Unlock object and clear modification flag
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
    return TRUE;
 }
@@ -329,7 +329,7 @@ void NetworkService::statusPoll(ClientSession *session, UINT32 rqId, Node *polle
    m_pollRequestor = session;
    if (m_hostNode == NULL)
    {
-      m_status = STATUS_UNKNOWN;
+      setStatus(STATUS_UNKNOWN);
       return;     // Service without host node, which is VERY strange
    }
 
@@ -400,7 +400,7 @@ void NetworkService::statusPoll(ClientSession *session, UINT32 rqId, Node *polle
 
 		if (m_pollCount >= ((m_requiredPollCount > 0) ? m_requiredPollCount : g_requiredPolls))
 		{
-			m_status = newStatus;
+			setStatus(newStatus);
 			m_pendingStatus = -1;	// Invalidate pending status
 			sendPollerMsg(rqId, _T("      Service status changed to %s\r\n"), GetStatusAsText(m_status, true));
 			PostEventEx(eventQueue, m_status == STATUS_NORMAL ? EVENT_SERVICE_UP :
@@ -480,102 +480,106 @@ BOOL Node::saveToDatabase(DB_HANDLE hdb)
       return FALSE;
    }
 
-   // Form and execute INSERT or UPDATE query
-   int snmpMethods = m_snmpSecurity->getAuthMethod() | (m_snmpSecurity->getPrivMethod() << 8);
-   DB_STATEMENT hStmt;
-   if (IsDatabaseRecordExist(hdb, _T("nodes"), _T("id"), m_id))
-   {
-      hStmt = DBPrepare(hdb,
-         _T("UPDATE nodes SET primary_ip=?,primary_name=?,snmp_port=?,node_flags=?,snmp_version=?,community=?,")
-         _T("status_poll_type=?,agent_port=?,auth_method=?,secret=?,snmp_oid=?,uname=?,agent_version=?,")
-         _T("platform_name=?,poller_node_id=?,zone_guid=?,proxy_node=?,snmp_proxy=?,icmp_proxy=?,required_polls=?,")
-         _T("use_ifxtable=?,usm_auth_password=?,usm_priv_password=?,usm_methods=?,snmp_sys_name=?,bridge_base_addr=?,")
-         _T("runtime_flags=?,down_since=?,driver_name=?,rack_image=?,rack_position=?,rack_height=?,rack_id=?,boot_time=?,")
-         _T("agent_cache_mode=?,snmp_sys_contact=?,snmp_sys_location=?,last_agent_comm_time=?,")
-         _T("syslog_msg_count=?,snmp_trap_count=?,node_type=?,node_subtype=?,ssh_login=?,ssh_password=?,")
-         _T("ssh_proxy=?,chassis_id=?,port_rows=?,port_numbering_scheme=?,agent_comp_mode=? WHERE id=?"));
-   }
-   else
-   {
-      hStmt = DBPrepare(hdb,
-        _T("INSERT INTO nodes (primary_ip,primary_name,snmp_port,node_flags,snmp_version,community,status_poll_type,")
-        _T("agent_port,auth_method,secret,snmp_oid,uname,agent_version,platform_name,poller_node_id,zone_guid,")
-        _T("proxy_node,snmp_proxy,icmp_proxy,required_polls,use_ifxtable,usm_auth_password,usm_priv_password,usm_methods,")
-        _T("snmp_sys_name,bridge_base_addr,runtime_flags,down_since,driver_name,rack_image,rack_position,rack_height,rack_id,boot_time,")
-        _T("agent_cache_mode,snmp_sys_contact,snmp_sys_location,last_agent_comm_time,syslog_msg_count,snmp_trap_count,")
-        _T("node_type,node_subtype,ssh_login,ssh_password,ssh_proxy,chassis_id,port_rows,port_numbering_scheme,agent_comp_mode,id) ")
-        _T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
-   }
-   if (hStmt == NULL)
-   {
-      unlockProperties();
-      return FALSE;
-   }
+   BOOL bResult = TRUE;
+   if (m_modified & MODIFY_OTHER)
+   {
+      // Form and execute INSERT or UPDATE query
+      int snmpMethods = m_snmpSecurity->getAuthMethod() | (m_snmpSecurity->getPrivMethod() << 8);
+      DB_STATEMENT hStmt;
+      if (IsDatabaseRecordExist(hdb, _T("nodes"), _T("id"), m_id))
+      {
+         hStmt = DBPrepare(hdb,
+            _T("UPDATE nodes SET primary_ip=?,primary_name=?,snmp_port=?,node_flags=?,snmp_version=?,community=?,")
+            _T("status_poll_type=?,agent_port=?,auth_method=?,secret=?,snmp_oid=?,uname=?,agent_version=?,")
+            _T("platform_name=?,poller_node_id=?,zone_guid=?,proxy_node=?,snmp_proxy=?,icmp_proxy=?,required_polls=?,")
+            _T("use_ifxtable=?,usm_auth_password=?,usm_priv_password=?,usm_methods=?,snmp_sys_name=?,bridge_base_addr=?,")
+            _T("runtime_flags=?,down_since=?,driver_name=?,rack_image=?,rack_position=?,rack_height=?,rack_id=?,boot_time=?,")
+            _T("agent_cache_mode=?,snmp_sys_contact=?,snmp_sys_location=?,last_agent_comm_time=?,")
+            _T("syslog_msg_count=?,snmp_trap_count=?,node_type=?,node_subtype=?,ssh_login=?,ssh_password=?,")
+            _T("ssh_proxy=?,chassis_id=?,port_rows=?,port_numbering_scheme=?,agent_comp_mode=? WHERE id=?"));
+      }
+      else
+      {
+         hStmt = DBPrepare(hdb,
+           _T("INSERT INTO nodes (primary_ip,primary_name,snmp_port,node_flags,snmp_version,community,status_poll_type,")
+           _T("agent_port,auth_method,secret,snmp_oid,uname,agent_version,platform_name,poller_node_id,zone_guid,")
+           _T("proxy_node,snmp_proxy,icmp_proxy,required_polls,use_ifxtable,usm_auth_password,usm_priv_password,usm_methods,")
+           _T("snmp_sys_name,bridge_base_addr,runtime_flags,down_since,driver_name,rack_image,rack_position,rack_height,rack_id,boot_time,")
+           _T("agent_cache_mode,snmp_sys_contact,snmp_sys_location,last_agent_comm_time,syslog_msg_count,snmp_trap_count,")
+           _T("node_type,node_subtype,ssh_login,ssh_password,ssh_proxy,chassis_id,port_rows,port_numbering_scheme,agent_comp_mode,id) ")
+           _T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
+      }
+      if (hStmt == NULL)
+      {
+         unlockProperties();
+         return FALSE;
+      }
 
-   TCHAR ipAddr[64], baseAddress[16], cacheMode[16], compressionMode[16];
+      TCHAR ipAddr[64], baseAddress[16], cacheMode[16], compressionMode[16];
 
-   DBBind(hStmt, 1, DB_SQLTYPE_VARCHAR, m_ipAddress.toString(ipAddr), DB_BIND_STATIC);
-   DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, m_primaryName, DB_BIND_STATIC);
-   DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, (LONG)m_snmpPort);
-   DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, m_flags);
-   DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, (LONG)m_snmpVersion);
+      DBBind(hStmt, 1, DB_SQLTYPE_VARCHAR, m_ipAddress.toString(ipAddr), DB_BIND_STATIC);
+      DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, m_primaryName, DB_BIND_STATIC);
+      DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, (LONG)m_snmpPort);
+      DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, m_flags);
+      DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, (LONG)m_snmpVersion);
 #ifdef UNICODE
-   DBBind(hStmt, 6, DB_SQLTYPE_VARCHAR, WideStringFromMBString(m_snmpSecurity->getCommunity()), DB_BIND_DYNAMIC);
+      DBBind(hStmt, 6, DB_SQLTYPE_VARCHAR, WideStringFromMBString(m_snmpSecurity->getCommunity()), DB_BIND_DYNAMIC);
 #else
-   DBBind(hStmt, 6, DB_SQLTYPE_VARCHAR, m_snmpSecurity->getCommunity(), DB_BIND_STATIC);
+      DBBind(hStmt, 6, DB_SQLTYPE_VARCHAR, m_snmpSecurity->getCommunity(), DB_BIND_STATIC);
 #endif
-   DBBind(hStmt, 7, DB_SQLTYPE_INTEGER, (LONG)m_iStatusPollType);
-   DBBind(hStmt, 8, DB_SQLTYPE_INTEGER, (LONG)m_agentPort);
-   DBBind(hStmt, 9, DB_SQLTYPE_INTEGER, (LONG)m_agentAuthMethod);
-   DBBind(hStmt, 10, DB_SQLTYPE_VARCHAR, m_szSharedSecret, DB_BIND_STATIC);
-   DBBind(hStmt, 11, DB_SQLTYPE_VARCHAR, m_szObjectId, DB_BIND_STATIC);
-   DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, m_sysDescription, DB_BIND_STATIC);
-   DBBind(hStmt, 13, DB_SQLTYPE_VARCHAR, m_szAgentVersion, DB_BIND_STATIC);
-   DBBind(hStmt, 14, DB_SQLTYPE_VARCHAR, m_szPlatformName, DB_BIND_STATIC);
-   DBBind(hStmt, 15, DB_SQLTYPE_INTEGER, m_pollerNode);
-   DBBind(hStmt, 16, DB_SQLTYPE_INTEGER, m_zoneId);
-   DBBind(hStmt, 17, DB_SQLTYPE_INTEGER, m_agentProxy);
-   DBBind(hStmt, 18, DB_SQLTYPE_INTEGER, m_snmpProxy);
-   DBBind(hStmt, 19, DB_SQLTYPE_INTEGER, m_icmpProxy);
-   DBBind(hStmt, 20, DB_SQLTYPE_INTEGER, (LONG)m_iRequiredPollCount);
-   DBBind(hStmt, 21, DB_SQLTYPE_INTEGER, (LONG)m_nUseIfXTable);
+      DBBind(hStmt, 7, DB_SQLTYPE_INTEGER, (LONG)m_iStatusPollType);
+      DBBind(hStmt, 8, DB_SQLTYPE_INTEGER, (LONG)m_agentPort);
+      DBBind(hStmt, 9, DB_SQLTYPE_INTEGER, (LONG)m_agentAuthMethod);
+      DBBind(hStmt, 10, DB_SQLTYPE_VARCHAR, m_szSharedSecret, DB_BIND_STATIC);
+      DBBind(hStmt, 11, DB_SQLTYPE_VARCHAR, m_szObjectId, DB_BIND_STATIC);
+      DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, m_sysDescription, DB_BIND_STATIC);
+      DBBind(hStmt, 13, DB_SQLTYPE_VARCHAR, m_szAgentVersion, DB_BIND_STATIC);
+      DBBind(hStmt, 14, DB_SQLTYPE_VARCHAR, m_szPlatformName, DB_BIND_STATIC);
+      DBBind(hStmt, 15, DB_SQLTYPE_INTEGER, m_pollerNode);
+      DBBind(hStmt, 16, DB_SQLTYPE_INTEGER, m_zoneId);
+      DBBind(hStmt, 17, DB_SQLTYPE_INTEGER, m_agentProxy);
+      DBBind(hStmt, 18, DB_SQLTYPE_INTEGER, m_snmpProxy);
+      DBBind(hStmt, 19, DB_SQLTYPE_INTEGER, m_icmpProxy);
+      DBBind(hStmt, 20, DB_SQLTYPE_INTEGER, (LONG)m_iRequiredPollCount);
+      DBBind(hStmt, 21, DB_SQLTYPE_INTEGER, (LONG)m_nUseIfXTable);
 #ifdef UNICODE
-   DBBind(hStmt, 22, DB_SQLTYPE_VARCHAR, WideStringFromMBString(m_snmpSecurity->getAuthPassword()), DB_BIND_DYNAMIC);
-   DBBind(hStmt, 23, DB_SQLTYPE_VARCHAR, WideStringFromMBString(m_snmpSecurity->getPrivPassword()), DB_BIND_DYNAMIC);
+      DBBind(hStmt, 22, DB_SQLTYPE_VARCHAR, WideStringFromMBString(m_snmpSecurity->getAuthPassword()), DB_BIND_DYNAMIC);
+      DBBind(hStmt, 23, DB_SQLTYPE_VARCHAR, WideStringFromMBString(m_snmpSecurity->getPrivPassword()), DB_BIND_DYNAMIC);
 #else
-   DBBind(hStmt, 22, DB_SQLTYPE_VARCHAR, m_snmpSecurity->getAuthPassword(), DB_BIND_STATIC);
-   DBBind(hStmt, 23, DB_SQLTYPE_VARCHAR, m_snmpSecurity->getPrivPassword(), DB_BIND_STATIC);
+      DBBind(hStmt, 22, DB_SQLTYPE_VARCHAR, m_snmpSecurity->getAuthPassword(), DB_BIND_STATIC);
+      DBBind(hStmt, 23, DB_SQLTYPE_VARCHAR, m_snmpSecurity->getPrivPassword(), DB_BIND_STATIC);
 #endif
-   DBBind(hStmt, 24, DB_SQLTYPE_INTEGER, (LONG)snmpMethods);
-   DBBind(hStmt, 25, DB_SQLTYPE_VARCHAR, m_sysName, DB_BIND_STATIC);
-   DBBind(hStmt, 26, DB_SQLTYPE_VARCHAR, BinToStr(m_baseBridgeAddress, MAC_ADDR_LENGTH, baseAddress), DB_BIND_STATIC);
-   DBBind(hStmt, 27, DB_SQLTYPE_INTEGER, m_dwDynamicFlags);
-   DBBind(hStmt, 28, DB_SQLTYPE_INTEGER, (LONG)m_downSince);
-   DBBind(hStmt, 29, DB_SQLTYPE_VARCHAR, (m_driver != NULL) ? m_driver->getName() : _T(""), DB_BIND_STATIC);
-   DBBind(hStmt, 30, DB_SQLTYPE_VARCHAR, m_rackImage);   // rack image
-   DBBind(hStmt, 31, DB_SQLTYPE_INTEGER, m_rackPosition); // rack position
-   DBBind(hStmt, 32, DB_SQLTYPE_INTEGER, m_rackHeight);   // device height in rack units
-   DBBind(hStmt, 33, DB_SQLTYPE_INTEGER, m_rackId);   // rack ID
-   DBBind(hStmt, 34, DB_SQLTYPE_INTEGER, (LONG)m_bootTime);
-   DBBind(hStmt, 35, DB_SQLTYPE_VARCHAR, _itot(m_agentCacheMode, cacheMode, 10), DB_BIND_STATIC, 1);
-   DBBind(hStmt, 36, DB_SQLTYPE_VARCHAR, m_sysContact, DB_BIND_STATIC);
-   DBBind(hStmt, 37, DB_SQLTYPE_VARCHAR, m_sysLocation, DB_BIND_STATIC);
-   DBBind(hStmt, 38, DB_SQLTYPE_INTEGER, (LONG)m_lastAgentCommTime);
-   DBBind(hStmt, 39, DB_SQLTYPE_BIGINT, m_syslogMessageCount);
-   DBBind(hStmt, 40, DB_SQLTYPE_BIGINT, m_snmpTrapCount);
-   DBBind(hStmt, 41, DB_SQLTYPE_INTEGER, (INT32)m_type);
-   DBBind(hStmt, 42, DB_SQLTYPE_VARCHAR, m_subType, DB_BIND_STATIC);
-   DBBind(hStmt, 43, DB_SQLTYPE_VARCHAR, m_sshLogin, DB_BIND_STATIC);
-   DBBind(hStmt, 44, DB_SQLTYPE_VARCHAR, m_sshPassword, DB_BIND_STATIC);
-   DBBind(hStmt, 45, DB_SQLTYPE_INTEGER, m_sshProxy);
-   DBBind(hStmt, 46, DB_SQLTYPE_INTEGER, m_chassisId);
-   DBBind(hStmt, 47, DB_SQLTYPE_INTEGER, m_portRowCount);
-   DBBind(hStmt, 48, DB_SQLTYPE_INTEGER, m_portNumberingScheme);
-   DBBind(hStmt, 49, DB_SQLTYPE_VARCHAR, _itot(m_agentCompressionMode, compressionMode, 10), DB_BIND_STATIC, 1);
-   DBBind(hStmt, 50, DB_SQLTYPE_INTEGER, m_id);
-
-   BOOL bResult = DBExecute(hStmt);
-   DBFreeStatement(hStmt);
+      DBBind(hStmt, 24, DB_SQLTYPE_INTEGER, (LONG)snmpMethods);
+      DBBind(hStmt, 25, DB_SQLTYPE_VARCHAR, m_sysName, DB_BIND_STATIC);
+      DBBind(hStmt, 26, DB_SQLTYPE_VARCHAR, BinToStr(m_baseBridgeAddress, MAC_ADDR_LENGTH, baseAddress), DB_BIND_STATIC);
+      DBBind(hStmt, 27, DB_SQLTYPE_INTEGER, m_dwDynamicFlags);
+      DBBind(hStmt, 28, DB_SQLTYPE_INTEGER, (LONG)m_downSince);
+      DBBind(hStmt, 29, DB_SQLTYPE_VARCHAR, (m_driver != NULL) ? m_driver->getName() : _T(""), DB_BIND_STATIC);
+      DBBind(hStmt, 30, DB_SQLTYPE_VARCHAR, m_rackImage);   // rack image
+      DBBind(hStmt, 31, DB_SQLTYPE_INTEGER, m_rackPosition); // rack position
+      DBBind(hStmt, 32, DB_SQLTYPE_INTEGER, m_rackHeight);   // device height in rack units
+      DBBind(hStmt, 33, DB_SQLTYPE_INTEGER, m_rackId);   // rack ID
+      DBBind(hStmt, 34, DB_SQLTYPE_INTEGER, (LONG)m_bootTime);
+      DBBind(hStmt, 35, DB_SQLTYPE_VARCHAR, _itot(m_agentCacheMode, cacheMode, 10), DB_BIND_STATIC, 1);
+      DBBind(hStmt, 36, DB_SQLTYPE_VARCHAR, m_sysContact, DB_BIND_STATIC);
+      DBBind(hStmt, 37, DB_SQLTYPE_VARCHAR, m_sysLocation, DB_BIND_STATIC);
+      DBBind(hStmt, 38, DB_SQLTYPE_INTEGER, (LONG)m_lastAgentCommTime);
+      DBBind(hStmt, 39, DB_SQLTYPE_BIGINT, m_syslogMessageCount);
+      DBBind(hStmt, 40, DB_SQLTYPE_BIGINT, m_snmpTrapCount);
+      DBBind(hStmt, 41, DB_SQLTYPE_INTEGER, (INT32)m_type);
+      DBBind(hStmt, 42, DB_SQLTYPE_VARCHAR, m_subType, DB_BIND_STATIC);
+      DBBind(hStmt, 43, DB_SQLTYPE_VARCHAR, m_sshLogin, DB_BIND_STATIC);
+      DBBind(hStmt, 44, DB_SQLTYPE_VARCHAR, m_sshPassword, DB_BIND_STATIC);
+      DBBind(hStmt, 45, DB_SQLTYPE_INTEGER, m_sshProxy);
+      DBBind(hStmt, 46, DB_SQLTYPE_INTEGER, m_chassisId);
+      DBBind(hStmt, 47, DB_SQLTYPE_INTEGER, m_portRowCount);
+      DBBind(hStmt, 48, DB_SQLTYPE_INTEGER, m_portNumberingScheme);
+      DBBind(hStmt, 49, DB_SQLTYPE_VARCHAR, _itot(m_agentCompressionMode, compressionMode, 10), DB_BIND_STATIC, 1);
+      DBBind(hStmt, 50, DB_SQLTYPE_INTEGER, m_id);
+
+      bResult = DBExecute(hStmt);
+      DBFreeStatement(hStmt);
+   }
 
    // Save access list
    saveACLToDB(hdb);
@@ -583,7 +587,7 @@ BOOL Node::saveToDatabase(DB_HANDLE hdb)
    unlockProperties();
 
    // Save data collection items
-   if (bResult)
+   if (bResult && (m_modified & MODIFY_DATA_COLLECTION))
    {
       lockDciAccess(false);
       for(int i = 0; i < m_dcObjects->size(); i++)
@@ -593,7 +597,7 @@ BOOL Node::saveToDatabase(DB_HANDLE hdb)
 
    // Clear modifications flag
    lockProperties();
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
 
    return bResult;
@@ -911,23 +915,32 @@ Interface *Node::findBridgePort(UINT32 bridgePortNumber)
  */
 NetObj *Node::findConnectionPoint(UINT32 *localIfId, BYTE *localMacAddr, int *type)
 {
-   NetObj *cp = NULL;
+   // Collect MAC addresses of all interfaces so they can be resolved in MAC location index at once
    lockChildList(false);
+   BYTE *macAddrs = (BYTE *)malloc(m_childList->size() * MAC_ADDR_LENGTH + 1);
+   UINT32 *ifIds = (UINT32 *)malloc(m_childList->size() * sizeof(UINT32) + 1);
+   int count = 0;
    for(int i = 0; i < m_childList->size(); i++)
    {
       if (m_childList->get(i)->getObjectClass() == OBJECT_INTERFACE)
       {
          Interface *iface = (Interface *)m_childList->get(i);
-         cp = FindInterfaceConnectionPoint(iface->getMacAddr(), type);
-         if (cp != NULL)
-         {
-            *localIfId = iface->getId();
-            memcpy(localMacAddr, iface->getMacAddr(), MAC_ADDR_LENGTH);
-            break;
-         }
+         memcpy(&macAddrs[count * MAC_ADDR_LENGTH], iface->getMacAddr(), MAC_ADDR_LENGTH);
+         ifIds[count++] = iface->getId();
       }
    }
    unlockChildList();
+
+   int index;
+   NetObj *cp = FindInterfaceConnectionPoint(macAddrs, count, &index, type);
+   if (cp != NULL)
+   {
+      *localIfId = ifIds[index];
+      memcpy(localMacAddr, &macAddrs[index * MAC_ADDR_LENGTH], MAC_ADDR_LENGTH);
+   }
+
+   free(macAddrs);
+   free(ifIds);
    return cp;
 }
 
@@ -1336,8 +1349,9 @@ restart_agent_check:
       UINT32 dwResult;
 
       DbgPrintf(6, _T("StatusPoll(%s): check SNMP"), m_name);
-      pTransport = createSnmpTransport();
-      if (pTransport != NULL)
+      bool useAsyncEngine = isAsyncSnmpAvailable();
+      pTransport = useAsyncEngine ? NULL : createSnmpTransport();
+      if (useAsyncEngine || (pTransport != NULL))
       {
          poller->setStatus(_T("check SNMP"));
          sendPollerMsg(dwRqId, _T("Checking SNMP agent connectivity\r\n"));
@@ -1346,7 +1360,10 @@ restart_agent_check:
          {
             testOid = _T(".1.3.6.1.2.1.1.2.0");
          }
-         dwResult = SnmpGet(m_snmpVersion, pTransport, testOid, NULL, 0, szBuffer, sizeof(szBuffer), 0);
+         if (useAsyncEngine)
+            dwResult = checkSnmpAgentAsync(testOid);
+         else
+            dwResult = SnmpGet(m_snmpVersion, pTransport, testOid, NULL, 0, szBuffer, sizeof(szBuffer), 0);
          if ((dwResult == SNMP_ERR_SUCCESS) || (dwResult == SNMP_ERR_NO_OBJECT))
          {
             if (m_dwDynamicFlags & NDF_SNMP_UNREACHABLE)
@@ -1357,7 +1374,7 @@ restart_agent_check:
             }
 
             // Update authoritative engine data for SNMPv3
-            if ((pTransport->getSnmpVersion() == SNMP_VERSION_3) && (pTransport->getAuthoritativeEngine() != NULL))
+            if ((pTransport != NULL) && (pTransport->getSnmpVersion() == SNMP_VERSION_3) && (pTransport->getAuthoritativeEngine() != NULL))
             {
                lockProperties();
                m_snmpSecurity->setAuthoritativeEngine(*pTransport->getAuthoritativeEngine());
@@ -1699,7 +1716,7 @@ restart_agent_check:
             DbgPrintf(5, _T("StatusPoll(%s [%d]): location set to %s, %s from agent"), m_name, m_id, loc.getLatitudeAsString(), loc.getLongitudeAsString());
             lockProperties();
             m_geoLocation = loc;
-            setModified();
+            setModified(MODIFY_COMMON_PROPERTIES);
             unlockProperties();
          }
       }
@@ -1770,7 +1787,7 @@ restart_agent_check:
    {
       PostEvent(EVENT_NODE_FLAGS_CHANGED, m_id, "xx", dwOldFlags, m_flags);
       lockProperties();
-      setModified();
+      setModified(MODIFY_OTHER);
       unlockProperties();
    }
 
@@ -3926,6 +3943,120 @@ UINT32 Node::getItemFromSNMP(WORD port, const TCHAR *param, size_t bufSize, TCHA
    return DCErrorFromSNMPError(dwResult);
 }
 
+/**
+ * Get value of first variable from response to SNMP GET request
+ */
+static UINT32 GetValueFromSnmpResponse(SNMP_PDU *response, TCHAR *buffer, size_t bufSize)
+{
+   if ((response->getNumVariables() == 0) || (response->getErrorCode() != SNMP_PDU_ERR_SUCCESS))
+      return (response->getErrorCode() == SNMP_PDU_ERR_NO_SUCH_NAME) ? SNMP_ERR_NO_OBJECT : SNMP_ERR_AGENT;
+
+   SNMP_Variable *v = response->getVariable(0);
+   if ((v->getType() == ASN_NO_SUCH_OBJECT) || (v->getType() == ASN_NO_SUCH_INSTANCE) || (v->getType() == ASN_NULL))
+      return SNMP_ERR_NO_OBJECT;
+
+   if (buffer != NULL)
+   {
+      bool convert = true;
+      v->getValueAsPrintableString(buffer, bufSize, &convert);
+   }
+   return SNMP_ERR_SUCCESS;
+}
+
+/**
+ * Check if asynchronous SNMP engine can be used for requests to this node
+ * (direct SNMP version 1 or 2c access only)
+ */
+bool Node::isAsyncSnmpAvailable()
+{
+   return (g_snmpEngine != NULL) && !(m_flags & NF_DISABLE_SNMP) &&
+          (m_snmpVersion != SNMP_VERSION_3) && (getEffectiveSnmpProxy() == 0);
+}
+
+/**
+ * Check SNMP agent connectivity using asynchronous SNMP engine
+ */
+UINT32 Node::checkSnmpAgentAsync(const TCHAR *oid)
+{
+   UINT32 oidBin[MAX_OID_LEN];
+   size_t oidLen = SNMPParseOID(oid, oidBin, MAX_OID_LEN);
+   if (oidLen == 0)
+      return SNMP_ERR_BAD_OID;
+
+   SNMP_PDU *request = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), m_snmpVersion);
+   request->bindVariable(new SNMP_Variable(oidBin, oidLen));
+
+   lockProperties();
+   SNMP_SecurityContext securityContext(m_snmpSecurity);
+   unlockProperties();
+
+   SNMP_PDU *response;
+   UINT32 rc = g_snmpEngine->doRequest(request, m_ipAddress, m_snmpPort, &securityContext, &response);
+   if (rc == SNMP_ERR_SUCCESS)
+   {
+      rc = GetValueFromSnmpResponse(response, NULL, 0);
+      delete response;
+   }
+   return rc;
+}
+
+/**
+ * Context for asynchronous SNMP DCI value request
+ */
+struct AsyncSnmpItemRequest
+{
+   void (*callback)(UINT32, const TCHAR *, void *);
+   void *context;
+};
+
+/**
+ * Completion callback for asynchronous SNMP DCI value request
+ */
+static void AsyncSnmpItemCallback(UINT32 rc, SNMP_PDU *response, void *context)
+{
+   AsyncSnmpItemRequest *request = (AsyncSnmpItemRequest *)context;
+   TCHAR buffer[MAX_RESULT_LENGTH];
+   buffer[0] = 0;
+   if (rc == SNMP_ERR_SUCCESS)
+      rc = GetValueFromSnmpResponse(response, buffer, MAX_RESULT_LENGTH);
+   request->callback(DCErrorFromSNMPError(rc), buffer, request->context);
+   delete request;
+}
+
+/**
+ * Start asynchronous request for DCI value via SNMP. Returns false if asynchronous
+ * request cannot be made (caller should use getItemFromSNMP in that case). Callback
+ * is called from SNMP engine thread with DCI error code and value and should not block.
+ */
+bool Node::getItemFromSNMPAsync(WORD port, const TCHAR *param, void (*callback)(UINT32, const TCHAR *, void *), void *context)
+{
+   if ((((m_dwDynamicFlags & NDF_SNMP_UNREACHABLE) || !(m_flags & NF_IS_SNMP)) && (port == 0)) ||
+       (m_dwDynamicFlags & NDF_UNREACHABLE) || !isAsyncSnmpAvailable())
+      return false;
+
+   UINT32 oidBin[MAX_OID_LEN];
+   size_t oidLen = SNMPParseOID(param, oidBin, MAX_OID_LEN);
+   if (oidLen == 0)
+      return false;
+
+   SNMP_PDU *pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), m_snmpVersion);
+   pdu->bindVariable(new SNMP_Variable(oidBin, oidLen));
+
+   lockProperties();
+   SNMP_SecurityContext securityContext(m_snmpSecurity);
+   unlockProperties();
+
+   AsyncSnmpItemRequest *request = new AsyncSnmpItemRequest;
+   request->callback = callback;
+   request->context = context;
+   if (g_snmpEngine->sendRequest(pdu, m_ipAddress, (port != 0) ? port : m_snmpPort, &securityContext, AsyncSnmpItemCallback, request) != SNMP_ERR_SUCCESS)
+   {
+      delete request;
+      return false;
+   }
+   return true;
+}
+
 /**
  * Read one row for SNMP table
  */
@@ -4627,6 +4758,24 @@ UINT32 Node::getInternalItem(const TCHAR *param, size_t bufSize, TCHAR *buffer)
          DBGetPerfCounters(&counters);
          _sntprintf(buffer, bufSize, UINT64_FMT, counters.totalQueries);
       }
+      else if (!_tcsicmp(param, _T("Server.DB.StatementCache.Evictions")))
+      {
+         LIBNXDB_PERF_COUNTERS counters;
+         DBGetPerfCounters(&counters);
+         _sntprintf(buffer, bufSize, UINT64_FMT, counters.statementCacheEvictions);
+      }
+      else if (!_tcsicmp(param, _T("Server.DB.StatementCache.Hits")))
+      {
+         LIBNXDB_PERF_COUNTERS counters;
+         DBGetPerfCounters(&counters);
+         _sntprintf(buffer, bufSize, UINT64_FMT, counters.statementCacheHits);
+      }
+      else if (!_tcsicmp(param, _T("Server.DB.StatementCache.Misses")))
+      {
+         LIBNXDB_PERF_COUNTERS counters;
+         DBGetPerfCounters(&counters);
+         _sntprintf(buffer, bufSize, UINT64_FMT, counters.statementCacheMisses);
+      }
       else if (!_tcsicmp(param, _T("Server.DBWriter.Requests.IData")))
       {
          _sntprintf(buffer, bufSize, UINT64_FMT, g_idataWriteRequests);
@@ -4647,6 +4796,22 @@ UINT32 Node::getInternalItem(const TCHAR *param, size_t bufSize, TCHAR *buffer)
       {
          _sntprintf(buffer, bufSize, UINT64_FMT, g_syslogMessagesReceived);
       }
+      else if (!_tcsicmp(param, _T("Server.Syncer.CycleTime")))
+      {
+         _sntprintf(buffer, bufSize, _T("%u"), g_syncerCycleTime);
+      }
+      else if (!_tcsicmp(param, _T("Server.Syncer.ObjectsDeleted")))
+      {
+         _sntprintf(buffer, bufSize, _T("%u"), g_syncerObjectsDeleted);
+      }
+      else if (!_tcsicmp(param, _T("Server.Syncer.ObjectsSaved")))
+      {
+         _sntprintf(buffer, bufSize, _T("%u"), g_syncerObjectsSaved);
+      }
+      else if (!_tcsicmp(param, _T("Server.Syncer.Queries")))
+      {
+         _sntprintf(buffer, bufSize, UINT64_FMT, g_syncerQueries);
+      }
       else if (MatchString(_T("Server.ThreadPool.ActiveRequests(*)"), param, FALSE))
       {
          rc = GetThreadPoolStat(THREAD_POOL_REQUESTS, param, buffer);
@@ -4700,6 +4865,51 @@ UINT32 Node::getInternalItem(const TCHAR *param, size_t bufSize, TCHAR *buffer)
    return rc;
 }
 
+/**
+ * Get internal table
+ */
+UINT32 Node::getInternalTable(const TCHAR *name, Table **table)
+{
+   if (!(m_flags & NF_IS_LOCAL_MGMT) || _tcsicmp(name, _T("Server.DB.QueryStatistics")))
+      return DCE_NOT_SUPPORTED;
+
+   Table *result = new Table();
+   result->setTitle(name);
+   result->addColumn(_T("QUERY"), DCI_DT_STRING, _T("Query"), true);
+   result->addColumn(_T("COUNT"), DCI_DT_UINT64, _T("Count"));
+   result->addColumn(_T("FAILED"), DCI_DT_UINT64, _T("Failed"));
+   result->addColumn(_T("TOTAL_TIME"), DCI_DT_UINT64, _T("Total time (ms)"));
+   result->addColumn(_T("AVERAGE_TIME"), DCI_DT_FLOAT, _T("Average time (ms)"));
+   result->addColumn(_T("MAX_TIME"), DCI_DT_UINT, _T("Max time (ms)"));
+   result->addColumn(_T("ROWS"), DCI_DT_UINT64, _T("Rows"));
+   result->addColumn(_T("TIME_1MS"), DCI_DT_UINT64, _T("< 1 ms"));
+   result->addColumn(_T("TIME_10MS"), DCI_DT_UINT64, _T("< 10 ms"));
+   result->addColumn(_T("TIME_100MS"), DCI_DT_UINT64, _T("< 100 ms"));
+   result->addColumn(_T("TIME_1S"), DCI_DT_UINT64, _T("< 1 s"));
+   result->addColumn(_T("TIME_10S"), DCI_DT_UINT64, _T("< 10 s"));
+   result->addColumn(_T("TIME_OVER_10S"), DCI_DT_UINT64, _T(">= 10 s"));
+
+   StructArray<LIBNXDB_QUERY_STATS> *stats = DBGetQueryStatistics();
+   for(int i = 0; i < stats->size(); i++)
+   {
+      LIBNXDB_QUERY_STATS *s = stats->get(i);
+      result->addRow();
+      result->set(0, s->fingerprint);
+      result->set(1, s->count);
+      result->set(2, s->failed);
+      result->set(3, s->totalTime);
+      result->set(4, (s->count > 0) ? (double)s->totalTime / (double)s->count : 0.0);
+      result->set(5, s->maxTime);
+      result->set(6, s->rows);
+      for(int j = 0; j < DB_QUERY_HISTOGRAM_SIZE; j++)
+         result->set(7 + j, s->histogram[j]);
+   }
+   delete stats;
+
+   *table = result;
+   return DCE_SUCCESS;
+}
+
 /**
  * Translate DCI error code into RCC
  */
@@ -5535,6 +5745,7 @@ void Node::changeIPAddress(const InetAddress& ipAddr)
       setModified();
    }
    unlockProperties();
+   propagateStatus();
 
    agentLock();
    deleteAgentConnection();
@@ -6355,7 +6566,7 @@ void Node::topologyPoll(ClientSession *pSession, UINT32 dwRqId, PollerInfo *poll
          else
             m_flags &= ~NF_HAS_VLANS;
          if (oldFlags != m_flags)
-            setModified();
+            setModified(MODIFY_OTHER);
          unlockProperties();
       }
    }
@@ -6366,6 +6577,7 @@ void Node::topologyPoll(ClientSession *pSession, UINT32 dwRqId, PollerInfo *poll
       m_fdb->decRefCount();
    m_fdb = fdb;
    MutexUnlock(m_mutexTopoAccess);
+   MacLocationIndexUpdateFdb(m_id, fdb);
    if (fdb != NULL)
    {
       DbgPrintf(4, _T("Switch forwarding database retrieved for node %s [%d]"), m_name, m_id);
@@ -6544,6 +6756,7 @@ void Node::topologyPoll(ClientSession *pSession, UINT32 dwRqId, PollerInfo *poll
          lockProperties();
          delete m_wirelessStations;
          m_wirelessStations = stations;
+         MacLocationIndexUpdateWirelessStations(m_id, stations);
          unlockProperties();
       }
    }
@@ -7828,7 +8041,7 @@ void Node::incSyslogMessageCount()
 {
    lockProperties();
    m_syslogMessageCount++;
-   setModified(false);
+   setModified(MODIFY_OTHER, false);
    unlockProperties();
 }
 
@@ -7839,7 +8052,7 @@ void Node::incSnmpTrapCount()
 {
    lockProperties();
    m_snmpTrapCount++;
-   setModified(false);
+   setModified(MODIFY_OTHER, false);
    unlockProperties();
 }
 
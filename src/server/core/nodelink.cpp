@@ -141,7 +141,7 @@ BOOL NodeLink::saveToDatabase(DB_HANDLE hdb)
 	saveACLToDB(hdb);
 
 	lockProperties();
-	m_isModified = false;
+	m_modified = 0;
 	unlockProperties();
 	return ServiceContainer::saveToDatabase(hdb);
 }
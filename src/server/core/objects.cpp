@@ -301,10 +301,14 @@ void NetObjInsert(NetObj *pObject, bool newObject, bool importedObject)
             }
          }
 
+         CreateDataPartitions(hdb, pObject->getId());
+
          DBConnectionPoolReleaseConnection(hdb);
 		}
    }
 	g_idxObjectById.put(pObject->getId(), pObject);
+   if (pObject->isModified())
+      EnqueueModifiedObject(pObject->getId());  // modifications made before object was indexed
    if (!pObject->isDeleted())
    {
       switch(pObject->getObjectClass())
@@ -494,6 +498,7 @@ void NetObjDeleteFromIndexes(NetObj *pObject)
 			break;
       case OBJECT_NODE:
 			g_idxNodeById.remove(pObject->getId());
+         MacLocationIndexRemoveNode(pObject->getId());
          if (!(((Node *)pObject)->getFlags() & NF_REMOTE_AGENT))
          {
 			   if (IsZoningEnabled())
@@ -1,6 +1,6 @@
 /* 
 ** NetXMS - Network Management System
-** Copyright (C) 2003-2014 Victor Kirhenshtein
+** Copyright (C) 2003-2017 Victor Kirhenshtein
 **
 ** This program is free software; you can redistribute it and/or modify
 ** it under the terms of the GNU General Public License as published by
@@ -23,19 +23,135 @@
 #define _WIN32_WINNT 0x0502
 #include "nxcore.h"
 #include <pdsdrv.h>
+#include <uthash.h>
 
 #define MAX_PDS_DRIVERS		8
 
+/**
+ * Maximum number of values passed to driver in one call
+ */
+#define MAX_BATCH_SIZE     256
+
 /**
  * Drivers to load
  */
 TCHAR *g_pdsLoadList = NULL;
 
+/**
+ * Queue size and overflow policy
+ */
+static int s_queueSize = 10000;
+static int s_overflowPolicy = PDS_OVERFLOW_DROP;
+
+/**
+ * Index entry for DCI with pending storage requests. Entry is removed from index
+ * when DCI is destroyed and freed when last request referencing it is released.
+ */
+struct PerfDataStoragePendingDCI
+{
+   UT_hash_handle hh;
+   DCObject *dci;
+   int count;        // number of queue and batch entries referencing this DCI
+   bool cancelled;   // DCI was destroyed, queued requests should be discarded
+};
+
+/**
+ * Queued storage request. Entries for destroyed DCIs are cancelled via DCI index entry
+ * while in queue and by setting dci to NULL while in batch.
+ */
+struct PerfDataStorageQueueEntry
+{
+   DCObject *dci;
+   PerfDataStoragePendingDCI *pending;
+   time_t timestamp;
+   TCHAR *value;     // for items
+   Table *table;     // for tables
+   INT64 queueTime;
+   bool inDriverCall;   // passed to driver call currently in progress
+};
+
+/**
+ * Header of record in spill file
+ */
+struct PerfDataStorageSpillRecord
+{
+   UINT32 ownerId;
+   UINT32 dciId;
+   INT64 timestamp;
+   UINT32 length;
+};
+
+/**
+ * Per-driver dispatcher with bounded queue and worker thread
+ */
+class PerfDataStorageDispatcher
+{
+private:
+   PerfDataStorageDriver *m_driver;
+   PerfDataStorageQueueEntry *m_queue;
+   int m_capacity;
+   int m_overflowPolicy;
+   int m_head;
+   int m_count;
+   MUTEX m_queueMutex;
+   MUTEX m_driverCallMutex;   // held while driver call is in progress
+   PerfDataStorageQueueEntry *m_batch;
+   int m_batchSize;
+   CONDITION m_wakeup;
+   THREAD m_thread;
+   bool m_shutdown;
+   PerfDataStoragePendingDCI *m_pending;
+   bool m_replayInProgress;
+   ObjectArray<DCObject> m_removedDuringReplay;
+
+   MUTEX m_spillMutex;
+   FILE *m_spillFile;
+   TCHAR m_spillFileName[MAX_PATH];
+   long m_spillReadPos;
+   long m_spillWritePos;
+
+   UINT64 m_queued;
+   UINT64 m_processed;
+   UINT64 m_dropped;
+   UINT64 m_spilled;
+   UINT64 m_failed;
+   UINT64 m_cancelled;
+   UINT64 m_batches;
+   UINT64 m_totalLatency;
+   UINT32 m_maxLatency;
+
+   static THREAD_RESULT THREAD_CALL workerThreadStarter(void *arg);
+   void workerThread();
+   PerfDataStoragePendingDCI *addPending(DCObject *dci);
+   void releaseEntry(PerfDataStorageQueueEntry *e);
+   int dequeue();
+   void process(int count);
+   int beginDriverCall(int start, int count, bool tables, PerfDataStorageValue *values);
+   void endDriverCall(int start, int count, int passed, bool success);
+   void spill(DCItem *dci, time_t timestamp, const TCHAR *value);
+   void replaySpilledValues();
+   void closeSpillFile();
+
+public:
+   PerfDataStorageDispatcher(PerfDataStorageDriver *driver, int queueSize, int overflowPolicy);
+   ~PerfDataStorageDispatcher();
+
+   PerfDataStorageDriver *getDriver() const { return m_driver; }
+
+   void start();
+   void stop();
+
+   void enqueue(DCItem *dci, time_t timestamp, const TCHAR *value);
+   void enqueue(DCTable *dci, time_t timestamp, Table *value);
+   void removeRequests(DCObject *dci);
+   void showStats(CONSOLE_CTX console);
+};
+
 /**
  * List of loaded drivers
  */
 static int s_numDrivers = 0;
-static PerfDataStorageDriver *s_drivers[MAX_PDS_DRIVERS];
+static PerfDataStorageDispatcher *s_dispatchers[MAX_PDS_DRIVERS];
 
 /**
  * Driver base class constructor
@@ -90,6 +206,21 @@ bool PerfDataStorageDriver::saveDCItemValue(DCItem *dcObject, time_t timestamp,
    return false;
 }
 
+/**
+ * Save batch of DCI values. Default implementation calls saveDCItemValue for each value.
+ * Returns false if at least one value was not saved.
+ */
+bool PerfDataStorageDriver::saveDCItemValues(PerfDataStorageValue *values, int count)
+{
+   bool success = true;
+   for(int i = 0; i < count; i++)
+   {
+      if (!saveDCItemValue(values[i].dci, values[i].timestamp, values[i].value))
+         success = false;
+   }
+   return success;
+}
+
 /**
  * Save table value
  */
@@ -98,13 +229,601 @@ bool PerfDataStorageDriver::saveDCTableValue(DCTable *dcObject, time_t timestamp
    return false;
 }
 
+/**
+ * Dispatcher constructor
+ */
+PerfDataStorageDispatcher::PerfDataStorageDispatcher(PerfDataStorageDriver *driver, int queueSize, int overflowPolicy)
+{
+   m_driver = driver;
+   m_capacity = max(queueSize, MAX_BATCH_SIZE);
+   m_overflowPolicy = overflowPolicy;
+   m_queue = (PerfDataStorageQueueEntry *)malloc(sizeof(PerfDataStorageQueueEntry) * m_capacity);
+   m_head = 0;
+   m_count = 0;
+   m_queueMutex = MutexCreate();
+   m_driverCallMutex = MutexCreate();
+   m_batch = (PerfDataStorageQueueEntry *)malloc(sizeof(PerfDataStorageQueueEntry) * MAX_BATCH_SIZE);
+   m_batchSize = 0;
+   m_wakeup = ConditionCreate(false);
+   m_thread = INVALID_THREAD_HANDLE;
+   m_shutdown = false;
+   m_pending = NULL;
+   m_replayInProgress = false;
+
+   m_spillMutex = MutexCreate();
+   m_spillFile = NULL;
+   _sntprintf(m_spillFileName, MAX_PATH, _T("%s%spds_%s.spill"), g_netxmsdDataDir, FS_PATH_SEPARATOR, driver->getName());
+   m_spillReadPos = 0;
+   m_spillWritePos = 0;
+
+   m_queued = 0;
+   m_processed = 0;
+   m_dropped = 0;
+   m_spilled = 0;
+   m_failed = 0;
+   m_cancelled = 0;
+   m_batches = 0;
+   m_totalLatency = 0;
+   m_maxLatency = 0;
+}
+
+/**
+ * Dispatcher destructor
+ */
+PerfDataStorageDispatcher::~PerfDataStorageDispatcher()
+{
+   for(int i = 0; i < m_count; i++)
+      releaseEntry(&m_queue[(m_head + i) % m_capacity]);
+   free(m_queue);
+   free(m_batch);
+   if (m_spillFile != NULL)
+      fclose(m_spillFile);
+   MutexDestroy(m_queueMutex);
+   MutexDestroy(m_driverCallMutex);
+   MutexDestroy(m_spillMutex);
+   ConditionDestroy(m_wakeup);
+}
+
+/**
+ * Start worker thread. Values spilled to disk by previous server run will be replayed.
+ */
+void PerfDataStorageDispatcher::start()
+{
+   if (m_overflowPolicy == PDS_OVERFLOW_SPILL)
+   {
+      m_spillFile = _tfopen(m_spillFileName, _T("r+b"));
+      if (m_spillFile != NULL)
+      {
+         fseek(m_spillFile, 0, SEEK_END);
+         m_spillWritePos = ftell(m_spillFile);
+         nxlog_debug(2, _T("PDS: %ld bytes of spilled data found for driver %s"), m_spillWritePos, m_driver->getName());
+      }
+   }
+   m_thread = ThreadCreateEx(workerThreadStarter, 0, this);
+}
+
+/**
+ * Stop worker thread. Values still in queue will be passed to driver.
+ */
+void PerfDataStorageDispatcher::stop()
+{
+   MutexLock(m_queueMutex);
+   m_shutdown = true;
+   MutexUnlock(m_queueMutex);
+   ConditionSet(m_wakeup);
+   ThreadJoin(m_thread);
+   m_thread = INVALID_THREAD_HANDLE;
+}
+
+/**
+ * Spill value to disk (should be called with spill mutex locked)
+ */
+void PerfDataStorageDispatcher::spill(DCItem *dci, time_t timestamp, const TCHAR *value)
+{
+   PerfDataStorageSpillRecord header;
+   header.ownerId = dci->getOwnerId();
+   header.dciId = dci->getId();
+   header.timestamp = (INT64)timestamp;
+   header.length = (UINT32)_tcslen(value);
+
+   if (m_spillFile == NULL)
+   {
+      m_spillFile = _tfopen(m_spillFileName, _T("w+b"));
+      m_spillReadPos = 0;
+      m_spillWritePos = 0;
+   }
+   bool success = false;
+   if ((m_spillFile != NULL) && (fseek(m_spillFile, m_spillWritePos, SEEK_SET) == 0))
+   {
+      success = (fwrite(&header, sizeof(header), 1, m_spillFile) == 1) &&
+                ((header.length == 0) || (fwrite(value, header.length * sizeof(TCHAR), 1, m_spillFile) == 1));
+      if (success)
+         m_spillWritePos = ftell(m_spillFile);
+   }
+   if (success)
+      m_spilled++;
+   else
+      m_dropped++;
+}
+
+/**
+ * Close and delete spill file (should be called with spill mutex locked)
+ */
+void PerfDataStorageDispatcher::closeSpillFile()
+{
+   fclose(m_spillFile);
+   m_spillFile = NULL;
+   _tremove(m_spillFileName);
+   m_spillReadPos = 0;
+   m_spillWritePos = 0;
+}
+
+/**
+ * Move values from spill file back to queue
+ */
+void PerfDataStorageDispatcher::replaySpilledValues()
+{
+   MutexLock(m_spillMutex);
+   if ((m_spillFile == NULL) || (fseek(m_spillFile, m_spillReadPos, SEEK_SET) != 0))
+   {
+      MutexUnlock(m_spillMutex);
+      return;
+   }
+
+   // DCIs destroyed while replay is in progress are recorded by removeRequests()
+   MutexLock(m_queueMutex);
+   m_replayInProgress = true;
+   MutexUnlock(m_queueMutex);
+
+   int discarded = 0;
+   TCHAR *value = NULL;
+   UINT32 allocated = 0;
+   for(int i = 0; (i < MAX_BATCH_SIZE) && (m_spillReadPos < m_spillWritePos); i++)
+   {
+      long recordPos = m_spillReadPos;
+      PerfDataStorageSpillRecord header;
+      if (fread(&header, sizeof(header), 1, m_spillFile) != 1)
+      {
+         m_spillReadPos = m_spillWritePos;   // spill file is corrupted
+         break;
+      }
+      if (header.length >= allocated)
+      {
+         allocated = header.length + 64;
+         value = (TCHAR *)realloc(value, allocated * sizeof(TCHAR));
+      }
+      if ((header.length > 0) && (fread(value, header.length * sizeof(TCHAR), 1, m_spillFile) != 1))
+      {
+         m_spillReadPos = m_spillWritePos;
+         break;
+      }
+      value[header.length] = 0;
+      m_spillReadPos = ftell(m_spillFile);
+
+      // Resolve DCI and put value into queue unless DCI was destroyed in between
+      NetObj *object = FindObjectById(header.ownerId);
+      if ((object == NULL) || !object->isDataCollectionTarget())
+      {
+         discarded++;
+         continue;
+      }
+      DCObject *dci = ((Template *)object)->getDCObjectById(header.dciId);
+      if ((dci == NULL) || (dci->getType() != DCO_TYPE_ITEM))
+      {
+         discarded++;
+         continue;
+      }
+
+      MutexLock(m_queueMutex);
+      if (m_count == m_capacity)
+      {
+         // Queue was filled up by table values, keep record in spill file
+         MutexUnlock(m_queueMutex);
+         m_spillReadPos = recordPos;
+         break;
+      }
+      if (m_removedDuringReplay.contains(dci))
+      {
+         discarded++;
+      }
+      else
+      {
+         PerfDataStorageQueueEntry *e = &m_queue[(m_head + m_count) % m_capacity];
+         e->dci = dci;
+         e->pending = addPending(dci);
+         e->timestamp = (time_t)header.timestamp;
+         e->value = _tcsdup(value);
+         e->table = NULL;
+         e->queueTime = GetCurrentTimeMs();
+         e->inDriverCall = false;
+         m_count++;
+         m_queued++;
+      }
+      MutexUnlock(m_queueMutex);
+   }
+   free(value);
+
+   MutexLock(m_queueMutex);
+   m_replayInProgress = false;
+   m_removedDuringReplay.clear();
+   m_cancelled += discarded;
+   MutexUnlock(m_queueMutex);
+
+   if (discarded > 0)
+      nxlog_debug(4, _T("PDS: %d spilled values for deleted DCIs discarded for driver %s"), discarded, m_driver->getName());
+
+   if (m_spillReadPos >= m_spillWritePos)
+      closeSpillFile();
+   MutexUnlock(m_spillMutex);
+}
+
+/**
+ * Add DCI value to queue. With spill policy new values are written to spill file
+ * while it contains values not yet replayed, so values for same DCI are passed
+ * to driver in the order they were collected. Spill mutex is locked before queue
+ * mutex, same as in replaySpilledValues().
+ */
+void PerfDataStorageDispatcher::enqueue(DCItem *dci, time_t timestamp, const TCHAR *value)
+{
+   bool spillPolicy = (m_overflowPolicy == PDS_OVERFLOW_SPILL);
+   if (spillPolicy)
+      MutexLock(m_spillMutex);
+
+   MutexLock(m_queueMutex);
+   if ((m_count == m_capacity) || (spillPolicy && (m_spillFile != NULL)))
+   {
+      MutexUnlock(m_queueMutex);
+      if (spillPolicy)
+      {
+         spill(dci, timestamp, value);
+         MutexUnlock(m_spillMutex);
+      }
+      else
+      {
+         MutexLock(m_spillMutex);
+         m_dropped++;
+         MutexUnlock(m_spillMutex);
+      }
+      return;
+   }
+
+   PerfDataStorageQueueEntry *e = &m_queue[(m_head + m_count) % m_capacity];
+   e->dci = dci;
+   e->pending = addPending(dci);
+   e->timestamp = timestamp;
+   e->value = _tcsdup(value);
+   e->table = NULL;
+   e->queueTime = GetCurrentTimeMs();
+   e->inDriverCall = false;
+   m_count++;
+   m_queued++;
+   bool wakeup = (m_count == 1);
+   MutexUnlock(m_queueMutex);
+
+   if (spillPolicy)
+      MutexUnlock(m_spillMutex);
+
+   if (wakeup)
+      ConditionSet(m_wakeup);
+}
+
+/**
+ * Add table value to queue. Table values are never spilled to disk.
+ */
+void PerfDataStorageDispatcher::enqueue(DCTable *dci, time_t timestamp, Table *value)
+{
+   MutexLock(m_queueMutex);
+   if (m_count == m_capacity)
+   {
+      MutexUnlock(m_queueMutex);
+      MutexLock(m_spillMutex);
+      m_dropped++;
+      MutexUnlock(m_spillMutex);
+      return;
+   }
+
+   value->incRefCount();
+   PerfDataStorageQueueEntry *e = &m_queue[(m_head + m_count) % m_capacity];
+   e->dci = dci;
+   e->pending = addPending(dci);
+   e->timestamp = timestamp;
+   e->value = NULL;
+   e->table = value;
+   e->queueTime = GetCurrentTimeMs();
+   e->inDriverCall = false;
+   m_count++;
+   m_queued++;
+   bool wakeup = (m_count == 1);
+   MutexUnlock(m_queueMutex);
+
+   if (wakeup)
+      ConditionSet(m_wakeup);
+}
+
+/**
+ * Find or create index entry for DCI and add reference to it (should be called with queue mutex locked)
+ */
+PerfDataStoragePendingDCI *PerfDataStorageDispatcher::addPending(DCObject *dci)
+{
+   PerfDataStoragePendingDCI *p;
+   HASH_FIND(hh, m_pending, &dci, sizeof(DCObject *), p);
+   if (p == NULL)
+   {
+      p = (PerfDataStoragePendingDCI *)malloc(sizeof(PerfDataStoragePendingDCI));
+      p->dci = dci;
+      p->count = 0;
+      p->cancelled = false;
+      HASH_ADD(hh, m_pending, dci, sizeof(DCObject *), p);
+   }
+   p->count++;
+   return p;
+}
+
+/**
+ * Release entry's value and detach it from DCI (should be called with queue mutex locked)
+ */
+void PerfDataStorageDispatcher::releaseEntry(PerfDataStorageQueueEntry *e)
+{
+   e->dci = NULL;
+   free(e->value);
+   e->value = NULL;
+   if (e->table != NULL)
+   {
+      e->table->decRefCount();
+      e->table = NULL;
+   }
+   if (e->pending != NULL)
+   {
+      PerfDataStoragePendingDCI *p = e->pending;
+      if (--p->count == 0)
+      {
+         if (!p->cancelled)
+            HASH_DEL(m_pending, p);
+         free(p);
+      }
+      e->pending = NULL;
+   }
+}
+
+/**
+ * Cancel all pending requests for given DCI. Queued entries are only marked as
+ * cancelled via DCI index and released when dequeued, so queue is not scanned.
+ * Entries in batch taken by worker thread are released immediately, and caller
+ * only waits if DCI was already passed to driver call currently in progress.
+ */
+void PerfDataStorageDispatcher::removeRequests(DCObject *dci)
+{
+   MutexLock(m_queueMutex);
+   if (m_replayInProgress)
+      m_removedDuringReplay.add(dci);
+
+   PerfDataStoragePendingDCI *p;
+   HASH_FIND(hh, m_pending, &dci, sizeof(DCObject *), p);
+   if (p == NULL)
+   {
+      MutexUnlock(m_queueMutex);
+      return;
+   }
+   HASH_DEL(m_pending, p);
+   p->cancelled = true;
+
+   int cancelled = 0;
+   bool inDriverCall = false;
+   for(int i = 0; i < m_batchSize; i++)
+   {
+      PerfDataStorageQueueEntry *e = &m_batch[i];
+      if (e->dci != dci)   // entries already processed by driver have dci set to NULL
+         continue;
+      if (e->inDriverCall)
+      {
+         inDriverCall = true;
+      }
+      else
+      {
+         releaseEntry(e);
+         cancelled++;
+      }
+   }
+   m_cancelled += cancelled;
+   MutexUnlock(m_queueMutex);
+
+   // Driver call mutex is locked by worker before queue mutex is released,
+   // so this will wait until driver call with given DCI completes
+   if (inDriverCall)
+   {
+      MutexLock(m_driverCallMutex);
+      MutexUnlock(m_driverCallMutex);
+   }
+}
+
+/**
+ * Move up to MAX_BATCH_SIZE entries from queue to batch, releasing entries
+ * for destroyed DCIs (should be called with queue mutex locked)
+ */
+int PerfDataStorageDispatcher::dequeue()
+{
+   int count = 0;
+   while((m_count > 0) && (count < MAX_BATCH_SIZE))
+   {
+      PerfDataStorageQueueEntry *e = &m_queue[m_head];
+      m_head = (m_head + 1) % m_capacity;
+      m_count--;
+      if (e->pending->cancelled)
+      {
+         releaseEntry(e);
+         m_cancelled++;
+         continue;
+      }
+      m_batch[count++] = *e;
+   }
+   m_batchSize = count;
+   return count;
+}
+
+/**
+ * Mark batch entries which are not cancelled as passed to driver and lock driver call mutex.
+ * Fills values array for item values. Returns number of entries passed to driver.
+ */
+int PerfDataStorageDispatcher::beginDriverCall(int start, int count, bool tables, PerfDataStorageValue *values)
+{
+   int passed = 0;
+   MutexLock(m_queueMutex);
+   for(int i = start; i < start + count; i++)
+   {
+      PerfDataStorageQueueEntry *e = &m_batch[i];
+      if ((e->dci == NULL) || ((e->table != NULL) != tables))
+         continue;
+      e->inDriverCall = true;
+      if (values != NULL)
+      {
+         values[passed].dci = (DCItem *)e->dci;
+         values[passed].timestamp = e->timestamp;
+         values[passed].value = e->value;
+      }
+      passed++;
+   }
+   if (passed > 0)
+      MutexLock(m_driverCallMutex);
+   MutexUnlock(m_queueMutex);
+   return passed;
+}
+
+/**
+ * Complete driver call - update statistics, release entries passed to driver, and unlock driver call mutex
+ */
+void PerfDataStorageDispatcher::endDriverCall(int start, int count, int passed, bool success)
+{
+   INT64 now = GetCurrentTimeMs();
+   MutexLock(m_queueMutex);
+   for(int i = start; i < start + count; i++)
+   {
+      PerfDataStorageQueueEntry *e = &m_batch[i];
+      if (!e->inDriverCall)
+         continue;
+      UINT32 latency = (UINT32)(now - e->queueTime);
+      m_totalLatency += latency;
+      if (latency > m_maxLatency)
+         m_maxLatency = latency;
+      e->inDriverCall = false;
+      releaseEntry(e);
+   }
+   m_processed += passed;
+   if (!success)
+      m_failed += passed;
+   MutexUnlock(m_driverCallMutex);
+   MutexUnlock(m_queueMutex);
+}
+
+/**
+ * Pass batch of dequeued entries to driver. Batch entries can be cancelled by
+ * removeRequests() until they are passed to driver.
+ */
+void PerfDataStorageDispatcher::process(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      if (beginDriverCall(i, 1, true, NULL) == 0)
+         continue;
+      bool success = m_driver->saveDCTableValue((DCTable *)m_batch[i].dci, m_batch[i].timestamp, m_batch[i].table);
+      endDriverCall(i, 1, 1, success);
+   }
+
+   PerfDataStorageValue values[MAX_BATCH_SIZE];
+   int valueCount = beginDriverCall(0, count, false, values);
+   if (valueCount > 0)
+   {
+      bool success = m_driver->saveDCItemValues(values, valueCount);
+      endDriverCall(0, count, valueCount, success);
+   }
+
+   MutexLock(m_queueMutex);
+   m_batchSize = 0;
+   m_batches++;
+   MutexUnlock(m_queueMutex);
+}
+
+/**
+ * Worker thread
+ */
+void PerfDataStorageDispatcher::workerThread()
+{
+   nxlog_debug(1, _T("PDS: dispatcher thread for driver %s started"), m_driver->getName());
+   while(true)
+   {
+      MutexLock(m_queueMutex);
+      int count = dequeue();
+      bool shutdown = m_shutdown;
+      bool replay = !m_shutdown && (m_count < m_capacity / 2);
+      MutexUnlock(m_queueMutex);
+
+      if (count > 0)
+         process(count);
+
+      if (replay && (m_spillFile != NULL))
+         replaySpilledValues();
+
+      if (count == 0)
+      {
+         if (shutdown)
+            break;
+         ConditionWait(m_wakeup, 1000);
+      }
+   }
+   nxlog_debug(1, _T("PDS: dispatcher thread for driver %s stopped"), m_driver->getName());
+}
+
+/**
+ * Worker thread starter
+ */
+THREAD_RESULT THREAD_CALL PerfDataStorageDispatcher::workerThreadStarter(void *arg)
+{
+   ((PerfDataStorageDispatcher *)arg)->workerThread();
+   return THREAD_OK;
+}
+
+/**
+ * Show dispatcher statistics
+ */
+void PerfDataStorageDispatcher::showStats(CONSOLE_CTX console)
+{
+   MutexLock(m_queueMutex);
+   int count = m_count;
+   UINT64 queued = m_queued;
+   UINT64 processed = m_processed;
+   UINT64 failed = m_failed;
+   UINT64 cancelled = m_cancelled;
+   UINT64 batches = m_batches;
+   UINT64 totalLatency = m_totalLatency;
+   UINT32 maxLatency = m_maxLatency;
+   MutexUnlock(m_queueMutex);
+
+   MutexLock(m_spillMutex);
+   UINT64 dropped = m_dropped;
+   UINT64 spilled = m_spilled;
+   long spillSize = m_spillWritePos - m_spillReadPos;
+   MutexUnlock(m_spillMutex);
+
+   ConsolePrintf(console, _T("Driver %s:\n"), m_driver->getName());
+   ConsolePrintf(console, _T("   Queue size ........ %d / %d\n"), count, m_capacity);
+   ConsolePrintf(console, _T("   Queued ............ ") UINT64_FMT _T("\n"), queued);
+   ConsolePrintf(console, _T("   Processed ......... ") UINT64_FMT _T("\n"), processed);
+   ConsolePrintf(console, _T("   Failed ............ ") UINT64_FMT _T("\n"), failed);
+   ConsolePrintf(console, _T("   Cancelled ......... ") UINT64_FMT _T("\n"), cancelled);
+   ConsolePrintf(console, _T("   Dropped ........... ") UINT64_FMT _T("\n"), dropped);
+   ConsolePrintf(console, _T("   Spilled ........... ") UINT64_FMT _T("\n"), spilled);
+   ConsolePrintf(console, _T("   Spill backlog ..... %ld bytes\n"), spillSize);
+   ConsolePrintf(console, _T("   Batches ........... ") UINT64_FMT _T("\n"), batches);
+   ConsolePrintf(console, _T("   Average latency ... ") UINT64_FMT _T(" ms\n"), (processed > 0) ? totalLatency / processed : _ULL(0));
+   ConsolePrintf(console, _T("   Maximum latency ... %u ms\n"), maxLatency);
+}
+
 /**
  * Storage request
  */
 void PerfDataStorageRequest(DCItem *dci, time_t timestamp, const TCHAR *value)
 {
    for(int i = 0; i < s_numDrivers; i++)
-      s_drivers[i]->saveDCItemValue(dci, timestamp, value);
+      s_dispatchers[i]->enqueue(dci, timestamp, value);
 }
 
 /**
@@ -113,7 +832,30 @@ void PerfDataStorageRequest(DCItem *dci, time_t timestamp, const TCHAR *value)
 void PerfDataStorageRequest(DCTable *dci, time_t timestamp, Table *value)
 {
    for(int i = 0; i < s_numDrivers; i++)
-      s_drivers[i]->saveDCTableValue(dci, timestamp, value);
+      s_dispatchers[i]->enqueue(dci, timestamp, value);
+}
+
+/**
+ * Remove pending storage requests for DCI being destroyed
+ */
+void PerfDataStorageRemoveRequests(DCObject *dci)
+{
+   for(int i = 0; i < s_numDrivers; i++)
+      s_dispatchers[i]->removeRequests(dci);
+}
+
+/**
+ * Show statistics for all loaded drivers
+ */
+void ShowPerfDataStorageStats(CONSOLE_CTX console)
+{
+   if (s_numDrivers == 0)
+   {
+      ConsolePrintf(console, _T("No performance data storage drivers loaded\n"));
+      return;
+   }
+   for(int i = 0; i < s_numDrivers; i++)
+      s_dispatchers[i]->showStats(console);
 }
 
 /**
@@ -172,7 +914,7 @@ static void LoadDriver(const TCHAR *file)
 				PerfDataStorageDriver *driver = CreateInstance();
 				if ((driver != NULL) && driver->init())
 				{
-					s_drivers[s_numDrivers++] = driver;
+					s_dispatchers[s_numDrivers++] = new PerfDataStorageDispatcher(driver, s_queueSize, s_overflowPolicy);
 					nxlog_write(MSG_PDSDRV_LOADED, EVENTLOG_INFORMATION_TYPE, "s", driver->getName());
 				}
 				else
@@ -205,7 +947,10 @@ static void LoadDriver(const TCHAR *file)
  */
 void LoadPerfDataStorageDrivers()
 {
-	memset(s_drivers, 0, sizeof(PerfDataStorageDriver *) * MAX_PDS_DRIVERS);
+   int first = s_numDrivers;   // drivers registered by RegisterPerfDataStorageDriver are already started
+
+   s_queueSize = ConfigReadInt(_T("PerfDataStorageQueueSize"), 10000);
+   s_overflowPolicy = ConfigReadInt(_T("PerfDataStorageOverflowPolicy"), PDS_OVERFLOW_DROP);
 
 	DbgPrintf(1, _T("Loading performance data storage drivers"));
 	for(TCHAR *curr = g_pdsLoadList, *next = NULL; curr != NULL; curr = next)
@@ -224,7 +969,39 @@ void LoadPerfDataStorageDrivers()
 		if (s_numDrivers == MAX_PDS_DRIVERS)
 			break;	// Too many drivers already loaded
    }
+   for(int i = first; i < s_numDrivers; i++)
+      s_dispatchers[i]->start();
    if (s_numDrivers > 0)
       g_flags |= AF_PERFDATA_STORAGE_DRIVER_LOADED;
-	DbgPrintf(1, _T("%d performance data storage drivers loaded"), s_numDrivers);
+	DbgPrintf(1, _T("%d performance data storage drivers loaded"), s_numDrivers - first);
+}
+
+/**
+ * Register driver instance created outside of driver loader (for example, by server module
+ * or test program). Dispatcher for registered driver is started immediately.
+ */
+bool NXCORE_EXPORTABLE RegisterPerfDataStorageDriver(PerfDataStorageDriver *driver, int queueSize, int overflowPolicy)
+{
+   if (s_numDrivers == MAX_PDS_DRIVERS)
+      return false;
+   PerfDataStorageDispatcher *dispatcher = new PerfDataStorageDispatcher(driver, queueSize, overflowPolicy);
+   s_dispatchers[s_numDrivers++] = dispatcher;
+   dispatcher->start();
+   g_flags |= AF_PERFDATA_STORAGE_DRIVER_LOADED;
+   nxlog_debug(1, _T("PDS: driver %s registered"), driver->getName());
+   return true;
+}
+
+/**
+ * Stop dispatcher threads and shutdown drivers
+ */
+void ShutdownPerfDataStorageDrivers()
+{
+   g_flags &= ~AF_PERFDATA_STORAGE_DRIVER_LOADED;
+   for(int i = 0; i < s_numDrivers; i++)
+   {
+      s_dispatchers[i]->stop();
+      s_dispatchers[i]->getDriver()->shutdown();
+   }
+	DbgPrintf(1, _T("Performance data storage drivers stopped"));
 }
@@ -22,6 +22,11 @@
 
 #include "nxcore.h"
 
+/**
+ * Debug tag
+ */
+#define DEBUG_TAG _T("poll.manager")
+
 /**
  * Node poller queue (polls new nodes)
  */
@@ -133,7 +138,7 @@ static void CheckMgmtFlagCallback(NetObj *object, void *data)
 	if ((g_dwMgmtNode != object->getId()) && ((Node *)object)->isLocalManagement())
 	{
 		((Node *)object)->clearLocalMgmtFlag();
-		DbgPrintf(2, _T("Incorrectly set flag NF_IS_LOCAL_MGMT cleared from node %s [%d]"),
+		nxlog_debug_tag(DEBUG_TAG, 2, _T("Incorrectly set flag NF_IS_LOCAL_MGMT cleared from node %s [%d]"),
 					 object->getName(), object->getId());
 	}
 }
@@ -169,7 +174,7 @@ void CheckForMgmtNode()
             if (!(node->getFlags() & NF_IS_LOCAL_MGMT))
             {
                node->setLocalMgmtFlag();
-               DbgPrintf(1, _T("Local management node %s [%d] was not have NF_IS_LOCAL_MGMT flag set"), node->getName(), node->getId());
+               nxlog_debug_tag(DEBUG_TAG, 1, _T("Local management node %s [%d] was not have NF_IS_LOCAL_MGMT flag set"), node->getName(), node->getId());
             }
             g_dwMgmtNode = node->getId();   // Set local management node ID
             break;
@@ -238,7 +243,7 @@ static void CheckPotentialNode(Node *node, const InetAddress& ipAddr, UINT32 ifI
 {
 	TCHAR buffer[64];
 
-	DbgPrintf(6, _T("DiscoveryPoller(): checking potential node %s at %d"), ipAddr.toString(buffer), ifIndex);
+	nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): checking potential node %s at %d"), ipAddr.toString(buffer), ifIndex);
    if (ipAddr.isValid() && !ipAddr.isBroadcast() && !ipAddr.isLoopback() && !ipAddr.isMulticast() &&
 	    (FindNodeByIP(node->getZoneId(), ipAddr) == NULL) && !IsClusterIP(node->getZoneId(), ipAddr) && 
 		 (g_nodePollerQueue.find((void *)&ipAddr, PollerQueueElementComparator) == NULL))
@@ -249,7 +254,7 @@ static void CheckPotentialNode(Node *node, const InetAddress& ipAddr, UINT32 ifI
          const InetAddress& interfaceAddress = pInterface->getIpAddressList()->findSameSubnetAddress(ipAddr);
          if (interfaceAddress.isValidUnicast())
          {
-			   DbgPrintf(6, _T("DiscoveryPoller(): interface found: %s [%d] addr=%s/%d ifIndex=%d"),
+			   nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): interface found: %s [%d] addr=%s/%d ifIndex=%d"),
                pInterface->getName(), pInterface->getId(), interfaceAddress.toString(buffer), interfaceAddress.getMaskBits(), pInterface->getIfIndex());
             if (!ipAddr.isSubnetBroadcast(interfaceAddress.getMaskBits()))
             {
@@ -265,28 +270,28 @@ static void CheckPotentialNode(Node *node, const InetAddress& ipAddr, UINT32 ifI
 					   memset(pInfo->bMacAddr, 0, MAC_ADDR_LENGTH);
 				   else
 					   memcpy(pInfo->bMacAddr, macAddr, MAC_ADDR_LENGTH);
-				   DbgPrintf(5, _T("DiscoveryPoller(): new node queued: %s/%d"),
+				   nxlog_debug_tag(DEBUG_TAG, 5, _T("DiscoveryPoller(): new node queued: %s/%d"),
 				             pInfo->ipAddr.toString(buffer), pInfo->ipAddr.getMaskBits());
                g_nodePollerQueue.put(pInfo);
             }
 			   else
 			   {
-               DbgPrintf(6, _T("DiscoveryPoller(): potential node %s rejected - broadcast/multicast address"), ipAddr.toString(buffer));
+               nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): potential node %s rejected - broadcast/multicast address"), ipAddr.toString(buffer));
 			   }
          }
          else
          {
-   			DbgPrintf(6, _T("DiscoveryPoller(): interface object found but IP address not found"));
+   			nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): interface object found but IP address not found"));
          }
 		}
 		else
 		{
-			DbgPrintf(6, _T("DiscoveryPoller(): interface object not found"));
+			nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): interface object not found"));
 		}
    }
 	else
 	{
-		DbgPrintf(6, _T("DiscoveryPoller(): potential node %s rejected"), ipAddr.toString(buffer));
+		nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): potential node %s rejected"), ipAddr.toString(buffer));
 	}
 }
 
@@ -299,7 +304,7 @@ static void CheckHostRoute(Node *node, ROUTE *route)
 	TCHAR buffer[16];
 	Interface *iface;
 
-	DbgPrintf(6, _T("DiscoveryPoller(): checking host route %s at %d"), IpToStr(route->dwDestAddr, buffer), route->dwIfIndex);
+	nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): checking host route %s at %d"), IpToStr(route->dwDestAddr, buffer), route->dwIfIndex);
 	iface = node->findInterfaceByIndex(route->dwIfIndex);
 	if ((iface != NULL) && iface->getIpAddressList()->findSameSubnetAddress(route->dwDestAddr).isValidUnicast())
 	{
@@ -307,7 +312,7 @@ static void CheckHostRoute(Node *node, ROUTE *route)
 	}
 	else
 	{
-		DbgPrintf(6, _T("DiscoveryPoller(): interface object not found for host route"));
+		nxlog_debug_tag(DEBUG_TAG, 6, _T("DiscoveryPoller(): interface object not found for host route"));
 	}
 }
 
@@ -333,7 +338,7 @@ static void DiscoveryPoller(void *arg)
       return;
 	}
 
-   DbgPrintf(4, _T("Starting discovery poll for node %s (%s) in zone %d"),
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Starting discovery poll for node %s (%s) in zone %d"),
 	          node->getName(), (const TCHAR *)node->getIpAddress().toString(), (int)node->getZoneId());
 
    // Retrieve and analyze node's ARP cache
@@ -347,7 +352,7 @@ static void DiscoveryPoller(void *arg)
    }
 
 	// Retrieve and analyze node's routing table
-   DbgPrintf(5, _T("Discovery poll for node %s (%s) - reading routing table"),
+   nxlog_debug_tag(DEBUG_TAG, 5, _T("Discovery poll for node %s (%s) - reading routing table"),
              node->getName(), (const TCHAR *)node->getIpAddress().toString());
 	ROUTING_TABLE *rt = node->getRoutingTable();
 	if (rt != NULL)
@@ -361,7 +366,7 @@ static void DiscoveryPoller(void *arg)
 		DestroyRoutingTable(rt);
 	}
 
-   DbgPrintf(4, _T("Finished discovery poll for node %s (%s)"),
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Finished discovery poll for node %s (%s)"),
              node->getName(), (const TCHAR *)node->getIpAddress().toString());
    node->setDiscoveryPollTimeStamp();
    delete poller;
@@ -374,7 +379,7 @@ static void CheckRange(const InetAddressListElement& range)
 {
    if (range.getBaseAddress().getFamily() != AF_INET)
    {
-      DbgPrintf(4, _T("Active discovery on range %s skipped - only IPv4 ranges supported"), (const TCHAR *)range.toString());
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("Active discovery on range %s skipped - only IPv4 ranges supported"), (const TCHAR *)range.toString());
       return;
    }
 
@@ -391,14 +396,14 @@ static void CheckRange(const InetAddressListElement& range)
    }
 
    TCHAR ipAddr1[16], ipAddr2[16];
-   DbgPrintf(4, _T("Starting active discovery check on range %s - %s"), IpToStr(from, ipAddr1), IpToStr(to, ipAddr2));
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Starting active discovery check on range %s - %s"), IpToStr(from, ipAddr1), IpToStr(to, ipAddr2));
 
    for(UINT32 curr = from; (curr <= to) && !IsShutdownInProgress(); curr++)
    {
       InetAddress addr = InetAddress(curr);
       if (IcmpPing(addr, 3, g_icmpPingTimeout, NULL, g_icmpPingSize) == ICMP_SUCCESS)
       {
-         DbgPrintf(5, _T("Active discovery - node %s responds to ICMP ping"), addr.toString(ipAddr1));
+         nxlog_debug_tag(DEBUG_TAG, 5, _T("Active discovery - node %s responds to ICMP ping"), addr.toString(ipAddr1));
          if (FindNodeByIP(0, addr) == NULL)
          {
             Subnet *pSubnet;
@@ -435,7 +440,7 @@ static void CheckRange(const InetAddressListElement& range)
       }
    }
 
-   DbgPrintf(4, _T("Finished active discovery check on range %s - %s"), IpToStr(from, ipAddr1), IpToStr(to, ipAddr2));
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Finished active discovery check on range %s - %s"), IpToStr(from, ipAddr1), IpToStr(to, ipAddr2));
 }
 
 /**
@@ -487,37 +492,37 @@ static void QueueForPolling(NetObj *object, void *data)
 				if (node->isReadyForConfigurationPoll())
 				{
 					node->lockForConfigurationPoll();
-					DbgPrintf(6, _T("Node %d \"%s\" queued for configuration poll"), (int)node->getId(), node->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Node %d \"%s\" queued for configuration poll"), (int)node->getId(), node->getName());
                ThreadPoolExecute(g_pollerThreadPool, node, &Node::configurationPoll, RegisterPoller(POLLER_TYPE_CONFIGURATION, node));
 				}
 				if (node->isReadyForInstancePoll())
 				{
 					node->lockForInstancePoll();
-					DbgPrintf(6, _T("Node %d \"%s\" queued for instance discovery poll"), (int)node->getId(), node->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Node %d \"%s\" queued for instance discovery poll"), (int)node->getId(), node->getName());
                ThreadPoolExecute(g_pollerThreadPool, node, &Node::instanceDiscoveryPoll, RegisterPoller(POLLER_TYPE_INSTANCE_DISCOVERY, node));
 				}
 				if (node->isReadyForStatusPoll())
 				{
 					node->lockForStatusPoll();
-					DbgPrintf(6, _T("Node %d \"%s\" queued for status poll"), (int)node->getId(), node->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Node %d \"%s\" queued for status poll"), (int)node->getId(), node->getName());
                ThreadPoolExecute(g_pollerThreadPool, node, &Node::statusPoll, RegisterPoller(POLLER_TYPE_STATUS, node));
 				}
 				if (node->isReadyForRoutePoll())
 				{
 					node->lockForRoutePoll();
-					DbgPrintf(6, _T("Node %d \"%s\" queued for routing table poll"), (int)node->getId(), node->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Node %d \"%s\" queued for routing table poll"), (int)node->getId(), node->getName());
                ThreadPoolExecute(g_pollerThreadPool, node, &Node::routingTablePoll, RegisterPoller(POLLER_TYPE_ROUTING_TABLE, node));
 				}
 				if (node->isReadyForDiscoveryPoll())
 				{
 					node->lockForDiscoveryPoll();
-					DbgPrintf(6, _T("Node %d \"%s\" queued for discovery poll"), (int)node->getId(), node->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Node %d \"%s\" queued for discovery poll"), (int)node->getId(), node->getName());
                ThreadPoolExecute(g_pollerThreadPool, DiscoveryPoller, RegisterPoller(POLLER_TYPE_DISCOVERY, node));
 				}
 				if (node->isReadyForTopologyPoll())
 				{
 					node->lockForTopologyPoll();
-					DbgPrintf(6, _T("Node %d \"%s\" queued for topology poll"), (int)node->getId(), node->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Node %d \"%s\" queued for topology poll"), (int)node->getId(), node->getName());
                ThreadPoolExecute(g_pollerThreadPool, node, &Node::topologyPoll, RegisterPoller(POLLER_TYPE_TOPOLOGY, node));
 				}
 			}
@@ -528,7 +533,7 @@ static void QueueForPolling(NetObj *object, void *data)
 				if (cond->isReadyForPoll())
 				{
 					cond->lockForPoll();
-					DbgPrintf(6, _T("Condition %d \"%s\" queued for poll"), (int)object->getId(), object->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Condition %d \"%s\" queued for poll"), (int)object->getId(), object->getName());
                ThreadPoolExecute(g_pollerThreadPool, cond, &ConditionObject::doPoll, RegisterPoller(POLLER_TYPE_CONDITION, cond));
 				}
 			}
@@ -539,13 +544,13 @@ static void QueueForPolling(NetObj *object, void *data)
 				if (cluster->isReadyForStatusPoll())
 				{
 					cluster->lockForStatusPoll();
-					DbgPrintf(6, _T("Cluster %d \"%s\" queued for status poll"), (int)cluster->getId(), cluster->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Cluster %d \"%s\" queued for status poll"), (int)cluster->getId(), cluster->getName());
                ThreadPoolExecute(g_pollerThreadPool, cluster, &Cluster::statusPoll, RegisterPoller(POLLER_TYPE_STATUS, cluster));
 				}
             if (cluster->isReadyForConfigurationPoll())
             {
                cluster->lockForConfigurationPoll();
-               DbgPrintf(6, _T("Cluster %d \"%s\" queued for configuration poll"), (int)cluster->getId(), cluster->getName());
+               nxlog_debug_tag(DEBUG_TAG, 6, _T("Cluster %d \"%s\" queued for configuration poll"), (int)cluster->getId(), cluster->getName());
                ThreadPoolExecute(g_pollerThreadPool, cluster, &Cluster::configurationPoll, RegisterPoller(POLLER_TYPE_CONFIGURATION, cluster));
             }
 			}
@@ -556,7 +561,7 @@ static void QueueForPolling(NetObj *object, void *data)
 				if (service->isReadyForPolling())
 				{
 					service->lockForPolling();
-					DbgPrintf(6, _T("Business service %d \"%s\" queued for poll"), (int)object->getId(), object->getName());
+					nxlog_debug_tag(DEBUG_TAG, 6, _T("Business service %d \"%s\" queued for poll"), (int)object->getId(), object->getName());
                ThreadPoolExecute(g_pollerThreadPool, service, &BusinessService::poll, RegisterPoller(POLLER_TYPE_BUSINESS_SERVICE, service));
 				}
 			}
@@ -602,7 +607,7 @@ THREAD_RESULT THREAD_CALL PollManager(void *pArg)
    g_nodePollerQueue.put(INVALID_POINTER_VALUE);
 
    ThreadPoolDestroy(g_pollerThreadPool);
-   DbgPrintf(1, _T("PollManager: main thread terminated"));
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("PollManager: main thread terminated"));
    return THREAD_OK;
 }
 
@@ -245,7 +245,7 @@ BOOL SlmCheck::saveToDatabase(DB_HANDLE hdb)
          ret = saveACLToDB(hdb);
 	}
 
-   m_isModified = false;
+   m_modified = 0;
 	unlockProperties();
 	return ret;
 }
@@ -416,6 +416,9 @@ void SlmCheck::execute()
 		setModified();
 	}
 	unlockProperties();
+
+	if (m_status != oldStatus)
+		propagateStatus();
 }
 
 /**
@@ -22,6 +22,11 @@
 
 #include "nxcore.h"
 
+/**
+ * Debug tag
+ */
+#define DEBUG_TAG _T("snmp.trap")
+
 #define BY_OBJECT_ID 0
 #define BY_POSITION 1
 
@@ -463,7 +468,7 @@ void ProcessTrap(SNMP_PDU *pdu, const InetAddress& srcAddr, UINT32 zoneId, int s
 	BOOL processed = FALSE;
    int iResult;
 
-   DbgPrintf(4, _T("Received SNMP %s %s from %s"), isInformRq ? _T("INFORM-REQUEST") : _T("TRAP"),
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Received SNMP %s %s from %s"), isInformRq ? _T("INFORM-REQUEST") : _T("TRAP"),
              pdu->getTrapId()->toString(&szBuffer[96], 4000), srcAddr.toString(szBuffer));
    g_snmpTrapsReceived++;
 
@@ -532,7 +537,7 @@ void ProcessTrap(SNMP_PDU *pdu, const InetAddress& srcAddr, UINT32 zoneId, int s
    // Process trap if it is coming from host registered in database
    if (node != NULL)
    {
-      DbgPrintf(4, _T("ProcessTrap: trap matched to node %s [%d]"), node->getName(), node->getId());
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("ProcessTrap: trap matched to node %s [%d]"), node->getName(), node->getId());
       node->incSnmpTrapCount();
       if ((node->getStatus() != STATUS_UNMANAGED) || (g_flags & AF_TRAPS_FROM_UNMANAGED_NODES))
       {
@@ -617,12 +622,12 @@ void ProcessTrap(SNMP_PDU *pdu, const InetAddress& srcAddr, UINT32 zoneId, int s
       }
       else
       {
-         DbgPrintf(4, _T("ProcessTrap: Node %s [%d] is in UNMANAGED state, trap ignored"), node->getName(), node->getId());
+         nxlog_debug_tag(DEBUG_TAG, 4, _T("ProcessTrap: Node %s [%d] is in UNMANAGED state, trap ignored"), node->getName(), node->getId());
       }
    }
    else if (g_flags & AF_SNMP_TRAP_DISCOVERY)  // unknown node, discovery enabled
    {
-      DbgPrintf(4, _T("ProcessTrap: trap not matched to node, adding new IP address %s for discovery"), srcAddr.toString(szBuffer));
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("ProcessTrap: trap not matched to node, adding new IP address %s for discovery"), srcAddr.toString(szBuffer));
       Subnet *subnet = FindSubnetForNode(zoneId, srcAddr);
       if (subnet != NULL)
       {
@@ -649,7 +654,7 @@ void ProcessTrap(SNMP_PDU *pdu, const InetAddress& srcAddr, UINT32 zoneId, int s
    }
    else  // unknown node, discovery disabled
    {
-      DbgPrintf(4, _T("ProcessTrap: trap not matched to any node"));
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("ProcessTrap: trap not matched to any node"));
    }
 }
 
@@ -661,7 +666,7 @@ static SNMP_SecurityContext *ContextFinder(struct sockaddr *addr, socklen_t addr
    InetAddress ipAddr = InetAddress::createFromSockaddr(addr);
 	Node *node = FindNodeByIP((g_flags & AF_TRAP_SOURCES_IN_ALL_ZONES) ? ALL_ZONES : 0, ipAddr);
 	TCHAR buffer[64];
-	DbgPrintf(6, _T("SNMPTrapReceiver: looking for SNMP security context for node %s %s"),
+	nxlog_debug_tag(DEBUG_TAG, 6, _T("SNMPTrapReceiver: looking for SNMP security context for node %s %s"),
       ipAddr.toString(buffer), (node != NULL) ? node->getName() : _T("<unknown>"));
 	return (node != NULL) ? node->getSnmpSecurityContext() : NULL;
 }
@@ -770,7 +775,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
    // Bind socket
    TCHAR buffer[64];
    int bindFailures = 0;
-   DbgPrintf(5, _T("Trying to bind on UDP %s:%d"), SockaddrToStr((struct sockaddr *)&servAddr, buffer), ntohs(servAddr.sin_port));
+   nxlog_debug_tag(DEBUG_TAG, 5, _T("Trying to bind on UDP %s:%d"), SockaddrToStr((struct sockaddr *)&servAddr, buffer), ntohs(servAddr.sin_port));
    if (bind(hSocket, (struct sockaddr *)&servAddr, sizeof(struct sockaddr_in)) != 0)
    {
       nxlog_write(MSG_BIND_ERROR, EVENTLOG_ERROR_TYPE, "dse", m_wTrapPort, _T("SNMPTrapReceiver"), WSAGetLastError());
@@ -780,7 +785,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
    }
 
 #ifdef WITH_IPV6
-   DbgPrintf(5, _T("Trying to bind on UDP [%s]:%d"), SockaddrToStr((struct sockaddr *)&servAddr6, buffer), ntohs(servAddr6.sin6_port));
+   nxlog_debug_tag(DEBUG_TAG, 5, _T("Trying to bind on UDP [%s]:%d"), SockaddrToStr((struct sockaddr *)&servAddr6, buffer), ntohs(servAddr6.sin6_port));
    if (bind(hSocket6, (struct sockaddr *)&servAddr6, sizeof(struct sockaddr_in6)) != 0)
    {
       nxlog_write(MSG_BIND_ERROR, EVENTLOG_ERROR_TYPE, "dse", m_wTrapPort, _T("SNMPTrapReceiver"), WSAGetLastError());
@@ -795,7 +800,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
    // Abort if cannot bind to at least one socket
    if (bindFailures == 2)
    {
-      DbgPrintf(1, _T("SNMP trap receiver aborted - cannot bind at least one socket"));
+      nxlog_debug_tag(DEBUG_TAG, 1, _T("SNMP trap receiver aborted - cannot bind at least one socket"));
       return THREAD_OK;
    }
 
@@ -813,7 +818,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
 
    SocketPoller sp;
 
-   DbgPrintf(1, _T("SNMP Trap Receiver started on port %u"), m_wTrapPort);
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("SNMP Trap Receiver started on port %u"), m_wTrapPort);
 
    // Wait for packets
    while(!IsShutdownInProgress())
@@ -841,7 +846,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
          if ((bytes > 0) && (pdu != NULL))
          {
             InetAddress sourceAddr = InetAddress::createFromSockaddr((struct sockaddr *)&addr);
-            DbgPrintf(6, _T("SNMPTrapReceiver: received PDU of type %d from %s"), pdu->getCommand(), (const TCHAR *)sourceAddr.toString());
+            nxlog_debug_tag(DEBUG_TAG, 6, _T("SNMPTrapReceiver: received PDU of type %d from %s"), pdu->getCommand(), (const TCHAR *)sourceAddr.toString());
 			   if ((pdu->getCommand() == SNMP_TRAP) || (pdu->getCommand() == SNMP_INFORM_REQUEST))
 			   {
 				   if ((pdu->getVersion() == SNMP_VERSION_3) && (pdu->getCommand() == SNMP_INFORM_REQUEST))
@@ -854,7 +859,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
 			   else if ((pdu->getVersion() == SNMP_VERSION_3) && (pdu->getCommand() == SNMP_GET_REQUEST) && (pdu->getAuthoritativeEngine().getIdLen() == 0))
 			   {
 				   // Engine ID discovery
-				   DbgPrintf(6, _T("SNMPTrapReceiver: EngineId discovery"));
+				   nxlog_debug_tag(DEBUG_TAG, 6, _T("SNMPTrapReceiver: EngineId discovery"));
 
 				   SNMP_PDU *response = new SNMP_PDU(SNMP_REPORT, pdu->getRequestId(), pdu->getVersion());
 				   response->setReportable(false);
@@ -878,7 +883,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
 			   }
 			   else if (pdu->getCommand() == SNMP_REPORT)
 			   {
-				   DbgPrintf(6, _T("SNMPTrapReceiver: REPORT PDU with error %s"), (const TCHAR *)pdu->getVariable(0)->getName().toString());
+				   nxlog_debug_tag(DEBUG_TAG, 6, _T("SNMPTrapReceiver: REPORT PDU with error %s"), (const TCHAR *)pdu->getVariable(0)->getName().toString());
 			   }
             delete pdu;
          }
@@ -894,7 +899,7 @@ THREAD_RESULT THREAD_CALL SNMPTrapReceiver(void *pArg)
 #ifdef WITH_IPV6
    delete snmp6;
 #endif
-   DbgPrintf(1, _T("SNMP Trap Receiver terminated"));
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("SNMP Trap Receiver terminated"));
    return THREAD_OK;
 }
 
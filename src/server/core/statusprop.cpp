@@ -0,0 +1,151 @@
+/*
+** NetXMS - Network Management System
+** Copyright (C) 2003-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: statusprop.cpp
+**
+**/
+
+#include "nxcore.h"
+
+/**
+ * Objects waiting for status recalculation
+ */
+static IntegerArray<UINT32> *s_queue = new IntegerArray<UINT32>(256, 256);
+
+/**
+ * Queue access lock
+ */
+static MUTEX s_queueLock = MutexCreate();
+
+/**
+ * Wakeup condition. Never destroyed, so it can be signalled safely after propagation is stopped.
+ */
+static CONDITION s_wakeupCondition = ConditionCreate(FALSE);
+
+/**
+ * Worker thread handle
+ */
+static THREAD s_thread = INVALID_THREAD_HANDLE;
+
+/**
+ * Shutdown flag
+ */
+static volatile bool s_shutdown = false;
+
+/**
+ * Queue object for status recalculation. Multiple requests for same object
+ * made before worker picks them up are coalesced into single recalculation.
+ */
+void EnqueueStatusRecalculation(UINT32 id)
+{
+   MutexLock(s_queueLock);
+   bool wakeup = (s_queue->size() == 0);
+   s_queue->add(id);
+   MutexUnlock(s_queueLock);
+
+   if (wakeup)
+      ConditionSet(s_wakeupCondition);
+}
+
+/**
+ * Get number of pending status recalculation requests
+ */
+int GetStatusPropagationQueueSize()
+{
+   MutexLock(s_queueLock);
+   int size = s_queue->size();
+   MutexUnlock(s_queueLock);
+   return size;
+}
+
+/**
+ * Compare object IDs
+ */
+static int CompareObjectId(const void *p1, const void *p2)
+{
+   return COMPARE_NUMBERS(*((UINT32 *)p1), *((UINT32 *)p2));
+}
+
+/**
+ * Status propagation thread
+ */
+static THREAD_RESULT THREAD_CALL StatusPropagationThread(void *arg)
+{
+   nxlog_debug(1, _T("Status propagation thread started"));
+
+   IntegerArray<UINT32> *batch = new IntegerArray<UINT32>(256, 256);
+   while(!s_shutdown)
+   {
+      ConditionWait(s_wakeupCondition, INFINITE);
+      if (s_shutdown)
+         break;
+
+      MutexLock(s_queueLock);
+      IntegerArray<UINT32> *tmp = s_queue;
+      s_queue = batch;
+      batch = tmp;
+      MutexUnlock(s_queueLock);
+
+      if (batch->size() == 0)
+         continue;
+
+      batch->sort(CompareObjectId);
+      int count = 0;
+      for(int i = 0; i < batch->size(); i++)
+      {
+         UINT32 id = batch->get(i);
+         if ((i > 0) && (id == batch->get(i - 1)))
+            continue;
+
+         NetObj *object = FindObjectById(id);
+         if ((object != NULL) && !object->isDeleted())
+         {
+            object->calculateCompoundStatus();
+            count++;
+         }
+      }
+      nxlog_debug(7, _T("Status propagation: %d requests processed, %d objects recalculated"), batch->size(), count);
+      batch->clear();
+   }
+   delete batch;
+
+   nxlog_debug(1, _T("Status propagation thread stopped"));
+   return THREAD_OK;
+}
+
+/**
+ * Start status propagation thread
+ */
+void StartStatusPropagation()
+{
+   s_thread = ThreadCreateEx(StatusPropagationThread, 0, NULL);
+   if (GetStatusPropagationQueueSize() > 0)
+      ConditionSet(s_wakeupCondition);
+}
+
+/**
+ * Stop status propagation thread. Wakeup condition is kept because pollers
+ * still running may enqueue more requests.
+ */
+void StopStatusPropagation()
+{
+   s_shutdown = true;
+   ConditionSet(s_wakeupCondition);
+   ThreadJoin(s_thread);
+   s_thread = INVALID_THREAD_HANDLE;
+}
@@ -134,14 +134,9 @@ void ServiceContainer::calculateCompoundStatus(BOOL bForcedRecalc)
 	unlockChildList();
 
 	// Cause parent object(s) to recalculate it's status
+	propagateStatus(bForcedRecalc ? true : false);
 	if ((iOldStatus != m_status) || bForcedRecalc)
-	{
-		lockParentList(false);
-		for(i = 0; i < m_parentList->size(); i++)
-			m_parentList->get(i)->calculateCompoundStatus();
-		unlockParentList();
 		setModified();   /* LOCK? */
-	}
 
 	DbgPrintf(6, _T("ServiceContainer::calculateCompoundStatus(%s [%d]): old_status=%d new_status=%d"), m_name, m_id, iOldStatus, m_status);
 
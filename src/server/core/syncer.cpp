@@ -1,6 +1,6 @@
 /*
 ** NetXMS - Network Management System
-** Copyright (C) 2003-2016 Victor Kirhenshtein
+** Copyright (C) 2003-2017 Victor Kirhenshtein
 **
 ** This program is free software; you can redistribute it and/or modify
 ** it under the terms of the GNU General Public License as published by
@@ -22,6 +22,11 @@
 
 #include "nxcore.h"
 
+/**
+ * Debug tag
+ */
+#define DEBUG_TAG _T("obj.sync")
+
 /**
  * Externals
  */
@@ -51,62 +56,317 @@ void NXCORE_EXPORTABLE ObjectTransactionEnd()
 }
 
 /**
- * Save objects to database
+ * Maximum number of objects saved within single database transaction
+ */
+#define SYNCER_TRANSACTION_SIZE  64
+
+/**
+ * Maximum number of parallel syncer workers
+ */
+#define SYNCER_MAX_THREADS       32
+
+/**
+ * Syncer statistics for last cycle
+ */
+UINT32 g_syncerObjectsSaved = 0;
+UINT32 g_syncerObjectsDeleted = 0;
+UINT64 g_syncerQueries = 0;   // non-SELECT queries executed by server during last cycle
+UINT32 g_syncerCycleTime = 0; // milliseconds
+UINT32 g_syncerThreads = 0;
+
+/**
+ * Queue of modified objects
+ */
+static IntegerArray<UINT32> *s_modifiedObjects = new IntegerArray<UINT32>(1024, 1024);
+static MUTEX s_modifiedObjectsLock = MutexCreate();
+
+/**
+ * Put object into syncer's queue. Same object can be queued more than once.
+ */
+void NXCORE_EXPORTABLE EnqueueModifiedObject(UINT32 id)
+{
+   MutexLock(s_modifiedObjectsLock);
+   s_modifiedObjects->add(id);
+   MutexUnlock(s_modifiedObjectsLock);
+}
+
+/**
+ * Compare object IDs
+ */
+static int CompareObjectId(const void *p1, const void *p2)
+{
+   return COMPARE_NUMBERS(*((UINT32 *)p1), *((UINT32 *)p2));
+}
+
+/**
+ * Save batch of modified objects within single transaction. If batch transaction fails
+ * objects are saved one by one so that single failed object does not block others.
+ * Modification flags taken by rolled back saves are restored. Returns number of
+ * successfully saved objects.
+ */
+static int SaveObjectBatch(DB_HANDLE hdb, ObjectArray<NetObj> *batch, IntegerArray<UINT32> *retryList)
+{
+   if (batch->size() == 0)
+      return 0;
+
+   UINT32 flags[SYNCER_TRANSACTION_SIZE];
+   int attempted = 0;
+   int count = 0;
+   bool success = DBBegin(hdb);
+   if (success)
+   {
+      for(; (attempted < batch->size()) && success; attempted++)
+         success = batch->get(attempted)->saveModified(hdb, &flags[attempted]);
+      if (success)
+         success = DBCommit(hdb);
+      else
+         DBRollback(hdb);
+   }
+
+   if (success)
+   {
+      count = batch->size();
+   }
+   else
+   {
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("Syncer: batch transaction failed, saving %d objects individually"), batch->size());
+      for(int i = 0; i < attempted; i++)
+         batch->get(i)->markAsModified(flags[i], false);  // restore flags cleared by rolled back save
+
+      for(int i = 0; i < batch->size(); i++)
+      {
+         NetObj *object = batch->get(i);
+         UINT32 objectFlags;
+         DBBegin(hdb);
+         if (object->saveModified(hdb, &objectFlags))
+         {
+            DBCommit(hdb);
+            count++;
+         }
+         else
+         {
+            DBRollback(hdb);
+            object->markAsModified(objectFlags, false);
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("Syncer: Call to saveToDatabase() failed for object %s [%d], transaction rollback"), object->getName(), object->getId());
+         }
+      }
+   }
+
+   // Objects which are still marked as modified (failed or modified again during save) will be retried
+   for(int i = 0; i < batch->size(); i++)
+   {
+      if (batch->get(i)->isModified())
+         retryList->add(batch->get(i)->getId());
+   }
+
+   batch->clear();
+   return count;
+}
+
+/**
+ * Single shard of modified objects saved by one syncer worker
+ */
+struct SyncerShard
+{
+   DB_HANDLE hdb;
+   ObjectArray<NetObj> objects;
+   IntegerArray<UINT32> retryList;
+   int saved;
+   VolatileCounter *pending;
+   Condition *completed;
+
+   SyncerShard() : objects(256, 256, false) { hdb = NULL; saved = 0; pending = NULL; completed = NULL; }
+};
+
+/**
+ * Save all objects from shard in batches of SYNCER_TRANSACTION_SIZE objects per transaction
+ */
+static void SaveShard(SyncerShard *shard)
+{
+   ObjectArray<NetObj> batch(SYNCER_TRANSACTION_SIZE, 16, false);
+   for(int i = 0; i < shard->objects.size(); i++)
+   {
+      NetObj *object = shard->objects.get(i);
+      if (!object->isModified())
+         continue;
+
+      nxlog_debug_tag(DEBUG_TAG, 5, _T("Syncer: object %s [%d] modified (flags 0x%04X)"), object->getName(), object->getId(), object->getModifiedFlags());
+      batch.add(object);
+      if (batch.size() == SYNCER_TRANSACTION_SIZE)
+         shard->saved += SaveObjectBatch(shard->hdb, &batch, &shard->retryList);
+   }
+   shard->saved += SaveObjectBatch(shard->hdb, &batch, &shard->retryList);
+}
+
+/**
+ * Syncer worker thread - saves one shard using separate connection from pool
+ */
+static THREAD_RESULT THREAD_CALL SyncerWorkerThread(void *arg)
+{
+   SyncerShard *shard = (SyncerShard *)arg;
+   shard->hdb = DBConnectionPoolAcquireConnection();
+   SaveShard(shard);
+   DBConnectionPoolReleaseConnection(shard->hdb);
+   if (InterlockedDecrement(shard->pending) == 0)
+      shard->completed->set();
+   return THREAD_OK;
+}
+
+/**
+ * Save objects to database. Only objects from modified objects queue are processed.
+ * Modified objects are distributed between several workers (each using own
+ * database connection) by object ID and saved in parallel. Object transaction
+ * lock is held until all workers complete, so no object transaction can be
+ * partially saved.
  */
 void SaveObjects(DB_HANDLE hdb, UINT32 watchdogId)
 {
-   if (g_flags & AF_ENABLE_OBJECT_TRANSACTIONS)
+   INT64 startTime = GetCurrentTimeMs();
+   LIBNXDB_PERF_COUNTERS counters;
+   DBGetPerfCounters(&counters);
+   UINT64 startQueries = counters.nonSelectQueries;
+
+   // SQLite does not handle concurrent writers
+   int numShards = (g_dbSyntax == DB_SYNTAX_SQLITE) ? 1 : ConfigReadInt(_T("SyncerThreadCount"), 4);
+   if (numShards < 1)
+      numShards = 1;
+   else if (numShards > SYNCER_MAX_THREADS)
+      numShards = SYNCER_MAX_THREADS;
+
+   // Take snapshot of modified objects and block object transactions until all shards are saved
+   bool txnLock = (g_flags & AF_ENABLE_OBJECT_TRANSACTIONS) != 0;
+   if (txnLock)
       RWLockWriteLock(s_objectTxnLock, INFINITE);
 
-	ObjectArray<NetObj> *objects = g_idxObjectById.getObjects(false);
-   DbgPrintf(5, _T("Syncer: %d objects to process"), objects->size());
-	for(int i = 0; i < objects->size(); i++)
+   MutexLock(s_modifiedObjectsLock);
+   IntegerArray<UINT32> *queue = s_modifiedObjects;
+   s_modifiedObjects = new IntegerArray<UINT32>(1024, 1024);
+   MutexUnlock(s_modifiedObjectsLock);
+
+   queue->sort(CompareObjectId);
+
+   SyncerShard *shards = new SyncerShard[numShards];
+   ObjectArray<NetObj> deletedObjects(16, 16, false);
+   int count = 0;
+	for(int i = 0; i < queue->size(); i++)
    {
-	   WatchdogNotify(watchdogId);
-   	NetObj *object = objects->get(i);
+      UINT32 id = queue->get(i);
+      if ((i > 0) && (queue->get(i - 1) == id))
+         continue;   // duplicate entry
+
+   	NetObj *object = g_idxObjectById.get(id);
+      if (object == NULL)
+         continue;
+
       if (object->isDeleted())
+         deletedObjects.add(object);
+      else if (object->isModified())
+         shards[id % numShards].objects.add(object);
+      count++;
+   }
+
+   delete queue;
+   nxlog_debug_tag(DEBUG_TAG, 5, _T("Syncer: %d objects to process"), count);
+
+   // Save modified objects. Single shard (or shard with all modified objects) is saved
+   // by calling thread using provided connection, others by separate worker threads.
+   int activeShards = 0;
+   for(int i = 0; i < numShards; i++)
+      if (shards[i].objects.size() > 0)
+         activeShards++;
+
+   int saved = 0;
+   if (activeShards > 1)
+   {
+      VolatileCounter pending = activeShards;
+      Condition completed(true);
+      THREAD threads[SYNCER_MAX_THREADS];
+      for(int i = 0; i < numShards; i++)
+      {
+         shards[i].pending = &pending;
+         shards[i].completed = &completed;
+         threads[i] = (shards[i].objects.size() > 0) ? ThreadCreateEx(SyncerWorkerThread, 0, &shards[i]) : INVALID_THREAD_HANDLE;
+         if ((threads[i] == INVALID_THREAD_HANDLE) && (shards[i].objects.size() > 0))
+         {
+            // Cannot start worker, save shard in current thread
+            shards[i].hdb = hdb;
+            SaveShard(&shards[i]);
+            if (InterlockedDecrement(&pending) == 0)
+               completed.set();
+         }
+      }
+      while(!completed.wait(1000))
+         WatchdogNotify(watchdogId);
+      for(int i = 0; i < numShards; i++)
+         ThreadJoin(threads[i]);
+   }
+   else
+   {
+      for(int i = 0; i < numShards; i++)
+      {
+         if (shards[i].objects.size() == 0)
+            continue;
+         WatchdogNotify(watchdogId);
+         shards[i].hdb = hdb;
+         SaveShard(&shards[i]);
+      }
+   }
+
+   if (txnLock)
+      RWLockUnlock(s_objectTxnLock);
+
+   IntegerArray<UINT32> retryList;
+   for(int i = 0; i < numShards; i++)
+   {
+      saved += shards[i].saved;
+      for(int j = 0; j < shards[i].retryList.size(); j++)
+         retryList.add(shards[i].retryList.get(j));
+   }
+   delete[] shards;
+
+   // Delete objects marked for deletion
+   int deleted = 0;
+   for(int i = 0; i < deletedObjects.size(); i++)
+   {
+	   WatchdogNotify(watchdogId);
+      NetObj *object = deletedObjects.get(i);
+      nxlog_debug_tag(DEBUG_TAG, 5, _T("Syncer: object %s [%d] marked for deletion"), object->getName(), object->getId());
+      if (object->getRefCount() == 0)
       {
-         DbgPrintf(5, _T("Syncer: object %s [%d] marked for deletion"), object->getName(), object->getId());
-         if (object->getRefCount() == 0)
+         DBBegin(hdb);
+         if (object->deleteFromDatabase(hdb))
          {
-   		   DBBegin(hdb);
-            if (object->deleteFromDatabase(hdb))
-            {
-               DbgPrintf(4, _T("Syncer: Object %d \"%s\" deleted from database"), object->getId(), object->getName());
-               DBCommit(hdb);
-               NetObjDelete(object);
-            }
-            else
-            {
-               DBRollback(hdb);
-               DbgPrintf(4, _T("Syncer: Call to deleteFromDatabase() failed for object %s [%d], transaction rollback"), object->getName(), object->getId());
-            }
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("Syncer: Object %d \"%s\" deleted from database"), object->getId(), object->getName());
+            DBCommit(hdb);
+            NetObjDelete(object);
+            deleted++;
          }
          else
          {
-            DbgPrintf(3, _T("Syncer: Unable to delete object with id %d because it is being referenced %d time(s)"),
-                      object->getId(), object->getRefCount());
+            DBRollback(hdb);
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("Syncer: Call to deleteFromDatabase() failed for object %s [%d], transaction rollback"), object->getName(), object->getId());
+            retryList.add(object->getId());
          }
       }
-		else if (object->isModified())
-		{
-         DbgPrintf(5, _T("Syncer: object %s [%d] modified"), object->getName(), object->getId());
-		   DBBegin(hdb);
-			if (object->saveToDatabase(hdb))
-			{
-				DBCommit(hdb);
-			}
-			else
-			{
-				DBRollback(hdb);
-			}
-		}
+      else
+      {
+         nxlog_debug_tag(DEBUG_TAG, 3, _T("Syncer: Unable to delete object with id %d because it is being referenced %d time(s)"),
+                   object->getId(), object->getRefCount());
+         retryList.add(object->getId());
+      }
    }
 
-   if (g_flags & AF_ENABLE_OBJECT_TRANSACTIONS)
-      RWLockUnlock(s_objectTxnLock);
-	delete objects;
-   DbgPrintf(5, _T("Syncer: save objects completed"));
+   for(int i = 0; i < retryList.size(); i++)
+      EnqueueModifiedObject(retryList.get(i));
+
+   DBGetPerfCounters(&counters);
+   g_syncerObjectsSaved = saved;
+   g_syncerObjectsDeleted = deleted;
+   g_syncerQueries = counters.nonSelectQueries - startQueries;
+   g_syncerCycleTime = (UINT32)(GetCurrentTimeMs() - startTime);
+   g_syncerThreads = (activeShards > 1) ? activeShards : 1;
+   nxlog_debug_tag(DEBUG_TAG, 5, _T("Syncer: save objects completed (%d saved by %d threads, %d deleted, ") UINT64_FMT _T(" queries, %u ms)"),
+             saved, g_syncerThreads, deleted, g_syncerQueries, g_syncerCycleTime);
 }
 
 /**
@@ -117,7 +377,7 @@ THREAD_RESULT THREAD_CALL Syncer(void *arg)
    int syncInterval = ConfigReadInt(_T("SyncInterval"), 60);
    UINT32 watchdogId = WatchdogAddThread(_T("Syncer Thread"), 30);
 
-   nxlog_debug(1, _T("Syncer thread started, sync_interval = %d"), syncInterval);
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Syncer thread started, sync_interval = %d"), syncInterval);
 
    // Main syncer loop
    WatchdogStartSleep(watchdogId);
@@ -135,6 +395,6 @@ THREAD_RESULT THREAD_CALL Syncer(void *arg)
       WatchdogStartSleep(watchdogId);
    }
 
-   DbgPrintf(1, _T("Syncer thread terminated"));
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Syncer thread terminated"));
    return THREAD_OK;
 }
@@ -277,29 +277,33 @@ BOOL Template::saveToDatabase(DB_HANDLE hdb)
 		return FALSE;
 	}
 
-	DB_STATEMENT hStmt;
-   if (IsDatabaseRecordExist(hdb, _T("templates"), _T("id"), m_id))
-	{
-		hStmt = DBPrepare(hdb, _T("UPDATE templates SET version=?,flags=?,apply_filter=? WHERE id=?"));
-	}
-   else
-	{
-		hStmt = DBPrepare(hdb, _T("INSERT INTO templates (version,flags,apply_filter,id) VALUES (?,?,?,?)"));
-	}
-	if (hStmt == NULL)
-	{
-		unlockProperties();
-		return FALSE;
-	}
+   BOOL success = TRUE;
+   if (m_modified & MODIFY_OTHER)
+   {
+      DB_STATEMENT hStmt;
+      if (IsDatabaseRecordExist(hdb, _T("templates"), _T("id"), m_id))
+      {
+         hStmt = DBPrepare(hdb, _T("UPDATE templates SET version=?,flags=?,apply_filter=? WHERE id=?"));
+      }
+      else
+      {
+         hStmt = DBPrepare(hdb, _T("INSERT INTO templates (version,flags,apply_filter,id) VALUES (?,?,?,?)"));
+      }
+      if (hStmt == NULL)
+      {
+         unlockProperties();
+         return FALSE;
+      }
 
-	DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, m_dwVersion);
-	DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, m_flags);
-	DBBind(hStmt, 3, DB_SQLTYPE_TEXT, m_applyFilterSource, DB_BIND_STATIC);
-	DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, m_id);
-	BOOL success = DBExecute(hStmt);
-	DBFreeStatement(hStmt);
+      DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, m_dwVersion);
+      DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, m_flags);
+      DBBind(hStmt, 3, DB_SQLTYPE_TEXT, m_applyFilterSource, DB_BIND_STATIC);
+      DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, m_id);
+      success = DBExecute(hStmt);
+      DBFreeStatement(hStmt);
+   }
 
-	if (success)
+	if (success && (m_modified & MODIFY_RELATIONS))
 	{
 		TCHAR query[256];
 
@@ -313,22 +317,26 @@ BOOL Template::saveToDatabase(DB_HANDLE hdb)
 			DBQuery(hdb, query);
 		}
 		unlockChildList();
+	}
 
-		// Save access list
+	// Save access list
+	if (success)
 		saveACLToDB(hdb);
-	}
 
    unlockProperties();
 
    // Save data collection items
-	lockDciAccess(false);
-   for(int i = 0; i < m_dcObjects->size(); i++)
-      m_dcObjects->get(i)->saveToDatabase(hdb);
-	unlockDciAccess();
+   if (m_modified & MODIFY_DATA_COLLECTION)
+   {
+      lockDciAccess(false);
+      for(int i = 0; i < m_dcObjects->size(); i++)
+         m_dcObjects->get(i)->saveToDatabase(hdb);
+      unlockDciAccess();
+   }
 
    // Clear modifications flag
 	lockProperties();
-   m_isModified = false;
+   m_modified = 0;
 	unlockProperties();
 
    return success;
@@ -430,7 +438,7 @@ bool Template::addDCObject(DCObject *object, bool alreadyLocked)
       if (object->getStatus() != ITEM_STATUS_DISABLED)
          object->setStatus(ITEM_STATUS_ACTIVE, false);
       object->clearBusyFlag();
-      m_isModified = true;
+      setModified(MODIFY_DATA_COLLECTION, false);
       success = true;
    }
 
@@ -440,7 +448,7 @@ bool Template::addDCObject(DCObject *object, bool alreadyLocked)
 	if (success)
 	{
 		lockProperties();
-      setModified();
+      setModified(MODIFY_DATA_COLLECTION);
 		unlockProperties();
 	}
    return success;
@@ -486,7 +494,7 @@ bool Template::deleteDCObject(UINT32 dcObjectId, bool needLock)
 	if (success)
 	{
 	   lockProperties();
-	   setModified(false);
+	   setModified(MODIFY_DATA_COLLECTION, false);
 	   unlockProperties();
 	}
    return success;
@@ -559,7 +567,7 @@ bool Template::updateDCObject(UINT32 dwItemId, NXCPMessage *pMsg, UINT32 *pdwNum
 				object->updateFromMessage(pMsg);
 			}
 			success = true;
-			m_isModified = true;
+			setModified(MODIFY_DATA_COLLECTION, false);
          break;
       }
 	}
@@ -653,7 +661,7 @@ bool Template::unlockDCIList(int sessionId)
       {
          if (getObjectClass() == OBJECT_TEMPLATE)
             m_dwVersion++;
-         setModified();
+         setModified(MODIFY_DATA_COLLECTION | MODIFY_OTHER);
          callChangeHook = true;
       }
       m_dciListModified = false;
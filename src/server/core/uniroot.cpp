@@ -81,22 +81,25 @@ BOOL UniversalRoot::saveToDatabase(DB_HANDLE hdb)
    saveCommonProperties(hdb);
 
    // Update members list
-   _sntprintf(szQuery, sizeof(szQuery) / sizeof(TCHAR), _T("DELETE FROM container_members WHERE container_id=%d"), m_id);
-   DBQuery(hdb, szQuery);
-   lockChildList(FALSE);
-   for(int i = 0; i < m_childList->size(); i++)
+   if (m_modified & MODIFY_RELATIONS)
    {
-      _sntprintf(szQuery, sizeof(szQuery) / sizeof(TCHAR), _T("INSERT INTO container_members (container_id,object_id) VALUES (%d,%d)"), m_id, m_childList->get(i)->getId());
+      _sntprintf(szQuery, sizeof(szQuery) / sizeof(TCHAR), _T("DELETE FROM container_members WHERE container_id=%d"), m_id);
       DBQuery(hdb, szQuery);
+      lockChildList(FALSE);
+      for(int i = 0; i < m_childList->size(); i++)
+      {
+         _sntprintf(szQuery, sizeof(szQuery) / sizeof(TCHAR), _T("INSERT INTO container_members (container_id,object_id) VALUES (%d,%d)"), m_id, m_childList->get(i)->getId());
+         DBQuery(hdb, szQuery);
+      }
+      unlockChildList();
    }
-   unlockChildList();
 
    // Save access list
    saveACLToDB(hdb);
 
    // Unlock object and clear modification flag
    unlockProperties();
-   m_isModified = false;
+   m_modified = 0;
    return TRUE;
 }
 
@@ -176,7 +176,7 @@ BOOL VPNConnector::saveToDatabase(DB_HANDLE hdb)
    saveACLToDB(hdb);
 
    // Clear modifications flag and unlock object
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
 
    return TRUE;
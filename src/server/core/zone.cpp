@@ -143,7 +143,7 @@ BOOL Zone::saveToDatabase(DB_HANDLE hdb)
          success = saveACLToDB(hdb);
    }
    // Unlock object and clear modification flag
-   m_isModified = false;
+   m_modified = 0;
    unlockProperties();
    return success;
 }
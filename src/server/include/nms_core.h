@@ -1044,6 +1044,7 @@ void ConsoleWrite(CONSOLE_CTX pCtx, const TCHAR *text);
 int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx);
 
 void SaveObjects(DB_HANDLE hdb, UINT32 watchdogId);
+void NXCORE_EXPORTABLE EnqueueModifiedObject(UINT32 id);
 void NXCORE_EXPORTABLE ObjectTransactionStart();
 void NXCORE_EXPORTABLE ObjectTransactionEnd();
 
@@ -1056,6 +1057,9 @@ void StopDBWriter();
 
 void PerfDataStorageRequest(DCItem *dci, time_t timestamp, const TCHAR *value);
 void PerfDataStorageRequest(DCTable *dci, time_t timestamp, Table *value);
+void PerfDataStorageRemoveRequests(DCObject *dci);
+void ShutdownPerfDataStorageDrivers();
+void ShowPerfDataStorageStats(CONSOLE_CTX console);
 
 void DecodeSQLStringAndSetVariable(NXCPMessage *pMsg, UINT32 dwVarId, TCHAR *pszStr);
 
@@ -1224,6 +1228,22 @@ void StartHouseKeeper();
 void StopHouseKeeper();
 void RunHouseKeeper();
 
+/**
+ * Status propagation control
+ */
+void StartStatusPropagation();
+void StopStatusPropagation();
+void EnqueueStatusRecalculation(UINT32 id);
+int GetStatusPropagationQueueSize();
+
+/**
+ * Data table partitioning
+ */
+void InitDataPartitioning();
+bool IsDataPartitioningEnabled();
+void CreateDataPartitions(DB_HANDLE hdb, UINT32 objectId);
+void DropExpiredDataPartitions(DB_HANDLE hdb, const TCHAR *prefix, UINT32 objectId, time_t cutoff);
+
 /**
  * Alarm category functions
  */
@@ -1320,10 +1340,16 @@ extern Queue *g_dciRawDataWriterQueue;
 extern UINT64 g_idataWriteRequests;
 extern UINT64 g_rawDataWriteRequests;
 extern UINT64 g_otherWriteRequests;
+extern UINT32 g_syncerObjectsSaved;
+extern UINT32 g_syncerObjectsDeleted;
+extern UINT64 g_syncerQueries;
+extern UINT32 g_syncerCycleTime;
+extern UINT32 g_syncerThreads;
 
 extern int NXCORE_EXPORTABLE g_dbSyntax;
 extern FileMonitoringList g_monitoringList;
 
 extern ThreadPool NXCORE_EXPORTABLE *g_mainThreadPool;
+extern SNMP_AsyncEngine *g_snmpEngine;
 
 #endif   /* _nms_core_h_ */
@@ -118,6 +118,17 @@ bool NXCORE_EXPORTABLE ExecuteQueryOnObject(DB_HANDLE hdb, UINT32 objectId, cons
 #define CLF_DOWN                          0x0002
 #define CLF_QUEUED_FOR_CONFIGURATION_POLL 0x0004
 
+/**
+ * Object modification flags (groups of persistent properties to be saved by syncer)
+ */
+#define MODIFY_OTHER                0x0001   /* class specific properties */
+#define MODIFY_COMMON_PROPERTIES    0x0002
+#define MODIFY_CUSTOM_ATTRIBUTES    0x0004
+#define MODIFY_ACCESS_LIST          0x0008
+#define MODIFY_DATA_COLLECTION      0x0010
+#define MODIFY_RELATIONS            0x0020
+#define MODIFY_ALL                  0xFFFF
+
 class AgentTunnel;
 
 /**
@@ -444,6 +455,12 @@ private:
 
 	void getFullChildListInternal(ObjectIndex *list, bool eventSourceOnly);
 
+   int m_reportedStatus;     // Propagated status last reported to parents
+   int m_childStatusCount[STATUS_UNKNOWN];   // Number of child objects for each reported status
+   bool m_childStatusValid;  // Child status counters are in sync with child list
+
+   void invalidateChildStatus();
+
 protected:
    UINT32 m_id;
 	uuid m_guid;
@@ -459,7 +476,9 @@ protected:
    int m_statusTranslation[4];
    int m_statusSingleThreshold;
    int m_statusThresholds[4];
-   bool m_isModified;
+   UINT32 m_modified;        // Modification flags (MODIFY_xxx)
+   UINT32 m_modifiedDuringSave; // Modification flags set while syncer save is in progress
+   bool m_saveInProgress;
    bool m_isDeleted;
    bool m_isHidden;
 	bool m_isSystem;
@@ -510,7 +529,11 @@ protected:
    }
    void unlockChildList() { RWLockUnlock(m_rwlockChildList); }
 
-   void setModified(bool notify = true);                  // Used to mark object as modified
+   void setModified(UINT32 flags = MODIFY_ALL, bool notify = true);   // Used to mark object as modified
+
+   void getChildStatusCounters(int *counters);
+   void propagateStatus(bool forced = false);
+   void setStatus(int status) { m_status = status; propagateStatus(); }   // Set status outside of compound status calculation (should be called without properties lock)
 
    bool loadACLFromDB(DB_HANDLE hdb);
    bool saveACLToDB(DB_HANDLE hdb);
@@ -547,15 +570,16 @@ public:
 	const TCHAR *getComments() const { return CHECK_NULL_EX(m_comments); }
 
 	const GeoLocation& getGeoLocation() const { return m_geoLocation; }
-	void setGeoLocation(const GeoLocation& geoLocation) { lockProperties(); m_geoLocation = geoLocation; setModified(); unlockProperties(); }
+	void setGeoLocation(const GeoLocation& geoLocation) { lockProperties(); m_geoLocation = geoLocation; setModified(MODIFY_COMMON_PROPERTIES); unlockProperties(); }
 
    const PostalAddress *getPostalAddress() const { return m_postalAddress; }
-   void setPostalAddress(PostalAddress * addr) { lockProperties(); delete m_postalAddress; m_postalAddress = addr; setModified(); unlockProperties(); }
+   void setPostalAddress(PostalAddress * addr) { lockProperties(); delete m_postalAddress; m_postalAddress = addr; setModified(MODIFY_COMMON_PROPERTIES); unlockProperties(); }
 
    const uuid& getMapImage() { return m_image; }
-   void setMapImage(const uuid& image) { lockProperties(); m_image = image; setModified(); unlockProperties(); }
+   void setMapImage(const uuid& image) { lockProperties(); m_image = image; setModified(MODIFY_COMMON_PROPERTIES); unlockProperties(); }
 
-   bool isModified() const { return m_isModified; }
+   bool isModified() const { return m_modified != 0; }
+   UINT32 getModifiedFlags() const { return m_modified; }
    bool isDeleted() const { return m_isDeleted; }
    bool isOrphaned() const { return m_parentList->size() == 0; }
    bool isEmpty() const { return m_childList->size() == 0; }
@@ -581,17 +605,18 @@ public:
    bool isHidden() { return m_isHidden; }
    void hide();
    void unhide();
-   void markAsModified() { lockProperties(); setModified(); unlockProperties(); }  // external API to mark object as modified
+   void markAsModified(UINT32 flags = MODIFY_ALL, bool notify = true) { lockProperties(); setModified(flags, notify); unlockProperties(); }  // external API to mark object as modified
 
    virtual BOOL saveToDatabase(DB_HANDLE hdb);
    virtual bool deleteFromDatabase(DB_HANDLE hdb);
    virtual bool loadFromDatabase(DB_HANDLE hdb, UINT32 id);
    virtual void linkObjects();
+   bool saveModified(DB_HANDLE hdb, UINT32 *flags);
 
    void setId(UINT32 dwId) { m_id = dwId; setModified(); }
    void generateGuid() { m_guid = uuid::generate(); }
-   void setName(const TCHAR *pszName) { nx_strncpy(m_name, pszName, MAX_OBJECT_NAME); setModified(); }
-   void resetStatus() { m_status = STATUS_UNKNOWN; setModified(); }
+   void setName(const TCHAR *pszName) { nx_strncpy(m_name, pszName, MAX_OBJECT_NAME); setModified(MODIFY_COMMON_PROPERTIES); }
+   void resetStatus() { setModified(MODIFY_COMMON_PROPERTIES); setStatus(STATUS_UNKNOWN); }
    void setComments(TCHAR *text);	/* text must be dynamically allocated */
 
    bool isInMaintenanceMode() const { return m_maintenanceMode; }
@@ -617,9 +642,9 @@ public:
    void addChildDCTargetsToList(ObjectArray<DataCollectionTarget> *dctList, UINT32 dwUserId);
 
    const TCHAR *getCustomAttribute(const TCHAR *name) { return m_customAttributes.get(name); }
-   void setCustomAttribute(const TCHAR *name, const TCHAR *value) { m_customAttributes.set(name, value); setModified(); }
-   void setCustomAttributePV(const TCHAR *name, TCHAR *value) { m_customAttributes.setPreallocated(_tcsdup(name), value); setModified(); }
-   void deleteCustomAttribute(const TCHAR *name) { m_customAttributes.remove(name); setModified(); }
+   void setCustomAttribute(const TCHAR *name, const TCHAR *value) { m_customAttributes.set(name, value); setModified(MODIFY_CUSTOM_ATTRIBUTES); }
+   void setCustomAttributePV(const TCHAR *name, TCHAR *value) { m_customAttributes.setPreallocated(_tcsdup(name), value); setModified(MODIFY_CUSTOM_ATTRIBUTES); }
+   void deleteCustomAttribute(const TCHAR *name) { m_customAttributes.remove(name); setModified(MODIFY_CUSTOM_ATTRIBUTES); }
    NXSL_Value *getCustomAttributesForNXSL() const;
 
    virtual NXSL_Value *createNXSLObject();
@@ -886,21 +911,21 @@ public:
 
    void setMacAddr(const BYTE *macAddr, bool updateMacDB);
    void setIpAddress(const InetAddress& addr);
-   void setBridgePortNumber(UINT32 bpn) { m_bridgePortNumber = bpn; setModified(); }
-   void setSlotNumber(UINT32 slot) { m_slotNumber = slot; setModified(); }
-   void setPortNumber(UINT32 port) { m_portNumber = port; setModified(); }
-	void setPhysicalPortFlag(bool isPhysical) { if (isPhysical) m_flags |= IF_PHYSICAL_PORT; else m_flags &= ~IF_PHYSICAL_PORT; setModified(); }
-	void setManualCreationFlag(bool isManual) { if (isManual) m_flags |= IF_CREATED_MANUALLY; else m_flags &= ~IF_CREATED_MANUALLY; setModified(); }
+   void setBridgePortNumber(UINT32 bpn) { m_bridgePortNumber = bpn; setModified(MODIFY_OTHER); }
+   void setSlotNumber(UINT32 slot) { m_slotNumber = slot; setModified(MODIFY_OTHER); }
+   void setPortNumber(UINT32 port) { m_portNumber = port; setModified(MODIFY_OTHER); }
+	void setPhysicalPortFlag(bool isPhysical) { if (isPhysical) m_flags |= IF_PHYSICAL_PORT; else m_flags &= ~IF_PHYSICAL_PORT; setModified(MODIFY_OTHER); }
+	void setManualCreationFlag(bool isManual) { if (isManual) m_flags |= IF_CREATED_MANUALLY; else m_flags &= ~IF_CREATED_MANUALLY; setModified(MODIFY_OTHER); }
 	void setPeer(Node *node, Interface *iface, LinkLayerProtocol protocol, bool reflection);
-   void clearPeer() { lockProperties(); m_peerNodeId = 0; m_peerInterfaceId = 0; m_peerDiscoveryProtocol = LL_PROTO_UNKNOWN; setModified(); unlockProperties(); }
-   void setDescription(const TCHAR *descr) { lockProperties(); nx_strncpy(m_description, descr, MAX_DB_STRING); setModified(); unlockProperties(); }
-   void setAlias(const TCHAR *alias) { lockProperties(); nx_strncpy(m_alias, alias, MAX_DB_STRING); setModified(); unlockProperties(); }
+   void clearPeer() { lockProperties(); m_peerNodeId = 0; m_peerInterfaceId = 0; m_peerDiscoveryProtocol = LL_PROTO_UNKNOWN; setModified(MODIFY_OTHER); unlockProperties(); }
+   void setDescription(const TCHAR *descr) { lockProperties(); nx_strncpy(m_description, descr, MAX_DB_STRING); setModified(MODIFY_OTHER); unlockProperties(); }
+   void setAlias(const TCHAR *alias) { lockProperties(); nx_strncpy(m_alias, alias, MAX_DB_STRING); setModified(MODIFY_OTHER); unlockProperties(); }
    void addIpAddress(const InetAddress& addr);
    void deleteIpAddress(InetAddress addr);
    void setNetMask(const InetAddress& addr);
-	void setMTU(int mtu) { m_mtu = mtu; setModified(); }
-	void setSpeed(UINT64 speed) { m_speed = speed; setModified(); }
-   void setIfTableSuffix(int len, const UINT32 *suffix) { lockProperties(); safe_free(m_ifTableSuffix); m_ifTableSuffixLen = len; m_ifTableSuffix = (len > 0) ? (UINT32 *)nx_memdup(suffix, len * sizeof(UINT32)) : NULL; setModified(); unlockProperties(); }
+	void setMTU(int mtu) { m_mtu = mtu; setModified(MODIFY_OTHER); }
+	void setSpeed(UINT64 speed) { m_speed = speed; setModified(MODIFY_OTHER); }
+   void setIfTableSuffix(int len, const UINT32 *suffix) { lockProperties(); safe_free(m_ifTableSuffix); m_ifTableSuffixLen = len; m_ifTableSuffix = (len > 0) ? (UINT32 *)nx_memdup(suffix, len * sizeof(UINT32)) : NULL; setModified(MODIFY_OTHER); unlockProperties(); }
 
 	void updateZoneId();
 
@@ -1501,10 +1526,13 @@ protected:
    void updatePhysicalContainerBinding(int containerClass, UINT32 containerId);
 
    bool connectToAgent(UINT32 *error = NULL, UINT32 *socketError = NULL, bool *newConnection = NULL, bool forceConnect = false);
-   void setLastAgentCommTime() { time_t now = time(NULL); if (m_lastAgentCommTime < now - 60) { m_lastAgentCommTime = now; setModified(); } }
+   void setLastAgentCommTime() { time_t now = time(NULL); if (m_lastAgentCommTime < now - 60) { m_lastAgentCommTime = now; setModified(MODIFY_OTHER); } }
 
 	void buildIPTopologyInternal(nxmap_ObjList &topology, int nDepth, UINT32 seedObject, bool vpnLink, bool includeEndNodes);
 
+   bool isAsyncSnmpAvailable();
+   UINT32 checkSnmpAgentAsync(const TCHAR *oid);
+
 	virtual bool isDataCollectionDisabled();
    virtual void collectProxyInfo(ProxyInfo *info);
 
@@ -1541,8 +1569,8 @@ public:
    const TCHAR *getSubType() const { return m_subType; }
    UINT32 getRuntimeFlags() const { return m_dwDynamicFlags; }
 
-   void setFlag(UINT32 flag) { lockProperties(); m_flags |= flag; setModified(); unlockProperties(); }
-   void clearFlag(UINT32 flag) { lockProperties(); m_flags &= ~flag; setModified(); unlockProperties(); }
+   void setFlag(UINT32 flag) { lockProperties(); m_flags |= flag; setModified(MODIFY_OTHER); unlockProperties(); }
+   void clearFlag(UINT32 flag) { lockProperties(); m_flags &= ~flag; setModified(MODIFY_OTHER); unlockProperties(); }
    void setLocalMgmtFlag() { m_flags |= NF_IS_LOCAL_MGMT; }
    void clearLocalMgmtFlag() { m_flags &= ~NF_IS_LOCAL_MGMT; }
 
@@ -1672,8 +1700,10 @@ public:
    bool connectToSMCLP();
 
 	virtual UINT32 getInternalItem(const TCHAR *param, size_t bufSize, TCHAR *buffer);
+   UINT32 getInternalTable(const TCHAR *name, Table **table);
 
    UINT32 getItemFromSNMP(WORD port, const TCHAR *param, size_t bufSize, TCHAR *buffer, int interpretRawValue);
+   bool getItemFromSNMPAsync(WORD port, const TCHAR *param, void (*callback)(UINT32, const TCHAR *, void *), void *context);
 	UINT32 getTableFromSNMP(WORD port, const TCHAR *oid, ObjectArray<DCTableColumn> *columns, Table **table);
    UINT32 getListFromSNMP(WORD port, const TCHAR *oid, StringList **list);
    UINT32 getOIDSuffixListFromSNMP(WORD port, const TCHAR *oid, StringMap **values);
@@ -27,6 +27,7 @@
 
 class Node;
 class Interface;
+struct WirelessStationInfo;
 
 /**
  * LLDP local port info
@@ -102,6 +103,28 @@ struct PORT_MAPPING_ENTRY
 	UINT32 ifIndex;
 };
 
+/**
+ * Source of MAC address location
+ */
+enum MacLocationSource
+{
+   MAC_LOCATION_FDB = 0,      /* switch forwarding database */
+   MAC_LOCATION_WIRELESS = 1  /* wireless controller station list */
+};
+
+/**
+ * Known location of MAC address (candidate connection point)
+ */
+struct MacLocation
+{
+   UINT32 nodeId;          // Switch or wireless controller node
+   UINT32 ifIndex;         // Interface index (FDB) or radio interface index (wireless)
+   UINT32 apObjectId;      // Access point object ID (wireless only)
+   int macCount;           // Number of MAC addresses on same port (FDB only)
+   BYTE source;            // MAC_LOCATION_FDB or MAC_LOCATION_WIRELESS
+   bool isStatic;          // Static FDB entry
+};
+
 /**
  * Switch forwarding database
  */
@@ -270,6 +293,14 @@ NetworkPath *TraceRoute(Node *pSrc, Node *pDest);
 void BuildL2Topology(nxmap_ObjList &topology, Node *root, int nDepth, bool includeEndNodes);
 ForwardingDatabase *GetSwitchForwardingDatabase(Node *node);
 NetObj *FindInterfaceConnectionPoint(const BYTE *macAddr, int *type);
+NetObj *FindInterfaceConnectionPoint(const BYTE *macAddrs, int count, int *index, int *type);
+
+void MacLocationIndexUpdateFdb(UINT32 nodeId, ForwardingDatabase *fdb);
+void MacLocationIndexUpdateWirelessStations(UINT32 nodeId, ObjectArray<WirelessStationInfo> *stations);
+void MacLocationIndexRemoveNode(UINT32 nodeId);
+int MacLocationIndexFind(const BYTE *macAddr, MacLocation *buffer, int size);
+void MacLocationIndexFind(const BYTE *macAddrs, int count, StructArray<MacLocation> *locations, int *offsets);
+int MacLocationIndexSize();
 
 ObjectArray<LLDP_LOCAL_PORT_INFO> *GetLLDPLocalPortInfo(SNMP_Transport *snmp);
 
@@ -29,7 +29,7 @@
 /**
  *API version
  */
-#define PDSDRV_API_VERSION          1
+#define PDSDRV_API_VERSION          2
 
 /**
  * Driver header
@@ -48,7 +48,26 @@ const TCHAR __PDSDRV_EXPORT *pdsdrvName = name; \
 extern "C" PerfDataStorageDriver __PDSDRV_EXPORT *pdsdrvCreateInstance() { return new implClass; }
 
 /**
- * Base class for performance data storage drivers
+ * Queue overflow policies
+ */
+#define PDS_OVERFLOW_DROP     0
+#define PDS_OVERFLOW_SPILL    1
+
+/**
+ * DCI value passed to driver in batch
+ */
+struct PerfDataStorageValue
+{
+   DCItem *dci;
+   time_t timestamp;
+   const TCHAR *value;
+};
+
+/**
+ * Base class for performance data storage drivers. Driver methods for saving
+ * values are called from driver's dedicated dispatcher thread. Driver should
+ * not lock data collection objects of DCI owner or keep references to
+ * passed objects after call returns.
  */
 class NXCORE_EXPORTABLE PerfDataStorageDriver
 {
@@ -63,7 +82,10 @@ public:
    virtual void shutdown();
 
    virtual bool saveDCItemValue(DCItem *dcObject, time_t timestamp, const TCHAR *value);
+   virtual bool saveDCItemValues(PerfDataStorageValue *values, int count);
    virtual bool saveDCTableValue(DCTable *dcObject, time_t timestamp, Table *value);
 };
 
+bool NXCORE_EXPORTABLE RegisterPerfDataStorageDriver(PerfDataStorageDriver *driver, int queueSize, int overflowPolicy);
+
 #endif   /* _pdsdrv_h_ */
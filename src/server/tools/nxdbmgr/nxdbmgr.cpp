@@ -651,6 +651,7 @@ stop_search:
                      _T("   import <file>        : Import database from file\n")
                      _T("   init <file>          : Initialize database\n")
 				         _T("   migrate <source>     : Migrate database from given source\n")
+                     _T("   partition <days>     : Convert data tables to time-partitioned layout (PostgreSQL 11+)\n")
                      _T("   reset-system-account : Unlock user \"system\" and reset it's password to default\n")
                      _T("   set <name> <value>   : Set value of server configuration variable\n")
                      _T("   unlock               : Forced database unlock\n")
@@ -762,6 +763,7 @@ stop_search:
        strcmp(argv[optind], "import") &&
        strcmp(argv[optind], "init") &&
        strcmp(argv[optind], "migrate") &&
+       strcmp(argv[optind], "partition") &&
        strcmp(argv[optind], "reset-system-account") &&
        strcmp(argv[optind], "set") &&
        strcmp(argv[optind], "unlock") &&
@@ -770,7 +772,7 @@ stop_search:
       _tprintf(_T("Invalid command \"%hs\". Type nxdbmgr -h for command line syntax.\n"), argv[optind]);
       return 1;
    }
-   if (((!strcmp(argv[optind], "init") || !strcmp(argv[optind], "batch") || !strcmp(argv[optind], "export") || !strcmp(argv[optind], "import") || !strcmp(argv[optind], "get") || !strcmp(argv[optind], "migrate")) && (argc - optind < 2)) ||
+   if (((!strcmp(argv[optind], "init") || !strcmp(argv[optind], "batch") || !strcmp(argv[optind], "export") || !strcmp(argv[optind], "import") || !strcmp(argv[optind], "get") || !strcmp(argv[optind], "migrate") || !strcmp(argv[optind], "partition")) && (argc - optind < 2)) ||
        (!strcmp(argv[optind], "set") && (argc - optind < 3)))
    {
       _tprintf(_T("Required command argument(s) missing\n"));
@@ -800,6 +802,9 @@ stop_search:
       return 3;
    }
 
+   // Schema changes can invalidate prepared statements, so do not keep them between uses
+   DBSetStatementCacheSize(0);
+
 	s_driver = DBLoadDriver(s_dbDriver, s_dbDrvParams, false, NULL, NULL);
 	if (s_driver == NULL)
    {
@@ -874,6 +879,10 @@ stop_search:
 			free(sourceConfig);
 #endif
 		}
+      else if (!strcmp(argv[optind], "partition"))
+      {
+         EnableDataPartitioning(strtol(argv[optind + 1], NULL, 10));
+      }
       else if (!strcmp(argv[optind], "get"))
 		{
 #ifdef UNICODE
@@ -90,6 +90,8 @@ BOOL CreateTDataTable_preV281(DWORD nodeId);
 
 void ResetSystemAccount();
 
+bool EnableDataPartitioning(int days);
+
 //
 // Global variables
 //
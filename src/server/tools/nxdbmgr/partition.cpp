@@ -0,0 +1,255 @@
+/*
+** nxdbmgr - NetXMS database manager
+** Copyright (C) 2004-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: partition.cpp
+**
+**/
+
+#include "nxdbmgr.h"
+
+/**
+ * Time ahead of current time covered by pre-created partitions (in seconds).
+ * Should match value used by server.
+ */
+#define PARTITION_PRECREATE_TIME    (7 * 86400)
+
+/**
+ * Append partitioning clause to table creation command stored in metadata
+ */
+static bool UpdateCreationCommand(const TCHAR *var, const TCHAR *column)
+{
+   TCHAR command[256];
+   MetaDataReadStr(var, command, 256, _T(""));
+   if (command[0] == 0)
+      return true;
+
+   TCHAR clause[64];
+   _sntprintf(clause, 64, _T(" PARTITION BY RANGE(%s)"), column);
+   if (_tcslen(command) + _tcslen(clause) > 255)
+   {
+      _tprintf(_T("Cannot update %s: command too long\n"), var);
+      return false;
+   }
+   _tcscat(command, clause);
+
+   String query = _T("UPDATE metadata SET var_value=");
+   query.append(DBPrepareString(g_hCoreDB, command));
+   query.append(_T(" WHERE var_name='"));
+   query.append(var);
+   query.append(_T("'"));
+   return SQLQuery(query);
+}
+
+/**
+ * Check if given table is already partitioned
+ */
+static bool IsPartitionedTable(const TCHAR *table)
+{
+   TCHAR query[256];
+   _sntprintf(query, 256, _T("SELECT relkind FROM pg_class WHERE relname='%s'"), table);
+   DB_RESULT hResult = SQLSelect(query);
+   if (hResult == NULL)
+      return false;
+
+   bool partitioned = false;
+   if (DBGetNumRows(hResult) > 0)
+   {
+      TCHAR kind[4];
+      DBGetField(hResult, 0, 0, kind, 4);
+      partitioned = (kind[0] == _T('p'));
+   }
+   DBFreeResult(hResult);
+   return partitioned;
+}
+
+/**
+ * Convert given data table (should be called within transaction)
+ */
+static bool ConvertDataTableInTransaction(const TCHAR *prefix, UINT32 id, const TCHAR *table, UINT32 interval, UINT32 period)
+{
+   TCHAR legacy[64], query[512];
+   _sntprintf(legacy, 64, _T("%s_%d_p%u"), prefix, id, period - 1);
+
+   // Rename existing indexes to avoid name conflicts with indexes on partitioned table
+   _sntprintf(query, 512, _T("SELECT indexname FROM pg_indexes WHERE tablename='%s'"), table);
+   DB_RESULT hResult = SQLSelect(query);
+   if (hResult == NULL)
+      return false;
+   int count = DBGetNumRows(hResult);
+   for(int i = 0; i < count; i++)
+   {
+      TCHAR index[128];
+      DBGetField(hResult, i, 0, index, 128);
+      _sntprintf(query, 512, _T("ALTER INDEX %s RENAME TO %s_p%u"), index, index, period - 1);
+      if (!SQLQuery(query))
+      {
+         DBFreeResult(hResult);
+         return false;
+      }
+   }
+   DBFreeResult(hResult);
+
+   _sntprintf(query, 512, _T("ALTER TABLE %s RENAME TO %s"), table, legacy);
+   CHK_EXEC(SQLQuery(query));
+
+   if (!_tcscmp(prefix, _T("idata")))
+      CHK_EXEC(CreateIDataTable(id));
+   else
+      CHK_EXEC(CreateTDataTable(id));
+
+   _sntprintf(query, 512, _T("ALTER TABLE %s ATTACH PARTITION %s FOR VALUES FROM (MINVALUE) TO (") INT64_FMT _T(")"),
+            table, legacy, (INT64)period * interval);
+   CHK_EXEC(SQLQuery(query));
+
+   UINT32 last = (UINT32)((time(NULL) + PARTITION_PRECREATE_TIME) / interval);
+   for(UINT32 p = period; p <= last; p++)
+   {
+      _sntprintf(query, 512, _T("CREATE TABLE %s_%d_p%u PARTITION OF %s FOR VALUES FROM (") INT64_FMT _T(") TO (") INT64_FMT _T(")"),
+               prefix, id, p, table, (INT64)p * interval, (INT64)(p + 1) * interval);
+      CHK_EXEC(SQLQuery(query));
+   }
+   return true;
+}
+
+/**
+ * Convert existing data table into partitioned one. Existing table becomes
+ * partition holding all data collected before current period. Each table is
+ * converted in separate transaction; tables which are already partitioned
+ * are skipped, so interrupted conversion can be continued.
+ */
+static bool ConvertDataTable(const TCHAR *prefix, UINT32 id, UINT32 interval, UINT32 period)
+{
+   TCHAR format[64], table[64];
+   _sntprintf(format, 64, _T("%s_%%d"), prefix);
+   if (!IsDataTableExist(format, id))
+      return true;
+   _sntprintf(table, 64, format, id);
+   if (IsPartitionedTable(table))
+      return true;
+
+   if (!DBBegin(g_hCoreDB))
+   {
+      _tprintf(_T("Cannot start transaction\n"));
+      return false;
+   }
+
+   bool success = ConvertDataTableInTransaction(prefix, id, table, interval, period);
+   if (success)
+      DBCommit(g_hCoreDB);
+   else
+      DBRollback(g_hCoreDB);
+   return success;
+}
+
+/**
+ * Convert data tables for given object class
+ */
+static bool ConvertDataTablesForClass(const TCHAR *className, UINT32 interval, UINT32 period)
+{
+   TCHAR query[256];
+   _sntprintf(query, 256, _T("SELECT id FROM %s"), className);
+   DB_RESULT hResult = SQLSelect(query);
+   if (hResult == NULL)
+      return false;
+
+   bool success = true;
+   int count = DBGetNumRows(hResult);
+   for(int i = 0; (i < count) && success; i++)
+   {
+      UINT32 id = DBGetFieldULong(hResult, i, 0);
+      success = ConvertDataTable(_T("idata"), id, interval, period) &&
+                ConvertDataTable(_T("tdata"), id, interval, period);
+   }
+   DBFreeResult(hResult);
+   return success;
+}
+
+/**
+ * Convert idata_xx and tdata_xx tables to time-partitioned layout
+ * (PostgreSQL 11 or higher is required)
+ */
+bool EnableDataPartitioning(int days)
+{
+   if (g_dbSyntax != DB_SYNTAX_PGSQL)
+   {
+      _tprintf(_T("Data table partitioning is only supported for PostgreSQL\n"));
+      return false;
+   }
+
+   if (days <= 0)
+   {
+      _tprintf(_T("Invalid partition interval\n"));
+      return false;
+   }
+
+   int currentInterval = MetaDataReadInt(_T("DataPartitionInterval"), 0);
+   if ((currentInterval > 0) && (currentInterval != days))
+   {
+      _tprintf(_T("Data tables already partitioned with interval %d days\n"), currentInterval);
+      return false;
+   }
+
+   UINT32 interval = (UINT32)days * 86400;
+   UINT32 period = (UINT32)(time(NULL) / interval);
+
+   // Switch to partitioned mode first, so that tables created afterwards are partitioned
+   // and server maintains partitions for already converted tables even if conversion
+   // of remaining tables is interrupted
+   if (currentInterval == 0)
+   {
+      if (!DBBegin(g_hCoreDB))
+      {
+         _tprintf(_T("Cannot start transaction\n"));
+         return false;
+      }
+
+      bool success =
+         UpdateCreationCommand(_T("IDataTableCreationCommand"), _T("idata_timestamp")) &&
+         UpdateCreationCommand(_T("TDataTableCreationCommand_0"), _T("tdata_timestamp"));
+      if (success)
+      {
+         TCHAR query[256];
+         _sntprintf(query, 256, _T("INSERT INTO metadata (var_name,var_value) VALUES ('DataPartitionInterval','%d')"), days);
+         success = SQLQuery(query);
+      }
+
+      if (success)
+      {
+         DBCommit(g_hCoreDB);
+      }
+      else
+      {
+         DBRollback(g_hCoreDB);
+         _tprintf(_T("Data table conversion failed\n"));
+         return false;
+      }
+   }
+
+   bool success =
+      ConvertDataTablesForClass(_T("nodes"), interval, period) &&
+      ConvertDataTablesForClass(_T("clusters"), interval, period) &&
+      ConvertDataTablesForClass(_T("mobile_devices"), interval, period) &&
+      ConvertDataTablesForClass(_T("access_points"), interval, period) &&
+      ConvertDataTablesForClass(_T("chassis"), interval, period);
+
+   if (success)
+      _tprintf(_T("Data tables successfully converted (partition interval %d days)\n"), days);
+   else
+      _tprintf(_T("Data table conversion failed (run command again to convert remaining tables)\n"));
+   return success;
+}
@@ -746,6 +746,47 @@ static bool SetSchemaVersion(int version)
    return SQLQuery(query);
 }
 
+/**
+ * Upgrade from V444 to V445
+ */
+static BOOL H_UpgradeFromV444(int currVersion, int newVersion)
+{
+   CHK_EXEC(CreateConfigParam(_T("SyncerThreadCount"), _T("4"), _T("Number of parallel threads (each using separate database connection) used by syncer to save modified objects."), 'I', true, false, false, false));
+   CHK_EXEC(SetSchemaVersion(445));
+   return TRUE;
+}
+
+/**
+ * Upgrade from V443 to V444
+ */
+static BOOL H_UpgradeFromV443(int currVersion, int newVersion)
+{
+   CHK_EXEC(CreateConfigParam(_T("SNMPMaxRequestsPerTarget"), _T("8"), _T("Maximum number of simultaneous requests sent by asynchronous SNMP engine to single SNMP agent. If set to 0, asynchronous SNMP engine is disabled."), 'I', true, true, false, false));
+   CHK_EXEC(SetSchemaVersion(444));
+   return TRUE;
+}
+
+/**
+ * Upgrade from V442 to V443
+ */
+static BOOL H_UpgradeFromV442(int currVersion, int newVersion)
+{
+   CHK_EXEC(CreateConfigParam(_T("SNMPMaxRepetitions"), _T("20"), _T("Number of variables requested in single GETBULK request when walking SNMP tables on SNMPv2c/v3 devices. If set to 0, GETNEXT requests are used."), 'I', true, true, false, false));
+   CHK_EXEC(SetSchemaVersion(443));
+   return TRUE;
+}
+
+/**
+ * Upgrade from V441 to V442
+ */
+static BOOL H_UpgradeFromV441(int currVersion, int newVersion)
+{
+   CHK_EXEC(CreateConfigParam(_T("PerfDataStorageQueueSize"), _T("10000"), _T("Maximum number of values queued for each performance data storage driver."), 'I', true, true, false, false));
+   CHK_EXEC(CreateConfigParam(_T("PerfDataStorageOverflowPolicy"), _T("0"), _T("Action on performance data storage driver queue overflow (0 = drop new values, 1 = spill values to disk)."), 'I', true, true, false, false));
+   CHK_EXEC(SetSchemaVersion(442));
+   return TRUE;
+}
+
 /**
  * Upgrade from V440 to V441
  */
@@ -11559,6 +11600,10 @@ static struct
    { 438, 439, H_UpgradeFromV438 },
    { 439, 440, H_UpgradeFromV439 },
    { 440, 441, H_UpgradeFromV440 },
+   { 441, 442, H_UpgradeFromV441 },
+   { 442, 443, H_UpgradeFromV442 },
+   { 443, 444, H_UpgradeFromV443 },
+   { 444, 445, H_UpgradeFromV444 },
    { 0, 0, NULL }
 };
 
@@ -0,0 +1,655 @@
+/*
+** NetXMS - Network Management System
+** SNMP support library
+** Copyright (C) 2003-2017 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation; either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: async.cpp
+**
+**/
+
+#include "libnxsnmp.h"
+
+/**
+ * Maximum time between checks for new requests and timeouts (milliseconds)
+ */
+#define MAX_POLL_TIMEOUT   50
+
+/**
+ * Receive buffer size
+ */
+#define RECEIVE_BUFFER_SIZE   65536
+
+/**
+ * Asynchronous request
+ */
+struct SNMP_AsyncRequest
+{
+   UINT32 id;
+   SNMP_PDU *pdu;
+   BYTE *packet;
+   size_t packetSize;
+   SockAddrBuffer addr;
+   InetAddress peer;
+   SNMP_AsyncTargetKey key;
+   UINT32 timeout;
+   int retries;
+   UINT32 generation;   // incremented on each transmission to invalidate older timers
+   SNMP_AsyncCallback callback;
+   void *context;
+   UINT32 rc;
+   SNMP_PDU *response;
+   SNMP_AsyncRequest *next;
+
+   ~SNMP_AsyncRequest()
+   {
+      delete pdu;
+      free(packet);
+   }
+};
+
+/**
+ * Target (agent address and port) with requests in flight and waiting requests
+ */
+struct SNMP_AsyncTarget
+{
+   int inFlight;
+   SNMP_AsyncRequest *waitingHead;
+   SNMP_AsyncRequest *waitingTail;
+};
+
+/**
+ * Timer (element of binary heap ordered by deadline)
+ */
+struct SNMP_AsyncTimer
+{
+   INT64 deadline;
+   UINT32 requestId;
+   UINT32 generation;
+};
+
+/**
+ * Engine constructor
+ */
+SNMP_AsyncEngine::SNMP_AsyncEngine(int maxInFlightPerTarget)
+{
+   m_socketV4 = INVALID_SOCKET;
+   m_socketV6 = INVALID_SOCKET;
+   m_mutex = MutexCreate();
+   m_thread = INVALID_THREAD_HANDLE;
+   m_shutdown = false;
+   m_running = false;
+   m_maxInFlight = max(maxInFlightPerTarget, 1);
+   m_requests = new HashMap<UINT32, SNMP_AsyncRequest>(false);
+   m_targets = new HashMap<SNMP_AsyncTargetKey, SNMP_AsyncTarget>(true);
+   m_timerAllocated = 256;
+   m_timers = (SNMP_AsyncTimer *)malloc(sizeof(SNMP_AsyncTimer) * m_timerAllocated);
+   m_timerCount = 0;
+   m_waiting = 0;
+   m_requestCount = 0;
+   m_responseCount = 0;
+   m_timeoutCount = 0;
+   m_retransmissionCount = 0;
+   m_unmatchedCount = 0;
+}
+
+/**
+ * Engine destructor
+ */
+SNMP_AsyncEngine::~SNMP_AsyncEngine()
+{
+   stop();
+   delete m_requests;
+   delete m_targets;
+   free(m_timers);
+   MutexDestroy(m_mutex);
+}
+
+/**
+ * Create non-blocking UDP socket bound to any address of given family
+ */
+static SOCKET CreateSocket(int family)
+{
+   SOCKET s = socket(family, SOCK_DGRAM, 0);
+   if (s == INVALID_SOCKET)
+      return INVALID_SOCKET;
+
+   SockAddrBuffer localAddr;
+   memset(&localAddr, 0, sizeof(SockAddrBuffer));
+   if (family == AF_INET)
+   {
+      localAddr.sa4.sin_family = AF_INET;
+      localAddr.sa4.sin_addr.s_addr = htonl(INADDR_ANY);
+   }
+#ifdef WITH_IPV6
+   else
+   {
+      localAddr.sa6.sin6_family = AF_INET6;
+   }
+#endif
+   if (bind(s, (struct sockaddr *)&localAddr, SA_LEN((struct sockaddr *)&localAddr)) != 0)
+   {
+      closesocket(s);
+      return INVALID_SOCKET;
+   }
+   SetSocketNonBlocking(s);
+   return s;
+}
+
+/**
+ * Start engine. Returns false if sockets cannot be created.
+ */
+bool SNMP_AsyncEngine::start()
+{
+   m_socketV4 = CreateSocket(AF_INET);
+#ifdef WITH_IPV6
+   m_socketV6 = CreateSocket(AF_INET6);
+#endif
+   if ((m_socketV4 == INVALID_SOCKET) && (m_socketV6 == INVALID_SOCKET))
+      return false;
+   m_shutdown = false;
+   m_thread = ThreadCreateEx(ioThreadStarter, 0, this);
+   MutexLock(m_mutex);
+   m_running = true;
+   MutexUnlock(m_mutex);
+   return true;
+}
+
+/**
+ * Stop engine. All outstanding requests are completed with SNMP_ERR_COMM.
+ * Running flag is cleared under engine mutex, so any request accepted by
+ * sendRequest() is already registered when pending requests are completed.
+ */
+void SNMP_AsyncEngine::stop()
+{
+   if (m_thread == INVALID_THREAD_HANDLE)
+      return;
+
+   MutexLock(m_mutex);
+   m_running = false;
+   MutexUnlock(m_mutex);
+
+   m_shutdown = true;
+   ThreadJoin(m_thread);
+   m_thread = INVALID_THREAD_HANDLE;
+
+   SNMP_AsyncRequest *completed = NULL;
+   MutexLock(m_mutex);
+
+   // Waiting requests should be completed first so they will not be sent
+   Iterator<SNMP_AsyncTarget> *tit = m_targets->iterator();
+   while(tit->hasNext())
+   {
+      SNMP_AsyncTarget *target = tit->next();
+      while(target->waitingHead != NULL)
+      {
+         SNMP_AsyncRequest *rq = target->waitingHead;
+         target->waitingHead = rq->next;
+         rq->rc = SNMP_ERR_COMM;
+         rq->response = NULL;
+         rq->next = completed;
+         completed = rq;
+      }
+      target->waitingTail = NULL;
+   }
+   delete tit;
+   m_waiting = 0;
+
+   Iterator<SNMP_AsyncRequest> *it = m_requests->iterator();
+   ObjectArray<SNMP_AsyncRequest> inFlight(64, 64, false);
+   while(it->hasNext())
+      inFlight.add(it->next());
+   delete it;
+   for(int i = 0; i < inFlight.size(); i++)
+      finish(inFlight.get(i), SNMP_ERR_COMM, NULL, &completed);
+   m_timerCount = 0;
+   MutexUnlock(m_mutex);
+
+   while(completed != NULL)
+   {
+      SNMP_AsyncRequest *rq = completed;
+      completed = rq->next;
+      rq->callback(rq->rc, rq->response, rq->context);
+      delete rq->response;
+      delete rq;
+   }
+
+   if (m_socketV4 != INVALID_SOCKET)
+   {
+      closesocket(m_socketV4);
+      m_socketV4 = INVALID_SOCKET;
+   }
+   if (m_socketV6 != INVALID_SOCKET)
+   {
+      closesocket(m_socketV6);
+      m_socketV6 = INVALID_SOCKET;
+   }
+}
+
+/**
+ * Send request (should be called with engine mutex locked)
+ */
+void SNMP_AsyncEngine::transmit(SNMP_AsyncRequest *rq)
+{
+   SOCKET s = (rq->peer.getFamily() == AF_INET) ? m_socketV4 : m_socketV6;
+   sendto(s, (char *)rq->packet, (int)rq->packetSize, 0, (struct sockaddr *)&rq->addr, SA_LEN((struct sockaddr *)&rq->addr));
+   rq->generation++;
+   addTimer(rq);
+}
+
+/**
+ * Add timer for request (should be called with engine mutex locked)
+ */
+void SNMP_AsyncEngine::addTimer(SNMP_AsyncRequest *rq)
+{
+   if (m_timerCount == m_timerAllocated)
+   {
+      m_timerAllocated *= 2;
+      m_timers = (SNMP_AsyncTimer *)realloc(m_timers, sizeof(SNMP_AsyncTimer) * m_timerAllocated);
+   }
+
+   SNMP_AsyncTimer t;
+   t.deadline = GetCurrentTimeMs() + rq->timeout;
+   t.requestId = rq->id;
+   t.generation = rq->generation;
+
+   int i = m_timerCount++;
+   while(i > 0)
+   {
+      int parent = (i - 1) / 2;
+      if (m_timers[parent].deadline <= t.deadline)
+         break;
+      m_timers[i] = m_timers[parent];
+      i = parent;
+   }
+   m_timers[i] = t;
+}
+
+/**
+ * Remove request from in-flight list and add it to list of completed requests.
+ * Next waiting request for same target is sent. Should be called with engine mutex locked.
+ */
+void SNMP_AsyncEngine::finish(SNMP_AsyncRequest *rq, UINT32 rc, SNMP_PDU *response, SNMP_AsyncRequest **completed)
+{
+   m_requests->remove(rq->id);
+   rq->rc = rc;
+   rq->response = response;
+   rq->next = *completed;
+   *completed = rq;
+
+   SNMP_AsyncTarget *target = m_targets->get(rq->key);
+   if (target == NULL)
+      return;
+
+   target->inFlight--;
+   if (target->waitingHead != NULL)
+   {
+      SNMP_AsyncRequest *next = target->waitingHead;
+      target->waitingHead = next->next;
+      if (target->waitingHead == NULL)
+         target->waitingTail = NULL;
+      next->next = NULL;
+      m_waiting--;
+      target->inFlight++;
+      m_requests->set(next->id, next);
+      transmit(next);
+   }
+   else if (target->inFlight == 0)
+   {
+      m_targets->remove(rq->key);
+   }
+}
+
+/**
+ * Receive and process all responses waiting in socket buffer. Socket is
+ * non-blocking, so reading stops when no more datagrams are available.
+ */
+void SNMP_AsyncEngine::receive(SOCKET s, BYTE *buffer, size_t bufferSize, SNMP_AsyncRequest **completed)
+{
+   while(true)
+   {
+      SockAddrBuffer sender;
+      socklen_t addrLen = sizeof(SockAddrBuffer);
+      int bytes = recvfrom(s, (char *)buffer, (int)bufferSize, 0, (struct sockaddr *)&sender, &addrLen);
+      if (bytes < 0)
+         break;   // EAGAIN/EWOULDBLOCK or socket error
+      if (bytes == 0)
+         continue;
+
+      SNMP_PDU *response = new SNMP_PDU;
+      if (!response->parse(buffer, bytes, NULL, false) || (response->getCommand() != SNMP_RESPONSE))
+      {
+         delete response;
+         continue;
+      }
+
+      MutexLock(m_mutex);
+      SNMP_AsyncRequest *rq = m_requests->get(response->getRequestId());
+      // Only sender address is checked because some devices respond from different port
+      if ((rq != NULL) && rq->peer.equals(InetAddress::createFromSockaddr((struct sockaddr *)&sender)))
+      {
+         m_responseCount++;
+         finish(rq, SNMP_ERR_SUCCESS, response, completed);
+      }
+      else
+      {
+         m_unmatchedCount++;
+         delete response;
+      }
+      MutexUnlock(m_mutex);
+   }
+}
+
+/**
+ * Process expired timers - retransmit requests or complete them with timeout error
+ */
+void SNMP_AsyncEngine::checkTimeouts(SNMP_AsyncRequest **completed)
+{
+   INT64 now = GetCurrentTimeMs();
+   MutexLock(m_mutex);
+   while((m_timerCount > 0) && (m_timers[0].deadline <= now))
+   {
+      SNMP_AsyncTimer t = m_timers[0];
+
+      // Remove top element from heap
+      SNMP_AsyncTimer last = m_timers[--m_timerCount];
+      int i = 0;
+      while(true)
+      {
+         int child = i * 2 + 1;
+         if (child >= m_timerCount)
+            break;
+         if ((child + 1 < m_timerCount) && (m_timers[child + 1].deadline < m_timers[child].deadline))
+            child++;
+         if (last.deadline <= m_timers[child].deadline)
+            break;
+         m_timers[i] = m_timers[child];
+         i = child;
+      }
+      if (m_timerCount > 0)
+         m_timers[i] = last;
+
+      SNMP_AsyncRequest *rq = m_requests->get(t.requestId);
+      if ((rq == NULL) || (rq->generation != t.generation))
+         continue;   // request already completed or retransmitted
+
+      if (rq->retries > 0)
+      {
+         rq->retries--;
+         m_retransmissionCount++;
+         transmit(rq);
+      }
+      else
+      {
+         m_timeoutCount++;
+         finish(rq, SNMP_ERR_TIMEOUT, NULL, completed);
+      }
+   }
+   MutexUnlock(m_mutex);
+}
+
+/**
+ * Get timeout for socket poll
+ */
+UINT32 SNMP_AsyncEngine::getPollTimeout()
+{
+   UINT32 timeout = MAX_POLL_TIMEOUT;
+   MutexLock(m_mutex);
+   if (m_timerCount > 0)
+   {
+      INT64 remaining = m_timers[0].deadline - GetCurrentTimeMs();
+      if (remaining < (INT64)timeout)
+         timeout = (remaining > 0) ? (UINT32)remaining : 0;
+   }
+   MutexUnlock(m_mutex);
+   return timeout;
+}
+
+/**
+ * I/O thread
+ */
+void SNMP_AsyncEngine::ioThread()
+{
+   BYTE *buffer = (BYTE *)malloc(RECEIVE_BUFFER_SIZE);
+   SocketPoller sp;
+   while(!m_shutdown)
+   {
+      sp.reset();
+      if (m_socketV4 != INVALID_SOCKET)
+         sp.add(m_socketV4);
+      if (m_socketV6 != INVALID_SOCKET)
+         sp.add(m_socketV6);
+
+      SNMP_AsyncRequest *completed = NULL;
+      if (sp.poll(getPollTimeout()) > 0)
+      {
+         if ((m_socketV4 != INVALID_SOCKET) && sp.isSet(m_socketV4))
+            receive(m_socketV4, buffer, RECEIVE_BUFFER_SIZE, &completed);
+         if ((m_socketV6 != INVALID_SOCKET) && sp.isSet(m_socketV6))
+            receive(m_socketV6, buffer, RECEIVE_BUFFER_SIZE, &completed);
+      }
+      checkTimeouts(&completed);
+
+      while(completed != NULL)
+      {
+         SNMP_AsyncRequest *rq = completed;
+         completed = rq->next;
+         rq->callback(rq->rc, rq->response, rq->context);
+         delete rq->response;
+         delete rq;
+      }
+   }
+   free(buffer);
+}
+
+/**
+ * I/O thread starter
+ */
+THREAD_RESULT THREAD_CALL SNMP_AsyncEngine::ioThreadStarter(void *arg)
+{
+   ((SNMP_AsyncEngine *)arg)->ioThread();
+   return THREAD_OK;
+}
+
+/**
+ * Send request. Engine takes ownership of request PDU. Security context is
+ * only used for request encoding and can be destroyed after call. If request
+ * cannot be sent (error code other than SNMP_ERR_SUCCESS returned) callback
+ * will not be called. If timeout is 0 default timeout is used.
+ */
+UINT32 SNMP_AsyncEngine::sendRequest(SNMP_PDU *request, const InetAddress& addr, UINT16 port, SNMP_SecurityContext *securityContext,
+         SNMP_AsyncCallback callback, void *context, UINT32 timeout, int numRetries)
+{
+   if ((request->getVersion() == SNMP_VERSION_3) || !addr.isValid())
+   {
+      delete request;
+      return SNMP_ERR_PARAM;
+   }
+
+   SNMP_AsyncRequest *rq = new SNMP_AsyncRequest;
+   rq->id = request->getRequestId();
+   rq->pdu = request;
+   rq->packet = NULL;
+   rq->packetSize = request->encode(&rq->packet, securityContext);
+   if (rq->packetSize == 0)
+   {
+      delete rq;
+      return SNMP_ERR_PARAM;
+   }
+   addr.fillSockAddr(&rq->addr, port);
+   rq->peer = addr;
+   memset(&rq->key, 0, sizeof(SNMP_AsyncTargetKey));
+   rq->key.family = (INT16)addr.getFamily();
+   rq->key.port = port;
+   if (addr.getFamily() == AF_INET)
+   {
+      UINT32 a = addr.getAddressV4();
+      memcpy(rq->key.addr, &a, 4);
+   }
+   else
+   {
+      memcpy(rq->key.addr, addr.getAddressV6(), 16);
+   }
+   rq->timeout = (timeout != 0) ? timeout : SnmpGetDefaultTimeout();
+   rq->retries = max(numRetries, 1) - 1;
+   rq->generation = 0;
+   rq->callback = callback;
+   rq->context = context;
+   rq->rc = SNMP_ERR_SUCCESS;
+   rq->response = NULL;
+   rq->next = NULL;
+
+   // Running flag is checked under same lock as used by stop() so request
+   // cannot be registered after pending requests were completed
+   MutexLock(m_mutex);
+   if (!m_running || m_requests->contains(rq->id))
+   {
+      MutexUnlock(m_mutex);
+      delete rq;
+      return SNMP_ERR_PARAM;
+   }
+   if (((addr.getFamily() == AF_INET) ? m_socketV4 : m_socketV6) == INVALID_SOCKET)
+   {
+      MutexUnlock(m_mutex);
+      delete rq;
+      return SNMP_ERR_SOCKET;
+   }
+
+   m_requestCount++;
+   SNMP_AsyncTarget *target = m_targets->get(rq->key);
+   if (target == NULL)
+   {
+      target = new SNMP_AsyncTarget;
+      target->inFlight = 0;
+      target->waitingHead = NULL;
+      target->waitingTail = NULL;
+      m_targets->set(rq->key, target);
+   }
+
+   if (target->inFlight < m_maxInFlight)
+   {
+      target->inFlight++;
+      m_requests->set(rq->id, rq);
+      transmit(rq);
+   }
+   else
+   {
+      if (target->waitingTail != NULL)
+         target->waitingTail->next = rq;
+      else
+         target->waitingHead = rq;
+      target->waitingTail = rq;
+      m_waiting++;
+   }
+   MutexUnlock(m_mutex);
+   return SNMP_ERR_SUCCESS;
+}
+
+/**
+ * Context for synchronous request. Context is referenced by waiting caller and
+ * by request callback, and destroyed by whichever releases it last.
+ */
+struct SyncRequestContext
+{
+   CONDITION completed;
+   UINT32 rc;
+   SNMP_PDU *response;
+   VolatileCounter refCount;
+};
+
+/**
+ * Release synchronous request context
+ */
+static void ReleaseSyncRequestContext(SyncRequestContext *ctx)
+{
+   if (InterlockedDecrement(&ctx->refCount) == 0)
+   {
+      ConditionDestroy(ctx->completed);
+      delete ctx->response;
+      delete ctx;
+   }
+}
+
+/**
+ * Callback for synchronous request
+ */
+static void SyncRequestCallback(UINT32 rc, SNMP_PDU *response, void *context)
+{
+   SyncRequestContext *ctx = (SyncRequestContext *)context;
+   ctx->rc = rc;
+   if (response != NULL)
+   {
+      ctx->response = new SNMP_PDU(response);
+   }
+   ConditionSet(ctx->completed);
+   ReleaseSyncRequestContext(ctx);
+}
+
+/**
+ * Send request and wait for response. Engine takes ownership of request PDU.
+ * Response PDU should be destroyed by caller. Wait time is limited to timeout
+ * multiplied by number of attempts plus one more timeout interval for time
+ * spent in target's waiting queue; SNMP_ERR_TIMEOUT is returned if request
+ * is not completed within that time.
+ */
+UINT32 SNMP_AsyncEngine::doRequest(SNMP_PDU *request, const InetAddress& addr, UINT16 port, SNMP_SecurityContext *securityContext,
+         SNMP_PDU **response, UINT32 timeout, int numRetries)
+{
+   SyncRequestContext *ctx = new SyncRequestContext;
+   ctx->completed = ConditionCreate(true);
+   ctx->rc = SNMP_ERR_COMM;
+   ctx->response = NULL;
+   ctx->refCount = 2;
+
+   UINT32 rc = sendRequest(request, addr, port, securityContext, SyncRequestCallback, ctx, timeout, numRetries);
+   if (rc == SNMP_ERR_SUCCESS)
+   {
+      UINT32 waitTime = ((timeout != 0) ? timeout : SnmpGetDefaultTimeout()) * (max(numRetries, 1) + 1);
+      if (ConditionWait(ctx->completed, waitTime))
+      {
+         rc = ctx->rc;
+         *response = ctx->response;
+         ctx->response = NULL;
+      }
+      else
+      {
+         rc = SNMP_ERR_TIMEOUT;
+      }
+   }
+   else
+   {
+      ReleaseSyncRequestContext(ctx);  // callback will not be called
+   }
+   ReleaseSyncRequestContext(ctx);
+   return rc;
+}
+
+/**
+ * Get engine statistics
+ */
+void SNMP_AsyncEngine::getStats(SNMP_AsyncEngineStats *stats)
+{
+   MutexLock(m_mutex);
+   stats->requests = m_requestCount;
+   stats->responses = m_responseCount;
+   stats->timeouts = m_timeoutCount;
+   stats->retransmissions = m_retransmissionCount;
+   stats->unmatchedResponses = m_unmatchedCount;
+   stats->inFlight = m_requests->size();
+   stats->waiting = m_waiting;
+   stats->targets = m_targets->size();
+   MutexUnlock(m_mutex);
+}
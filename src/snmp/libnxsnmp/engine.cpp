@@ -33,6 +33,7 @@ SNMP_Engine::SNMP_Engine()
 	m_idLen = 0;
 	m_engineBoots = 0;
 	m_engineTime = 0;
+	m_timeUpdated = 0;
 }
 
 SNMP_Engine::SNMP_Engine(BYTE *id, size_t idLen, int engineBoots, int engineTime)
@@ -41,6 +42,7 @@ SNMP_Engine::SNMP_Engine(BYTE *id, size_t idLen, int engineBoots, int engineTime
 	memcpy(m_id, id, m_idLen);
 	m_engineBoots = engineBoots;
 	m_engineTime = engineTime;
+	m_timeUpdated = time(NULL);
 }
 
 SNMP_Engine::SNMP_Engine(const SNMP_Engine *src)
@@ -49,6 +51,7 @@ SNMP_Engine::SNMP_Engine(const SNMP_Engine *src)
 	memcpy(m_id, src->m_id, m_idLen);
 	m_engineBoots = src->m_engineBoots;
 	m_engineTime = src->m_engineTime;
+	m_timeUpdated = src->m_timeUpdated;
 }
 
 /**
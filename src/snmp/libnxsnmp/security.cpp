@@ -23,6 +23,112 @@
 
 #include "libnxsnmp.h"
 
+/**
+ * Maximum engine ID length for cached keys (RFC 3411 limits engine ID to 32 octets)
+ */
+#define MAX_CACHED_ENGINEID_LEN  32
+
+/**
+ * Maximum number of entries in localized key cache
+ */
+#define MAX_KEY_CACHE_SIZE       16384
+
+/**
+ * Localized key cache entry identifier
+ */
+struct LocalizedKeyId
+{
+   BYTE passwordHash[SHA1_DIGEST_SIZE];
+   BYTE engineId[MAX_CACHED_ENGINEID_LEN];
+   INT16 engineIdLen;
+   INT16 method;
+};
+
+/**
+ * Localized key
+ */
+struct LocalizedKey
+{
+   BYTE key[SHA1_DIGEST_SIZE];
+};
+
+/**
+ * Process-wide cache of localized keys
+ */
+static HashMap<LocalizedKeyId, LocalizedKey> s_keyCache(true);
+static Mutex s_keyCacheLock;
+static UINT64 s_keyCacheHits = 0;
+static UINT64 s_keyCacheMisses = 0;
+
+/**
+ * Calculate localized key for given password and engine (RFC 3414 section A.2).
+ * Method should be SNMP_AUTH_MD5 or SNMP_AUTH_SHA1. Results are cached because
+ * password to key conversion requires hashing of 1 MB of data.
+ */
+static void LocalizeKey(const char *password, int method, const SNMP_Engine& engine, BYTE *key)
+{
+   size_t keyLen = (method == SNMP_AUTH_MD5) ? MD5_DIGEST_SIZE : SHA1_DIGEST_SIZE;
+   bool cacheable = (engine.getIdLen() <= MAX_CACHED_ENGINEID_LEN);
+
+   LocalizedKeyId id;
+   if (cacheable)
+   {
+      memset(&id, 0, sizeof(id));
+      CalculateSHA1Hash((BYTE *)password, strlen(password), id.passwordHash);
+      memcpy(id.engineId, engine.getId(), engine.getIdLen());
+      id.engineIdLen = (INT16)engine.getIdLen();
+      id.method = (INT16)method;
+
+      s_keyCacheLock.lock();
+      LocalizedKey *k = s_keyCache.get(id);
+      if (k != NULL)
+      {
+         memcpy(key, k->key, keyLen);
+         s_keyCacheHits++;
+         s_keyCacheLock.unlock();
+         return;
+      }
+      s_keyCacheMisses++;
+      s_keyCacheLock.unlock();
+   }
+
+   BYTE buffer[SHA1_DIGEST_SIZE * 2 + SNMP_MAX_ENGINEID_LEN];
+   if (method == SNMP_AUTH_MD5)
+      MD5HashForPattern((const BYTE *)password, strlen(password), 1048576, buffer);
+   else
+      SHA1HashForPattern((BYTE *)password, strlen(password), 1048576, buffer);
+   memcpy(&buffer[keyLen], engine.getId(), engine.getIdLen());
+   memcpy(&buffer[keyLen + engine.getIdLen()], buffer, keyLen);
+   if (method == SNMP_AUTH_MD5)
+      CalculateMD5Hash(buffer, engine.getIdLen() + keyLen * 2, key);
+   else
+      CalculateSHA1Hash(buffer, engine.getIdLen() + keyLen * 2, key);
+
+   if (cacheable)
+   {
+      LocalizedKey *k = new LocalizedKey;
+      memset(k, 0, sizeof(LocalizedKey));
+      memcpy(k->key, key, keyLen);
+      s_keyCacheLock.lock();
+      if (s_keyCache.size() >= MAX_KEY_CACHE_SIZE)
+         s_keyCache.clear();
+      s_keyCache.set(id, k);
+      s_keyCacheLock.unlock();
+   }
+}
+
+/**
+ * Get localized key cache counters
+ */
+void LIBNXSNMP_EXPORTABLE SnmpGetKeyCacheCounters(UINT64 *hits, UINT64 *misses, int *size)
+{
+   s_keyCacheLock.lock();
+   *hits = s_keyCacheHits;
+   *misses = s_keyCacheMisses;
+   *size = s_keyCache.size();
+   s_keyCacheLock.unlock();
+}
+
 /**
  * Default constructor for SNMP_SecurityContext
  */
@@ -38,6 +144,7 @@ SNMP_SecurityContext::SNMP_SecurityContext()
 	memset(m_authKeyMD5, 0, 16);
 	memset(m_authKeySHA1, 0, 20);
 	memset(m_privKey, 0, 20);
+	m_validKeys = true;
 }
 
 /**
@@ -55,6 +162,7 @@ SNMP_SecurityContext::SNMP_SecurityContext(SNMP_SecurityContext *src)
 	memcpy(m_authKeyMD5, src->m_authKeyMD5, 16);
 	memcpy(m_authKeySHA1, src->m_authKeySHA1, 20);
 	memcpy(m_privKey, src->m_privKey, 20);
+	m_validKeys = src->m_validKeys;
 	m_authoritativeEngine = src->m_authoritativeEngine;
 }
 
@@ -73,6 +181,7 @@ SNMP_SecurityContext::SNMP_SecurityContext(const char *community)
 	memset(m_authKeyMD5, 0, 16);
 	memset(m_authKeySHA1, 0, 20);
 	memset(m_privKey, 0, 20);
+	m_validKeys = true;
 }
 
 /**
@@ -87,7 +196,7 @@ SNMP_SecurityContext::SNMP_SecurityContext(const char *user, const char *authPas
 	m_contextName = NULL;
 	m_authMethod = authMethod;
 	m_privMethod = SNMP_ENCRYPT_NONE;
-	recalculateKeys();
+	m_validKeys = false;
 }
 
 /**
@@ -103,7 +212,7 @@ SNMP_SecurityContext::SNMP_SecurityContext(const char *user, const char *authPas
 	m_contextName = NULL;
 	m_authMethod = authMethod;
 	m_privMethod = encryptionMethod;
-	recalculateKeys();
+	m_validKeys = false;
 }
 
 /**
@@ -166,7 +275,7 @@ void SNMP_SecurityContext::setAuthPassword(const char *password)
 {
 	safe_free(m_authPassword);
 	m_authPassword = strdup(CHECK_NULL_EX_A(password));
-	recalculateKeys();
+	m_validKeys = false;
 }
 
 /**
@@ -176,52 +285,45 @@ void SNMP_SecurityContext::setPrivPassword(const char *password)
 {
 	safe_free(m_privPassword);
 	m_privPassword = strdup(CHECK_NULL_EX_A(password));
-	recalculateKeys();
+	m_validKeys = false;
 }
 
 /**
- * Set authoritative engine ID
+ * Set authoritative engine ID. Keys are recalculated only if engine ID is changed
+ * (engine boots and time do not affect localized keys).
  */
 void SNMP_SecurityContext::setAuthoritativeEngine(const SNMP_Engine &engine)
 {
+	if ((engine.getIdLen() != m_authoritativeEngine.getIdLen()) ||
+	    memcmp(engine.getId(), m_authoritativeEngine.getId(), engine.getIdLen()))
+		m_validKeys = false;
 	m_authoritativeEngine = engine;
-	recalculateKeys();
 }
 
 /**
- * Recalculate keys
+ * Calculate keys for configured authentication and encryption methods if needed
  */
-void SNMP_SecurityContext::recalculateKeys()
+void SNMP_SecurityContext::validateKeys()
 {
-	BYTE buffer[256];
-	const char *authPassword = (m_authPassword != NULL) ? m_authPassword : "";
-	const char *privPassword = (m_privPassword != NULL) ? m_privPassword : "";
+	if (m_validKeys)
+		return;
 
-	// MD5 auth key
-	MD5HashForPattern((const BYTE *)authPassword, strlen(authPassword), 1048576, buffer);
-	memcpy(&buffer[16], m_authoritativeEngine.getId(), m_authoritativeEngine.getIdLen());
-	memcpy(&buffer[16 + m_authoritativeEngine.getIdLen()], buffer, 16);
-	CalculateMD5Hash(buffer, m_authoritativeEngine.getIdLen() + 32, m_authKeyMD5);
-
-	// SHA1 auth key
-	SHA1HashForPattern((BYTE *)authPassword, strlen(authPassword), 1048576, buffer);
-	memcpy(&buffer[20], m_authoritativeEngine.getId(), m_authoritativeEngine.getIdLen());
-	memcpy(&buffer[20 + m_authoritativeEngine.getIdLen()], buffer, 20);
-	CalculateSHA1Hash(buffer, m_authoritativeEngine.getIdLen() + 40, m_authKeySHA1);
+	memset(m_authKeyMD5, 0, 16);
+	memset(m_authKeySHA1, 0, 20);
+	memset(m_privKey, 0, 20);
 
-	// Priv key
+	const char *authPassword = (m_authPassword != NULL) ? m_authPassword : "";
 	if (m_authMethod == SNMP_AUTH_MD5)
+		LocalizeKey(authPassword, SNMP_AUTH_MD5, m_authoritativeEngine, m_authKeyMD5);
+	else if (m_authMethod == SNMP_AUTH_SHA1)
+		LocalizeKey(authPassword, SNMP_AUTH_SHA1, m_authoritativeEngine, m_authKeySHA1);
+
+	// Privacy key is localized using hash function of authentication protocol
+	if (m_privMethod != SNMP_ENCRYPT_NONE)
 	{
-		MD5HashForPattern((const BYTE *)privPassword, strlen(privPassword), 1048576, buffer);
-		memcpy(&buffer[16], m_authoritativeEngine.getId(), m_authoritativeEngine.getIdLen());
-		memcpy(&buffer[16 + m_authoritativeEngine.getIdLen()], buffer, 16);
-		CalculateMD5Hash(buffer, m_authoritativeEngine.getIdLen() + 32, m_privKey);
-	}
-	else
-	{
-		SHA1HashForPattern((BYTE *)privPassword, strlen(privPassword), 1048576, buffer);
-		memcpy(&buffer[20], m_authoritativeEngine.getId(), m_authoritativeEngine.getIdLen());
-		memcpy(&buffer[20 + m_authoritativeEngine.getIdLen()], buffer, 20);
-		CalculateSHA1Hash(buffer, m_authoritativeEngine.getIdLen() + 40, m_privKey);
+		const char *privPassword = (m_privPassword != NULL) ? m_privPassword : "";
+		LocalizeKey(privPassword, (m_authMethod == SNMP_AUTH_MD5) ? SNMP_AUTH_MD5 : SNMP_AUTH_SHA1, m_authoritativeEngine, m_privKey);
 	}
+
+	m_validKeys = true;
 }
@@ -44,6 +44,56 @@ static struct
 	{ { 0 }, 0, 0 }
 };
 
+/**
+ * Key for SNMPv3 engine cache
+ */
+struct PeerEngineKey
+{
+   BYTE addr[16];
+   UINT16 port;
+   INT16 family;
+};
+
+/**
+ * Cached engine data for SNMPv3 agent
+ */
+struct PeerEngineData
+{
+   SNMP_Engine authoritativeEngine;
+   SNMP_Engine contextEngine;
+};
+
+/**
+ * Process-wide cache of SNMPv3 engine data (engine ID, boots, and time) for known agents.
+ * Allows new transports to skip engine discovery and time synchronization.
+ */
+static HashMap<PeerEngineKey, PeerEngineData> s_engineCache(true);
+static Mutex s_engineCacheLock;
+
+/**
+ * Build engine cache key for transport's peer. Returns false if peer address is unknown.
+ */
+static bool GetPeerEngineKey(SNMP_Transport *transport, PeerEngineKey *key)
+{
+   InetAddress addr = transport->getPeerIpAddress();
+   if (!addr.isValid())
+      return false;
+
+   memset(key, 0, sizeof(PeerEngineKey));
+   key->family = (INT16)addr.getFamily();
+   key->port = transport->getPort();
+   if (addr.getFamily() == AF_INET)
+   {
+      UINT32 a = addr.getAddressV4();
+      memcpy(key->addr, &a, 4);
+   }
+   else
+   {
+      memcpy(key->addr, addr.getAddressV6(), 16);
+   }
+   return true;
+}
+
 /**
  * Create new SNMP transport.
  */
@@ -99,6 +149,30 @@ UINT32 SNMP_Transport::doRequest(SNMP_PDU *request, SNMP_PDU **response, UINT32
 	if (m_securityContext == NULL)
 		m_securityContext = new SNMP_SecurityContext();
 
+	// Use engine data cached by previous transports for same agent
+	PeerEngineKey peerKey;
+	bool usePeerCache = (request->getVersion() == SNMP_VERSION_3) && GetPeerEngineKey(this, &peerKey);
+	if (usePeerCache && ((m_authoritativeEngine == NULL) || (m_contextEngine == NULL)))
+	{
+	   s_engineCacheLock.lock();
+	   PeerEngineData *data = s_engineCache.get(peerKey);
+	   if (data != NULL)
+	   {
+	      if (m_authoritativeEngine == NULL)
+	      {
+	         m_authoritativeEngine = new SNMP_Engine(&data->authoritativeEngine);
+	         m_securityContext->setAuthoritativeEngine(*m_authoritativeEngine);
+	      }
+	      if ((m_contextEngine == NULL) && (data->contextEngine.getIdLen() > 0) &&
+	          (m_authoritativeEngine->getIdLen() == data->authoritativeEngine.getIdLen()) &&
+	          !memcmp(m_authoritativeEngine->getId(), data->authoritativeEngine.getId(), m_authoritativeEngine->getIdLen()))
+	      {
+	         m_contextEngine = new SNMP_Engine(&data->contextEngine);
+	      }
+	   }
+	   s_engineCacheLock.unlock();
+	}
+
 	// Update SNMP V3 request with cached context engine id
 	if (request->getVersion() == SNMP_VERSION_3)
 	{
@@ -116,6 +190,12 @@ UINT32 SNMP_Transport::doRequest(SNMP_PDU *request, SNMP_PDU **response, UINT32
 
 retry:
 		rc = SNMP_ERR_SUCCESS;
+		if ((request->getVersion() == SNMP_VERSION_3) && (m_authoritativeEngine != NULL) && (m_authoritativeEngine->getTime() != 0))
+		{
+		   // Advance engine time by time elapsed since it was received so request will fit into agent's time window
+		   m_authoritativeEngine->setTime(m_authoritativeEngine->getAdjustedTime());
+		   m_securityContext->setAuthoritativeEngine(*m_authoritativeEngine);
+		}
       if (sendMessage(request) <= 0)
       {
          rc = SNMP_ERR_COMM;
@@ -247,6 +327,32 @@ retry_wait:
       }
    }
 
+	// Update engine cache
+	if (usePeerCache)
+	{
+	   if ((rc == SNMP_ERR_SUCCESS) && (m_authoritativeEngine != NULL))
+	   {
+	      s_engineCacheLock.lock();
+	      PeerEngineData *data = s_engineCache.get(peerKey);
+	      if (data == NULL)
+	      {
+	         data = new PeerEngineData;
+	         s_engineCache.set(peerKey, data);
+	      }
+	      data->authoritativeEngine = *m_authoritativeEngine;
+	      if (m_contextEngine != NULL)
+	         data->contextEngine = *m_contextEngine;
+	      s_engineCacheLock.unlock();
+	   }
+	   else if (rc == SNMP_ERR_ENGINE_ID)
+	   {
+	      // Agent's engine ID has changed, discovery should be done again
+	      s_engineCacheLock.lock();
+	      s_engineCache.remove(peerKey);
+	      s_engineCacheLock.unlock();
+	   }
+	}
+
 	if (rc != SNMP_ERR_SUCCESS)
 		delete_and_null(*response);
    return rc;
@@ -1,6 +1,6 @@
 /* 
 ** NetXMS - Network Management System
-** Copyright (C) 2003-2016 Victor Kirhenshtein
+** Copyright (C) 2003-2017 Victor Kirhenshtein
 **
 ** This program is free software; you can redistribute it and/or modify
 ** it under the terms of the GNU General Public License as published by
@@ -73,6 +73,58 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpGetDefaultTimeout()
    return s_snmpTimeout;
 }
 
+/**
+ * Default max-repetitions value for GETBULK requests used by SnmpWalk (0 to disable GETBULK)
+ */
+static UINT32 s_maxRepetitions = 20;
+
+/**
+ * Set default max-repetitions value for GETBULK requests (0 to use GETNEXT only)
+ */
+void LIBNXSNMP_EXPORTABLE SnmpSetDefaultMaxRepetitions(UINT32 maxRepetitions)
+{
+   s_maxRepetitions = maxRepetitions;
+}
+
+/**
+ * Get default max-repetitions value for GETBULK requests
+ */
+UINT32 LIBNXSNMP_EXPORTABLE SnmpGetDefaultMaxRepetitions()
+{
+   return s_maxRepetitions;
+}
+
+/**
+ * Walk counters. Each walk counts its own requests and varbinds and adds them
+ * to global counters once when completed, so lock is taken once per walk.
+ */
+static LIBNXSNMP_WALK_COUNTERS s_walkCounters;
+static Mutex s_walkCountersLock;
+
+/**
+ * Add counters of completed walk to global walk counters
+ */
+static void UpdateWalkCounters(const LIBNXSNMP_WALK_COUNTERS *walk)
+{
+   s_walkCountersLock.lock();
+   s_walkCounters.walks += walk->walks;
+   s_walkCounters.requests += walk->requests;
+   s_walkCounters.bulkRequests += walk->bulkRequests;
+   s_walkCounters.varbinds += walk->varbinds;
+   s_walkCounters.bulkFallbacks += walk->bulkFallbacks;
+   s_walkCountersLock.unlock();
+}
+
+/**
+ * Get walk counters
+ */
+void LIBNXSNMP_EXPORTABLE SnmpGetWalkCounters(LIBNXSNMP_WALK_COUNTERS *counters)
+{
+   s_walkCountersLock.lock();
+   memcpy(counters, &s_walkCounters, sizeof(LIBNXSNMP_WALK_COUNTERS));
+   s_walkCountersLock.unlock();
+}
+
 /**
  * Get value for SNMP variable
  * If szOidStr is not NULL, string representation of OID is used, otherwise -
@@ -254,7 +306,11 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const TCHAR *roo
 }
 
 /**
- * Enumerate multiple values by walking through MIB, starting at given root
+ * Enumerate multiple values by walking through MIB, starting at given root.
+ * For SNMP version 2c and 3 GETBULK requests are used (unless disabled by
+ * setting default max-repetitions to 0); walk falls back to GETNEXT requests
+ * if agent responds to GETBULK request with error or empty response. Timeout
+ * is reported to caller as for any other request.
  */
 UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const UINT32 *rootOid, size_t rootOidLen,
                                      UINT32 (* handler)(SNMP_Variable *, SNMP_Transport *, void *),
@@ -263,6 +319,11 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const UINT32 *ro
 	if (transport == NULL)
 		return SNMP_ERR_COMM;
 
+   LIBNXSNMP_WALK_COUNTERS counters;
+   memset(&counters, 0, sizeof(LIBNXSNMP_WALK_COUNTERS));
+   counters.walks = 1;
+   UINT32 maxRepetitions = (transport->getSnmpVersion() != SNMP_VERSION_1) ? s_maxRepetitions : 0;
+
 	// First OID to request
    UINT32 pdwName[MAX_OID_LEN];
    memcpy(pdwName, rootOid, rootOidLen * sizeof(UINT32));
@@ -270,27 +331,65 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const UINT32 *ro
 
    // Walk the MIB
    UINT32 dwResult;
-   BOOL bRunning = TRUE;
+   bool running = true;
    UINT32 firstObjectName[MAX_OID_LEN];
    size_t firstObjectNameLen = 0;
-   while(bRunning)
+   while(running)
    {
-      SNMP_PDU *pRqPDU = new SNMP_PDU(SNMP_GET_NEXT_REQUEST, (UINT32)InterlockedIncrement(&s_requestId) & 0x7FFFFFFF, transport->getSnmpVersion());
+      SNMP_PDU *pRqPDU;
+      if (maxRepetitions > 0)
+      {
+         pRqPDU = new SNMP_PDU(SNMP_GET_BULK_REQUEST, (UINT32)InterlockedIncrement(&s_requestId) & 0x7FFFFFFF, transport->getSnmpVersion());
+         pRqPDU->setNonRepeaters(0);
+         pRqPDU->setMaxRepetitions(maxRepetitions);
+         counters.bulkRequests++;
+      }
+      else
+      {
+         pRqPDU = new SNMP_PDU(SNMP_GET_NEXT_REQUEST, (UINT32)InterlockedIncrement(&s_requestId) & 0x7FFFFFFF, transport->getSnmpVersion());
+      }
       pRqPDU->bindVariable(new SNMP_Variable(pdwName, nameLength));
+      counters.requests++;
 	   SNMP_PDU *pRespPDU;
       dwResult = transport->doRequest(pRqPDU, &pRespPDU, s_snmpTimeout, 3);
+      delete pRqPDU;
 
       // Analyze response
       if (dwResult == SNMP_ERR_SUCCESS)
       {
+         if ((maxRepetitions > 0) && ((pRespPDU->getErrorCode() != SNMP_PDU_ERR_SUCCESS) || (pRespPDU->getNumVariables() == 0)))
+         {
+            // Retry with smaller max-repetitions if response is too big, or with GETNEXT otherwise
+            if ((pRespPDU->getErrorCode() == SNMP_PDU_ERR_TOO_BIG) && (maxRepetitions > 1))
+            {
+               maxRepetitions /= 2;
+            }
+            else
+            {
+               maxRepetitions = 0;
+               counters.bulkFallbacks++;
+            }
+            delete pRespPDU;
+            continue;
+         }
+
          if ((pRespPDU->getNumVariables() > 0) &&
              (pRespPDU->getErrorCode() == SNMP_PDU_ERR_SUCCESS))
          {
-            SNMP_Variable *pVar = pRespPDU->getVariable(0);
-
-            if ((pVar->getType() != ASN_NO_SUCH_OBJECT) &&
-                (pVar->getType() != ASN_NO_SUCH_INSTANCE))
+            for(int i = 0; (i < pRespPDU->getNumVariables()) && running; i++)
             {
+               SNMP_Variable *pVar = pRespPDU->getVariable(i);
+               counters.varbinds++;
+
+               if ((pVar->getType() == ASN_NO_SUCH_OBJECT) ||
+                   (pVar->getType() == ASN_NO_SUCH_INSTANCE) ||
+                   (pVar->getType() == ASN_END_OF_MIBVIEW))
+               {
+                  // Consider no object/no instance as end of walk signal instead of failure
+                  running = false;
+                  break;
+               }
+
                // Should we stop walking?
 					// Some buggy SNMP agents may return first value after last one
 					// (Toshiba Strata CTX do that for example), so last check is here
@@ -299,8 +398,7 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const UINT32 *ro
 						 (pVar->getName().compare(pdwName, nameLength) == OID_EQUAL) ||
 						 (pVar->getName().compare(firstObjectName, firstObjectNameLen) == OID_EQUAL))
                {
-                  delete pRespPDU;
-                  delete pRqPDU;
+                  running = false;
                   break;
                }
                nameLength = pVar->getName().length();
@@ -315,21 +413,16 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const UINT32 *ro
                dwResult = handler(pVar, transport, userArg);
                if (dwResult != SNMP_ERR_SUCCESS)
                {
-                  bRunning = FALSE;
+                  running = false;
                }
             }
-            else
-            {
-               // Consider no object/no instance as end of walk signal instead of failure
-               bRunning = FALSE;
-            }
          }
          else
          {
             // Some SNMP agents sends NO_SUCH_NAME PDU error after last element in MIB
             if (pRespPDU->getErrorCode() != SNMP_PDU_ERR_NO_SUCH_NAME)
                dwResult = SNMP_ERR_AGENT;
-            bRunning = FALSE;
+            running = false;
          }
          delete pRespPDU;
       }
@@ -337,9 +430,9 @@ UINT32 LIBNXSNMP_EXPORTABLE SnmpWalk(SNMP_Transport *transport, const UINT32 *ro
       {
          if (logErrors)
             nxlog_write(s_msgGetError, EVENTLOG_ERROR_TYPE, "d", dwResult);
-         bRunning = FALSE;
+         running = false;
       }
-      delete pRqPDU;
    }
+   UpdateWalkCounters(&counters);
    return dwResult;
 }
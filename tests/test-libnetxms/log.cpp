@@ -0,0 +1,116 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <testtools.h>
+
+#define LOG_TEST_THREADS   16
+#define LOG_TEST_MESSAGES  20000
+
+static const TCHAR *s_messages[] = { _T("unused"), _T("%1") };
+
+static THREAD_RESULT THREAD_CALL LogWriterWorkerThread(void *arg)
+{
+   int id = CAST_FROM_POINTER(arg, int);
+   for(int i = 0; i < LOG_TEST_MESSAGES; i++)
+      nxlog_debug(5, _T("Thread %d message %d"), id, i);
+   return THREAD_OK;
+}
+
+void TestLogWriter()
+{
+   const TCHAR *fileName = _T("test-libnetxms.log");
+   _tremove(fileName);
+
+   TCHAR name[128];
+   _sntprintf(name, 128, _T("Log writer throughput (%d threads)"), LOG_TEST_THREADS);
+   StartTest(name);
+
+   AssertTrue(nxlog_open(fileName, NXLOG_BACKGROUND_WRITER, _T("test-libnetxms.exe"), 2, s_messages, 1));
+   nxlog_set_rotation_policy(NXLOG_ROTATION_DISABLED, 0, 0, NULL);
+   nxlog_set_debug_level(6);
+
+   INT64 start = GetCurrentTimeMs();
+   THREAD t[LOG_TEST_THREADS];
+   for(int i = 0; i < LOG_TEST_THREADS; i++)
+      t[i] = ThreadCreateEx(LogWriterWorkerThread, 0, CAST_TO_POINTER(i, void *));
+   for(int i = 0; i < LOG_TEST_THREADS; i++)
+      ThreadJoin(t[i]);
+   INT64 elapsed = GetCurrentTimeMs() - start;
+   nxlog_close();
+   nxlog_set_debug_level(0);
+
+#ifndef _WIN32
+   // Every message should be either written or counted as dropped, and
+   // messages from single thread should appear in original order
+   FILE *f = _tfopen(fileName, _T("r"));
+   AssertNotNull(f);
+   int last[LOG_TEST_THREADS];
+   for(int i = 0; i < LOG_TEST_THREADS; i++)
+      last[i] = -1;
+   UINT64 count = 0;
+   char line[256];
+   while(fgets(line, 256, f) != NULL)
+   {
+      const char *p = strstr(line, "Thread ");
+      if (p == NULL)
+         continue;
+      int id, n;
+      AssertEquals(sscanf(p, "Thread %d message %d", &id, &n), 2);
+      AssertTrue((id >= 0) && (id < LOG_TEST_THREADS));
+      AssertTrue(n > last[id]);
+      last[id] = n;
+      count++;
+   }
+   fclose(f);
+   AssertEquals(count + nxlog_get_dropped_count(), (UINT64)LOG_TEST_THREADS * LOG_TEST_MESSAGES);
+#endif
+
+   _tremove(fileName);
+   EndTest(elapsed);
+}
+
+/**
+ * Test debug tag level resolution
+ */
+void TestDebugTags()
+{
+   StartTest(_T("Debug tags"));
+
+   nxlog_set_debug_level(2);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 2);
+
+   nxlog_set_debug_level_tag(_T("snmp"), 5);
+   nxlog_set_debug_level_tag(_T("snmp.trap"), 7);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp")), 5);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 7);
+   AssertEquals(nxlog_get_debug_level_tag(_T("SNMP.Trap.Receiver")), 7);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.proxy")), 5);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmptrap")), 2);
+   AssertEquals(nxlog_get_debug_level_tag(_T("dc.collector")), 2);
+
+   StructArray<DebugTagInfo> *tags = nxlog_get_debug_tags();
+   AssertEquals(tags->size(), 2);
+   delete tags;
+
+   // Cached levels should follow configuration changes
+   nxlog_set_debug_level_tag(_T("snmp.trap"), 3);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 3);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 3);
+   AssertEquals(nxlog_get_debug_level_tag(_T("SNMP.Trap.Receiver")), 3);
+   nxlog_set_debug_level(4);
+   AssertEquals(nxlog_get_debug_level_tag(_T("dc.collector")), 4);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 3);
+   nxlog_set_debug_level(2);
+   nxlog_set_debug_level_tag(_T("snmp.trap"), 7);
+
+   nxlog_set_debug_level_tag(_T("snmp.trap"), -1);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 5);
+   nxlog_set_debug_level_tag(_T("snmp"), -1);
+   AssertEquals(nxlog_get_debug_level_tag(_T("snmp.trap")), 2);
+
+   tags = nxlog_get_debug_tags();
+   AssertEquals(tags->size(), 0);
+   delete tags;
+
+   nxlog_set_debug_level(0);
+   EndTest();
+}
@@ -21,6 +21,33 @@ static THREAD_RESULT THREAD_CALL PosterThread(void *arg)
    return THREAD_OK;
 }
 
+/**
+ * Number of concurrent waiters for message wait queue test
+ */
+#define WAITER_COUNT    32
+
+/**
+ * Waiter thread data
+ */
+struct WaiterData
+{
+   MsgWaitQueue *queue;
+   UINT32 id;
+   bool success;
+};
+
+/**
+ * Waiter thread
+ */
+static THREAD_RESULT THREAD_CALL WaiterThread(void *arg)
+{
+   WaiterData *data = (WaiterData *)arg;
+   NXCPMessage *msg = data->queue->waitForMessage(CMD_REQUEST_COMPLETED, data->id, 5000);
+   data->success = (msg != NULL) && (msg->getFieldAsUInt32(1) == data->id);
+   delete msg;
+   return THREAD_OK;
+}
+
 /**
  * Test message wait queue
  */
@@ -40,6 +67,57 @@ void TestMsgWaitQueue()
    delete queue;
 
    EndTest();
+
+   StartTest(_T("Message wait queue: message order"));
+   queue = new MsgWaitQueue;
+   for(UINT32 i = 0; i < 3; i++)
+   {
+      msg = new NXCPMessage();
+      msg->setCode(CMD_REQUEST_COMPLETED);
+      msg->setId(7);
+      msg->setField(1, i);
+      queue->put(msg);
+   }
+   for(UINT32 i = 0; i < 3; i++)
+   {
+      msg = queue->waitForMessage(CMD_REQUEST_COMPLETED, 7, 0);
+      AssertNotNull(msg);
+      AssertEquals(msg->getFieldAsUInt32(1), i);
+      delete msg;
+   }
+   AssertNull(queue->waitForMessage(CMD_REQUEST_COMPLETED, 7, 0));
+   delete queue;
+   EndTest();
+
+   StartTest(_T("Message wait queue: concurrent waiters"));
+   queue = new MsgWaitQueue;
+   WaiterData data[WAITER_COUNT];
+   THREAD threads[WAITER_COUNT];
+   for(int i = 0; i < WAITER_COUNT; i++)
+   {
+      data[i].queue = queue;
+      data[i].id = i + 1;
+      data[i].success = false;
+      threads[i] = ThreadCreateEx(WaiterThread, 0, &data[i]);
+   }
+   ThreadSleepMs(200);
+   for(int i = WAITER_COUNT; i > 0; i--)
+   {
+      msg = new NXCPMessage();
+      msg->setCode(CMD_REQUEST_COMPLETED);
+      msg->setId(i);
+      msg->setField(1, (UINT32)i);
+      queue->put(msg);
+   }
+   for(int i = 0; i < WAITER_COUNT; i++)
+   {
+      ThreadJoin(threads[i]);
+      AssertTrue(data[i].success);
+   }
+   String diag = MsgWaitQueue::getDiagInfo();
+   AssertTrue(_tcsstr(diag.getBuffer(), _T("spuriousWakeups=0")) != NULL);
+   delete queue;
+   EndTest();
 }
 
 /**
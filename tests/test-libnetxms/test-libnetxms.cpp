@@ -9,6 +9,8 @@ void TestMessageClass();
 void TestMutexWrapper();
 void TestRWLockWrapper();
 void TestConditionWrapper();
+void TestLogWriter();
+void TestDebugTags();
 
 static char mbText[] = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.";
 static WCHAR wcText[] = L"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.";
@@ -208,6 +210,95 @@ static void TestStringSet()
    delete s;
 }
 
+/**
+ * Find first matching name using sequential scan (reference implementation for name index test)
+ */
+static int FindNameSequentially(const StringList *names, const TCHAR *name)
+{
+   for(int i = 0; i < names->size(); i++)
+      if (MatchString(names->get(i), name, false))
+         return i;
+   return -1;
+}
+
+/**
+ * Test wildcard name index
+ */
+static void TestWildcardNameIndex()
+{
+   static const TCHAR *names[] = {
+      _T("Agent.Uptime"), _T("Net.Interface.BytesIn(*)"), _T("Net.Interface.*(*)"), _T("System.CPU.Usage"),
+      _T("System.CPU.Usage(*)"), _T("File.Size(*)"), _T("Net.Interface.BytesIn(*,*)"), _T("Disk.*"),
+      _T("Disk.Free(*)"), _T("Net.Interface.BytesOut(*)"), _T("Process.Count(?*)"), NULL
+   };
+   static const TCHAR *requests[] = {
+      _T("agent.uptime"), _T("Net.Interface.BytesIn(eth0)"), _T("Net.Interface.BytesOut(1)"), _T("Net.Interface.PacketsIn(eth0)"),
+      _T("System.CPU.Usage"), _T("System.CPU.Usage(2)"), _T("SYSTEM.CPU.USAGE()"), _T("Disk.Free(/)"), _T("Disk.Used"),
+      _T("Net.Interface.BytesIn(eth0,1)"), _T("Process.Count()"), _T("Process.Count(nginx)"), _T("Unknown.Parameter"),
+      _T("Agent.Uptime(1)"), _T("File.Size"), NULL
+   };
+
+   StartTest(_T("Wildcard name index - find"));
+   WildcardNameIndex index;
+   StringList list;
+   for(int i = 0; names[i] != NULL; i++)
+   {
+      AssertEquals(index.add(names[i]), i);
+      list.add(names[i]);
+   }
+   AssertEquals(index.size(), list.size());
+   for(int i = 0; requests[i] != NULL; i++)
+      AssertEquals(index.find(requests[i]), FindNameSequentially(&list, requests[i]));
+   AssertEquals(index.findExact(_T("net.interface.bytesin(*)")), 1);
+   AssertEquals(index.findExact(_T("disk.*")), 7);
+   AssertEquals(index.findExact(_T("Net.Interface.BytesIn(eth0)")), -1);
+   EndTest();
+
+   index.clear();
+   list.clear();
+   for(int i = 0; i < 3000; i++)
+   {
+      TCHAR name[64];
+      _sntprintf(name, 64, (i % 3 == 0) ? _T("Subagent%d.Parameter%d") : _T("Subagent%d.Parameter%d(*)"), i % 20, i);
+      index.add(name);
+      list.add(name);
+   }
+   index.add(_T("Subagent*.Fallback(*)"));
+   list.add(_T("Subagent*.Fallback(*)"));
+
+   StartTest(_T("Wildcard name index - sequential scan performance"));
+   INT64 start = GetCurrentTimeMs();
+   for(int i = 0; i < 1000; i++)
+   {
+      TCHAR name[64];
+      _sntprintf(name, 64, _T("Subagent%d.Parameter%d(instance)"), (i * 7) % 20, (i * 7) % 3000);
+      FindNameSequentially(&list, name);
+   }
+   EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("Wildcard name index - indexed lookup performance"));
+   start = GetCurrentTimeMs();
+   for(int i = 0; i < 1000; i++)
+   {
+      TCHAR name[64];
+      _sntprintf(name, 64, _T("Subagent%d.Parameter%d(instance)"), (i * 7) % 20, (i * 7) % 3000);
+      index.find(name);
+   }
+   EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("Wildcard name index - large index"));
+   for(int i = 0; i < 3000; i += 7)
+   {
+      TCHAR name[64];
+      _sntprintf(name, 64, _T("SUBAGENT%d.parameter%d(instance)"), i % 20, i);
+      AssertEquals(index.find(name), FindNameSequentially(&list, name));
+      _sntprintf(name, 64, _T("Subagent%d.Parameter%d"), i % 20, i);
+      AssertEquals(index.find(name), FindNameSequentially(&list, name));
+   }
+   AssertEquals(index.find(_T("Subagent1.Fallback(x)")), 3000);
+   EndTest();
+}
+
 /**
  * Test string class
  */
@@ -701,6 +792,7 @@ int main(int argc, char *argv[])
    TestStringConversion();
    TestStringMap();
    TestStringSet();
+   TestWildcardNameIndex();
    TestMessageClass();
    TestMsgWaitQueue();
    TestInetAddress();
@@ -712,6 +804,8 @@ int main(int argc, char *argv[])
    TestMutexWrapper();
    TestRWLockWrapper();
    TestConditionWrapper();
+   TestLogWriter();
+   TestDebugTags();
    TestByteSwap();
 
    MsgWaitQueue::shutdown();
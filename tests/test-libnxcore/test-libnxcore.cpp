@@ -0,0 +1,463 @@
+#include <nms_core.h>
+#include <nms_objects.h>
+#include <nddrv.h>
+#include <pdsdrv.h>
+#include <testtools.h>
+
+/**
+ * Value received by test driver
+ */
+struct ReceivedValue
+{
+   UINT32 dciId;
+   time_t timestamp;
+};
+
+/**
+ * Performance data storage driver for tests. Driver calls can be blocked
+ * to simulate slow storage.
+ */
+class TestStorageDriver : public PerfDataStorageDriver
+{
+private:
+   MUTEX m_mutex;
+   CONDITION m_callStarted;
+   CONDITION m_release;
+   StructArray<ReceivedValue> m_values;
+   bool m_blocked;
+
+public:
+   TestStorageDriver()
+   {
+      m_mutex = MutexCreate();
+      m_callStarted = ConditionCreate(false);
+      m_release = ConditionCreate(false);
+      m_blocked = false;
+   }
+
+   virtual ~TestStorageDriver()
+   {
+      MutexDestroy(m_mutex);
+      ConditionDestroy(m_callStarted);
+      ConditionDestroy(m_release);
+   }
+
+   virtual const TCHAR *getName() { return _T("TEST"); }
+
+   virtual bool saveDCItemValues(PerfDataStorageValue *values, int count)
+   {
+      MutexLock(m_mutex);
+      for(int i = 0; i < count; i++)
+      {
+         ReceivedValue v;
+         v.dciId = values[i].dci->getId();
+         v.timestamp = values[i].timestamp;
+         m_values.add(&v);
+      }
+      bool blocked = m_blocked;
+      MutexUnlock(m_mutex);
+
+      ConditionSet(m_callStarted);
+      if (blocked)
+         ConditionWait(m_release, 10000);
+      return true;
+   }
+
+   /**
+    * Block subsequent driver calls until releaseCall() is called
+    */
+   void block()
+   {
+      MutexLock(m_mutex);
+      m_blocked = true;
+      MutexUnlock(m_mutex);
+      ConditionReset(m_callStarted);
+   }
+
+   /**
+    * Release one blocked call and optionally unblock subsequent calls
+    */
+   void releaseCall(bool unblock)
+   {
+      if (unblock)
+      {
+         MutexLock(m_mutex);
+         m_blocked = false;
+         MutexUnlock(m_mutex);
+      }
+      ConditionSet(m_release);
+   }
+
+   bool waitForCall(UINT32 timeout) { return ConditionWait(m_callStarted, timeout); }
+
+   /**
+    * Wait until given number of values received
+    */
+   bool waitForValues(int count, UINT32 timeout)
+   {
+      for(UINT32 elapsed = 0; elapsed < timeout; elapsed += 50)
+      {
+         if (getValueCount() >= count)
+            return true;
+         ThreadSleepMs(50);
+      }
+      return getValueCount() >= count;
+   }
+
+   int getValueCount()
+   {
+      MutexLock(m_mutex);
+      int count = m_values.size();
+      MutexUnlock(m_mutex);
+      return count;
+   }
+
+   int countValues(UINT32 dciId)
+   {
+      int count = 0;
+      MutexLock(m_mutex);
+      for(int i = 0; i < m_values.size(); i++)
+         if (m_values.get(i)->dciId == dciId)
+            count++;
+      MutexUnlock(m_mutex);
+      return count;
+   }
+
+   /**
+    * Check that values for given DCI were received in order of their timestamps
+    */
+   bool isOrdered(UINT32 dciId)
+   {
+      bool ordered = true;
+      time_t last = 0;
+      MutexLock(m_mutex);
+      for(int i = 0; i < m_values.size(); i++)
+      {
+         ReceivedValue *v = m_values.get(i);
+         if (v->dciId != dciId)
+            continue;
+         if (v->timestamp <= last)
+         {
+            ordered = false;
+            break;
+         }
+         last = v->timestamp;
+      }
+      MutexUnlock(m_mutex);
+      return ordered;
+   }
+
+   void clear()
+   {
+      MutexLock(m_mutex);
+      m_values.clear();
+      MutexUnlock(m_mutex);
+   }
+};
+
+/**
+ * Data for DCI destruction thread
+ */
+struct DeleteDCIData
+{
+   DCItem *dci;
+   CONDITION completed;
+};
+
+/**
+ * Thread which destroys DCI
+ */
+static THREAD_RESULT THREAD_CALL DeleteDCIThread(void *arg)
+{
+   DeleteDCIData *data = (DeleteDCIData *)arg;
+   delete data->dci;
+   ConditionSet(data->completed);
+   return THREAD_OK;
+}
+
+/**
+ * Thread which destroys DCIs not bound to any node
+ */
+static THREAD_RESULT THREAD_CALL DeleteUnrelatedDCIThread(void *arg)
+{
+   for(int i = 0; i < 1000; i++)
+      delete new DCItem(10000 + i, _T("Test.Unrelated"), DS_INTERNAL, DCI_DT_INT, 60, 30, NULL);
+   return THREAD_OK;
+}
+
+/**
+ * Queue size used by tests (minimal allowed)
+ */
+#define TEST_QUEUE_SIZE    256
+
+/**
+ * Test performance data storage dispatcher
+ */
+static void TestPerfDataStorage()
+{
+   _tcscpy(g_netxmsdDataDir, _T("."));
+   _tremove(_T("./pds_TEST.spill"));
+
+   Node *node = new Node();
+   node->setId(1000);
+   g_idxObjectById.put(node->getId(), node);
+
+   DCItem *dci = new DCItem(1, _T("Test.Value"), DS_INTERNAL, DCI_DT_INT, 60, 30, node);
+   node->addDCObject(dci);
+
+   TestStorageDriver *driver = new TestStorageDriver();
+   StartTest(_T("PDS: register driver"));
+   AssertTrue(RegisterPerfDataStorageDriver(driver, TEST_QUEUE_SIZE, PDS_OVERFLOW_SPILL));
+   EndTest();
+
+   StartTest(_T("PDS: values delivered in order"));
+   time_t timestamp = 1;
+   for(int i = 0; i < 100; i++, timestamp++)
+      PerfDataStorageRequest(dci, timestamp, _T("42"));
+   AssertTrue(driver->waitForValues(100, 5000));
+   AssertEquals(driver->countValues(1), 100);
+   AssertTrue(driver->isOrdered(1));
+   EndTest();
+
+   StartTest(_T("PDS: new values queued behind spilled values"));
+   driver->clear();
+   driver->block();
+   PerfDataStorageRequest(dci, timestamp++, _T("42"));
+   AssertTrue(driver->waitForCall(5000));
+
+   // Fill queue and put some values into spill file while driver is blocked
+   for(int i = 0; i < TEST_QUEUE_SIZE + 50; i++, timestamp++)
+      PerfDataStorageRequest(dci, timestamp, _T("42"));
+
+   // Let dispatcher take queued values and block it again before spilled values are replayed
+   driver->releaseCall(false);
+   AssertTrue(driver->waitForCall(5000));
+
+   // Queue is empty now but spill file is not - new value should not bypass spilled values
+   PerfDataStorageRequest(dci, timestamp++, _T("42"));
+
+   driver->releaseCall(true);
+   AssertTrue(driver->waitForValues(TEST_QUEUE_SIZE + 52, 10000));
+   AssertEquals(driver->countValues(1), TEST_QUEUE_SIZE + 52);
+   AssertTrue(driver->isOrdered(1));
+   EndTest();
+
+   StartTest(_T("PDS: DCI destruction does not wait for driver"));
+   driver->clear();
+   DCItem *dci2 = new DCItem(2, _T("Test.Value2"), DS_INTERNAL, DCI_DT_INT, 60, 30, node);
+   driver->block();
+   PerfDataStorageRequest(dci, timestamp++, _T("42"));
+   AssertTrue(driver->waitForCall(5000));
+   for(int i = 0; i < 10; i++, timestamp++)
+      PerfDataStorageRequest(dci2, timestamp, _T("42"));
+
+   DeleteDCIData data;
+   data.dci = dci2;
+   data.completed = ConditionCreate(true);
+   THREAD thread = ThreadCreateEx(DeleteDCIThread, 0, &data);
+   bool completed = ConditionWait(data.completed, 2000);
+   driver->releaseCall(true);
+   ThreadJoin(thread);
+   ConditionDestroy(data.completed);
+   AssertTrue(completed);
+
+   PerfDataStorageRequest(dci, timestamp++, _T("42"));
+   AssertTrue(driver->waitForValues(2, 5000));
+   ThreadSleepMs(200);
+   AssertEquals(driver->countValues(1), 2);
+   AssertEquals(driver->countValues(2), 0);
+   EndTest();
+
+   StartTest(_T("PDS: spilled values kept when other DCI destroyed"));
+   driver->clear();
+   driver->block();
+   PerfDataStorageRequest(dci, timestamp++, _T("42"));
+   AssertTrue(driver->waitForCall(5000));
+   for(int i = 0; i < TEST_QUEUE_SIZE + 200; i++, timestamp++)
+      PerfDataStorageRequest(dci, timestamp, _T("42"));
+
+   thread = ThreadCreateEx(DeleteUnrelatedDCIThread, 0, NULL);
+   driver->releaseCall(true);
+   ThreadJoin(thread);
+   AssertTrue(driver->waitForValues(TEST_QUEUE_SIZE + 201, 10000));
+   AssertEquals(driver->countValues(1), TEST_QUEUE_SIZE + 201);
+   AssertTrue(driver->isOrdered(1));
+   EndTest();
+
+   ShutdownPerfDataStorageDrivers();
+   _tremove(_T("./pds_TEST.spill"));
+}
+
+/**
+ * Test MAC location index
+ */
+static void TestMacLocationIndex()
+{
+   static BYTE macAddrs[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x01,
+                              0x00, 0x11, 0x22, 0x33, 0x44, 0x02,
+                              0x00, 0x11, 0x22, 0x33, 0x44, 0x03 };
+
+   StartTest(_T("MAC location index: batch lookup"));
+   ObjectArray<WirelessStationInfo> stations(4, 4, true);
+   for(int i = 0; i < 3; i += 2)
+   {
+      WirelessStationInfo *ws = new WirelessStationInfo;
+      memset(ws, 0, sizeof(WirelessStationInfo));
+      memcpy(ws->macAddr, &macAddrs[i * MAC_ADDR_LENGTH], MAC_ADDR_LENGTH);
+      ws->rfIndex = i + 1;
+      ws->apObjectId = 100 + i;
+      stations.add(ws);
+   }
+   MacLocationIndexUpdateWirelessStations(2000, &stations);
+
+   StructArray<MacLocation> locations;
+   int offsets[4];
+   MacLocationIndexFind(macAddrs, 3, &locations, offsets);
+   AssertEquals(locations.size(), 2);
+   AssertEquals(offsets[0], 0);
+   AssertEquals(offsets[1], 1);
+   AssertEquals(offsets[2], 1);
+   AssertEquals(offsets[3], 2);
+   AssertEquals(locations.get(0)->apObjectId, 100);
+   AssertEquals(locations.get(1)->apObjectId, 102);
+
+   MacLocation buffer[4];
+   AssertEquals(MacLocationIndexFind(&macAddrs[MAC_ADDR_LENGTH * 2], buffer, 4), 1);
+   AssertEquals(buffer[0].ifIndex, 3);
+
+   MacLocationIndexRemoveNode(2000);
+   locations.clear();
+   MacLocationIndexFind(macAddrs, 3, &locations, offsets);
+   AssertEquals(locations.size(), 0);
+   AssertEquals(offsets[3], 0);
+   EndTest();
+}
+
+/**
+ * Object which is modified by "another thread" while being saved
+ */
+class TestSaveObject : public NetObj
+{
+public:
+   bool failSave;
+
+   TestSaveObject() : NetObj() { failSave = false; }
+
+   virtual BOOL saveToDatabase(DB_HANDLE hdb)
+   {
+      lockProperties();
+      setModified(MODIFY_CUSTOM_ATTRIBUTES, false);
+      m_modified = 0;
+      unlockProperties();
+      return !failSave;
+   }
+};
+
+/**
+ * Test modification flags handling during syncer save
+ */
+static void TestSaveModified()
+{
+   StartTest(_T("Object save: rolled back save keeps modification flags"));
+   TestSaveObject *object = new TestSaveObject();
+   object->failSave = true;
+   object->markAsModified(MODIFY_OTHER, false);
+   UINT32 flags;
+   AssertTrue(!object->saveModified(NULL, &flags));
+   AssertEquals(flags, MODIFY_OTHER);
+   AssertEquals(object->getModifiedFlags(), MODIFY_CUSTOM_ATTRIBUTES);
+   object->markAsModified(flags, false);
+   AssertEquals(object->getModifiedFlags(), MODIFY_OTHER | MODIFY_CUSTOM_ATTRIBUTES);
+   EndTest();
+
+   StartTest(_T("Object save: modification during save is not lost"));
+   object->failSave = false;
+   AssertTrue(object->saveModified(NULL, &flags));
+   AssertEquals(flags, MODIFY_OTHER | MODIFY_CUSTOM_ATTRIBUTES);
+   AssertEquals(object->getModifiedFlags(), MODIFY_CUSTOM_ATTRIBUTES);
+   EndTest();
+   delete object;
+}
+
+/**
+ * Node with access to child status counters
+ */
+class TestStatusNode : public Node
+{
+public:
+   int getChildCount(int status)
+   {
+      int counters[STATUS_UNKNOWN];
+      getChildStatusCounters(counters);
+      return counters[status];
+   }
+};
+
+/**
+ * Network service with directly settable status
+ */
+class TestNetworkService : public NetworkService
+{
+public:
+   void forceStatus(int status) { setStatus(status); }
+};
+
+/**
+ * Test status propagation from network service to owning node
+ */
+static void TestServiceStatusPropagation()
+{
+   StartTest(_T("Status propagation: service status change updates node"));
+   TestStatusNode *node = new TestStatusNode();
+   node->setId(1100);
+   TestNetworkService *service = new TestNetworkService();
+   service->setId(1101);
+   node->addChild(service);
+   service->addParent(node);
+
+   service->forceStatus(STATUS_CRITICAL);
+   AssertEquals(node->getChildCount(STATUS_CRITICAL), 1);
+
+   // Service without host node goes to UNKNOWN on status poll
+   service->statusPoll(NULL, 0, NULL, NULL);
+   AssertEquals(service->getStatus(), STATUS_UNKNOWN);
+   AssertEquals(node->getChildCount(STATUS_CRITICAL), 0);
+   EndTest();
+}
+
+/**
+ * Test query statistics internal table
+ */
+static void TestQueryStatisticsTable()
+{
+   StartTest(_T("Internal table: Server.DB.QueryStatistics"));
+   Node *node = new Node();
+   node->setId(1200);
+   Table *table = NULL;
+   AssertEquals(node->getInternalTable(_T("Server.DB.QueryStatistics"), &table), DCE_NOT_SUPPORTED);
+   AssertNull(table);
+
+   node->setFlag(NF_IS_LOCAL_MGMT);
+   AssertEquals(node->getInternalTable(_T("Server.DB.QueryStatistics"), &table), DCE_SUCCESS);
+   AssertNotNull(table);
+   AssertEquals(table->getNumColumns(), 13);
+   AssertEquals(table->getColumnIndex(_T("QUERY")), 0);
+   delete table;
+
+   AssertEquals(node->getInternalTable(_T("Server.DB.Unknown"), &table), DCE_NOT_SUPPORTED);
+   EndTest();
+}
+
+/**
+ * main()
+ */
+int main(int argc, char *argv[])
+{
+   InitNetXMSProcess(true);
+   TestPerfDataStorage();
+   TestMacLocationIndex();
+   TestSaveModified();
+   TestServiceStatusPropagation();
+   TestQueryStatisticsTable();
+   return 0;
+}
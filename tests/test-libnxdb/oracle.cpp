@@ -94,3 +94,106 @@ void TestOracleBatch()
    DBUnloadDriver(drv);
    EndTest();
 }
+
+/**
+ * Number of iterations for driver benchmark
+ */
+#define BENCHMARK_ITERATIONS  10000
+
+/**
+ * Benchmark prepare/bind/execute rates for given Oracle driver
+ */
+void TestOracleBenchmark(const TCHAR *driver)
+{
+   TCHAR name[256];
+   _sntprintf(name, 256, _T("Connect to Oracle (%s)"), driver);
+   StartTest(name);
+   DB_DRIVER drv = DBLoadDriver(driver, _T(""), false, NULL, NULL);
+   AssertNotNull(drv);
+   TCHAR buffer[DBDRV_MAX_ERROR_TEXT];
+   DB_HANDLE session = DBConnect(drv, ORA_SERVER, NULL, ORA_LOGIN, ORA_PASSWORD, NULL, buffer);
+   AssertNotNullEx(session, buffer);
+   if (DBIsTableExist(session, _T("nx_bench")) == DBIsTableExist_Found)
+      DBQuery(session, _T("DROP TABLE nx_bench"));
+   AssertTrueEx(DBQueryEx(session, _T("CREATE TABLE nx_bench (id integer not null,value1 varchar(63),value2 varchar(255),PRIMARY KEY(id))"), buffer), buffer);
+   EndTest();
+
+   // Prepare without statement cache to measure driver's own prepare cost
+   _sntprintf(name, 256, _T("Prepare %d statements"), BENCHMARK_ITERATIONS);
+   StartTest(name);
+   DBSetStatementCacheSize(0);
+   INT64 start = GetCurrentTimeMs();
+   for(int i = 0; i < BENCHMARK_ITERATIONS; i++)
+   {
+      DB_STATEMENT hStmt = DBPrepareEx(session, _T("INSERT INTO nx_bench (id,value1,value2) VALUES (?,?,?)"), buffer);
+      AssertNotNullEx(hStmt, buffer);
+      DBFreeStatement(hStmt);
+   }
+   EndTest(GetCurrentTimeMs() - start);
+
+   _sntprintf(name, 256, _T("Bind and execute %d rows"), BENCHMARK_ITERATIONS);
+   StartTest(name);
+   start = GetCurrentTimeMs();
+   DBBegin(session);
+   DB_STATEMENT hStmt = DBPrepareEx(session, _T("INSERT INTO nx_bench (id,value1,value2) VALUES (?,?,?)"), buffer);
+   AssertNotNullEx(hStmt, buffer);
+   for(INT32 i = 0; i < BENCHMARK_ITERATIONS; i++)
+   {
+      TCHAR text[64];
+      _sntprintf(text, 64, _T("value %d"), i);
+      DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, i);
+      DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, text, DB_BIND_STATIC);
+      DBBind(hStmt, 3, DB_SQLTYPE_VARCHAR, _T("The quick brown fox jumps over the lazy dog"), DB_BIND_STATIC);
+      AssertTrueEx(DBExecuteEx(hStmt, buffer), buffer);
+   }
+   DBFreeStatement(hStmt);
+   DBCommit(session);
+   EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("Check record count"));
+   DB_RESULT hResult = DBSelectEx(session, _T("SELECT count(*) FROM nx_bench"), buffer);
+   AssertNotNullEx(hResult, buffer);
+   AssertEquals(DBGetFieldLong(hResult, 0, 0), BENCHMARK_ITERATIONS);
+   DBFreeResult(hResult);
+   EndTest();
+
+   _sntprintf(name, 256, _T("Buffered select of %d rows"), BENCHMARK_ITERATIONS);
+   StartTest(name);
+   start = GetCurrentTimeMs();
+   hResult = DBSelectEx(session, _T("SELECT id,value1,value2 FROM nx_bench ORDER BY id"), buffer);
+   AssertNotNullEx(hResult, buffer);
+   AssertEquals(DBGetNumRows(hResult), BENCHMARK_ITERATIONS);
+   for(int i = 0; i < BENCHMARK_ITERATIONS; i++)
+   {
+      AssertEquals(DBGetFieldLong(hResult, i, 0), i);
+      TCHAR text[64], expected[64];
+      _sntprintf(expected, 64, _T("value %d"), i);
+      AssertTrue(!_tcscmp(DBGetField(hResult, i, 1, text, 64), expected));
+   }
+   DBFreeResult(hResult);
+   EndTest(GetCurrentTimeMs() - start);
+
+   _sntprintf(name, 256, _T("Unbuffered select of %d rows"), BENCHMARK_ITERATIONS);
+   StartTest(name);
+   start = GetCurrentTimeMs();
+   DB_UNBUFFERED_RESULT hUResult = DBSelectUnbufferedEx(session, _T("SELECT id,value1,value2 FROM nx_bench ORDER BY id"), buffer);
+   AssertNotNullEx(hUResult, buffer);
+   INT32 count = 0;
+   while(DBFetch(hUResult))
+   {
+      AssertEquals(DBGetFieldLong(hUResult, 0), count);
+      TCHAR text[256];
+      AssertTrue(!_tcscmp(DBGetField(hUResult, 2, text, 256), _T("The quick brown fox jumps over the lazy dog")));
+      count++;
+   }
+   DBFreeResult(hUResult);
+   AssertEquals(count, BENCHMARK_ITERATIONS);
+   EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("Disconnect from Oracle"));
+   AssertTrue(DBQuery(session, _T("DROP TABLE nx_bench")));
+   DBDisconnect(session);
+   DBUnloadDriver(drv);
+   DBSetStatementCacheSize(32);
+   EndTest();
+}
@@ -4,6 +4,40 @@
 #include <testtools.h>
 
 void TestOracleBatch();
+void TestOracleBenchmark(const TCHAR *driver);
+
+/**
+ * Check normalized form of given query
+ */
+static bool CheckNormalizedQuery(const TCHAR *query, const TCHAR *expected)
+{
+   TCHAR buffer[MAX_QUERY_FINGERPRINT_LENGTH];
+   DBNormalizeQuery(query, buffer, MAX_QUERY_FINGERPRINT_LENGTH);
+   return !_tcscmp(buffer, expected);
+}
+
+/**
+ * Test query normalization used for query statistics
+ */
+static void TestQueryNormalization()
+{
+   StartTest(_T("Query normalization"));
+   AssertTrue(CheckNormalizedQuery(_T("SELECT * FROM t WHERE a=-5"), _T("SELECT * FROM t WHERE a=?")));
+   AssertTrue(CheckNormalizedQuery(_T("SELECT * FROM t WHERE a = -5.5 AND b>-1"), _T("SELECT * FROM t WHERE a = ? AND b>?")));
+   AssertTrue(CheckNormalizedQuery(_T("UPDATE t SET a=a-1 WHERE b=c-2"), _T("UPDATE t SET a=a-? WHERE b=c-?")));
+   AssertTrue(CheckNormalizedQuery(_T("SELECT idata_value FROM idata_1234 WHERE item_id=17"), _T("SELECT idata_value FROM idata_N WHERE item_id=?")));
+   AssertTrue(CheckNormalizedQuery(_T("SELECT tdata_value FROM tdata_12 WHERE x_1y=1"), _T("SELECT tdata_value FROM tdata_N WHERE x_1y=?")));
+   AssertTrue(CheckNormalizedQuery(_T("DELETE FROM t WHERE id IN (1, 2,3,'a''b')"), _T("DELETE FROM t WHERE id IN (?)")));
+   AssertTrue(CheckNormalizedQuery(_T("INSERT INTO t (a,b) VALUES (1,'x')"), _T("INSERT INTO t (a,b) VALUES (?)")));
+   AssertTrue(CheckNormalizedQuery(_T("SELECT * FROM t WHERE flags=0x1F"), _T("SELECT * FROM t WHERE flags=?")));
+   AssertTrue(CheckNormalizedQuery(_T("SELECT * FROM t WHERE a IN (0xFF,-0x10)"), _T("SELECT * FROM t WHERE a IN (?)")));
+   AssertTrue(CheckNormalizedQuery(_T("  SELECT  a\n\tFROM   t  "), _T("SELECT a FROM t")));
+
+   TCHAR buffer[MAX_QUERY_FINGERPRINT_LENGTH];
+   AssertEquals(DBNormalizeQuery(_T("SELECT * FROM idata_1 WHERE id=1"), buffer, MAX_QUERY_FINGERPRINT_LENGTH),
+                DBNormalizeQuery(_T("SELECT * FROM idata_22 WHERE id=-333"), buffer, MAX_QUERY_FINGERPRINT_LENGTH));
+   EndTest();
+}
 
 /**
  * main()
@@ -12,6 +46,16 @@ int main(int argc, char *argv[])
 {
    DBInit(0, 0);
 
+   TestQueryNormalization();
    TestOracleBatch();
+
+   // Driver for benchmark can be given on command line (oracle.ddr or ocilib.ddr)
+#ifdef UNICODE
+   WCHAR *driver = WideStringFromMBString((argc > 1) ? argv[1] : "oracle.ddr");
+   TestOracleBenchmark(driver);
+   free(driver);
+#else
+   TestOracleBenchmark((argc > 1) ? argv[1] : "oracle.ddr");
+#endif
    return 0;
 }
@@ -0,0 +1,99 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <nxlpapi.h>
+#include <testtools.h>
+
+/**
+ * Check that line is matched by parser with single rule identically with and without prefilter
+ */
+static void CheckRule(const TCHAR *regexp, const TCHAR *line, bool expected)
+{
+   LogParser *parser = new LogParser();
+   AssertTrue(parser->addRule(regexp));
+
+   parser->setPrefilterFlag(false);
+   AssertEquals(parser->matchLine(line), expected);
+
+   parser->setPrefilterFlag(true);
+   AssertEquals(parser->matchLine(line), expected);
+
+   delete parser;
+}
+
+/**
+ * Test prefilter handling of regular expression escapes
+ */
+static void TestPrefilterEscapes()
+{
+   StartTest(_T("Prefilter: word boundary assertions"));
+   CheckRule(_T("\\<error\\>"), _T("an error occurred"), true);
+   CheckRule(_T("\\<error\\>"), _T("no terrors here"), false);
+   CheckRule(_T("\\bfailed\\b"), _T("login failed for user"), true);
+   CheckRule(_T("\\Bing\\B"), _T("singer"), true);
+   EndTest();
+
+   StartTest(_T("Prefilter: character class macros"));
+   CheckRule(_T("\\w+@\\w+\\.com"), _T("mail to user@example.com"), true);
+   CheckRule(_T("\\w+@\\w+\\.com"), _T("mail to user@example.org"), false);
+   CheckRule(_T("port \\d+ down"), _T("port 12 down"), true);
+   CheckRule(_T("link\\sdown"), _T("link down"), true);
+   EndTest();
+
+   StartTest(_T("Prefilter: escaped literal characters"));
+   CheckRule(_T("disk \\(sda\\) full"), _T("disk (sda) full"), true);
+   CheckRule(_T("disk \\(sda\\) full"), _T("disk sda full"), false);
+   CheckRule(_T("cost \\$100"), _T("total cost $100"), true);
+   EndTest();
+}
+
+/**
+ * Stop condition for file monitor test
+ */
+static CONDITION s_stopCondition = INVALID_CONDITION_HANDLE;
+
+/**
+ * File monitor thread
+ */
+static THREAD_RESULT THREAD_CALL MonitorThread(void *arg)
+{
+   ((LogParser *)arg)->monitorFile(s_stopCondition);
+   return THREAD_OK;
+}
+
+/**
+ * Test that file monitor stops without waiting for periodic checks
+ */
+static void TestFileMonitorStop()
+{
+   StartTest(_T("File monitor: stop"));
+   FILE *f = _tfopen(_T("test-libnxlp.log"), _T("w"));
+   AssertNotNull(f);
+   fclose(f);
+
+   LogParser *parser = new LogParser();
+   parser->setFileName(_T("test-libnxlp.log"));
+   AssertTrue(parser->addRule(_T("error")));
+   s_stopCondition = ConditionCreate(TRUE);
+   THREAD thread = ThreadCreateEx(MonitorThread, 0, parser);
+   ThreadSleepMs(500);
+
+   INT64 startTime = GetCurrentTimeMs();
+   LogParser::stopFileMonitoring(s_stopCondition);
+   ThreadJoin(thread);
+   AssertTrue(GetCurrentTimeMs() - startTime < 500);
+
+   ConditionDestroy(s_stopCondition);
+   delete parser;
+   _tremove(_T("test-libnxlp.log"));
+   EndTest();
+}
+
+/**
+ * main()
+ */
+int main(int argc, char *argv[])
+{
+   TestPrefilterEscapes();
+   TestFileMonitorStop();
+   return 0;
+}
@@ -0,0 +1,140 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <nxcpapi.h>
+#include <netxms_maps.h>
+#include <testtools.h>
+
+/**
+ * Test object list
+ */
+static void TestObjectList()
+{
+   StartTest(_T("nxmap_ObjList - add objects"));
+   nxmap_ObjList list;
+   list.addObject(30);
+   list.addObject(10);
+   list.addObject(20);
+   list.addObject(10);
+   AssertEquals(list.getNumObjects(), 3);
+   AssertTrue(list.isObjectExist(10));
+   AssertTrue(list.isObjectExist(20));
+   AssertFalse(list.isObjectExist(40));
+   IntegerArray<UINT32> *objects = list.getObjects();
+   AssertEquals(objects->get(0), 10);
+   AssertEquals(objects->get(1), 20);
+   AssertEquals(objects->get(2), 30);
+   EndTest();
+
+   StartTest(_T("nxmap_ObjList - link objects"));
+   list.linkObjects(10, 20);
+   list.linkObjects(20, 10);
+   list.linkObjects(20, 30, LINK_TYPE_VPN);
+   list.linkObjects(10, 40);
+   AssertEquals(list.getNumLinks(), 2);
+   AssertTrue(list.isLinkExist(10, 20));
+   AssertFalse(list.isLinkExist(20, 10));
+   AssertTrue(list.isLinkExist(20, 30));
+   AssertEquals(list.getLinks()->get(1)->type, LINK_TYPE_VPN);
+   EndTest();
+
+   StartTest(_T("nxmap_ObjList - link objects with ports"));
+   list.addObject(40);
+   list.linkObjectsEx(40, 30, _T("eth0"), _T("ge1"), 100, 200);
+   list.linkObjectsEx(30, 40, _T("ge1"), _T("eth0"), 200, 100);
+   AssertEquals(list.getNumLinks(), 3);
+   AssertEquals(list.getLinks()->get(2)->portIdCount, 1);
+   list.linkObjectsEx(30, 40, _T("ge2"), _T("eth1"), 201, 101);
+   AssertEquals(list.getNumLinks(), 3);
+   ObjLink *link = list.getLinks()->get(2);
+   AssertEquals(link->id1, 40);
+   AssertEquals(link->portIdCount, 2);
+   AssertEquals(link->portIdArray1[1], 101);
+   AssertEquals(link->portIdArray2[1], 201);
+   AssertEquals(link->type, LINK_TYPE_MULTILINK);
+   AssertTrue(!_tcscmp(link->port1, _T("eth0, eth1")));
+   AssertTrue(!_tcscmp(link->port2, _T("ge1, ge2")));
+   EndTest();
+
+   StartTest(_T("nxmap_ObjList - remove object"));
+   list.removeObject(20);
+   AssertEquals(list.getNumObjects(), 3);
+   AssertFalse(list.isObjectExist(20));
+   AssertEquals(list.getNumLinks(), 1);
+   AssertTrue(list.isLinkExist(40, 30));
+   list.linkObjects(10, 30);
+   AssertEquals(list.getNumLinks(), 2);
+   list.removeObject(30);
+   AssertEquals(list.getNumLinks(), 0);
+   AssertEquals(list.getObjects()->get(0), 10);
+   AssertEquals(list.getObjects()->get(1), 40);
+   EndTest();
+
+   StartTest(_T("nxmap_ObjList - copy and NXCP message"));
+   list.addObject(5);
+   list.addObject(50);
+   list.linkObjects(50, 5);
+   list.linkObjects(10, 40);
+   nxmap_ObjList copy(&list);
+   NXCPMessage msg;
+   copy.createMessage(&msg);
+   nxmap_ObjList restored(&msg);
+   AssertEquals(restored.getNumObjects(), 4);
+   AssertEquals(restored.getObjects()->get(0), 5);
+   AssertEquals(restored.getObjects()->get(3), 50);
+   AssertEquals(restored.getNumLinks(), 2);
+   AssertEquals(restored.getLinks()->get(0)->id1, 50);
+   AssertEquals(restored.getLinks()->get(1)->id1, 10);
+   restored.removeObject(5);
+   AssertEquals(restored.getNumLinks(), 1);
+   EndTest();
+}
+
+/**
+ * Build synthetic tree-like map with given number of objects
+ */
+static void BuildSyntheticMap(nxmap_ObjList *list, int count)
+{
+   for(int i = 0; i < count; i++)
+      list->addObject((UINT32)((i * 7919) % count) + 1);
+   for(UINT32 i = 2; i <= (UINT32)count; i++)
+   {
+      list->linkObjects(i / 2, i);
+      TCHAR port1[32], port2[32];
+      _sntprintf(port1, 32, _T("port%u"), i);
+      _sntprintf(port2, 32, _T("uplink%u"), i % 4);
+      list->linkObjectsEx(i, i / 2, port2, port1, i % 4, i);
+   }
+}
+
+/**
+ * Benchmark map generation
+ */
+static void TestMapGenerationPerformance()
+{
+   static int sizes[] = { 1000, 5000, 20000 };
+   for(int i = 0; i < 3; i++)
+   {
+      TCHAR name[64];
+      _sntprintf(name, 64, _T("nxmap_ObjList - build map with %d objects"), sizes[i]);
+      StartTest(name);
+      INT64 start = GetCurrentTimeMs();
+      nxmap_ObjList list;
+      BuildSyntheticMap(&list, sizes[i]);
+      for(UINT32 id = 1; id <= (UINT32)sizes[i]; id += 10)
+         list.removeObject(id);
+      NXCPMessage msg;
+      list.createMessage(&msg);
+      AssertEquals(list.getNumObjects(), sizes[i] - sizes[i] / 10);
+      EndTest(GetCurrentTimeMs() - start);
+   }
+}
+
+/**
+ * main()
+ */
+int main(int argc, char *argv[])
+{
+   TestObjectList();
+   TestMapGenerationPerformance();
+   return 0;
+}
@@ -0,0 +1,222 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <nxsl.h>
+#include <testtools.h>
+
+#if defined(__GLIBC__) && !defined(_WIN32)
+
+/**
+ * Heap allocation counter. glibc allows replacing malloc family functions in
+ * executable, so all heap allocations made by libraries are counted.
+ */
+static bool s_countAllocations = false;
+static UINT64 s_heapAllocations = 0;
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *p, size_t size);
+extern "C" void __libc_free(void *p);
+
+extern "C" void *malloc(size_t size)
+{
+   if (s_countAllocations)
+      s_heapAllocations++;
+   return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+   if (s_countAllocations)
+      s_heapAllocations++;
+   return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *p, size_t size)
+{
+   if (s_countAllocations)
+      s_heapAllocations++;
+   return __libc_realloc(p, size);
+}
+
+extern "C" void free(void *p)
+{
+   __libc_free(p);
+}
+
+#define HEAP_ALLOCATION_COUNTER_AVAILABLE
+
+#endif
+
+/**
+ * Numeric benchmark script
+ */
+static const TCHAR *s_numericScript =
+   _T("sum = 0;\n")
+   _T("for(i = 0; i < 1000000; i++)\n")
+   _T("{\n")
+   _T("   sum = sum + i * 2 - i % 7;\n")
+   _T("   if (sum > 1000000000)\n")
+   _T("      sum = 0;\n")
+   _T("}\n")
+   _T("return sum;\n");
+
+/**
+ * Delete value in separate thread
+ */
+static THREAD_RESULT THREAD_CALL DeleteValueThread(void *arg)
+{
+   delete static_cast<NXSL_Value*>(arg);
+   return THREAD_OK;
+}
+
+/**
+ * Test value class
+ */
+static void TestValueClass()
+{
+   StartTest(_T("NXSL_Value: short string"));
+   NXSL_Value *v = new NXSL_Value(_T("short"));
+   AssertTrue(!_tcscmp(v->getValueAsCString(), _T("short")));
+   delete v;
+   EndTest();
+
+   StartTest(_T("NXSL_Value: concatenation beyond internal buffer"));
+   v = new NXSL_Value(_T("0123456789"));
+   v->concatenate(_T("abcdefghij"), 10);
+   AssertTrue(!_tcscmp(v->getValueAsCString(), _T("0123456789abcdefghij")));
+   NXSL_Value *c = new NXSL_Value(v);
+   delete v;
+   AssertTrue(!_tcscmp(c->getValueAsCString(), _T("0123456789abcdefghij")));
+   delete c;
+   EndTest();
+
+   StartTest(_T("NXSL_Value: numeric to string conversion"));
+   v = new NXSL_Value((INT32)42);
+   AssertTrue(!_tcscmp(v->getValueAsCString(), _T("42")));
+   v->increment();
+   AssertTrue(!_tcscmp(v->getValueAsCString(), _T("43")));
+   v->concatenate(_T("0"), 1);
+   AssertTrue(v->isInteger());
+   AssertEquals(v->getValueAsInt32(), 430);
+   delete v;
+   EndTest();
+
+   StartTest(_T("NXSL_ValuePool: allocation and reuse"));
+   NXSL_ValuePool *pool = new NXSL_ValuePool(16);
+   for(int i = 0; i < 1000; i++)
+   {
+      NXSL_Value *a = new(pool) NXSL_Value((INT32)i);
+      NXSL_Value *b = new(pool) NXSL_Value(a);
+      AssertEquals(b->getValueAsInt32(), i);
+      delete a;
+      delete b;
+   }
+   AssertEquals(pool->getChunkAllocations(), 1);
+   AssertEquals(pool->getActiveBlocks(), 0);
+   EndTest();
+
+   StartTest(_T("NXSL_ValuePool: value destroyed by other thread"));
+   v = new(pool) NXSL_Value((INT32)1);
+   AssertEquals(pool->getActiveBlocks(), 1);
+   THREAD t = ThreadCreateEx(DeleteValueThread, 0, v);
+   ThreadJoin(t);
+   AssertEquals(pool->getActiveBlocks(), 0);
+
+   // Block returned by other thread should be reused
+   NXSL_Value *values[16];
+   for(int i = 0; i < 16; i++)
+      values[i] = new(pool) NXSL_Value((INT32)i);
+   AssertEquals(pool->getChunkAllocations(), 1);
+   for(int i = 0; i < 16; i++)
+      delete values[i];
+   EndTest();
+
+   StartTest(_T("NXSL_ValuePool: value outlives pool owner"));
+   v = new(pool) NXSL_Value(_T("long string value that does not fit internal buffer"));
+   pool->detach();
+   AssertTrue(!_tcscmp(v->getValueAsCString(), _T("long string value that does not fit internal buffer")));
+   delete v;
+   EndTest();
+}
+
+/**
+ * Test VM performance on numeric script
+ */
+static void TestNumericPerformance()
+{
+   TCHAR errorText[1024];
+   StartTest(_T("NXSL numeric script performance"));
+   NXSL_VM *vm = NXSLCompileAndCreateVM(s_numericScript, errorText, 1024, new NXSL_Environment());
+   AssertNotNullEx(vm, errorText);
+#ifdef HEAP_ALLOCATION_COUNTER_AVAILABLE
+   s_heapAllocations = 0;
+   s_countAllocations = true;
+#endif
+   INT64 start = GetCurrentTimeMs();
+   AssertTrue(vm->run());
+   INT64 elapsed = GetCurrentTimeMs() - start;
+#ifdef HEAP_ALLOCATION_COUNTER_AVAILABLE
+   s_countAllocations = false;
+#endif
+   INT32 sum = 0;
+   for(INT32 i = 0; i < 1000000; i++)
+   {
+      sum = sum + i * 2 - i % 7;
+      if (sum > 1000000000)
+         sum = 0;
+   }
+   AssertEquals(vm->getResult()->getValueAsInt32(), sum);
+
+   UINT64 instructions = vm->getInstructionCount();
+   UINT64 allocations = vm->getValuePool()->getAllocations();
+   AssertTrue(vm->getValuePool()->getChunkAllocations() < 4);
+   delete vm;
+   EndTest(elapsed);
+#ifdef HEAP_ALLOCATION_COUNTER_AVAILABLE
+   _tprintf(_T("   ") UINT64_FMT _T(" instructions, %0.3f pool allocations and %0.6f heap allocations per instruction\n"),
+            instructions, (double)allocations / (double)instructions, (double)s_heapAllocations / (double)instructions);
+#else
+   _tprintf(_T("   ") UINT64_FMT _T(" instructions, %0.3f pool allocations per instruction\n"),
+            instructions, (double)allocations / (double)instructions);
+#endif
+}
+
+/**
+ * Run VM in separate thread
+ */
+static THREAD_RESULT THREAD_CALL RunVMThread(void *arg)
+{
+   static_cast<NXSL_VM*>(arg)->run();
+   return THREAD_OK;
+}
+
+/**
+ * Test VM created by one thread and executed by another
+ */
+static void TestVMInOtherThread()
+{
+   TCHAR errorText[1024];
+   StartTest(_T("NXSL VM executed by other thread"));
+   NXSL_VM *vm = NXSLCompileAndCreateVM(s_numericScript, errorText, 1024, new NXSL_Environment());
+   AssertNotNullEx(vm, errorText);
+   for(int i = 0; i < 2; i++)
+   {
+      THREAD t = ThreadCreateEx(RunVMThread, 0, vm);
+      ThreadJoin(t);
+   }
+   AssertNotNull(vm->getResult());
+   AssertTrue(vm->getValuePool()->getChunkAllocations() < 4);
+   delete vm;
+   EndTest();
+}
+
+/**
+ * main()
+ */
+int main(int argc, char *argv[])
+{
+   TestValueClass();
+   TestNumericPerformance();
+   TestVMInOtherThread();
+   return 0;
+}
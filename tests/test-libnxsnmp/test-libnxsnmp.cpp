@@ -140,6 +140,495 @@ static void TestVariableClass()
    EndTest();
 }
 
+/**
+ * Test SNMPv3 key localization and key cache (test vectors from RFC 3414 section A.3)
+ */
+static void TestKeyLocalization()
+{
+   static BYTE engineId[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+   static BYTE md5Key[] = { 0x52, 0x6f, 0x5e, 0xed, 0x9f, 0xcc, 0xe2, 0x6f, 0x89, 0x64, 0xc2, 0x93, 0x07, 0x87, 0xd8, 0x2b };
+   static BYTE sha1Key[] = { 0x66, 0x95, 0xfe, 0xbc, 0x92, 0x88, 0xe3, 0x62, 0x82, 0x23, 0x5f, 0xc7, 0x15, 0x1f, 0x12, 0x84, 0x97, 0xb3, 0x8f, 0x3f };
+   SNMP_Engine engine(engineId, sizeof(engineId));
+
+   StartTest(_T("SNMP_SecurityContext: MD5 key localization"));
+   SNMP_SecurityContext *ctx = new SNMP_SecurityContext("user", "maplesyrup", SNMP_AUTH_MD5);
+   ctx->setAuthoritativeEngine(engine);
+   AssertTrue(!memcmp(ctx->getAuthKeyMD5(), md5Key, 16));
+   delete ctx;
+   EndTest();
+
+   StartTest(_T("SNMP_SecurityContext: SHA1 key localization"));
+   ctx = new SNMP_SecurityContext("user", "maplesyrup", "maplesyrup", SNMP_AUTH_SHA1, SNMP_ENCRYPT_DES);
+   ctx->setAuthoritativeEngine(engine);
+   AssertTrue(!memcmp(ctx->getAuthKeySHA1(), sha1Key, 20));
+   AssertTrue(!memcmp(ctx->getPrivKey(), sha1Key, 20));
+   EndTest();
+
+   StartTest(_T("SNMP_SecurityContext: localized key cache"));
+   UINT64 hits, misses;
+   int size;
+   SnmpGetKeyCacheCounters(&hits, &misses, &size);
+   INT64 start = GetCurrentTimeMs();
+   for(int i = 0; i < 100; i++)
+   {
+      SNMP_SecurityContext *copy = new SNMP_SecurityContext(ctx);
+      copy->setAuthoritativeEngine(SNMP_Engine());
+      copy->setAuthoritativeEngine(engine);
+      AssertTrue(!memcmp(copy->getAuthKeySHA1(), sha1Key, 20));
+      delete copy;
+   }
+   INT64 elapsed = GetCurrentTimeMs() - start;
+   UINT64 hits2, misses2;
+   SnmpGetKeyCacheCounters(&hits2, &misses2, &size);
+   AssertEquals(misses2, misses);
+   AssertEquals(hits2 - hits, 200);
+   ctx->setAuthoritativeEngine(SNMP_Engine(engineId, sizeof(engineId), 5, 1000));   // boots and time does not affect keys
+   AssertTrue(!memcmp(ctx->getAuthKeySHA1(), sha1Key, 20));
+   SnmpGetKeyCacheCounters(&hits, &misses, &size);
+   AssertEquals(hits, hits2);
+   delete ctx;
+   EndTest(elapsed);
+}
+
+/**
+ * Simulated agent table size
+ */
+#define SIM_TABLE_SIZE  50
+
+/**
+ * Transport simulating SNMP agent with single table (1.3.6.1.2.1.2.2.1.2.1 .. 1.3.6.1.2.1.2.2.1.2.50)
+ * followed by one unrelated object
+ */
+class SimulatedTransport : public SNMP_Transport
+{
+private:
+   SNMP_PDU *m_response;
+   bool m_supportBulk;
+   bool m_bulkTimeout;
+
+   static bool getNextObject(const SNMP_ObjectId& name, UINT32 *next)
+   {
+      static UINT32 base[] = { 1, 3, 6, 1, 2, 1, 2, 2, 1, 2 };
+      memcpy(next, base, sizeof(base));
+      if (name.compare(base, 10) == OID_PRECEDING)
+      {
+         next[10] = 1;
+         return true;
+      }
+      if ((name.compare(base, 10) == OID_EQUAL) || (name.compare(base, 10) == OID_SHORTER))
+      {
+         next[10] = 1;
+         return true;
+      }
+      if ((name.compare(base, 10) == OID_LONGER) && (name.getElement(10) < SIM_TABLE_SIZE))
+      {
+         next[10] = name.getElement(10) + 1;
+         return true;
+      }
+      if ((name.compare(base, 10) == OID_LONGER) && (name.getElement(10) == SIM_TABLE_SIZE))
+      {
+         next[9] = 3;   // ifType.1
+         next[10] = 1;
+         return true;
+      }
+      return false;
+   }
+
+public:
+   int requests;
+   int bulkRequests;
+
+   SimulatedTransport(int version, bool supportBulk, bool bulkTimeout = false) : SNMP_Transport()
+   {
+      m_snmpVersion = version;
+      m_response = NULL;
+      m_supportBulk = supportBulk;
+      m_bulkTimeout = bulkTimeout;
+      requests = 0;
+      bulkRequests = 0;
+   }
+
+   virtual ~SimulatedTransport()
+   {
+      delete m_response;
+   }
+
+   virtual int sendMessage(SNMP_PDU *pdu)
+   {
+      requests++;
+      delete m_response;
+      m_response = new SNMP_PDU(SNMP_RESPONSE, pdu->getRequestId(), pdu->getVersion());
+      if (pdu->getCommand() == SNMP_GET_BULK_REQUEST)
+      {
+         bulkRequests++;
+         if (m_bulkTimeout)
+         {
+            delete m_response;   // do not respond at all
+            m_response = NULL;
+            return 1;
+         }
+         if (!m_supportBulk)
+            return 1;   // respond with empty PDU
+      }
+
+      int count = (pdu->getCommand() == SNMP_GET_BULK_REQUEST) ? (int)pdu->getMaxRepetitions() : 1;
+      SNMP_ObjectId name = pdu->getVariable(0)->getName();
+      for(int i = 0; i < count; i++)
+      {
+         UINT32 next[11];
+         if (!getNextObject(name, next))
+         {
+            SNMP_Variable *v = new SNMP_Variable(name);
+            v->setValueFromString(ASN_END_OF_MIBVIEW, _T(""));
+            m_response->bindVariable(v);
+            break;
+         }
+         name.setValue(next, 11);
+         SNMP_Variable *v = new SNMP_Variable(name);
+         TCHAR value[32];
+         _sntprintf(value, 32, _T("%d"), next[10]);
+         v->setValueFromString(ASN_INTEGER, value);
+         m_response->bindVariable(v);
+      }
+      return 1;
+   }
+
+   virtual int readMessage(SNMP_PDU **data, UINT32 timeout, struct sockaddr *sender, socklen_t *addrSize,
+                           SNMP_SecurityContext* (*contextFinder)(struct sockaddr *, socklen_t))
+   {
+      if (m_response == NULL)
+         return 0;   // timeout
+      *data = m_response;
+      m_response = NULL;
+      return 1;
+   }
+
+   virtual WORD getPort()
+   {
+      return 161;
+   }
+};
+
+/**
+ * Walk callback
+ */
+static UINT32 WalkCallback(SNMP_Variable *v, SNMP_Transport *transport, void *arg)
+{
+   INT32 *sum = (INT32 *)arg;
+   *sum += v->getValueAsInt();
+   return SNMP_ERR_SUCCESS;
+}
+
+/**
+ * Test SNMP walk
+ */
+static void TestWalk()
+{
+   StartTest(_T("SNMP_PDU: GETBULK encoding"));
+   SNMP_PDU *pdu = new SNMP_PDU(SNMP_GET_BULK_REQUEST, 1234, SNMP_VERSION_2C);
+   pdu->setNonRepeaters(1);
+   pdu->setMaxRepetitions(25);
+   pdu->bindVariable(new SNMP_Variable(s_system, sizeof(s_system) / sizeof(UINT32)));
+   SNMP_SecurityContext context("public");
+   BYTE *buffer;
+   size_t size = pdu->encode(&buffer, &context);
+   AssertTrue(size > 0);
+   SNMP_PDU *decoded = new SNMP_PDU();
+   AssertTrue(decoded->parse(buffer, size, &context, false));
+   AssertEquals(decoded->getCommand(), SNMP_GET_BULK_REQUEST);
+   AssertEquals(decoded->getNonRepeaters(), 1);
+   AssertEquals(decoded->getMaxRepetitions(), 25);
+   AssertEquals(decoded->getVariable(0)->getName().compare(s_oidSystem), OID_EQUAL);
+   free(buffer);
+   delete decoded;
+   delete pdu;
+   EndTest();
+
+   static UINT32 root[] = { 1, 3, 6, 1, 2, 1, 2, 2, 1, 2 };
+   INT32 expected = SIM_TABLE_SIZE * (SIM_TABLE_SIZE + 1) / 2;
+
+   StartTest(_T("SnmpWalk: SNMPv1 (GETNEXT)"));
+   SimulatedTransport *t = new SimulatedTransport(SNMP_VERSION_1, true);
+   INT32 sum = 0;
+   AssertEquals(SnmpWalk(t, root, 10, WalkCallback, &sum), SNMP_ERR_SUCCESS);
+   AssertEquals(sum, expected);
+   AssertEquals(t->requests, SIM_TABLE_SIZE + 1);
+   AssertEquals(t->bulkRequests, 0);
+   delete t;
+   EndTest();
+
+   StartTest(_T("SnmpWalk: SNMPv2c (GETBULK)"));
+   SnmpSetDefaultMaxRepetitions(20);
+   t = new SimulatedTransport(SNMP_VERSION_2C, true);
+   sum = 0;
+   AssertEquals(SnmpWalk(t, root, 10, WalkCallback, &sum), SNMP_ERR_SUCCESS);
+   AssertEquals(sum, expected);
+   AssertEquals(t->requests, 3);
+   AssertEquals(t->bulkRequests, 3);
+   delete t;
+   EndTest();
+
+   StartTest(_T("SnmpWalk: fallback to GETNEXT"));
+   t = new SimulatedTransport(SNMP_VERSION_2C, false);
+   sum = 0;
+   AssertEquals(SnmpWalk(t, root, 10, WalkCallback, &sum), SNMP_ERR_SUCCESS);
+   AssertEquals(sum, expected);
+   AssertEquals(t->requests, SIM_TABLE_SIZE + 2);
+   AssertEquals(t->bulkRequests, 1);
+   delete t;
+   EndTest();
+
+   StartTest(_T("SnmpGetWalkCounters"));
+   LIBNXSNMP_WALK_COUNTERS counters;
+   SnmpGetWalkCounters(&counters);
+   AssertEquals(counters.walks, _ULL(3));
+   AssertEquals(counters.requests, (UINT64)(SIM_TABLE_SIZE * 2 + 6));
+   AssertEquals(counters.bulkFallbacks, _ULL(1));
+   EndTest();
+
+   StartTest(_T("SnmpWalk: no fallback to GETNEXT on timeout"));
+   t = new SimulatedTransport(SNMP_VERSION_2C, true, true);
+   sum = 0;
+   AssertEquals(SnmpWalk(t, root, 10, WalkCallback, &sum), SNMP_ERR_TIMEOUT);
+   AssertEquals(sum, 0);
+   AssertEquals(t->bulkRequests, t->requests);
+   delete t;
+   SnmpGetWalkCounters(&counters);
+   AssertEquals(counters.walks, _ULL(4));
+   AssertEquals(counters.bulkFallbacks, _ULL(1));
+   EndTest();
+}
+
+/**
+ * Simulated UDP agent for asynchronous engine tests. Requests are collected until
+ * no new requests arrive within short interval and then answered in one batch,
+ * so batch size shows number of simultaneous requests sent by engine.
+ */
+struct UdpResponder
+{
+   SOCKET s;
+   UINT16 port;
+   bool stop;
+   int requests;
+   int maxBatch;
+};
+
+/**
+ * UDP responder thread
+ */
+static THREAD_RESULT THREAD_CALL UdpResponderThread(void *arg)
+{
+   UdpResponder *r = (UdpResponder *)arg;
+   SocketPoller sp;
+   BYTE buffer[2048];
+   SNMP_PDU *batch[64];
+   struct sockaddr_in peers[64];
+   int count = 0;
+   while(!r->stop)
+   {
+      sp.reset();
+      sp.add(r->s);
+      if (sp.poll((count > 0) ? 50 : 200) > 0)
+      {
+         struct sockaddr_in peer;
+         socklen_t len = sizeof(peer);
+         int bytes = recvfrom(r->s, (char *)buffer, sizeof(buffer), 0, (struct sockaddr *)&peer, &len);
+         if (bytes <= 0)
+            continue;
+         SNMP_PDU *pdu = new SNMP_PDU();
+         SNMP_SecurityContext context("public");
+         if (!pdu->parse(buffer, bytes, &context, false) || (count == 64))
+         {
+            delete pdu;
+            continue;
+         }
+         batch[count] = pdu;
+         peers[count] = peer;
+         count++;
+         continue;
+      }
+
+      if (count > r->maxBatch)
+         r->maxBatch = count;
+      for(int i = 0; i < count; i++)
+      {
+         r->requests++;
+         SNMP_PDU *response = new SNMP_PDU(SNMP_RESPONSE, batch[i]->getRequestId(), batch[i]->getVersion());
+         SNMP_Variable *v = new SNMP_Variable(batch[i]->getVariable(0)->getName());
+         TCHAR value[32];
+         _sntprintf(value, 32, _T("%u"), batch[i]->getRequestId());
+         v->setValueFromString(ASN_INTEGER, value);
+         response->bindVariable(v);
+
+         SNMP_SecurityContext context("public");
+         BYTE *packet;
+         size_t size = response->encode(&packet, &context);
+         if (size > 0)
+         {
+            sendto(r->s, (char *)packet, (int)size, 0, (struct sockaddr *)&peers[i], sizeof(struct sockaddr_in));
+            free(packet);
+         }
+         delete response;
+         delete batch[i];
+      }
+      count = 0;
+   }
+   return THREAD_OK;
+}
+
+/**
+ * Context for asynchronous engine test callback
+ */
+struct AsyncTestContext
+{
+   VolatileCounter completed;
+   VolatileCounter matched;
+   UINT32 lastError;
+};
+
+/**
+ * Asynchronous engine test callback
+ */
+static void AsyncTestCallback(UINT32 rc, SNMP_PDU *response, void *context)
+{
+   AsyncTestContext *c = (AsyncTestContext *)context;
+   if ((rc == SNMP_ERR_SUCCESS) && (response->getNumVariables() == 1) &&
+       ((UINT32)response->getVariable(0)->getValueAsUInt() == response->getRequestId()))
+      InterlockedIncrement(&c->matched);
+   else
+      c->lastError = rc;
+   InterlockedIncrement(&c->completed);
+}
+
+/**
+ * Data for blocking request thread
+ */
+struct BlockingRequestData
+{
+   SNMP_AsyncEngine *engine;
+   UINT16 port;
+   UINT32 rc;
+   CONDITION completed;
+};
+
+/**
+ * Thread which sends blocking request to agent that does not respond
+ */
+static THREAD_RESULT THREAD_CALL BlockingRequestThread(void *arg)
+{
+   BlockingRequestData *data = (BlockingRequestData *)arg;
+   SNMP_SecurityContext context("public");
+   SNMP_PDU *pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), SNMP_VERSION_2C);
+   pdu->bindVariable(new SNMP_Variable(s_oidSysDescription));
+   SNMP_PDU *response = NULL;
+   data->rc = data->engine->doRequest(pdu, InetAddress::parse("127.0.0.1"), data->port, &context, &response, 10000, 3);
+   delete response;
+   ConditionSet(data->completed);
+   return THREAD_OK;
+}
+
+/**
+ * Test asynchronous SNMP engine
+ */
+static void TestAsyncEngine()
+{
+   StartTest(_T("SNMP_AsyncEngine: setup"));
+   UdpResponder responder;
+   memset(&responder, 0, sizeof(responder));
+   responder.s = socket(AF_INET, SOCK_DGRAM, 0);
+   AssertTrue(responder.s != INVALID_SOCKET);
+   struct sockaddr_in sa;
+   memset(&sa, 0, sizeof(sa));
+   sa.sin_family = AF_INET;
+   sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   AssertTrue(bind(responder.s, (struct sockaddr *)&sa, sizeof(sa)) == 0);
+   socklen_t len = sizeof(sa);
+   AssertTrue(getsockname(responder.s, (struct sockaddr *)&sa, &len) == 0);
+   responder.port = ntohs(sa.sin_port);
+   THREAD responderThread = ThreadCreateEx(UdpResponderThread, 0, &responder);
+
+   SNMP_AsyncEngine *engine = new SNMP_AsyncEngine(4);
+   AssertTrue(engine->start());
+   EndTest();
+
+   StartTest(_T("SNMP_AsyncEngine: concurrent requests"));
+   InetAddress loopback = InetAddress::parse("127.0.0.1");
+   SNMP_SecurityContext context("public");
+   AsyncTestContext c;
+   memset(&c, 0, sizeof(c));
+   for(int i = 0; i < 32; i++)
+   {
+      SNMP_PDU *pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), SNMP_VERSION_2C);
+      pdu->bindVariable(new SNMP_Variable(s_oidSysDescription));
+      AssertEquals(engine->sendRequest(pdu, loopback, responder.port, &context, AsyncTestCallback, &c, 2000, 1), SNMP_ERR_SUCCESS);
+   }
+   for(int i = 0; (i < 100) && (c.completed < 32); i++)
+      ThreadSleepMs(100);
+   AssertEquals(c.completed, 32);
+   AssertEquals(c.matched, 32);
+   AssertTrue(responder.maxBatch <= 4);
+   EndTest();
+
+   StartTest(_T("SNMP_AsyncEngine: blocking request"));
+   SNMP_PDU *pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), SNMP_VERSION_1);
+   pdu->bindVariable(new SNMP_Variable(s_oidSysDescription));
+   SNMP_PDU *response = NULL;
+   AssertEquals(engine->doRequest(pdu, loopback, responder.port, &context, &response), SNMP_ERR_SUCCESS);
+   AssertNotNull(response);
+   AssertEquals(response->getNumVariables(), 1);
+   delete response;
+   EndTest();
+
+   StartTest(_T("SNMP_AsyncEngine: timeout"));
+   responder.stop = true;
+   ThreadJoin(responderThread);
+   memset(&c, 0, sizeof(c));
+   pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), SNMP_VERSION_2C);
+   pdu->bindVariable(new SNMP_Variable(s_oidSysDescription));
+   AssertEquals(engine->sendRequest(pdu, loopback, responder.port, &context, AsyncTestCallback, &c, 200, 2), SNMP_ERR_SUCCESS);
+   for(int i = 0; (i < 50) && (c.completed < 1); i++)
+      ThreadSleepMs(100);
+   AssertEquals(c.completed, 1);
+   AssertEquals(c.lastError, SNMP_ERR_TIMEOUT);
+   SNMP_AsyncEngineStats stats;
+   engine->getStats(&stats);
+   AssertTrue(stats.timeouts == 1);
+   AssertTrue(stats.retransmissions >= 1);
+   AssertEquals(stats.inFlight, 0);
+   EndTest();
+
+   StartTest(_T("SNMP_AsyncEngine: SNMPv3 rejected"));
+   pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), SNMP_VERSION_3);
+   AssertEquals(engine->sendRequest(pdu, loopback, responder.port, &context, AsyncTestCallback, &c), SNMP_ERR_PARAM);
+   EndTest();
+
+   StartTest(_T("SNMP_AsyncEngine: stop completes blocking request"));
+   BlockingRequestData data;
+   data.engine = engine;
+   data.port = responder.port;
+   data.rc = SNMP_ERR_SUCCESS;
+   data.completed = ConditionCreate(true);
+   THREAD requestThread = ThreadCreateEx(BlockingRequestThread, 0, &data);
+   ThreadSleepMs(200);
+   engine->stop();
+   AssertTrue(ConditionWait(data.completed, 2000));
+   ThreadJoin(requestThread);
+   ConditionDestroy(data.completed);
+   AssertEquals(data.rc, SNMP_ERR_COMM);
+   EndTest();
+
+   StartTest(_T("SNMP_AsyncEngine: request after stop rejected"));
+   pdu = new SNMP_PDU(SNMP_GET_REQUEST, SnmpNewRequestId(), SNMP_VERSION_2C);
+   pdu->bindVariable(new SNMP_Variable(s_oidSysDescription));
+   response = NULL;
+   AssertEquals(engine->doRequest(pdu, loopback, responder.port, &context, &response), SNMP_ERR_PARAM);
+   AssertNull(response);
+   EndTest();
+
+   delete engine;
+   closesocket(responder.s);
+}
+
 /**
  * main()
  */
@@ -148,5 +637,8 @@ int main(int argc, char *argv[])
    TestOidConversion();
    TestOidClass();
    TestVariableClass();
+   TestKeyLocalization();
+   TestWalk();
+   TestAsyncEngine();
    return 0;
 }